@@ -47,6 +47,7 @@ template<> struct Traits<Spin>: public Traits<Build>
 template<> struct Traits<Heaps>: public Traits<Build>
 {
     static const bool debugged = hysterically_debugged;
+    static const bool slab = false; // per-CPU size-class magazines in front of the heaps
 };
 
 template<> struct Traits<Observers>: public Traits<Build>
@@ -72,6 +73,7 @@ template<> struct Traits<Init>: public Traits<Build>
 
 template<> struct Traits<Framework>: public Traits<Build>
 {
+    static const bool syscall_ring = false; // batched submission of non-blocking system calls through a ring shared with the kernel
 };
 
 template<> struct Traits<Aspect>: public Traits<Build>
@@ -124,6 +126,10 @@ template<> struct Traits<Thread>: public Traits<Build>
     static const bool smp = Traits<System>::multicore;
     static const bool trace_idle = hysterically_debugged;
     static const bool simulate_capacity = false;
+    static const bool queue_locking = false;  // per-queue scheduler locks for partitioned criteria (e.g. Fixed_CPU, PEDF)
+    static const bool lock_profiling = false; // per-CPU scheduler lock wait and hold times
+    static const bool work_stealing = false;  // idle CPUs pull best-effort threads from the busiest queue of partitioned criteria (e.g. Fixed_CPU)
+    static const unsigned int STEAL_INTERVAL = 1000; // us, minimum time between two steals by the same CPU
 
     typedef IF<(CPUS > 1), Fixed_CPU, FCFS>::Result Criterion;
     static const unsigned int QUANTUM = 10000; // us
@@ -132,6 +138,8 @@ template<> struct Traits<Thread>: public Traits<Build>
 template<> struct Traits<Scheduler<Thread>>: public Traits<Build>
 {
     static const bool debugged = Traits<Thread>::trace_idle || hysterically_debugged;
+    static const bool indexed_queues = false; // priority bitmap (static criteria) or pairing heap (dynamic criteria) run-queues
+    static const bool enforce_capacity = false; // periodic EDF jobs that overrun their capacity have their deadlines postponed (see EDF)
 };
 
 template<> struct Traits<Synchronizer>: public Traits<Build>
@@ -142,6 +150,7 @@ template<> struct Traits<Synchronizer>: public Traits<Build>
 template<> struct Traits<Alarm>: public Traits<Build>
 {
     static const bool visible = hysterically_debugged;
+    static const bool tickless = false; // one-shot timer programming and a timing wheel instead of periodic ticks
 };
 
 template<> struct Traits<SmartData>: public Traits<Build>
@@ -218,6 +227,9 @@ template<> struct Traits<DHCP>: public Traits<Network>
 template<> struct Traits<Monitor>: public Traits<Build>
 {
     static const bool enabled = monitored;
+    static const bool trace = false;                    // stream a binary trace instead of keeping snapshots until shutdown (see tools/epostrace)
+    static const unsigned int TRACE_SIZE = 4096;        // bytes per CPU (a power of 2)
+    static const unsigned int TRACE_PERIOD = 10000;     // us between drains
 
     static constexpr System_Event       SYSTEM_EVENTS[]                 = { ELAPSED_TIME, DEADLINE_MISSES, CPU_EXECUTION_TIME, THREAD_EXECUTION_TIME, RUNNING_THREAD };
     static constexpr Hertz              SYSTEM_EVENTS_FREQUENCIES[]     = {            1,               1,                  1,                     1,              1 }; // in Hz
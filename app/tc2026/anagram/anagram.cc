@@ -217,7 +217,11 @@ void Anagram::anagram_ReadDict(void) {
     *pchBase++ = 0;
 }
 
-Anagram::Anagram() { anagram_ReadDict(); }
+Anagram::Anagram() {
+    anagram_freeHeapPos = 0;
+    anagram_ReadDict();
+    anagram_dictHeapPos = anagram_freeHeapPos;
+}
 
 /*
   Core benchmark functions
@@ -432,6 +436,9 @@ void Anagram::anagram_SortCandidates(void) {
 }
 
 int Anagram::run() {
+    /* Release the words allocated by the previous run, but keep the dictionary */
+    anagram_freeHeapPos = anagram_dictHeapPos;
+
     for (int i = 0; i < 3; i++) {
         anagram_Reset();
         anagram_BuildMask(anagram_achPhrase[i]);
@@ -207,4 +207,5 @@ class Anagram {
 
     inline static char anagram_simulated_heap[ANAGRAM_HEAP_SIZE];
     inline static unsigned int anagram_freeHeapPos;
+    inline static unsigned int anagram_dictHeapPos;
 };
@@ -410,6 +410,11 @@ void Audiobeam::audiobeam_calc_single_pos(float source_location[3], float audiob
 */
 
 int Audiobeam::run() {
+    /* Each run consumes the whole input and allocates its queues from scratch */
+    audiobeam_input_pos = 0;
+    audiobeam_checksum = 0;
+    audiobeam_freeall();
+
     char hamming = 1;
     audiobeam_calc_single_pos(audiobeam_source_location, audiobeam_mic_locations, hamming);
 
@@ -962,7 +962,7 @@ const float Audiobeam::audiobeam_input_data[5760] = {
     1.5545953e-002,  -5.7188645e-002, 3.3708440e-002,  7.9527486e-003,  7.2838427e-002,  -8.7159852e-004,
     9.8852335e-002,  4.3261724e-002,  -2.2410237e-002, -1.9969511e-002, 1.3049591e-002,  1.3520410e-001};
 
-const unsigned int Audiobeam::audiobeam_input_data_size = sizeof(Audiobeam::audiobeam_mic_locations_data);
+const unsigned int Audiobeam::audiobeam_input_data_size = sizeof(Audiobeam::audiobeam_input_data);
 
 const float Audiobeam::audiobeam_mic_locations_data[15][3] = {{1.5, 2.79, 0},
                                                               {1.5, 2.82, 0},
@@ -984,7 +984,7 @@ const unsigned int Audiobeam::audiobeam_mic_locations_data_size = sizeof(Audiobe
 
 const float Audiobeam::audiobeam_source_location_data[3] = {1.1677, 2.1677, 1};
 
-const unsigned int Audiobeam::audiobeam_source_location_data_size = sizeof(Audiobeam::audiobeam_mic_locations_data);
+const unsigned int Audiobeam::audiobeam_source_location_data_size = sizeof(Audiobeam::audiobeam_source_location_data);
 
 const float Audiobeam::audiobeam_origin_location_data[3] = {1.5, 3, 0};
 
@@ -11,3 +11,5 @@ void *audiobeam_malloc(unsigned int numberOfBytes) {
     audiobeam_freeHeapPos += ((numberOfBytes + 4) & (unsigned int)0xfffffffc);
     return currentPos;
 }
+
+void audiobeam_freeall(void) { audiobeam_freeHeapPos = 0; }
@@ -23,5 +23,7 @@
 #define AUDIOBEAM_MALLOC_H
 
 void *audiobeam_malloc(unsigned int numberOfBytes);
+//! Frees ALL allocated memory space
+void audiobeam_freeall(void);
 
 #endif
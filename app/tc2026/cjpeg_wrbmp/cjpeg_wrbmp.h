@@ -62,6 +62,10 @@ class CJpegWRBMP {
     ~CJpegWRBMP() {}
 
     inline int run() {
+        // Rewind the output stream, which would otherwise overflow after a few runs
+        cjpeg_wrbmp_jpeg_stream = cjpeg_wrbmp_output_array;
+        cjpeg_wrbmp_checksum = 0;
+
         cjpeg_wrbmp_finish_output_bmp(&cjpeg_wrbmp_jpeg_dec_1);
         cjpeg_wrbmp_write_colormap(&cjpeg_wrbmp_jpeg_dec_1, 768, 4, 1);
 
@@ -31,6 +31,7 @@ class Cosf {
 
     inline int run() {
         float i;
+        cosf_solutions = 0.0f;
         for (i = 0.0f; i < 10; i += 0.1f) cosf_solutions += basicmath___cosf(i);
 
         int temp = cosf_solutions;
@@ -36,6 +36,7 @@ class Deg2Rad {
     ~Deg2Rad() = default;
 
     inline int run() {
+        deg2rad_Y = 0;
         for (deg2rad_X = 0.0f; deg2rad_X <= 360.0f; deg2rad_X += 1.0f) deg2rad_Y += deg2rad(deg2rad_X);
 
         int temp = deg2rad_Y;
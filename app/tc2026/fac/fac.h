@@ -34,6 +34,7 @@ class Fac {
     inline int run() {
         int i;
 
+        fac_s = 0;
         for (i = 0; i <= fac_n; i++) {
             fac_s += fac_fac(i);
         }
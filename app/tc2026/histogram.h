@@ -0,0 +1,71 @@
+#pragma once
+
+// Log-linear histogram of non-negative values (e.g. microseconds)
+// Each power of two is split into SUB_BUCKETS buckets, so percentiles are reported with a relative error below
+// 1 / SUB_BUCKETS (12.5%) using a fixed amount of memory, regardless of how many samples are recorded.
+// Percentiles are the upper bound of the bucket where they fall (i.e., never optimistic); the maximum is exact.
+class Histogram {
+   public:
+    static const unsigned int SUB_BUCKETS = 8;
+    static const unsigned int SUB_BITS = 3;  // log2(SUB_BUCKETS)
+    static const unsigned int BUCKETS = (32 - SUB_BITS + 1) * SUB_BUCKETS;
+
+   public:
+    Histogram() { reset(); }
+
+    void reset() {
+        _count = 0;
+        _max = 0;
+        for (unsigned int i = 0; i < BUCKETS; i++) _buckets[i] = 0;
+    }
+
+    void add(unsigned int value) {
+        _buckets[_index(value)]++;
+        _count++;
+        if (value > _max) _max = value;
+    }
+
+    unsigned int count() const { return _count; }
+    unsigned int max() const { return _max; }
+
+    // p in percent (e.g. 50, 99)
+    unsigned int percentile(unsigned int p) const {
+        if (!_count) return 0;
+
+        unsigned long long rank = (static_cast<unsigned long long>(_count) * p + 99) / 100;
+        if (rank == 0) rank = 1;
+
+        unsigned long long seen = 0;
+        for (unsigned int i = 0; i < BUCKETS; i++) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                unsigned int bound = _upper(i);
+                return (bound < _max) ? bound : _max;
+            }
+        }
+
+        return _max;
+    }
+
+   private:
+    static unsigned int _index(unsigned int value) {
+        if (value < SUB_BUCKETS) return value;
+
+        unsigned int msb = 31 - __builtin_clz(value);
+        return (msb - SUB_BITS + 1) * SUB_BUCKETS + ((value >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+    }
+
+    static unsigned int _upper(unsigned int index) {
+        if (index < SUB_BUCKETS) return index;
+
+        unsigned int msb = index / SUB_BUCKETS + SUB_BITS - 1;
+        unsigned long long bound =
+            (static_cast<unsigned long long>(SUB_BUCKETS + index % SUB_BUCKETS + 1) << (msb - SUB_BITS)) - 1;
+        return (bound > 0xffffffffULL) ? 0xffffffff : static_cast<unsigned int>(bound);
+    }
+
+   private:
+    unsigned int _count;
+    unsigned int _max;
+    unsigned int _buckets[BUCKETS];
+};
@@ -4,3 +4,16 @@
 
 void kalman_init(void);
 void kalman_main(void);
+
+// The filter keeps its state in globals, so there must be a single instance
+class Kalman {
+   public:
+    Kalman() { kalman_init(); }
+
+    ~Kalman() = default;
+
+    inline int run() {
+        kalman_main();
+        return 0;
+    }
+};
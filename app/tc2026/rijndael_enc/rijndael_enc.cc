@@ -178,6 +178,10 @@ void RijndaelEnc::rijndael_enc_encfile(struct rijndael_enc_FILE *fin, struct aes
 int RijndaelEnc::run() {
     struct aes ctx[1];
 
+    /* rewind the pseudo-file, so every run encrypts the whole input */
+    rijndael_enc_fin.cur_pos = 0;
+    rijndael_enc_checksum = 0;
+
     /* encryption in Cipher Block Chaining mode */
     rijndael_enc_set_key(rijndael_enc_key, rijndael_enc_key_len, enc, ctx);
     rijndael_enc_encfile(&rijndael_enc_fin, ctx);
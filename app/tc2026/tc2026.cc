@@ -6,6 +6,7 @@ int main() {
     BenchmarkRunner::init();
     BenchmarkRunner::run();
     BenchmarkRunner::print_thread_timing();
+    BenchmarkRunner::print_results();
     BenchmarkRunner::free();
 
     return 0;
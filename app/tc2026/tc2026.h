@@ -18,6 +18,8 @@
 #include "fac/fac.h"
 #include "fft/fft.h"
 #include "h264_dec/h264_dec.h"
+#include "histogram.h"
+#include "kalman.h"
 #include "md5/md5.h"
 #include "mpeg2/mpeg2.h"
 #include "petrinet/petrinet.h"
@@ -32,16 +34,16 @@ OStream cout;
 
 enum BenchmarkType {
     RIJNDAEL_ENC,
-    KALMAN,        // TODO: Bring it to standard
+    KALMAN,
     BANDWIDTH_L1,  // TODO: Improve with IsolBench
     BANDWIDTH_L2,  // TODO: Improve with IsolBench
     H264DEC,
     MPEG2,
     SUSAN,
     CJPEG_TRANSUPP,
-    CJPEG_WRBMP,  // WARN: There are some problems, but it works
-    AUDIOBEAM,    // FIX: Currently hangs after 4 iterations
-    ANAGRAM,      // FIX: Currently hangs after 2 iterations
+    CJPEG_WRBMP,
+    AUDIOBEAM,
+    ANAGRAM,
     PETRINET,
     FAC,
     PRIME,
@@ -53,6 +55,11 @@ enum BenchmarkType {
     FFT
 };
 
+static const char *const benchmark_names[] = {
+    "rijndael_enc", "kalman", "bandwidth_l1", "bandwidth_l2", "h264_dec", "mpeg2", "susan",
+    "cjpeg_transupp", "cjpeg_wrbmp", "audiobeam", "anagram", "petrinet", "fac", "prime",
+    "bitcount", "cosf", "deg2rad", "md5", "sha", "fft"};
+
 struct StressTask {
     const unsigned int period;
     const unsigned int deadline;
@@ -67,136 +74,176 @@ struct Taskset {
     const unsigned int size;
 };
 
+// Each kernel's run() returns a checksum-based result, which is EXPECTED when the kernel ran correctly
 template <int TaskEnum>
 struct BenchmarkTraits;
 
 template <>
 struct BenchmarkTraits<RIJNDAEL_ENC> {
     using Type = RijndaelEnc;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }  // Default constructor
 };
 
+template <>
+struct BenchmarkTraits<KALMAN> {
+    using Type = Kalman;
+    static const int EXPECTED = 0;
+    static Type *create() { return new Type(); }
+};
+
 template <>
 struct BenchmarkTraits<BANDWIDTH_L1> {
     using Type = Bandwidth;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(Bandwidth::L1_CACHE_SIZE); }
 };
 
 template <>
 struct BenchmarkTraits<BANDWIDTH_L2> {
     using Type = Bandwidth;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(Bandwidth::L2_CACHE_SIZE); }
 };
 
 template <>
 struct BenchmarkTraits<H264DEC> {
     using Type = H264Dec;
+    static const int EXPECTED = 1;  // h264_dec_return() is 1 for a properly decoded macroblock
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<MPEG2> {
     using Type = Mpeg2;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<SUSAN> {
     using Type = Susan;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<CJPEG_TRANSUPP> {
     using Type = CJpegTransupp;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<CJPEG_WRBMP> {
     using Type = CJpegWRBMP;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<AUDIOBEAM> {
     using Type = Audiobeam;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<ANAGRAM> {
     using Type = Anagram;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<PETRINET> {
     using Type = Petrinet;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<FAC> {
     using Type = Fac;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<PRIME> {
     using Type = Prime;
+    static const int EXPECTED = 0;  // neither of its inputs (81 and 2759) is prime
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<BITCOUNT> {
     using Type = BitCount;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<COSF> {
     using Type = Cosf;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<DEG2RAD> {
     using Type = Deg2Rad;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<MD5> {
     using Type = Md5;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<SHA> {
     using Type = Sha;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
 template <>
 struct BenchmarkTraits<FFT> {
     using Type = Fft;
+    static const int EXPECTED = 0;
     static Type *create() { return new Type(); }
 };
 
+// BenchmarkRunner
+// Runs the task set selected by Traits<Application>::TASKSET for TEST_DURATION seconds. Every job runs its kernel for
+// its whole iteration budget (wcet / duration iterations) and is measured against its nominal release time (the
+// release of the first job plus one period per job):
+// - release jitter: start - release (from the second job on, since the first one's start defines the releases);
+// - response time: finish - release (a deadline miss whenever it exceeds the relative deadline);
+// - execution time: finish - start.
+// print_results() summarizes these distributions (p50/p99/max, in us) in lines starting with "tc2026," that
+// tools/epostest collects and compares against a baseline.
 class BenchmarkRunner {
     typedef TSC::Time_Stamp Time_Stamp;
 
    private:
     static const unsigned int TEST_DURATION = Traits<Build>::EXPECTED_SIMULATION_TIME - 10;  // in seconds
-    static const unsigned int SELECTED_TASKSET = 1;
+    static const unsigned int SELECTED_TASKSET = Traits<Application>::TASKSET;
     static const unsigned int SEED = 20260610;
+    static const unsigned int CPUS = Traits<Build>::CPUS;
 
     static constexpr float SINGLE = 200000.0f;
     static constexpr float AES_IT_DURATION = 2800.0f;  // in microseconds
     static constexpr float KALMAN_IT_DURATION = 500.0f;
     static constexpr float BANDWIDTH_IT_DURATION = 2000.0f;
 
+    // Task sets
+    // A kernel must not appear twice in the same set, since some of them keep their state in globals.
+    // CPUs are taken modulo the number of CPUs of the target.
     static constexpr StressTask taskset_1[] = {
         // {1000000, 1000000, 200000, 1, H264DEC, SINGLE},
         // {1000000, 1000000, 200000, 1, RIJNDAEL, SINGLE},  // 20 - band
@@ -205,7 +252,37 @@ class BenchmarkRunner {
         {1000000, 1000000, 200000, 3, BANDWIDTH_L2, BANDWIDTH_IT_DURATION},
     };  // HP = 1
 
-    static constexpr Taskset tasksets[] = {{taskset_1, sizeof(taskset_1) / sizeof(StressTask)}};
+    // Every kernel once per job (checks the whole suite)
+    static constexpr StressTask taskset_2[] = {
+        {1000000, 1000000, 10000, 0, RIJNDAEL_ENC, SINGLE},   {1000000, 1000000, 10000, 1, KALMAN, SINGLE},
+        {1000000, 1000000, 10000, 2, BANDWIDTH_L1, SINGLE},   {1000000, 1000000, 10000, 3, BANDWIDTH_L2, SINGLE},
+        {1000000, 1000000, 10000, 0, H264DEC, SINGLE},        {1000000, 1000000, 10000, 1, MPEG2, SINGLE},
+        {1000000, 1000000, 10000, 2, SUSAN, SINGLE},          {1000000, 1000000, 10000, 3, CJPEG_TRANSUPP, SINGLE},
+        {1000000, 1000000, 10000, 0, CJPEG_WRBMP, SINGLE},    {1000000, 1000000, 10000, 1, AUDIOBEAM, SINGLE},
+        {1000000, 1000000, 10000, 2, ANAGRAM, SINGLE},        {1000000, 1000000, 10000, 3, PETRINET, SINGLE},
+        {1000000, 1000000, 10000, 0, FAC, SINGLE},            {1000000, 1000000, 10000, 1, PRIME, SINGLE},
+        {1000000, 1000000, 10000, 2, BITCOUNT, SINGLE},       {1000000, 1000000, 10000, 3, COSF, SINGLE},
+        {1000000, 1000000, 10000, 0, DEG2RAD, SINGLE},        {1000000, 1000000, 10000, 1, MD5, SINGLE},
+        {1000000, 1000000, 10000, 2, SHA, SINGLE},            {1000000, 1000000, 10000, 3, FFT, SINGLE},
+    };  // HP = 1
+
+    // Harmonic periods, one constrained deadline
+    static constexpr StressTask taskset_3[] = {
+        {100000, 100000, 20000, 0, RIJNDAEL_ENC, AES_IT_DURATION},
+        {50000, 50000, 5000, 1, KALMAN, KALMAN_IT_DURATION},
+        {200000, 200000, 40000, 1, BANDWIDTH_L1, BANDWIDTH_IT_DURATION},
+        {250000, 250000, 50000, 2, AUDIOBEAM, SINGLE},
+        {500000, 500000, 100000, 2, ANAGRAM, SINGLE},
+        {1000000, 500000, 200000, 3, SUSAN, SINGLE},
+        {500000, 500000, 100000, 3, CJPEG_WRBMP, SINGLE},
+    };  // HP = 1
+
+    static constexpr Taskset tasksets[] = {{taskset_1, sizeof(taskset_1) / sizeof(StressTask)},
+                                           {taskset_2, sizeof(taskset_2) / sizeof(StressTask)},
+                                           {taskset_3, sizeof(taskset_3) / sizeof(StressTask)}};
+
+    static_assert((SELECTED_TASKSET >= 1) && (SELECTED_TASKSET <= sizeof(tasksets) / sizeof(Taskset)),
+                  "Traits<Application>::TASKSET does not name a task set!");
 
     inline static constexpr Taskset taskset = tasksets[SELECTED_TASKSET - 1];
     inline static constexpr unsigned int task_count = taskset.size;
@@ -236,7 +313,7 @@ class BenchmarkRunner {
 
     // TODO: Remember the resume on RT!
     inline static void run() {
-        Time_Stamp tsc0 = _get_time() + Convert::us2count<Time_Stamp, Time_Base>(TSC::frequency(), 10000);
+        Time_Stamp tsc0 = _get_time() + _ts(10000);
 
         // TODO: Check this
         // Monitor::enable_captures();
@@ -274,18 +351,44 @@ class BenchmarkRunner {
         cout << "-----------------------------------------------------" << endl;
 
         for (unsigned int i = 0; i < task_count; i++) {
-            cout << "Task [" << i << "]: " << _threads[i] << '\n'
-                 << ">   Counted iterations: " << _current_iteration[i] << endl;
+            cout << "Task [" << i << "]: " << _threads[i] << " (" << benchmark_names[taskset.tasks[i].task] << ")\n"
+                 << ">   Counted jobs: " << _jobs[i] << " of " << _calc_jobs(i) << endl;
+
+            if (!_jobs[i]) continue;
 
-            const int total_jobs = _calc_jobs(i);
-            const int total_iterations = total_jobs * _calc_iter_per_job(i);
+            const int total_iterations = _jobs[i] * _calc_iter_per_job(i);
 
             cout << ">   Execution time: " << _us(_task_runtime[i]) << " us\n"
                  << ">   Job WCET: " << _us(_job_wcet[i]) << " us\n"
                  << ">   Iteration WCET: " << _us(_iteration_wcet[i]) << " us\n"
-                 << ">   Average job runtime: " << _us(_task_runtime[i] / total_jobs) << " us\n"
+                 << ">   Average job runtime: " << _us(_task_runtime[i] / _jobs[i]) << " us\n"
                  << ">   Average iteration runtime: " << _us(_task_runtime[i] / total_iterations) << " us\n"
-                 << ">   Iterations per job: " << _calc_iter_per_job(i) << endl;
+                 << ">   Iterations per job: " << _calc_iter_per_job(i) << '\n'
+                 << ">   Deadline misses: " << _misses[i] << '\n'
+                 << ">   Failed iterations: " << _errors[i] << '\n'
+                 << ">   Response time (p50/p99/max): " << _response[i].percentile(50) << '/'
+                 << _response[i].percentile(99) << '/' << _response[i].max() << " us\n"
+                 << ">   Release jitter (p50/p99/max): " << _jitter[i].percentile(50) << '/'
+                 << _jitter[i].percentile(99) << '/' << _jitter[i].max() << " us" << endl;
+        }
+    }
+
+    // One CSV line per task, preceded by a header, all starting with "tc2026,"
+    inline static void print_results() {
+        cout << "tc2026,taskset,task,benchmark,cpu,period,deadline,wcet,iterations,jobs,misses,errors,"
+             << "response_p50,response_p99,response_max,jitter_p50,jitter_p99,jitter_max,"
+             << "execution_p50,execution_p99,execution_max" << endl;
+
+        for (unsigned int i = 0; i < task_count; i++) {
+            const StressTask &t = taskset.tasks[i];
+
+            cout << "tc2026," << SELECTED_TASKSET << ',' << i << ',' << benchmark_names[t.task] << ',' << t.cpu % CPUS
+                 << ',' << t.period << ',' << t.deadline << ',' << t.wcet << ',' << _calc_iter_per_job(i) << ','
+                 << _jobs[i] << ',' << _misses[i] << ',' << _errors[i] << ',' << _response[i].percentile(50) << ','
+                 << _response[i].percentile(99) << ',' << _response[i].max() << ',' << _jitter[i].percentile(50)
+                 << ',' << _jitter[i].percentile(99) << ',' << _jitter[i].max() << ','
+                 << _execution[i].percentile(50) << ',' << _execution[i].percentile(99) << ','
+                 << _execution[i].max() << endl;
         }
     }
 
@@ -305,6 +408,13 @@ class BenchmarkRunner {
         return Convert::count2us<Hertz, Time_Stamp, Time_Base>(TSC::frequency(), ts);
     }
 
+    inline static Time_Stamp _ts(Microsecond us) {
+        return Convert::us2count<Time_Stamp, Time_Base>(TSC::frequency(), us);
+    }
+
+    // Time from "from" to "to", or 0 if "to" comes first (e.g. a release a bit earlier than the nominal one)
+    inline static unsigned int _since(Time_Stamp from, Time_Stamp to) { return (to > from) ? static_cast<unsigned int>(_us(to - from)) : 0; }
+
     template <int ID>
     inline static void _init_taskset() {
         constexpr BenchmarkType benchmark_type = taskset.tasks[ID].task;
@@ -315,7 +425,9 @@ class BenchmarkRunner {
         _task_runtime[ID] = 0;
         _job_wcet[ID] = 0;
         _iteration_wcet[ID] = 0;
-        _current_iteration[ID] = 0;
+        _jobs[ID] = 0;
+        _misses[ID] = 0;
+        _errors[ID] = 0;
 
         _init_taskset<ID + 1>();
     }
@@ -341,7 +453,8 @@ class BenchmarkRunner {
 
         cout << ">  Thread[" << ID << "]: period = " << taskset.tasks[ID].period
              << ", deadline = " << taskset.tasks[ID].deadline << ", wcet = " << taskset.tasks[ID].wcet
-             << ", activation = " << activation << ", times = " << job << ", cpu = " << taskset.tasks[ID].cpu << endl;
+             << ", activation = " << activation << ", times = " << job << ", cpu = " << taskset.tasks[ID].cpu % CPUS
+             << ", benchmark = " << benchmark_names[taskset.tasks[ID].task] << endl;
 
         _threads[ID] = new RT_Thread(&_run_func<ID>,
                                      taskset.tasks[ID].period,
@@ -349,7 +462,7 @@ class BenchmarkRunner {
                                      taskset.tasks[ID].wcet,
                                      activation,
                                      job,
-                                     taskset.tasks[ID].cpu);
+                                     taskset.tasks[ID].cpu % CPUS);
 
         _init_thread<ID + 1>(activation);
     }
@@ -377,16 +490,23 @@ class BenchmarkRunner {
 
         Time_Stamp init = _get_time();
 
-        volatile int _ = 0;  // Just to ensure that the return is used
+        // RT_Thread sets the periodic alarm right before the first job, so it defines the release of all others
+        if (_jobs[ID] == 0) {
+            _first_release[ID] = init;
+            _period[ID] = _ts(taskset.tasks[ID].period);
+        }
+        unsigned int job = _jobs[ID];
+        Time_Stamp release = _first_release[ID] + job * _period[ID];
 
         for (unsigned int iterations = 0; iterations < my_iter_per_job; iterations++) {
-            _ = benchmark->run();
+            if (benchmark->run() != BenchmarkTraits<task>::EXPECTED) _errors[ID]++;
         }
 
-        Time_Stamp job_runtime = _get_time() - init;
+        Time_Stamp end = _get_time();
+        Time_Stamp job_runtime = end - init;
         _task_runtime[ID] += job_runtime;
 
-        _current_iteration[ID]++;
+        _jobs[ID]++;
 
         Time_Stamp average_iteration_runtime = job_runtime / my_iter_per_job;
 
@@ -397,15 +517,31 @@ class BenchmarkRunner {
         if (job_runtime > _job_wcet[ID]) {
             _job_wcet[ID] = job_runtime;
         }
+
+        unsigned int response = _since(release, end);
+        if (response > taskset.tasks[ID].deadline) _misses[ID]++;
+
+        _response[ID].add(response);
+        if (job > 0)  // the first job's start is its release, so its jitter would always be 0
+            _jitter[ID].add(_since(release, init));
+        _execution[ID].add(_us(job_runtime));
     }
 
    private:
     inline static Time_Stamp _task_runtime[task_count];
     inline static Time_Stamp _job_wcet[task_count];
     inline static Time_Stamp _iteration_wcet[task_count];
+    inline static Time_Stamp _first_release[task_count];
+    inline static Time_Stamp _period[task_count];
+
+    inline static unsigned int _jobs[task_count];
+    inline static unsigned int _misses[task_count];
+    inline static unsigned int _errors[task_count];  // iterations whose result did not match the expected one
+    inline static Histogram _response[task_count];
+    inline static Histogram _jitter[task_count];
+    inline static Histogram _execution[task_count];
 
     inline static Random *_rand;
-    inline static unsigned int _current_iteration[task_count];
     inline static Thread *_threads[task_count];
     inline static Thread *_logger;
     inline static void *_benchmarks[task_count];
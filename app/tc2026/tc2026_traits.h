@@ -49,6 +49,7 @@ template<> struct Traits<Spin>: public Traits<Build>
 template<> struct Traits<Heaps>: public Traits<Build>
 {
     static const bool debugged = true;
+    static const bool slab = false; // per-CPU size-class magazines in front of the heaps
 };
 
 template<> struct Traits<Observers>: public Traits<Build>
@@ -74,6 +75,7 @@ template<> struct Traits<Init>: public Traits<Build>
 
 template<> struct Traits<Framework>: public Traits<Build>
 {
+    static const bool syscall_ring = false; // batched submission of non-blocking system calls through a ring shared with the kernel
 };
 
 template<> struct Traits<Aspect>: public Traits<Build>
@@ -97,6 +99,8 @@ template<> struct Traits<Application>: public Traits<Build>
     static const unsigned int STACK_SIZE = Traits<Machine>::STACK_SIZE;
     static const unsigned int HEAP_SIZE = Traits<Machine>::HEAP_SIZE;
     static const unsigned int MAX_THREADS = Traits<Machine>::MAX_THREADS;
+
+    static const unsigned int TASKSET = 1; // task set run by BenchmarkRunner (see tc2026.h)
 };
 
 template<> struct Traits<System>: public Traits<Build>
@@ -126,6 +130,10 @@ template<> struct Traits<Thread>: public Traits<Build>
     static const bool smp = Traits<System>::multicore;
     static const bool trace_idle = hysterically_debugged;
     static const bool simulate_capacity = false;
+    static const bool queue_locking = false;  // per-queue scheduler locks for partitioned criteria (e.g. Fixed_CPU, PEDF)
+    static const bool lock_profiling = false; // per-CPU scheduler lock wait and hold times
+    static const bool work_stealing = false;  // idle CPUs pull best-effort threads from the busiest queue of partitioned criteria (e.g. Fixed_CPU)
+    static const unsigned int STEAL_INTERVAL = 1000; // us, minimum time between two steals by the same CPU
 
     typedef IF<(CPUS > 1), PEDF, EDF>::Result Criterion;
     static const unsigned int QUANTUM = 10000; // us
@@ -134,6 +142,8 @@ template<> struct Traits<Thread>: public Traits<Build>
 template<> struct Traits<Scheduler<Thread>>: public Traits<Build>
 {
     static const bool debugged = Traits<Thread>::trace_idle || hysterically_debugged;
+    static const bool indexed_queues = false; // priority bitmap (static criteria) or pairing heap (dynamic criteria) run-queues
+    static const bool enforce_capacity = false; // periodic EDF jobs that overrun their capacity have their deadlines postponed (see EDF)
 };
 
 template<> struct Traits<Synchronizer>: public Traits<Build>
@@ -144,6 +154,7 @@ template<> struct Traits<Synchronizer>: public Traits<Build>
 template<> struct Traits<Alarm>: public Traits<Build>
 {
     static const bool visible = hysterically_debugged;
+    static const bool tickless = false; // one-shot timer programming and a timing wheel instead of periodic ticks
 };
 
 template<> struct Traits<SmartData>: public Traits<Build>
@@ -220,6 +231,9 @@ template<> struct Traits<DHCP>: public Traits<Network>
 template<> struct Traits<Monitor>: public Traits<Build>
 {
     static const bool enabled = monitored;
+    static const bool trace = false;                    // stream a binary trace instead of keeping snapshots until shutdown (see tools/epostrace)
+    static const unsigned int TRACE_SIZE = 4096;        // bytes per CPU (a power of 2)
+    static const unsigned int TRACE_PERIOD = 10000;     // us between drains
 
     static constexpr System_Event       SYSTEM_EVENTS[]                 = { RUNNING_THREAD,
                                                                             JOB_UTILIZATION,
@@ -12,7 +12,7 @@ class ARMv7: protected CPU_Common
 protected:
     static const bool multicore = Traits<System>::multicore;
     static const bool multitask = Traits<System>::multitask;
-    static const bool save_fpu  = Traits<FPU>::enabled && !Traits<FPU>::user_save;
+    static const bool save_fpu  = Traits<FPU>::enabled && !Traits<FPU>::user_save && !Traits<FPU>::lazy;
 
 public:
     // Bootstrap/service CPU id
@@ -289,6 +289,14 @@ public:
     static void fpu_save() {}           // no FPU in M3, implement for M4
     static void fpu_restore() {}        // no FPU in M3, implement for M4
 
+    using CPU_Common::FPU_Context;
+    using CPU_Common::fpu_enabled;
+    using CPU_Common::fpu_dirty;
+    using CPU_Common::fpu_on;
+    using CPU_Common::fpu_off;
+    using CPU_Common::fpu_save;
+    using CPU_Common::fpu_restore;
+
     static Reg pd() { return 0; }       // no MMU
     static void pd(Reg r) {}            // no MMU
 
@@ -406,6 +414,24 @@ public:
         PARITY          = 1 << 9  // Parity checking enable (if implemented)
     };
 
+    // FPEXC bits
+    enum {
+        FPEXC_EN    = 1 << 30  // VFP enable
+    };
+
+    // FPU Context (saved on demand for lazy FPU context switching)
+    class FPU_Context
+    {
+        friend class ARMv7_A;   // for fpu_save() and fpu_restore()
+
+    public:
+        FPU_Context(): _fpscr(0) { for(unsigned int i = 0; i < 16; i++) _d[i] = 0; }
+
+    private:
+        Reg64 _d[16];
+        Reg _fpscr;
+    };
+
     // CPU Context
     class Multitask_Context
     {
@@ -511,6 +537,23 @@ public:
     static void fpu_save() {    ASM("vpush {s0-s15} \n vpush {s16-s31}"); }
     static void fpu_restore() { ASM("vpop  {s0-s15} \n vpop  {s16-s31}"); }
 
+    // Lazy FPU context switching: clearing FPEXC.EN makes the next FPU instruction raise an undefined instruction exception
+    // Since there is no dirty flag, any use of the FPU after fpu_on() is taken as a change
+    static bool fpu_enabled() { return fpexc() & FPEXC_EN; }
+    static bool fpu_dirty() { return fpu_enabled(); }
+    static void fpu_on() { fpexc(fpexc() | FPEXC_EN); }
+    static void fpu_off() { fpexc(fpexc() & ~FPEXC_EN); }
+    static void fpu_save(FPU_Context * fc) {
+        ASM("vstmia %0, {d0-d15}" : : "r"(fc->_d) : "memory");
+        ASM("vmrs %0, fpscr" : "=r"(fc->_fpscr));
+    }
+    static void fpu_restore(const FPU_Context * fc) {
+        ASM("vldmia %0, {d0-d15}" : : "r"(fc->_d) : "memory");
+        ASM("vmsr fpscr, %0" : : "r"(fc->_fpscr));
+    }
+    static Reg fpexc() { Reg r; ASM("vmrs %0, fpexc" : "=r"(r)); return r; }
+    static void fpexc(Reg r) {  ASM("vmsr fpexc, %0" : : "r"(r)); }
+
     // ARMv7-A specifics
     static Reg  psr() { Reg r; ASM("mrs %0, cpsr" :  "=r"(r) : : ); return r; }
     static void psr(Reg r) {   ASM("msr cpsr, %0" : : "r"(r) : "cc"); }
@@ -709,6 +752,11 @@ public:
 
     using Base::fpu_save;
     using Base::fpu_restore;
+    using Base::FPU_Context;
+    using Base::fpu_enabled;
+    using Base::fpu_dirty;
+    using Base::fpu_on;
+    using Base::fpu_off;
 
     using Base::id;
     using Base::cores;
@@ -16,7 +16,7 @@ class ARMv7_MMU: public MMU_Common<12, 8, 12>
     friend class Setup;
 
 private:
-    typedef Grouping_List<Frame> List;
+    typedef IF<Traits<MMU>::buddy, Buddy_List<Frame>, Grouping_List<Frame>>::Result List;
     typedef MMU_Common<12, 8, 12> Common;
 
     static const bool colorful = Traits<MMU>::colorful;
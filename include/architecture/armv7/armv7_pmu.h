@@ -18,6 +18,7 @@ private:
 protected:
     static const unsigned int CHANNELS = 6;
     static const unsigned int FIXED = 0;
+    static const unsigned int COUNTER_BITS = 32;
     static const unsigned int EVENTS = PMU_Event::LAST_EVENT;
 
 
@@ -219,6 +220,7 @@ public:
     using Engine::CHANNELS;
     using Engine::FIXED;
     using Engine::EVENTS;
+    using Engine::COUNTER_BITS;
 
     using Engine::Event;
     using Engine::Count;
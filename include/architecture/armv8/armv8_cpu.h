@@ -316,6 +316,16 @@ public:
     static void fpu_save();
     static void fpu_restore();
 
+    // Lazy FPU context switching is not implemented for AArch64 (it would toggle CPACR_EL1.FPEN and trap on its first use)
+    static_assert(!Traits<FPU>::lazy, "Lazy FPU context switching is not implemented for AArch64");
+    using CPU_Common::FPU_Context;
+    using CPU_Common::fpu_enabled;
+    using CPU_Common::fpu_dirty;
+    using CPU_Common::fpu_on;
+    using CPU_Common::fpu_off;
+    using CPU_Common::fpu_save;
+    using CPU_Common::fpu_restore;
+
     // ARMv8 specifics
     static Reg  r0() { Reg r; ASM("mov %0, x0" :  "=r"(r) : : ); return r; }
     static void r0(Reg r) {   ASM("mov x0, %0" : : "r"(r): ); }
@@ -593,6 +603,11 @@ public:
 
     using Base::fpu_save;
     using Base::fpu_restore;
+    using Base::FPU_Context;
+    using Base::fpu_enabled;
+    using Base::fpu_dirty;
+    using Base::fpu_on;
+    using Base::fpu_off;
 
     using Base::id;
     using Base::cores;
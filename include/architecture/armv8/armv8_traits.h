@@ -13,18 +13,21 @@ template<> struct Traits<CPU>: public Traits<Build>
     static const unsigned int WORD_SIZE         = 64;
     static const unsigned int CLOCK             = Traits<Build>::MODEL == Traits<Build>::Raspberry_Pi3 ? 600000000 : 0;
     static const bool unaligned_memory_access   = false;
+    static const bool vector_instructions       = false;    // Advanced SIMD (NEON), requires FP/SIMD, which is not enabled
 };
 
 template<> struct Traits<MMU>: public Traits<Build>
 {
     static const bool colorful = false;
     static const unsigned int COLORS = 1;
+    static const bool buddy = false; // buddy frame allocator with per-CPU single frame caches
 };
 
 template<> struct Traits<FPU>: public Traits<Build>
 {
     static const bool enabled = (Traits<Build>::MODEL == Traits<Build>::Raspberry_Pi3);;
     static const bool user_save = true;
+    static const bool lazy = false;     // lazy FPU context switching is not implemented for this architecture
 };
 
 template<> struct Traits<TSC>: public Traits<Build>
@@ -162,6 +162,17 @@ public:
     static void fpu_save();
     static void fpu_restore();
 
+    // Lazy FPU context switching (Traits<FPU>::lazy), overridden by the architectures that support it
+    // fpu_off() makes the next FPU instruction trap, fpu_on() grants access to the FPU assuming its registers match the
+    // running thread's FPU_Context, and fpu_dirty() tells whether they might have been changed since fpu_on()
+    class FPU_Context {};
+    static bool fpu_enabled() { return true; }
+    static bool fpu_dirty() { return false; }
+    static void fpu_on() {}
+    static void fpu_off() {}
+    static void fpu_save(FPU_Context * fc) {}
+    static void fpu_restore(const FPU_Context * fc) {}
+
     static void flush_tlb();
     static void flush_tlb(Log_Addr addr);
 
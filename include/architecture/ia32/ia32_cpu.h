@@ -267,6 +267,27 @@ public:
         Reg16 io_bmp;
     };
 
+    // FPU Context (x87 FNSAVE image, saved on demand for lazy FPU context switching)
+    class FPU_Context
+    {
+        friend class CPU;       // for fpu_save() and fpu_restore()
+
+    public:
+        FPU_Context(): _cw(0x037f), _sw(0), _tw(0xffff), _ip(0), _cs(0), _dp(0), _ds(0) { // as set by FNINIT
+            for(unsigned int i = 0; i < sizeof(_st); i++) _st[i] = 0;
+        }
+
+    private:
+        Reg32 _cw;      // control word
+        Reg32 _sw;      // status word
+        Reg32 _tw;      // tag word
+        Reg32 _ip;      // last instruction pointer
+        Reg32 _cs;      // last instruction selector and opcode
+        Reg32 _dp;      // last operand pointer
+        Reg32 _ds;      // last operand selector
+        Reg8 _st[80];   // ST0-ST7
+    };
+
     // CPU Context
     class Context
     {
@@ -390,6 +411,17 @@ public:
     static void fpu_save() {} // TODO
     static void fpu_restore() {} // TODO
 
+    // Lazy FPU context switching: CR0.TS makes the next FPU instruction raise EXC_NODEV
+    // Since there is no dirty flag, any use of the FPU after fpu_on() is taken as a change
+    static bool fpu_enabled() { return !(cr0() & CR0_TS); }
+    static bool fpu_dirty() { return fpu_enabled(); }
+    static void fpu_on() { ASM("clts"); }
+    static void fpu_off() { cr0(cr0() | CR0_TS); }
+
+    // FNSAVE reinitializes the FPU, so the state is reloaded to keep the registers matching the saved context
+    static void fpu_save(FPU_Context * fc) { ASM("fnsave %0 \n frstor %0" : "+m"(*fc)); }
+    static void fpu_restore(const FPU_Context * fc) { ASM("frstor %0" : : "m"(*fc)); }
+
     static void switch_context(Context * volatile * o, Context * volatile n);
 
     static void syscall(void * message);
@@ -397,21 +429,21 @@ public:
 
     template<typename T>
     static T tsl(volatile T & lock) {
-        register T old = 1;
+        T old = 1;
         ASM("lock xchg %0, %2" : "=a"(old) : "a"(old), "m"(lock) : "memory");
         return old;
     }
 
     template<typename T>
     static T finc(volatile T & value) {
-        register T old = 1;
+        T old = 1;
         ASM("lock xadd %0, %2" : "=a"(old) : "a"(old), "m"(value) : "memory");
         return old;
     }
 
     template<typename T>
     static T fdec(volatile T & value) {
-        register T old = -1;
+        T old = -1;
         ASM("lock xadd %0, %2" : "=a"(old) : "a"(old), "m"(value) : "memory");
         return old;
     }
@@ -580,7 +612,7 @@ public:
     static void btr(Log_Addr addr, const int bit) { ASM("btr %1,%0" : "=m"(addr) : "r"(bit)); }
 
     static int bsf(Log_Addr addr) { unsigned int pos;      ASM("bsf %1,%0"  : "=a"(pos) : "m"(addr) : ); return pos; }
-    static int bsr(Log_Addr addr) { register int pos = -1; ASM("bsr %1, %0" : "=a"(pos) : "m"(addr) : ); return pos; }
+    static int bsr(Log_Addr addr) { int pos = -1; ASM("bsr %1, %0" : "=a"(pos) : "m"(addr) : ); return pos; }
 
     static Reg64 rdtsc() { Reg64 r; ASM("rdtsc" : "=A"(r) : ); return r; }
 
@@ -23,6 +23,7 @@ protected:
 
     static const unsigned int CHANNELS = 3;
     static const unsigned int FIXED = 0;
+    static const unsigned int COUNTER_BITS = 40;       // the minimum width of both general-purpose and fixed counters
 
 public:
     // Architectural PM Version 1 Section 30.2.1.1
@@ -736,10 +737,15 @@ public:
     using Engine::CHANNELS;
     using Engine::FIXED;
     using Engine::EVENTS;
+    using Engine::COUNTER_BITS;
 
 public:
     PMU() {}
 
+    // For Monitor::print_pmu_events(), which lists events by name and by hardware code (IA32 events are only named by the API)
+    static unsigned long long get_event_code(const Event event) { return event; }
+    static const char * get_event_name(const Event) { return "PMU"; }
+
 private:
     static void int_handler(Interrupt_Id i);
 
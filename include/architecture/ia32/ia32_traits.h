@@ -23,12 +23,14 @@ template<> struct Traits<MMU>: public Traits<Build>
 {
     static const bool colorful = false;
     static const unsigned int COLORS = 1;
+    static const bool buddy = false; // buddy frame allocator with per-CPU single frame caches
 };
 
 template<> struct Traits<FPU>: public Traits<Build>
 {
     static const bool enabled = true;
     static const bool user_save = true;
+    static const bool lazy = false;     // disable the FPU on dispatch and save/restore its state only for threads that use it
 };
 
 template<> struct Traits<PMU>: public Traits<Build>
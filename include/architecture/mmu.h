@@ -6,6 +6,7 @@
 #include <architecture/cpu.h>
 #include <utility/string.h>
 #include <utility/list.h>
+#include <utility/buddy.h>
 
 __BEGIN_SYS
 
@@ -23,6 +23,7 @@ protected:
     static const unsigned int CHANNELS = 0;
     static const unsigned int FIXED = 0;
     static const unsigned int EVENTS = LAST_EVENT;
+    static const unsigned int COUNTER_BITS = 64;       // counters wrap around at 2^COUNTER_BITS
     static const unsigned int UNSUPORTED_EVENT = -1U;
 
 protected:
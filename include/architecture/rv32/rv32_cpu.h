@@ -255,6 +255,14 @@ public:
     static void fpu_save();
     static void fpu_restore();
 
+    using CPU_Common::FPU_Context;
+    using CPU_Common::fpu_enabled;
+    using CPU_Common::fpu_dirty;
+    using CPU_Common::fpu_on;
+    using CPU_Common::fpu_off;
+    using CPU_Common::fpu_save;
+    using CPU_Common::fpu_restore;
+
     static void switch_context(Context ** o, Context * n) __attribute__ ((naked));
 
     static void syscall(void * message);
@@ -596,6 +596,7 @@ public:
     using Engine::CHANNELS;
     using Engine::FIXED;
     using Engine::EVENTS;
+    using Engine::COUNTER_BITS;
 
     using Engine::Event;
     using Engine::Count;
@@ -20,12 +20,14 @@ template<> struct Traits<MMU>: public Traits<Build>
 {
     static const bool colorful = false;
     static const unsigned int COLORS = 1;
+    static const bool buddy = false; // buddy frame allocator with per-CPU single frame caches
 };
 
 template<> struct Traits<FPU>: public Traits<Build>
 {
     static const bool enabled = false;
     static const bool user_save = true;
+    static const bool lazy = false;     // no FPU
 };
 
 template<> struct Traits<TSC>: public Traits<Build>
@@ -17,6 +17,7 @@ private:
     static const bool multicore = Traits<System>::multicore;
     static const bool multitask = Traits<System>::multitask;
     static const bool fpu = Traits<FPU>::enabled;
+    static const bool lazy_fpu = fpu && Traits<FPU>::lazy;
 
 public:
     // Bootstrap/service CPU id
@@ -112,6 +113,19 @@ public:
         EXC_DWPF         = 15,  // Store/AMO data page fault
     };
 
+    // FPU Context (saved on demand for lazy FPU context switching)
+    class FPU_Context
+    {
+        friend class CPU;       // for fpu_save() and fpu_restore()
+
+    public:
+        FPU_Context(): _fcsr(0) { for(unsigned int i = 0; i < 32; i++) _f[i] = 0; }
+
+    private:
+        Reg64 _f[32];
+        Reg64 _fcsr;
+    };
+
     // CPU Context
     class Context
     {
@@ -376,6 +390,86 @@ public:
             "       fld      f31, 496(sp)            \n");
     }
 
+    // Lazy FPU context switching: [m|s]status.FS is kept per CPU by Thread::dispatch() (see Context::pop())
+    static bool fpu_enabled() { return (status() & FS) != FS_OFF; }
+    static bool fpu_dirty() { return (status() & FS) == FS_DIRTY; }
+    static void fpu_on() { status((status() & ~FS) | FS_CLEAN); }
+    static void fpu_off() { status(status() & ~FS); }
+
+    static void fpu_save(FPU_Context * fc) {
+        ASM("       fsd     f0,    0(%0)            \n"
+            "       fsd     f1,    8(%0)            \n"
+            "       fsd     f2,   16(%0)            \n"
+            "       fsd     f3,   24(%0)            \n"
+            "       fsd     f4,   32(%0)            \n"
+            "       fsd     f5,   40(%0)            \n"
+            "       fsd     f6,   48(%0)            \n"
+            "       fsd     f7,   56(%0)            \n"
+            "       fsd     f8,   64(%0)            \n"
+            "       fsd     f9,   72(%0)            \n"
+            "       fsd     f10,  80(%0)            \n"
+            "       fsd     f11,  88(%0)            \n"
+            "       fsd     f12,  96(%0)            \n"
+            "       fsd     f13, 104(%0)            \n"
+            "       fsd     f14, 112(%0)            \n"
+            "       fsd     f15, 120(%0)            \n"
+            "       fsd     f16, 128(%0)            \n"
+            "       fsd     f17, 136(%0)            \n"
+            "       fsd     f18, 144(%0)            \n"
+            "       fsd     f19, 152(%0)            \n"
+            "       fsd     f20, 160(%0)            \n"
+            "       fsd     f21, 168(%0)            \n"
+            "       fsd     f22, 176(%0)            \n"
+            "       fsd     f23, 184(%0)            \n"
+            "       fsd     f24, 192(%0)            \n"
+            "       fsd     f25, 200(%0)            \n"
+            "       fsd     f26, 208(%0)            \n"
+            "       fsd     f27, 216(%0)            \n"
+            "       fsd     f28, 224(%0)            \n"
+            "       fsd     f29, 232(%0)            \n"
+            "       fsd     f30, 240(%0)            \n"
+            "       fsd     f31, 248(%0)            \n"
+            "       frcsr   t0                      \n"
+            "       sd      t0, 256(%0)             \n" : : "r"(fc->_f) : "t0", "memory");
+    }
+
+    static void fpu_restore(const FPU_Context * fc) {
+        ASM("       ld      t0, 256(%0)             \n"
+            "       fscsr   t0                      \n"
+            "       fld     f0,    0(%0)            \n"
+            "       fld     f1,    8(%0)            \n"
+            "       fld     f2,   16(%0)            \n"
+            "       fld     f3,   24(%0)            \n"
+            "       fld     f4,   32(%0)            \n"
+            "       fld     f5,   40(%0)            \n"
+            "       fld     f6,   48(%0)            \n"
+            "       fld     f7,   56(%0)            \n"
+            "       fld     f8,   64(%0)            \n"
+            "       fld     f9,   72(%0)            \n"
+            "       fld     f10,  80(%0)            \n"
+            "       fld     f11,  88(%0)            \n"
+            "       fld     f12,  96(%0)            \n"
+            "       fld     f13, 104(%0)            \n"
+            "       fld     f14, 112(%0)            \n"
+            "       fld     f15, 120(%0)            \n"
+            "       fld     f16, 128(%0)            \n"
+            "       fld     f17, 136(%0)            \n"
+            "       fld     f18, 144(%0)            \n"
+            "       fld     f19, 152(%0)            \n"
+            "       fld     f20, 160(%0)            \n"
+            "       fld     f21, 168(%0)            \n"
+            "       fld     f22, 176(%0)            \n"
+            "       fld     f23, 184(%0)            \n"
+            "       fld     f24, 192(%0)            \n"
+            "       fld     f25, 200(%0)            \n"
+            "       fld     f26, 208(%0)            \n"
+            "       fld     f27, 216(%0)            \n"
+            "       fld     f28, 224(%0)            \n"
+            "       fld     f29, 232(%0)            \n"
+            "       fld     f30, 240(%0)            \n"
+            "       fld     f31, 248(%0)            \n" : : "r"(fc->_f) : "t0", "memory");
+    }
+
     static void switch_context(Context ** o, Context * n) __attribute__ ((naked));
 
     static void syscall(void * message);
@@ -712,7 +806,7 @@ if(supervisor) {
         "       sd      x29,  216(sp)           \n"
         "       sd      x30,  224(sp)           \n"
         "       sd      x31,  232(sp)           \n");
-if (fpu) {
+if(fpu && !lazy_fpu) {
     fpu_save();
 }
 if(multitask) {
@@ -739,10 +833,22 @@ if(supervisor) {
 } else {
     ASM("       csrw     mepc, x3               \n");   // MEPC = PC
 }
-if (fpu) {
+if(fpu && !lazy_fpu) {
     fpu_restore();
 }
     ASM("       ld       x3,    8(sp)           \n");   // pop ST into TMP
+if(lazy_fpu) {                                          // [M|S]STATUS.FS belongs to the CPU, not to the context (see Thread::dispatch())
+    ASM("       li      x10, %0                 \n"     // use X10 and X11 as TMPs, since they will be restored later
+        "       not     x11, x10                \n"
+        "       and      x3, x3, x11            \n" : : "i"(FS));
+if(supervisor) {
+    ASM("       csrr    x11, sstatus            \n");
+} else {
+    ASM("       csrr    x11, mstatus            \n");
+}
+    ASM("       and     x11, x11, x10           \n"
+        "       or       x3, x3, x11            \n");   // ST.FS = [M|S]STATUS.FS
+}
 if(!interrupt) {                                        // MSTATUS.MPP is automatically cleared on the MRET in the ISR, so we need to recover it here
     ASM("       li      x10, %0                 \n"     // use X10 as a second TMP, since it will be restored later
         "       or       x3, x3, x10            \n" : : "i"(supervisor ? SPP_S : MPP_M)); // [M|S]STATUS.[S|M]PP is automatically cleared on the [M|S]RET in the ISR, so we need to recover it here
@@ -16,7 +16,7 @@ class SV39_MMU: public MMU_Common<9, 9, 12, 9>
     friend class Setup;
 
 private:
-    typedef Grouping_List<Frame> List;
+    typedef IF<Traits<MMU>::buddy, Buddy_List<Frame>, Grouping_List<Frame>>::Result List;
     typedef MMU_Common<9, 9, 12, 9> Common;
 
     static const bool colorful = Traits<MMU>::colorful;
@@ -15,18 +15,22 @@ template<> struct Traits<CPU>: public Traits<Build>
 	static const unsigned long CLOCK            = (MODEL == SiFive_U) ? 1000000000L : (MODEL == VisionFive2) ? 600000000L : 50000000;
     static const bool unaligned_memory_access   = false;
     static const bool atomic_memory_operations  = (MODEL == SiFive_U || MODEL == VisionFive2);
+    static const bool aes_instructions          = false;    // scalar cryptography (Zkne/Zknd), not in SiFive's U54 nor U74 (nor in QEMU's sifive_u), so still untested
+    static const bool vector_instructions       = false;    // V extension (RVV 1.0), not in SiFive's U54 nor U74
 };
 
 template<> struct Traits<MMU>: public Traits<Build>
 {
     static const bool colorful = false;
     static const unsigned int COLORS = 1;
+    static const bool buddy = false; // buddy frame allocator with per-CPU single frame caches
 };
 
 template<> struct Traits<FPU>: public Traits<Build>
 {
     static const bool enabled = true;
     static const bool user_save = true;
+    static const bool lazy = false;     // disable the FPU on dispatch and save/restore its state only for threads that use it
 };
 
 template<> struct Traits<TSC>: public Traits<Build>
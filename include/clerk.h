@@ -20,6 +20,199 @@ __BEGIN_SYS
 
 extern OStream kout;
 
+// Trace
+// Compact binary trace kept in one ring per CPU. Each ring is written only by its own CPU, with interrupts disabled
+// (by Monitor::run() and by the scheduler), and read only by the drain thread (see Monitor::drain()), so no locks
+// are needed. Records are three unsigned LEB128 varints: the time stamp delta (in TSC ticks) to the previous record
+// of the same CPU, the event id, and the value. Records that do not fit are counted and reported by a LOST record.
+// Drained records are streamed through the console UART in frames that can be told apart from the surrounding text
+// (see tools/epostrace):
+//   SYNC0 SYNC1 | type | cpu | size (16 bits) | base time stamp (64 bits) | records | checksum (8 bits)
+// Multi-byte fields are little-endian. The INFO frame carries the TSC frequency in the base time stamp field.
+class Trace
+{
+    friend class Monitor;
+
+private:
+    typedef TSC::Time_Stamp Time_Stamp;
+
+    static const unsigned int CPUS = Traits<Build>::CPUS;
+    static const unsigned int SIZE = Traits<Monitor>::TRACE_SIZE;      // bytes per CPU
+    static const unsigned int FRAME = 256;                              // maximum records bytes per frame
+    static const unsigned int RECORD = 3 * 10;                          // maximum record size (three 64-bit varints)
+
+    enum : unsigned char {
+        SYNC0 = 0xeb,
+        SYNC1 = 0x7e
+    };
+
+    enum : unsigned char {
+        INFO,
+        DATA
+    };
+
+    struct Ring {
+        volatile unsigned int head;     // advanced by the drain thread
+        volatile unsigned int tail;     // advanced by the owner CPU
+        Time_Stamp last;                // time stamp of the last record written
+        Time_Stamp drained;             // time stamp of the last record drained
+        unsigned long lost;
+        unsigned char data[SIZE];
+    };
+
+public:
+    static const bool enabled = Traits<Monitor>::enabled && Traits<Monitor>::trace;
+
+    // Event ids are made of a kind (4 bits) and an event (12 bits)
+    enum Kind {
+        SYSTEM_EVENT,
+        PMU_EVENT,
+        TRANSDUCER_EVENT,
+        SCHEDULER_EVENT
+    };
+
+    enum Scheduler_Event {
+        DISPATCH,       // value = next thread
+        LOST            // value = records lost since the previous record
+    };
+
+public:
+    static unsigned int event(unsigned int kind, unsigned int event) { return (kind << 12) | (event & 0xfff); }
+
+    // Interrupts must be disabled
+    static void write(unsigned int event, unsigned long long value) {
+        if(!_rings)
+            return;
+
+        Ring * r = &_rings[CPU::id()];
+        Time_Stamp ts = TSC::time_stamp();
+        if(r->lost && put(r, ts, Trace::event(SCHEDULER_EVENT, LOST), r->lost))
+            r->lost = 0;
+        if(!put(r, ts, event, value))
+            r->lost++;
+    }
+
+private:
+    static bool put(Ring * r, Time_Stamp ts, unsigned int event, unsigned long long value) {
+        unsigned char record[RECORD];
+        unsigned int n = encode(&record[0], ts - r->last);
+        n += encode(&record[n], event);
+        n += encode(&record[n], value);
+
+        unsigned int tail = r->tail;
+        if(SIZE - (tail - r->head) < n)
+            return false;
+
+        for(unsigned int i = 0; i < n; i++)
+            r->data[(tail + i) % SIZE] = record[i];
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        r->tail = tail + n;
+        r->last = ts;
+
+        return true;
+    }
+
+    // Streams the records of all CPUs gathered so far (must not be called concurrently, so only the drain thread calls
+    // it until it has finished)
+    static void drain() {
+        if(!_rings)
+            return;
+
+        for(unsigned int cpu = 0; cpu < CPUS; cpu++) {
+            Ring * r = &_rings[cpu];
+            unsigned int tail = r->tail;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            while(r->head != tail) {
+                // Frames only carry whole records, so a corrupted one doesn't affect the time stamps of the next
+                unsigned int head = r->head;
+                Time_Stamp base = r->drained;
+                unsigned int size = 0;
+                while(head + size != tail) {
+                    unsigned long long delta, dummy;
+                    unsigned int n = decode(r, head + size, &delta);
+                    n += decode(r, head + size + n, &dummy);
+                    n += decode(r, head + size + n, &dummy);
+                    if(size + n > FRAME)
+                        break;
+                    size += n;
+                    r->drained += delta;
+                }
+
+                frame(DATA, cpu, base, r, head, size);
+
+                __atomic_thread_fence(__ATOMIC_RELEASE);
+                r->head = head + size;
+            }
+        }
+    }
+
+    static void frame(unsigned char type, unsigned char cpu, unsigned long long base, const Ring * r = 0, unsigned int from = 0, unsigned int size = 0) {
+        unsigned char header[1 + 1 + 2 + 8];
+        header[0] = type;
+        header[1] = cpu;
+        header[2] = size;
+        header[3] = size >> 8;
+        for(unsigned int i = 0; i < 8; i++)
+            header[4 + i] = base >> (i * 8);
+
+        unsigned char checksum = 0;
+        _uart->put(SYNC0);
+        _uart->put(SYNC1);
+        for(unsigned int i = 0; i < sizeof(header); i++) {
+            _uart->put(header[i]);
+            checksum += header[i];
+        }
+        for(unsigned int i = 0; i < size; i++) {
+            unsigned char c = r->data[(from + i) % SIZE];
+            _uart->put(c);
+            checksum += c;
+        }
+        _uart->put(checksum);
+    }
+
+    static unsigned int encode(unsigned char * buffer, unsigned long long v) {
+        unsigned int n = 0;
+        do {
+            buffer[n] = (v & 0x7f) | ((v >> 7) ? 0x80 : 0);
+            v >>= 7;
+            n++;
+        } while(v);
+        return n;
+    }
+
+    static unsigned int decode(const Ring * r, unsigned int i, unsigned long long * v) {
+        unsigned int n = 0;
+        unsigned char c;
+        *v = 0;
+        do {
+            c = r->data[(i + n) % SIZE];
+            *v |= static_cast<unsigned long long>(c & 0x7f) << (n * 7);
+            n++;
+        } while(c & 0x80);
+        return n;
+    }
+
+    static void init() {
+        _rings = new (SYSTEM) Ring[CPUS];
+        for(unsigned int i = 0; i < CPUS; i++) {
+            _rings[i].head = _rings[i].tail = 0;
+            _rings[i].last = _rings[i].drained = 0;
+            _rings[i].lost = 0;
+        }
+    }
+
+    static void start() {
+        _uart = new (SYSTEM) UART(Traits<Serial_Display>::UNIT);
+        frame(INFO, CPUS, TSC::frequency());
+    }
+
+private:
+    static Ring * _rings;
+    static UART * _uart;
+};
+
+
 class Monitor
 {
     friend void ::__pre_main(); // for init()
@@ -47,8 +240,19 @@ public:
 
     static void run();
 
+    // Scheduler events (and anything else not sampled by a Clerk) go straight to the trace
+    static void trace(unsigned int event, unsigned long long value) {
+        if(Trace::enabled && _enable)
+            Trace::write(event, value);
+    }
+
     static void process_batch() {
         disable_captures();
+        if(Trace::enabled) { // everything but the last records has already been streamed
+            if(_drainer && (_drainer->state() == Thread::FINISHING)) // only then it can't be draining as well
+                Trace::drain();
+            return;
+        }
         OStream os; // we are using OStream instead of db to avoid <CPU_ID> print in each line.
         db<Monitor>(TRC) << "Monitor::process_batch()" << endl;
         if(_monitors[0].begin() != _monitors[0].end()) // monitored, but no Clerk_Monitor created
@@ -80,6 +284,11 @@ public:
             }
         }
         _enable = true;
+
+        if(Trace::enabled && !_drainer) {
+            Trace::start();
+            _drainer = new (SYSTEM) Thread(Thread::Configuration(Thread::READY, Thread::LOW), &drain);
+        }
     }
 
     static void disable_captures() { _enable = false; }
@@ -131,6 +340,8 @@ private:
     template<unsigned int CHANNEL>
     static void init_pmu_monitoring();
 
+    static int drain();
+
     static void init();
 
 protected:
@@ -142,6 +353,7 @@ protected:
 
 private:
     static volatile bool _enable;
+    static Thread * _drainer;
 };
 
 
@@ -160,10 +372,11 @@ public:
     };
 
 public:
-    Clerk_Monitor(Clerk * clerk, const Hertz & frequency, bool data_to_us = false): _clerk(clerk), _frequency(frequency), _period(us2count((frequency > 0) ? 1000000 / frequency : -1UL)), _last_capture(0), _average(0), _data_to_us(data_to_us), _link(this) {
+    Clerk_Monitor(Clerk * clerk, const Hertz & frequency, bool data_to_us = false, unsigned int event = 0): _clerk(clerk), _frequency(frequency), _period(us2count((frequency > 0) ? 1000000 / frequency : -1UL)), _last_capture(0), _average(0), _data_to_us(data_to_us), _event(event), _link(this) {
         db<Monitor>(TRC) << "Clerk_Monitor(clerk=" << clerk << ") => " << this << endl;
-        _snapshots = TIME_SPAN * frequency;
-        _buffer = new (SYSTEM) Snapshot[_snapshots];
+        // When tracing, snapshots are streamed as they are captured instead of being kept until shutdown
+        _snapshots = Trace::enabled ? 0 : TIME_SPAN * frequency;
+        _buffer = _snapshots ? new (SYSTEM) Snapshot[_snapshots] : 0;
         _monitors[CPU::id()].insert(&_link);
     }
  
@@ -178,7 +391,14 @@ public:
 
     void capture() {
         Time_Stamp ts = time_since_t0();
-        if(_captures < _snapshots && ((ts - _last_capture) >= _period)) {
+        if(Trace::enabled) {
+            if((ts - _last_capture) >= _period) {
+                Data data = _clerk->read();
+                Trace::write(_event, _data_to_us ? static_cast<Data>(count2us(data)) : data);
+                _captures++;
+                _last_capture = ts;
+            }
+        } else if(_captures < _snapshots && ((ts - _last_capture) >= _period)) {
             _buffer[_captures].ts = ts;
             _buffer[_captures].data = _clerk->read();
             // a counter reset happens frequently depending on the selected feature and its capacity (32 or 64 bits)
@@ -285,6 +505,7 @@ private:
     unsigned int _snapshots;
     Snapshot * _buffer;
     bool _data_to_us;
+    unsigned int _event;
     List::Element _link;
 };
 
@@ -298,7 +519,7 @@ public:
     typedef typename T::Value Data;
 
 public:
-    Clerk(unsigned int dev, const Hertz frequency = 0, bool monitored = false): _dev(dev), _monitor(monitored ? new (SYSTEM) Clerk_Monitor<Clerk>(this, frequency) : 0) {}
+    Clerk(unsigned int dev, const Hertz frequency = 0, bool monitored = false): _dev(dev), _monitor(monitored ? new (SYSTEM) Clerk_Monitor<Clerk>(this, frequency, false, Trace::event(Trace::TRANSDUCER_EVENT, dev)) : 0) {}
     ~Clerk() {}
 
     Data read() { return T::sense(_dev); }
@@ -323,7 +544,7 @@ public:
 
 public:
     Clerk(Event event, Hertz frequency = 0, bool monitored = false): _event(event),
-        _monitor(monitored ? new (SYSTEM) Clerk_Monitor<Clerk>(this, frequency, (event == Event::THREAD_EXECUTION_TIME || event == Event::CPU_EXECUTION_TIME)) : 0) {}
+        _monitor(monitored ? new (SYSTEM) Clerk_Monitor<Clerk>(this, frequency, (event == Event::THREAD_EXECUTION_TIME || event == Event::CPU_EXECUTION_TIME), Trace::event(Trace::SYSTEM_EVENT, event)) : 0) {}
     ~Clerk() {}
 
     Data read(Thread * t = Thread::self()) {
@@ -352,6 +573,10 @@ public:
 #endif
         case Event::CORE:
             return CPU::id();
+        case Event::THREAD_STEALS:
+            return Thread::steal_statistics().steals;
+        case Event::THREAD_MIGRATIONS:
+            return Thread::steal_statistics().migrations;
         default:
             return 0;
         }
@@ -411,6 +636,10 @@ public:
                 return "System::CORE";
             case PREDICTED_JOB_UTILIZATION:
                 return "System::PREDICTED_JOB_UTILIZATION";
+            case THREAD_STEALS:
+                return "System::THREAD_STEALS";
+            case THREAD_MIGRATIONS:
+                return "System::THREAD_MIGRATIONS";
             default:
                 return "System::UNDEFINED_EVENT";
         }
@@ -427,9 +656,17 @@ private:
 };
 
 // PMU Clerk
+// A Clerk created for a Thread virtualizes the PMU: it counts the event only while that thread runs, on whichever CPU
+// it runs, regardless of the scheduling criterion. Thread::dispatch() claims a channel for it when the thread gets the
+// CPU and accumulates the channel's increments into a 64-bit count when the thread leaves it (or when the thread's
+// quantum expires), so wraps are absorbed as long as the counter does not wrap twice in between. If all channels are
+// busy when the thread is dispatched, that activation is not counted. Such a Clerk must be deleted either by its
+// thread or while the thread is not running.
 template<>
 class Clerk<PMU>: private PMU
 {
+    friend class Thread;        // for save(), restore(), sample(), and unbind()
+
 public:
     using PMU::CHANNELS;
     using PMU::EVENTS;
@@ -437,8 +674,11 @@ public:
     typedef PMU::Count Data;
     typedef PMU::Event Event;
 
+private:
+    static const Data MASK = (COUNTER_BITS < 64) ? (1ULL << (COUNTER_BITS % 64)) - 1 : ~0ULL;
+
 public:
-    Clerk(Event event, const Hertz frequency = 0, bool monitored = false) {
+    Clerk(Event event, const Hertz frequency = 0, bool monitored = false): _event(event), _virtual(false), _paused(false), _thread(0), _next(0), _count(0), _last(0) {
         if((FIXED > 0) && (event < FIXED)) {
             _channel = event;
         } else {
@@ -449,24 +689,157 @@ public:
             PMU::config(_channel, event);
 
             if(monitored)
-                new (SYSTEM) Clerk_Monitor<Clerk>(this, frequency);
+                new (SYSTEM) Clerk_Monitor<Clerk>(this, frequency, false, Trace::event(Trace::PMU_EVENT, event));
         }
     }
 
+    Clerk(Event event, Thread * thread): _channel(CHANNELS), _event(event), _virtual(true), _paused(false), _thread(thread), _count(0), _last(0) {
+        db<PMU>(TRC) << "Clerk<PMU>(e=" << event << ",t=" << thread << ")" << endl;
+
+        bool enabled = CPU::int_enabled();
+        CPU::int_disable();
+        _next = thread->_pmu_clerks;
+        thread->_pmu_clerks = this;
+        if(thread == Thread::self())
+            claim();
+        if(enabled)
+            CPU::int_enable();
+    }
+
     ~Clerk() {
-        if(_channel < CHANNELS) {
+        if(_virtual) {
+            if(!_thread)
+                return;
+
+            bool enabled = CPU::int_enabled();
+            CPU::int_disable();
+            if(_thread == Thread::self())
+                release();
+            Clerk ** c;
+            for(c = &_thread->_pmu_clerks; *c != this; c = &(*c)->_next);
+            *c = _next;
+            if(enabled)
+                CPU::int_enable();
+        } else if(_channel < CHANNELS) {
+            PMU::stop(_channel);
+            _in_use[CPU::id()][_channel] = false;
+        }
+    }
+
+    Data read() {
+        if(!_virtual)
+            return (_channel < CHANNELS) ? PMU::read(_channel) : 0;
+
+        bool enabled = CPU::int_enabled();
+        CPU::int_disable();
+        if(_thread == Thread::self())
+            account();
+        Data count = _count;
+        if(enabled)
+            CPU::int_enable();
+
+        return count;
+    }
+
+    void start() {
+        if(!_virtual) {
+            if(_channel < CHANNELS)
+                PMU::start(_channel);
+        } else if(_paused) {
+            _paused = false;
+            if((_thread == Thread::self()) && (_channel < CHANNELS))
+                _last = PMU::read(_channel);
+        }
+    }
+
+    void stop() {
+        if(!_virtual) {
+            if(_channel < CHANNELS)
+                PMU::stop(_channel);
+        } else if(!_paused) {
+            read();
+            _paused = true;
+        }
+    }
+
+    void reset() {
+        if(!_virtual) {
+            if(_channel < CHANNELS)
+                PMU::reset(_channel);
+        } else {
+            read();
+            _count = 0;
+        }
+    }
+
+private:
+    bool fixed() const { return (FIXED > 0) && (_event < FIXED); }
+
+    // The following methods run with interrupts disabled on the CPU running _thread
+    void account() {
+        if((_channel < CHANNELS) && !_paused) {
+            Data now = PMU::read(_channel);
+            _count += (now - _last) & MASK;
+            _last = now;
+        }
+    }
+
+    void claim() {
+        if(fixed())
+            _channel = _event;  // fixed channels are shared, so they are never stopped by release()
+        else {
+            unsigned int cpu = CPU::id();
+            for(_channel = FIXED; (_channel < CHANNELS) && _in_use[cpu][_channel]; _channel++);
+            if(_channel == CHANNELS)
+                return;
+            _in_use[cpu][_channel] = true;
+        }
+        PMU::config(_channel, _event);
+        _last = PMU::read(_channel);
+    }
+
+    void release() {
+        if(_channel == CHANNELS)
+            return;
+        account();
+        if(!fixed()) {
             PMU::stop(_channel);
             _in_use[CPU::id()][_channel] = false;
         }
+        _channel = CHANNELS;
+    }
+
+    static void save(Thread * t) {
+        for(Clerk * c = t->_pmu_clerks; c; c = c->_next)
+            c->release();
     }
 
-    Data read() { return (_channel < CHANNELS) ? PMU::read(_channel) : 0; }
-    void start() { if(_channel < CHANNELS) PMU::start(_channel); }
-    void stop() { if(_channel < CHANNELS) PMU::stop(_channel); }
-    void reset() { if(_channel < CHANNELS) PMU::reset(_channel); }
+    static void restore(Thread * t) {
+        for(Clerk * c = t->_pmu_clerks; c; c = c->_next)
+            c->claim();
+    }
+
+    static void sample(Thread * t) {
+        for(Clerk * c = t->_pmu_clerks; c; c = c->_next)
+            c->account();
+    }
+
+    // The thread is being deleted, but its clerks keep their counts
+    static void unbind(Thread * t) {
+        for(Clerk * c = t->_pmu_clerks; c; c = c->_next)
+            c->_thread = 0;
+        t->_pmu_clerks = 0;
+    }
 
 private:
     Channel _channel;
+    Event _event;
+    bool _virtual;
+    bool _paused;
+    Thread * _thread;
+    Clerk * _next;
+    Data _count;
+    Data _last;
 
     static bool _in_use[Traits<Build>::CPUS][CHANNELS];
 };
@@ -478,7 +851,7 @@ inline void Monitor::init_pmu_monitoring()
     if((Traits<Monitor>::PMU_EVENTS_CORES[CHANNEL] & (1 << CPU::id())) && Traits<Monitor>::PMU_EVENTS_FREQUENCIES[CHANNEL]) {
         if(CPU::id() == 0)
             db<Monitor>(TRC) << "Monitor::init: monitoring PMU event " << Traits<Monitor>::PMU_EVENTS[CHANNEL] << " at " << Traits<Monitor>::PMU_EVENTS_FREQUENCIES[CHANNEL] << " Hz" << endl;
-        if((((sizeof(Clerk<PMU>::Data) + sizeof(TSC::Time_Stamp)) * Traits<Monitor>::PMU_EVENTS_FREQUENCIES[CHANNEL] * TIME_SPAN) + sizeof(Clerk<PMU>)) > System::_heap->grouped_size()  - Traits<Application>::HEAP_SIZE)
+        if(!Trace::enabled && ((((sizeof(Clerk<PMU>::Data) + sizeof(TSC::Time_Stamp)) * Traits<Monitor>::PMU_EVENTS_FREQUENCIES[CHANNEL] * TIME_SPAN) + sizeof(Clerk<PMU>)) > System::_heap->grouped_size()  - Traits<Application>::HEAP_SIZE))
             db<Monitor>(ERR) << "Monitor::init: not enough memory to allocate Clerk (requested size=" << (((sizeof(Clerk<System>::Data) + sizeof(TSC::Time_Stamp)) * Traits<Monitor>::PMU_EVENTS_FREQUENCIES[CHANNEL] * TIME_SPAN) + sizeof(Clerk<System>)) << ", Heap::grouped_size()=" << System::_heap->grouped_size() - Traits<Application>::HEAP_SIZE << ")" << endl;
         else {
             new (SYSTEM) Clerk<PMU>(Traits<Monitor>::PMU_EVENTS[CHANNEL], Traits<Monitor>::PMU_EVENTS_FREQUENCIES[CHANNEL], true);
@@ -500,7 +873,7 @@ inline void Monitor::init_system_monitoring()
 {
     if((Traits<Monitor>::SYSTEM_EVENTS_CORES[CHANNEL] & (1 << CPU::id())) && Traits<Monitor>::SYSTEM_EVENTS[CHANNEL] != NONE && (Traits<Monitor>::SYSTEM_EVENTS_FREQUENCIES[CHANNEL] > 0)) {
         db<Monitor>(TRC) << "Monitor::init: monitoring system event " << Traits<Monitor>::SYSTEM_EVENTS[CHANNEL] << " at " << Traits<Monitor>::SYSTEM_EVENTS_FREQUENCIES[CHANNEL] << " Hz" << endl;
-        if((((sizeof(Clerk<System>::Data) + sizeof(TSC::Time_Stamp)) * Traits<Monitor>::SYSTEM_EVENTS_FREQUENCIES[CHANNEL] * TIME_SPAN) + sizeof(Clerk<System>)) > System::_heap->grouped_size() - Traits<Application>::HEAP_SIZE)
+        if(!Trace::enabled && ((((sizeof(Clerk<System>::Data) + sizeof(TSC::Time_Stamp)) * Traits<Monitor>::SYSTEM_EVENTS_FREQUENCIES[CHANNEL] * TIME_SPAN) + sizeof(Clerk<System>)) > System::_heap->grouped_size() - Traits<Application>::HEAP_SIZE))
             db<Monitor>(ERR) << "Monitor::init: not enough memory to allocate Clerk (requested size=" << (((sizeof(Clerk<System>::Data) + sizeof(TSC::Time_Stamp)) * Traits<Monitor>::SYSTEM_EVENTS_FREQUENCIES[CHANNEL] * TIME_SPAN) + sizeof(Clerk<System>)) << ", Heap::grouped_size()=" << System::_heap->grouped_size() - Traits<Application>::HEAP_SIZE << ")" << endl;
         else {
             new (SYSTEM) Clerk<System>(Traits<Monitor>::SYSTEM_EVENTS[CHANNEL], Traits<Monitor>::SYSTEM_EVENTS_FREQUENCIES[CHANNEL], true);
@@ -47,6 +47,10 @@ public:
     int send(const Address & from, const Address & to, const void * data, unsigned int size) {
         return Channel::send(from, to, data, size);
     }
+    template<typename C = Channel>
+    int send(const Address & to, const typename C::Chunk * chunks, unsigned int n) { // gather
+        return C::send(_address, to, chunks, n);
+    }
 
     template<typename Message>
     int receive(const Message & message) {
@@ -79,6 +83,13 @@ public:
         return r;
     }
 
+    // Zero-copy reception: the Buffer holding the next message is loaned to the caller, who can map its payload with
+    // data() and must release() it as soon as possible, since it belongs to the NIC's receive ring
+    Buffer * receive() { return updated(); }
+    template<typename C = Channel>
+    static unsigned int data(Buffer * buf, typename C::Chunk * chunks, unsigned int n) { return C::data(buf, chunks, n); }
+    static void release(Buffer * buf) { buf->nic()->free(buf); }
+
     template<typename Message>
     int reply(const Message & message) {
         return Channel::reply(message);
@@ -152,6 +163,12 @@ public:
         return r;
     }
 
+    // Zero-copy reception of a single segment, as in the connectionless receive()
+    Buffer * read() { return updated(); }
+    template<typename C = Channel>
+    unsigned int data(Buffer * buf, typename C::Chunk * chunks, unsigned int n) { return _connection->data(buf, chunks, n); }
+    static void release(Buffer * buf) { buf->nic()->free(buf); }
+
 private:
     void update(typename Channel::Observed * obs, const Observing_Condition & c, Buffer * buf) { Observer::update(c, buf); }
     Buffer * updated() { return Observer::updated(); }
@@ -173,14 +190,22 @@ private:
 public:
     // Channel imports
     typedef typename Channel::Address Address;
+    typedef typename Channel::Buffer Buffer;
 
 public:
     Link(const Address & address, const Address & peer = Address::NULL): Base(address), _peer(peer) {}
     ~Link() {}
 
     int send(const void * data, unsigned int size) { return Base::send(Base::_address, _peer, data, size); }
+    template<typename C = Channel>
+    int send(const typename C::Chunk * chunks, unsigned int n) { return Base::send(_peer, chunks, n); }
     int receive(void * data, unsigned int size) { return Base::receive(data, size); }
 
+    Buffer * receive() { return Base::receive(); }
+    template<typename C = Channel>
+    unsigned int data(Buffer * buf, typename C::Chunk * chunks, unsigned int n) { return Base::template data<C>(buf, chunks, n); }
+    void release(Buffer * buf) { Base::release(buf); }
+
     const Address & peer() const { return _peer;}
 
 private:
@@ -197,6 +222,7 @@ private:
 public:
     // Channel imports
     typedef typename Channel::Address Address;
+    typedef typename Channel::Buffer Buffer;
 
 public:
     Link(const Address & address, const Address & peer = Address::NULL): Base(address, peer), _peer(peer) {}
@@ -205,6 +231,11 @@ public:
     int read(void * data, unsigned int size) { return Base::read_all(data, size); }
     int write(const void * data, unsigned int size) { return Base::write(data, size); }
 
+    Buffer * read() { return Base::read(); }
+    template<typename C = Channel>
+    unsigned int data(Buffer * buf, typename C::Chunk * chunks, unsigned int n) { return Base::template data<C>(buf, chunks, n); }
+    void release(Buffer * buf) { Base::release(buf); }
+
     const Address & peer() const { return _peer;}
 
 private:
@@ -222,6 +253,7 @@ private:
 public:
     // Channel imports
     typedef typename Channel::Address Address;
+    typedef typename Channel::Buffer Buffer;
 
 public:
     Port(const Address & address): Base(address) {}
@@ -230,11 +262,18 @@ public:
     template<typename Message>
     int send(const Message & message) { return Base::send(message); }
     int send(const Address & to, const void * data, unsigned int size) { return Base::send(to, data, size); }
+    template<typename C = Channel>
+    int send(const Address & to, const typename C::Chunk * chunks, unsigned int n) { return Base::send(to, chunks, n); }
 
     template<typename Message>
     int receive(const Message & message) { return Base::receive(message); }
     int receive(Address * from, void * data, unsigned int size) { return Base::receive(from, data, size); }
 
+    Buffer * receive() { return Base::receive(); }
+    template<typename C = Channel>
+    unsigned int data(Buffer * buf, typename C::Chunk * chunks, unsigned int n) { return Base::template data<C>(buf, chunks, n); }
+    void release(Buffer * buf) { Base::release(buf); }
+
     template<typename Message>
     int reply(const Message & message) { return Base::reply(message); }
 };
@@ -111,6 +111,7 @@ public:
     const Microsecond period() { enter(); Microsecond res = Component::period(); leave(); return res; }
     void period(Microsecond p) { enter(); Component::period(p); leave(); }
     static Hertz alarm_frequency() { static_enter(); Hertz res = Component::frequency(); static_leave(); return res; }
+    static long elapsed() { static_enter(); long res = Component::elapsed(); static_leave(); return res; }
 
     // Communication
     template<typename ... Tn>
@@ -11,6 +11,7 @@
 #include <communicator.h>
 
 #include "message.h"
+#include "ring.h"
 #include "ipc.h"
 
 __BEGIN_SYS
@@ -21,7 +22,20 @@ private:
     typedef void (Agent:: * Member)();
 
 public:
+    // System calls run in a kernel FPU section, so the calling thread's FPU state survives kernel code that uses the FPU
     void exec() {
+        Thread::kernel_fpu_begin();
+
+        if(Traits<Framework>::syscall_ring)
+            drain();
+
+        handle();
+
+        Thread::kernel_fpu_end();
+    }
+
+private:
+    void handle() {
         if((id().type() != UTILITY_ID) || Traits<Framework>::hysterically_debugged)
             db<Framework>(TRC) << ":=>" << *reinterpret_cast<Message *>(this) << endl;
 
@@ -51,7 +65,16 @@ public:
             db<Framework>(TRC) << "<=:" << *reinterpret_cast<Message *>(this) << endl;
     }
 
-private:
+    // Messages queued in the task's Syscall_Ring go before the one that trapped
+    static void drain() {
+        Syscall_Ring * ring = Task::self()->syscall_ring();
+        if(ring) {
+            Agent agent;
+            while(ring->pop(&agent))
+                agent.handle();
+        }
+    }
+
     void handle_thread();
     void handle_task();
     void handle_active();
@@ -496,6 +519,9 @@ void Agent::handle_alarm()
     case ALARM_FREQUENCY:
         res = Adapter<Alarm>::alarm_frequency();
     break;
+    case ALARM_ELAPSED:
+        res = Adapter<Alarm>::elapsed();
+    break;
     default:
         res = UNDEFINED;
     }
@@ -607,6 +633,17 @@ void Agent::handle_utility()
         in(s);
         _print(s);
     } break;
+    case SYSCALL_RING: {
+        Syscall_Ring * ring = Task::self()->syscall_ring();
+        if(!ring)
+            ring = new (Task::self()->syscall_ring(sizeof(Syscall_Ring))) Syscall_Ring;
+        res = reinterpret_cast<Result>(ring);
+    } break;
+    case SYSCALL_SUBMIT: // the ring has already been drained by exec()
+        break;
+    case KERNEL_PAGE:
+        res = Task::self()->kernel_page();
+        break;
     default:
         res = UNDEFINED;
     }
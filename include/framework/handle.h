@@ -140,6 +140,7 @@ public:
     const Microsecond period() const { return _stub->period(); }
     void period(const Microsecond p) { _stub->period(p); }
     static Hertz alarm_frequency() { return _Stub::alarm_frequency(); }
+    static long elapsed() { return _Stub::elapsed(); }
 
     // Communication
     template<typename ... Tn>
@@ -154,6 +155,14 @@ public:
     template<typename ... Tn>
     int write(Tn ... an) { return _stub->write(an ...);}
 
+    // Batched system calls (KERNEL mode only), performed at the next trap or at submit()
+    void post_resume() { _stub->post(Message::THREAD_RESUME); }
+    void post_unlock() { _stub->post(Message::SYNCHRONIZER_UNLOCK); }
+    void post_v() { _stub->post(Message::SYNCHRONIZER_V); }
+    void post_signal() { _stub->post(Message::SYNCHRONIZER_SIGNAL); }
+    void post_broadcast() { _stub->post(Message::SYNCHRONIZER_BROADCAST); }
+    static void submit() { _Stub::submit(); }
+
 #pragma GCC diagnostic pop
 
 private:
@@ -22,6 +22,7 @@ public:
 
     typedef Data_Observer<Message, Type> Observer;
     typedef Data_Observed<Message, Type> Observed;
+    typedef Hashed_Data_Observed<Message, Type, 64> Demultiplexer; // by type
 
 public:
     IPC() {}
@@ -72,7 +73,7 @@ public:
     static Observer * observer(const Type & type, unsigned int index = 0) { return _observed.observer(type, index); }
 
 private:
-    static Observed _observed; // Channel protocols are singletons
+    static Demultiplexer _observed; // Channel protocols are singletons
 };
 
 template<> struct Type<Port<IPC> > { static const Type_Id ID = IPC_COMMUNICATOR_ID; };
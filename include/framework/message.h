@@ -79,12 +79,16 @@ public:
         ALARM_GET_PERIOD,
         ALARM_SET_PERIOD,
         ALARM_FREQUENCY,
+        ALARM_ELAPSED,
 
         COMMUNICATOR_SEND = COMPONENT,
         COMMUNICATOR_REPLY,
         COMMUNICATOR_RECEIVE,
 
         PRINT = COMPONENT,
+        SYSCALL_RING,
+        SYSCALL_SUBMIT,
+        KERNEL_PAGE,
 
         UNDEFINED = (unsigned(1) << (sizeof(int) * 8 - 1)) - 1
     };
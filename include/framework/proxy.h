@@ -5,7 +5,10 @@
 #ifndef __proxy_h
 #define __proxy_h
 
+#include <system/kernel_page.h>
+
 #include "message.h"
+#include "ring.h"
 
 __BEGIN_SYS
 
@@ -55,7 +58,14 @@ public:
     Proxy(const Tn & ... an): Message(Id(Type<Component>::ID, 0)) { invoke(CREATE + sizeof ... (Tn), an ...); }
     ~Proxy() { invoke(DESTROY); }
 
-    static Proxy<Component> * self() { return new (reinterpret_cast<void *>(static_invoke(SELF))) Proxied<Component>; }
+    // The running thread and task are read from the Kernel_Page when possible
+    static Proxy<Component> * self() {
+        void * adapter = (Type<Component>::ID == THREAD_ID) ? reinterpret_cast<void *>(Kernel_Page::thread())
+                       : (Type<Component>::ID == TASK_ID) ? reinterpret_cast<void *>(Kernel_Page::task()) : 0;
+        if(!adapter)
+            adapter = reinterpret_cast<void *>(static_invoke(SELF));
+        return new (adapter) Proxied<Component>;
+    }
 
     static Proxy * share(const Id & id) {
         Proxy * proxy = new Proxy(id);
@@ -107,6 +117,8 @@ public:
     // Timing
     template<typename T>
     static void delay(T t) { static_invoke(ALARM_DELAY, t); }
+    static Hertz alarm_frequency() { Hertz f = Kernel_Page::alarm_frequency(); return f ? f : static_invoke(ALARM_FREQUENCY); }
+    static long elapsed() { long t = Kernel_Page::elapsed(); return t ? t : static_invoke(ALARM_ELAPSED); }
 
     // Communication
     template<typename ... Tn>
@@ -121,6 +133,11 @@ public:
     template<typename ... Tn>
     int write(Tn ... an) { return send(an ...); }
 
+    // Batched invocations (see ring.h)
+    template<typename ... Tn>
+    void post(const Method & m, const Tn & ... an) { Syscall_Ring::post(Message(Id(Type<Component>::ID, this->id().unit()), m, an ...)); }
+    static void submit() { Syscall_Ring::submit(); }
+
  private:
     template<typename ... Tn>
     Result invoke(const Method & m, const Tn & ... an) {
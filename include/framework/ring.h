@@ -0,0 +1,103 @@
+// EPOS Component Framework - System Call Ring
+
+// Syscall_Ring is a page shared by a task and the kernel through which proxies queue invocations of methods
+// that neither block nor have a meaningful result (e.g. Semaphore::v(), Thread::resume()). Queued messages
+// are executed by the Agent, in order, right before the message of the next system call issued by any of the
+// task's threads, so a whole batch costs a single trap (submit() traps just to flush the ring).
+// The task's threads serialize on a lock kept in the ring itself. The kernel only tries to get it and, if it
+// is taken, leaves the ring alone until the next trap.
+
+#ifndef __ring_h
+#define __ring_h
+
+#include "message.h"
+
+__BEGIN_SYS
+
+class Syscall_Ring
+{
+public:
+    static const unsigned int SLOTS = 8;
+
+public:
+    Syscall_Ring(): _head(0), _tail(0), _lock(false) {}
+
+    // User side
+    static void post(const Message & msg) {
+        if(!Traits<Framework>::syscall_ring) {
+            Message m(msg);
+            m.act();
+            return;
+        }
+
+        Syscall_Ring * r = ring();
+        while(!r->push(msg)) // full
+            submit();
+    }
+
+    static void submit() {
+        Message msg(Id(UTILITY_ID, 0), Message::SYSCALL_SUBMIT);
+        msg.act();
+    }
+
+    // Kernel side
+    bool pop(Message * msg) {
+        if(CPU::tsl(_lock))
+            return false;
+
+        bool popped = (_head != _tail);
+        if(popped) {
+            copy(msg, _slots[_head % SLOTS]);
+            _head = _head + 1;
+        }
+
+        _lock = false;
+
+        return popped;
+    }
+
+private:
+    bool push(const Message & msg) {
+        while(CPU::tsl(_lock));
+
+        bool pushed = (_tail - _head < SLOTS);
+        if(pushed) {
+            copy(&_slots[_tail % SLOTS], msg);
+            _tail = _tail + 1;
+        }
+
+        _lock = false;
+
+        return pushed;
+    }
+
+    // Only the payload travels through the ring, the list links of the messages on each side stay untouched
+    static void copy(Message * to, const Message & from) {
+        to->_id = from._id;
+        to->_method = from._method;
+        memcpy(to->_parms, from._parms, sizeof(from._parms));
+        to->_reply_to = from._reply_to;
+    }
+
+    // The ring is mapped into the task's address space on the first use
+    static Syscall_Ring * ring() {
+        if(!_ring) {
+            Message msg(Id(UTILITY_ID, 0), Message::SYSCALL_RING);
+            msg.act();
+            _ring = reinterpret_cast<Syscall_Ring *>(msg.result());
+        }
+        return _ring;
+    }
+
+private:
+    volatile unsigned int _head;
+    volatile unsigned int _tail;
+    alignas(int) volatile bool _lock;
+    Message _slots[SLOTS];
+
+    static Syscall_Ring * _ring; // user side
+};
+
+__END_SYS
+
+#endif
@@ -4,6 +4,7 @@
 #define __cortex_timer_h
 
 #include <architecture/cpu.h>
+#include <architecture/tsc.h>
 #include <machine/ic.h>
 #include <machine/timer.h>
 #include __HEADER_MMOD(timer)
@@ -20,9 +21,17 @@ class Timer: public System_Timer_Engine
 
 protected:
     static const bool multicore = Traits<System>::multicore;
+    static const bool tickless = Traits<Alarm>::tickless;
     static const unsigned int CHANNELS = 2;
     static const unsigned int FREQUENCY = Traits<Timer>::FREQUENCY;
 
+    // Only the RealView's private timers interrupt every core, the other engines interrupt the BSP, which forwards ticks
+    static const bool private_engines = (Traits<Build>::MODEL == Traits<Build>::Realview_PBX);
+
+    // One-shot counting limits (the narrowest engine, SysTick, has 24 bits)
+    static const unsigned int MIN_COUNT = 16;
+    static const unsigned int MAX_COUNT = 0x00ffffff;
+
     typedef System_Timer_Engine Engine;
     typedef IC_Common::Interrupt_Id Interrupt_Id;
 
@@ -68,7 +77,15 @@ public:
 
     void handler(Handler handler) { _handler = handler; }
 
+    // One-shot ALARM channel for tickless alarms (absolute TSC time stamp, 0 disarms)
+    // The deadline is serviced by the CPU that armed it last (or by the BSP, whose engine is armed on its behalf)
+    static void deadline(const TSC::Time_Stamp & ts) { _deadline = ts; _deadline_cpu = private_engines ? CPU::id() : CPU::BSP; program(); }
+
 private:
+    // Tickless mode: the engine is set in one-shot mode to the next event (scheduler tick or alarm deadline)
+    static bool periodic() { return _channels[SCHEDULER]; }
+    static void program();
+
     static void int_handler(Interrupt_Id i);
     static void eoi(Interrupt_Id i);
 
@@ -82,6 +99,10 @@ protected:
     Handler _handler;
 
     static Timer * _channels[CHANNELS];
+    static volatile TSC::Time_Stamp _deadline;
+    static volatile unsigned int _deadline_cpu;
+    alignas(int) static volatile bool _programming;
+    static volatile TSC::Time_Stamp _next_tick[Traits<Machine>::CPUS];
 };
 
 
@@ -90,6 +111,19 @@ class Scheduler_Timer: public Timer
 {
 public:
     Scheduler_Timer(Microsecond quantum, Handler handler): Timer(SCHEDULER, 1000000 / quantum, handler) {}
+
+    using Timer::restart;
+
+    // Restarts the quantum, shortened to "budget" (rounded up to a timer tick) if that is shorter (0 means no budget)
+    int restart(Microsecond budget) {
+        int percentage = restart();
+        if(budget) {
+            Tick ticks = (static_cast<unsigned long long>(budget) * FREQUENCY + 999999) / 1000000;
+            if(ticks < _current[CPU::id()])
+                _current[CPU::id()] = ticks;
+        }
+        return percentage;
+    }
 };
 
 // Timer used by Alarm
@@ -31,6 +31,7 @@ public:
     static Count read() { return systick()->read(); }
 
     static void reset() { systick()->config(systick()->clock() / FREQUENCY, true, true); }
+    static void arm(const Count & count) { disable(); systick()->config(count, true, true); enable(); } // SysTick always reloads, so the next interrupt must reprogram it
     static void enable() { systick()->enable(); }
     static void disable() { systick()->disable(); }
 
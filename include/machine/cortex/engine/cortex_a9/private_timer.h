@@ -45,12 +45,12 @@ public:
     };
 
 public:
-    void config(const Count & count) {
-        // TODO: interrupt and periodic are not being handled!
+    void config(const Count & count, bool periodic = true) {
+        // TODO: interrupt is not being handled!
         pt(PTCLR) = 0;
         pt(PTISR) = INT_CLR;
         pt(PTLR) = count;
-        pt(PTCLR) = IRQ_EN | AUTO_RELOAD;
+        pt(PTCLR) = IRQ_EN | (periodic ? AUTO_RELOAD : 0);
     }
 
     Count count() { return pt(PTCTR); }
@@ -29,6 +29,7 @@ public:
     static Count count() { return systick()->count(); }
 
     static void reset() { disable(); systick()->config(systick()->clock() / FREQUENCY, true, true); enable();}
+    static void arm(const Count & count) { disable(); systick()->config(count, true, true); enable(); } // SysTick always reloads, so the next interrupt must reprogram it
     static void enable() { systick()->enable(); }
     static void disable() { systick()->disable(); }
 
@@ -40,6 +40,11 @@ public:
         enable();
     }
 
+    static void arm(const Count & count) {
+        _count = count; // also used by eoi() to re-arm the compare register
+        timer()->config(UNIT, _count);
+    }
+
     static void enable() { timer()->enable(); }
     static void disable() { timer()->disable(); }
 
@@ -30,6 +30,7 @@ public:
     static Count read() { return pt()->read(); }
 
     static void reset() { disable(); pt()->config(pt()->clock() / FREQUENCY); enable();}
+    static void arm(const Count & count) { disable(); pt()->config(count, false); enable(); }
     static void enable() { pt()->enable(); }
     static void disable() { pt()->disable(); }
 
@@ -171,12 +171,16 @@ public:
     {
         typedef unsigned int Count;
 
-        Statistics(): rx_packets(0), tx_packets(0), rx_bytes(0), tx_bytes(0) {}
+        Statistics(): rx_packets(0), tx_packets(0), rx_bytes(0), tx_bytes(0), rx_interrupts(0) {}
+
+        // In hundredths of a packet (e.g. 150 for 3 packets in 2 interrupts), since polling can take fewer packets than interrupts
+        Count packets_per_interrupt() const { return rx_interrupts ? static_cast<unsigned long long>(rx_packets) * 100 / rx_interrupts : 0; }
 
         Count rx_packets;
         Count tx_packets;
         Count rx_bytes;
         Count tx_bytes;
+        Count rx_interrupts;
     };
 
     // Buffer Metadata added to frames by higher-level protocols
@@ -284,6 +288,23 @@ public:
     virtual Buffer * alloc(const Address & dst, const Protocol & prot, unsigned int once, unsigned int always, unsigned int payload) = 0;
     virtual int send(Buffer * buf) = 0;
     virtual bool drop(Buffer * buf) { return false; } // after send, while still in the working queues, not supported by many NICs
+
+    // Batched transmission: alloc_batch() seizes buffers for up to n frames of size bytes at once, appending them to list, and
+    // send(list) hands all frames in list over to the NIC, which is only started once. NICs that cannot do better go frame by frame.
+    virtual unsigned int alloc_batch(typename Buffer::List * list, const Address & dst, const Protocol & prot, unsigned int n, unsigned int size) {
+        unsigned int i = 0;
+        for(Buffer * buf; (i < n) && (buf = alloc(dst, prot, 0, 0, size)); i++)
+            list->insert(buf->link());
+        return i;
+    }
+    virtual int send(typename Buffer::List * list) {
+        int size = 0;
+        while(typename Buffer::Element * el = list->remove()) {
+            el->next(0);
+            size += send(el->object());
+        }
+        return size;
+    }
     virtual void free(Buffer * buf) = 0; // to be called by observers after handling notifications from the NIC
 
     virtual const Address & address() = 0;
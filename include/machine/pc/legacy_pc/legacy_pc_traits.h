@@ -139,6 +139,10 @@ template<> struct Traits<Ethernet>: public Traits<Machine_Common>
     static const bool enabled = (Traits<Build>::NETWORKING != STANDALONE) && (UNITS > 0);
 
     static const bool promiscuous = false;
+
+    // Receive rings are drained by a kernel thread with receive interrupts masked (instead of by the ISR)
+    static const bool polling = false;
+    static const unsigned int POLLING_BUDGET = 16; // frames per polling round
 };
 
 template<> struct Traits<PCNet32>: public Traits<Ethernet>
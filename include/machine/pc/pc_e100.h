@@ -209,6 +209,7 @@ public:
         irq_mask_none = 0x00,
         irq_mask_all  = 0x01,
         irq_sw_gen    = 0x02,
+        irq_mask_rx   = 0x50, // FR and RNR
     };
 
     enum scb_cmd_lo {
@@ -540,6 +541,8 @@ private:
     static const unsigned int UNITS = Traits<E100>::UNITS;
     static const unsigned int TX_BUFS = Traits<E100>::SEND_BUFFERS;
     static const unsigned int RX_BUFS = Traits<E100>::RECEIVE_BUFFERS;
+    static const bool polling = Traits<E100>::polling;
+    static const unsigned int BUDGET = Traits<E100>::POLLING_BUDGET;
     static const unsigned int DMA_BUFFER_SIZE =
         ((sizeof(ConfigureCB) + 15) & ~15U) +
         ((sizeof(MACaddrCB) + 15) & ~15U) +
@@ -578,6 +581,8 @@ public:
 
     void attach(Observer * o, const Protocol & p) {
         NIC<Ethernet>::attach(o, p);
+        if(polling && !_poller)
+            start_poller();
         ; // enable receive interrupt
     }
 
@@ -590,9 +595,13 @@ public:
     static E100 * get(unsigned int unit = 0) { return get_by_unit(unit); }
 
 private:
+    unsigned int receive(unsigned int budget, const TSC::Time_Stamp & ts);
     void reset();
     void handle_int();
 
+    void start_poller();
+    static int poll(E100 * dev);
+
     static void int_handler(IC::Interrupt_Id interrupt);
 
     bool verifyPendingInterrupts(void);
@@ -736,6 +745,9 @@ private:
 
     DMA_Buffer * _dma_buffer;
 
+    Thread * _poller;
+    Semaphore * _rx_ready;
+
     static Device _devices[UNITS];
 };
 
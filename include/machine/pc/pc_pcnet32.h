@@ -404,6 +404,8 @@ private:
 
     // Mode
     static const bool promiscuous = Traits<PCNet32>::promiscuous;
+    static const bool polling = Traits<PCNet32>::polling;
+    static const unsigned int BUDGET = Traits<PCNet32>::POLLING_BUDGET;
 
     // Transmit and Receive Ring sizes
     static const unsigned int UNITS = Traits<PCNet32>::UNITS;
@@ -434,6 +436,9 @@ public:
     int send(Buffer * buf);
     void free(Buffer * buf);
 
+    unsigned int alloc_batch(Buffer::List * list, const Address & dst, const Protocol & prot, unsigned int n, unsigned int size);
+    int send(Buffer::List * list);
+
     const Address & address() { return _configuration.address; }
     void address(const Address & address) { _configuration.address = address; _configuration.selector = Configuration::ADDRESS; reconfigure(&_configuration); }
 
@@ -444,6 +449,8 @@ public:
 
     void attach(Observer * o, const Protocol & p) {
         NIC<Ethernet>::attach(o, p);
+        if(polling && !_poller)
+            start_poller();
         csr(3, csr(3) & ~ CSR3_RINTM); // enable receive interrupt
     }
 
@@ -456,10 +463,17 @@ public:
     static PCNet32 * get(unsigned int unit = 0) { return get_by_unit(unit); }
 
 private:
-    void receive();
+    unsigned int receive(unsigned int budget);
     void reset();
     void handle_int();
 
+    unsigned int seize();
+    unsigned int post(Buffer * buf);
+    void kick() { csr(0, csr(0) | CSR0_TDMD); } // trigger an immediate send poll
+
+    void start_poller();
+    static int poll(PCNet32 * dev);
+
     static void int_handler(Interrupt_Id interrupt);
 
     static PCNet32 * get_by_unit(unsigned int unit) {
@@ -498,6 +512,9 @@ private:
     Buffer * _rx_buffer[RX_BUFS];
     Buffer * _tx_buffer[TX_BUFS];
 
+    Thread * _poller;
+    Semaphore * _rx_ready;
+
     static Device _devices[UNITS];
 };
 
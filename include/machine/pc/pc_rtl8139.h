@@ -76,6 +76,10 @@ private:
     static const unsigned int TX_BUFFER_SIZE = (sizeof(Frame) + 3) & ~3;
     static const unsigned int TX_BUFS = Traits<RTL8139>::SEND_BUFFERS;
 
+    // Receive mode
+    static const bool polling = Traits<RTL8139>::polling;
+    static const unsigned int BUDGET = Traits<RTL8139>::POLLING_BUDGET;
+
     // Size of the DMA Buffer
     static const unsigned int DMA_BUFFER_SIZE = RX_BUFFER_SIZE + TX_BUFFER_SIZE * TX_BUFS;
 
@@ -108,6 +112,8 @@ public:
     virtual void attach(Observer * o, const Protocol & p) {
         db<RTL8139>(TRC) << "RTL8139::attach(p=" << p  << ")" << endl;
         NIC<Ethernet>::attach(o, p);
+        if(polling && !_poller)
+            start_poller();
         CPU::out16 (_io_port + IMR, ROK); // enable receive int
     }
 
@@ -120,9 +126,13 @@ public:
     static RTL8139 * get(unsigned int unit = 0) { return get_by_unit(unit); }
 
 private:
+    unsigned int receive(unsigned int budget, const TSC::Time_Stamp & ts);
     void reset();
     void handle_int();
 
+    void start_poller();
+    static int poll(RTL8139 * dev);
+
     static void int_handler(IC::Interrupt_Id interrupt);
 
     static RTL8139 * get_by_unit(unsigned int unit) {
@@ -160,6 +170,9 @@ private:
     char * _rx_buffer;
     Buffer * _tx_buffer[TX_BUFS];
 
+    Thread * _poller = 0;
+    Semaphore * _rx_ready = 0;
+
     static Device _devices[UNITS];
 };
 
@@ -3,6 +3,7 @@
 #ifndef __pc_timer_h
 #define __pc_timer_h
 
+#include <architecture/tsc.h>
 #include <machine/machine.h>
 #include <machine/ic.h>
 #include <machine/rtc.h>
@@ -87,7 +88,7 @@ public:
         break;
         default:
             cnt = CNT_0;
-            control = DEF_CTRL_C0;
+            control = periodic ? DEF_CTRL_C0 : (SC0 | LMSB | IOTC | BINARY);
         }
 
         CPU::out8(CTRL, control);
@@ -238,11 +239,16 @@ class Timer: public Timer_Common
 
 protected:
     static const bool multicore = Traits<System>::multicore;
+    static const bool tickless = Traits<Alarm>::tickless;
     static const unsigned int CHANNELS = 3;
     static const unsigned int FREQUENCY = Traits<Timer>::FREQUENCY;
 
     typedef IF<Traits<System>::multicore, APIC_Timer, i8253>::Result Engine;
     typedef Engine::Count Count;
+
+    // One-shot counting limits (APIC counts are prescaled by 16)
+    static const Count MIN_COUNT = 16;
+    static const Count MAX_COUNT = ~Count(0);
     typedef IC::Interrupt_Id Interrupt_Id;
 
 protected:
@@ -287,7 +293,15 @@ public:
 
     void handler(Handler handler) { _handler = handler; }
 
+    // One-shot ALARM channel for tickless alarms (absolute TSC time stamp, 0 disarms)
+    // The deadline is serviced by the CPU that armed it last
+    static void deadline(const TSC::Time_Stamp & ts) { _deadline = ts; _deadline_cpu = CPU::id(); program(); }
+
 private:
+    // Tickless mode: the engine is set in one-shot mode to the next event (periodic channel tick or alarm deadline)
+    static bool periodic() { return _channels[SCHEDULER] || _channels[USER]; }
+    static void program();
+
     static void int_handler(Interrupt_Id i);
 
     static void init();
@@ -300,6 +314,9 @@ protected:
     Handler _handler;
 
     static Timer * _channels[CHANNELS];
+    static volatile TSC::Time_Stamp _deadline;
+    static volatile unsigned int _deadline_cpu;
+    static volatile TSC::Time_Stamp _next_tick[Traits<Machine>::CPUS];
 };
 
 
@@ -308,6 +325,19 @@ class Scheduler_Timer: public Timer
 {
 public:
     Scheduler_Timer(Microsecond quantum, Handler handler): Timer(SCHEDULER, 1000000 / quantum, handler) {}
+
+    using Timer::restart;
+
+    // Restarts the quantum, shortened to "budget" (rounded up to a timer tick) if that is shorter (0 means no budget)
+    int restart(Microsecond budget) {
+        int percentage = restart();
+        if(budget) {
+            Count ticks = (static_cast<unsigned long long>(budget) * FREQUENCY + 999999) / 1000000;
+            if(ticks < _current[CPU::id()])
+                _current[CPU::id()] = ticks;
+        }
+        return percentage;
+    }
 };
 
 // Timer used by Alarm
@@ -318,6 +348,14 @@ public:
 };
 
 
+// Timer used by Monitor (PC has only three channels, so it takes the USER one)
+class Monitor_Timer: public Timer
+{
+public:
+    Monitor_Timer(Hertz frequency, Handler handler): Timer(USER, frequency, handler) {}
+};
+
+
 // Timer available for users
 class User_Timer: public Timer
 {
@@ -275,6 +275,9 @@ public:
     int send(Buffer * buf);
     void free(Buffer * buf);
 
+    unsigned int alloc_batch(Buffer::List * list, const Address & dst, const Protocol & prot, unsigned int n, unsigned int size);
+    int send(Buffer::List * list);
+
     const Address & address() { return _configuration.address; }
     void address(const Address & address) { _configuration.address = address; _configuration.selector = Configuration::ADDRESS; reconfigure(&_configuration); }
 
@@ -297,6 +300,8 @@ public:
     static GEM * get(unsigned int unit = 0) { return get_by_unit(unit); }
 
 private:
+    unsigned int seize();
+
     void receive();
     void handle_int();
 
@@ -4,6 +4,7 @@
 #define __riscv_timer_h
 
 #include <architecture/cpu.h>
+#include <architecture/tsc.h>
 #include <machine/ic.h>
 #include <machine/timer.h>
 #include <system/memory_map.h>
@@ -20,6 +21,7 @@ class Timer: private Timer_Common, private CLINT
 
 protected:
     static const bool multicore = Traits<System>::multicore;
+    static const bool tickless = Traits<Alarm>::tickless;
     static const unsigned int CHANNELS = 3;
     static const Hertz FREQUENCY = Traits<Timer>::FREQUENCY;
 
@@ -79,9 +81,17 @@ public:
 
     void handler(Handler handler) { _handler = handler; }
 
+    // One-shot ALARM channel for tickless alarms (absolute TSC time stamp, 0 disarms)
+    // The deadline is serviced by the CPU that armed it last
+    static void deadline(const TSC::Time_Stamp & ts) { _deadline = ts; _deadline_cpu = CPU::id(); program(); }
+
 private:
     static void config(Hertz frequency) { mtimecmp(mtime() + (CLOCK / frequency)); }
 
+    // Tickless mode: MTIMECMP is set to the next event (periodic channel tick or alarm deadline) instead of every tick
+    static bool periodic() { return _channels[SCHEDULER] || _channels[MONITOR]; }
+    static void program();
+
     static void int_handler(Interrupt_Id i);
 
     static void init();
@@ -94,6 +104,9 @@ protected:
     Handler _handler;
 
     static Timer * _channels[CHANNELS];
+    static volatile TSC::Time_Stamp _deadline;
+    static volatile unsigned int _deadline_cpu;
+    static volatile TSC::Time_Stamp _next_tick[Traits<Machine>::CPUS];
 };
 
 // Timer used by Thread::Scheduler
@@ -101,6 +114,19 @@ class Scheduler_Timer: public Timer
 {
 public:
     Scheduler_Timer(Microsecond quantum, Handler handler): Timer(SCHEDULER, 1000000 / quantum, handler) {}
+
+    using Timer::restart;
+
+    // Restarts the quantum, shortened to "budget" (rounded up to a timer tick) if that is shorter (0 means no budget)
+    int restart(Microsecond budget) {
+        int percentage = restart();
+        if(budget) {
+            Tick ticks = (static_cast<unsigned long long>(budget) * FREQUENCY + 999999) / 1000000;
+            if(ticks < _current[CPU::id()])
+                _current[CPU::id()] = ticks;
+        }
+        return percentage;
+    }
 };
 
 // Timer used by Alarm
@@ -91,6 +91,11 @@ public:
         }
 
         unsigned char ttl() { return _ttl; }
+        void ttl(unsigned char ttl) { // the checksum is updated incrementally (e.g. when forwarding)
+            unsigned short from = (_ttl << 8) | _protocol; // TTL and protocol share a 16-bit word
+            _ttl = ttl;
+            _checksum = htons(IP::checksum(ntohs(_checksum), from, (_ttl << 8) | _protocol));
+        }
 
         const Protocol & protocol() const { return _protocol; }
 
@@ -182,6 +187,12 @@ public:
 
     typedef Packet PDU;
 
+    // Piece of a message for scatter-gather I/O (e.g. UDP::send() and UDP::data())
+    struct Chunk {
+        const void * data;
+        unsigned int size;
+    };
+
 private:
     // Fragment key = f(from, id) = (from & ~_netmask) << 16 | id (fragmentation can only happen on localnet)
     typedef unsigned long Key;
@@ -237,19 +248,16 @@ private:
     };
 
 
+public:
     class Router;
 
     class Route
     {
         friend class Router;
 
-    private:
-        typedef Simple_List<Route> Table;
-        typedef Table::Element Element;
-
     public:
         Route(NIC<Ethernet> * nic, IP * ip, ARP<NIC<Ethernet>, IP> * arp, const Address & d, const Address & g, const Address & m, unsigned int t = 0, unsigned int w = 0):
-            _destination(d), _gateway(g), _genmask(m), _flags(t), _metric(w), _nic(nic), _ip(ip), _arp(arp), _link(this) {}
+            _destination(d), _gateway(g), _genmask(m), _flags(t), _metric(w), _nic(nic), _ip(ip), _arp(arp), _next(0) {}
 
         const Address & gateway() const { return _gateway; }
         NIC<Ethernet> * nic() { return _nic; }
@@ -278,53 +286,83 @@ private:
         IP * _ip;
         ARP<NIC<Ethernet>, IP> * _arp;
 
-        Element _link;
+        Route * _next; // next route to the same prefix
     };
 
 
+    // Routes are kept in a path-compressed binary trie keyed by their prefixes (destination/genmask), so search()
+    // returns the longest prefix match in at most 32 steps regardless of the number of routes. Routes to the same
+    // prefix are chained at their node and the one with the lowest metric (the first inserted on ties) is used.
+    // Destinations recently searched are kept in a small direct-mapped cache along with the MAC address of their
+    // next hop, so the send path usually takes neither the trie nor ARP. The cache is invalidated whenever a route
+    // is inserted or removed (ARP mappings are never aged).
     class Router
     {
     private:
-        typedef Route::Table::Element Element;
+        static const unsigned int CACHE_SIZE = 16;
+
+        struct Node {
+            Node(unsigned int p, unsigned int l): prefix(p), length(l), routes(0) { child[0] = child[1] = 0; }
+
+            unsigned int prefix; // host order, bits past length are zero
+            unsigned int length;
+            Route * routes;
+            Node * child[2];
+        };
+
+        struct Entry {
+            Address to;
+            Route * route;
+            MAC_Address mac;
+        };
 
     public:
-        void insert(NIC<Ethernet> * nic, IP * ip, ARP<NIC<Ethernet>, IP> * arp, const Address & d, const Address & g, const Address & m, unsigned int t = 0, unsigned int w = 0) {
-            Route * route = new (SYSTEM) Route(nic, ip, arp, d, g, m, t, w);
+        Router(): _root(0), _version(0) { invalidate(); }
+
+        void insert(NIC<Ethernet> * nic, IP * ip, ARP<NIC<Ethernet>, IP> * arp, const Address & d, const Address & g, const Address & m, unsigned int t = 0, unsigned int w = 0);
+
+        // Removes the route that would be used to reach "to"
+        void remove(const Address & to);
 
-            db<IP>(TRC) << "IP::Router::insert() => " << *route << endl;
+        // Route to "to" and, if "mac" is given, the MAC address of its next hop (resolved through ARP if not cached)
+        Route * search(const Address & to, MAC_Address * mac = 0);
 
-            _table.insert(&route->_link);
+        void invalidate() {
+            _version++;
+            for(unsigned int i = 0; i < CACHE_SIZE; i++)
+                _cache[i].route = 0;
         }
 
-        void remove(const Address & to) {
-            db<IP>(TRC) << "IP::Router::remove(to=" << to << ")" << endl;
+    private:
+        static unsigned int bits(const Address & a) {
+            unsigned int b;
+            memcpy(&b, &a, sizeof(unsigned int));
+            return ntohl(b);
+        }
+        static unsigned int mask(unsigned int length) { return length ? ~0U << (32 - length) : 0; }
+        static unsigned int bit(unsigned int key, unsigned int length) { return (key >> (31 - length)) & 1; }
+        static unsigned int hash(const Address & to) { unsigned int b = bits(to); return (b ^ (b >> 8)) % CACHE_SIZE; }
 
-            Element * e = _table.head();
-            for(; e && ((to & e->object()->_genmask) != e->object()->_destination); e = e->next());
-            if(e) {
-                db<IP>(INF) << "IP::Router::remove: removing and deleting " << *e->object() << endl;
+        Node ** find(unsigned int key, Node *** up = 0);
+        static Route * best(Route * routes);
 
-                _table.remove(e);
-                delete e->object();
-            }
+        void lock() {
+            CPU::int_disable();
+            if(Traits<System>::multicore)
+                _lock.acquire();
         }
 
-        Route * search(Address to) {
-            // Assume default (0.0.0.0) to have genmask 0.0.0.0 and be the last route in table
-            // Assume all routes to be network routes (i.g. flags "G")
-            db<IP>(TRC) << "IP::Route::search(to=" << to << ")" << endl;
-
-            Element * e = _table.head();
-            for(; e && ((to & e->object()->_genmask) != e->object()->_destination); e = e->next());
-            if(e) {
-                db<IP>(INF) << "IP::Route::search: found route to " << to << " => " << *e->object() << endl;
-                return e->object();
-            } else
-                return 0;
+        void unlock() {
+            if(Traits<System>::multicore)
+                _lock.release();
+            CPU::int_enable();
         }
 
     private:
-        Route::Table _table;
+        Node * _root;
+        Entry _cache[CACHE_SIZE];
+        unsigned int _version;
+        Spin _lock;
     };
 
 
@@ -362,11 +400,26 @@ public:
 
     static Buffer * alloc(const Address & to, const Protocol & prot, unsigned int once, unsigned int payload);
     static int send(Buffer * buf);
+    static int send(Buffer::List * train);
 
     static const unsigned int mtu() { return MTU; }
 
+    // Internet checksum (RFC 1071) of "size" bytes at "data"
     static unsigned short checksum(const void * data, unsigned int size);
 
+    // Incremental update (RFC 1624) of "checksum" for a 16-bit word (or a field of "size" bytes) rewritten from "from" to "to"
+    // Checksums and words are in host order (e.g. as returned by checksum() and Header::checksum())
+    static unsigned short checksum(unsigned short checksum, unsigned short from, unsigned short to);
+    static unsigned short checksum(unsigned short checksum, const void * from, const void * to, unsigned int size);
+
+    // One's complement sum (in host order, folded to 16 bits) of "size" bytes at "data", added to "partial"
+    // Partial sums can be chained over consecutive pieces of a message, as long as all but the last piece have even sizes
+    // The checksum is the complement of the final sum
+    static unsigned long sum(const void * data, unsigned int size, unsigned long partial = 0);
+
+    // Same as memcpy(to, from, size) followed by sum(to, size, partial), but in a single pass
+    static unsigned long copy_and_sum(void * to, const void * from, unsigned int size, unsigned long partial = 0);
+
     static void attach(Observer * obs, const Protocol & prot) { _observed.attach(obs, prot); }
     static void detach(Observer * obs, const Protocol & prot) { _observed.detach(obs, prot); }
 
@@ -390,6 +443,15 @@ private:
 
     static bool notify(const Protocol & prot, Buffer * buf) { return _observed.notify(prot, buf); }
 
+    static unsigned long fold(unsigned long long sum) {
+        while(sum >> 16)
+            sum = (sum & 0xffff) + (sum >> 16);
+        return sum;
+    }
+
+    // Native word holding the last byte of odd-sized data padded with zero
+    static unsigned short trailer(unsigned char byte) { return htons(byte << 8); }
+
     template<unsigned int UNIT>
     inline static void init_helper() {
         NIC<Ethernet> * nic = Traits<Ethernet>::DEVICES::Get<Traits<IP>::NICS[UNIT]>::Result::get(Traits<IP>::NICS[UNIT]);
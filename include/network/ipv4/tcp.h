@@ -30,7 +30,13 @@ public:
     static const unsigned int TIMEOUT = Traits<TCP>::TIMEOUT * 1000000;
     static const unsigned int WINDOW = Traits<TCP>::WINDOW;
 
+    static const unsigned int MIN_RTO = 200000;     // us
+    static const unsigned int MAX_RTO = 60000000;   // us
+    static const unsigned int ACK_DELAY = 40000;    // us
+    static const unsigned int TRAIN = 4;            // segments handed over to the NIC at once
+
     typedef IP::Buffer Buffer;
+    typedef IP::Chunk Chunk;
 
     typedef UDP::Port Port;
 
@@ -40,6 +46,7 @@ public:
 
     typedef Data_Observer<Buffer, Connection_Id> Observer;
     typedef Data_Observed<Buffer, Connection_Id> Observed;
+    typedef Hashed_Data_Observed<Buffer, Connection_Id, 64> Demultiplexer; // by connection
 
     class Header
     {
@@ -97,6 +104,7 @@ public:
     static const unsigned int MTU = IP::MTU - sizeof(Header);
     static const unsigned int MSS = IP::MFS - sizeof(Header);
     static const unsigned int HEADERS_SIZE = sizeof(IP::Header) + sizeof(Header);
+    static const unsigned int INITIAL_WINDOW = (4 * MSS < 4380) ? 4 * MSS : (2 * MSS > 4380) ? 2 * MSS : 4380; // RFC 5681
 
     typedef unsigned char Data[MTU];
 
@@ -110,7 +118,8 @@ public:
         template<typename T>
         T * data() { return reinterpret_cast<T *>(&_data); }
 
-        void sum(const IP::Address & from, const IP::Address & to, const void * data, unsigned int length);
+        // If "copy" is true, data is also copied into the segment while being summed
+        void sum(const IP::Address & from, const IP::Address & to, const void * data, unsigned int length, bool copy = false);
         bool check(unsigned int length) { return IP::checksum(this, length) != 0xffff; } // FIXME
 
         friend OStream & operator<<(OStream & os, const Segment & m) {
@@ -148,14 +157,17 @@ public:
         Connection(const Address & from, const Address & to)
         : Header(from.port(), to.port(), Random::random() & 0x00ffffff, WINDOW), _peer(to.ip()), _peer_window(0), _next(ntohl(_sequence)),
           _unacknowledged(_next), _initial(_next), _state(CLOSED), _handler(&Connection::closed), _current(0), _length(0), _valid(false),
-          _streaming(false), _retransmiting(false), _timeout_handler(&timeout,this), _alarm(0), _tries(0), _observer(0) {}
-        ~Connection() { if(_alarm) delete _alarm; close(); }
+          _streaming(false), _retransmiting(false), _retransmit(false), _acks(0), _stream(0), _awake(true), _cwnd(INITIAL_WINDOW), _ssthresh(65535), _recover(_next),
+          _duplicates(0), _recovering(false), _timing(false), _timed(0), _srtt(0), _rttvar(0), _rto(TIMEOUT), _delayed(false),
+          _ack_handler(&delayed_ack, this), _ack_alarm(0), _timeout_handler(&timeout,this), _alarm(0), _tries(0), _observer(0) {}
+        ~Connection() { if(_alarm) delete _alarm; if(_ack_alarm) delete _ack_alarm; close(); }
 
         const volatile State & state() const { return _state; }
         const Header * header() const { return this; }
 
         int write(const void * data, unsigned int size);
         int read(Buffer * buf, void * data, unsigned int size);
+        unsigned int data(Buffer * buf, Chunk * chunks, unsigned int n); // in place, as UDP::data()
 
         const IP::Address & peer() const { return _peer; }
 
@@ -185,7 +197,8 @@ public:
 
         friend OStream & operator<<(OStream & os, const Connection & c) {
             os << *c.header()
-               << ",peer=" << c._peer << ",pwin=" << c._peer_window << ",uack=" << ntohl(c._unacknowledged) << ",stat=" << c._state;
+               << ",peer=" << c._peer << ",pwin=" << c._peer_window << ",uack=" << c._unacknowledged << ",stat=" << c._state
+               << ",cwnd=" << c._cwnd << ",ssth=" << c._ssthresh << ",srtt=" << c._srtt << ",rto=" << c._rto;
             if(c._current)
                 os << ",curr=" << c._current << " => " << *c._current << ",len=" << c._length;
             return os;
@@ -218,11 +231,21 @@ public:
         void closed();
 
         void fsend(const Flags & flags);
-        int dsend(const void * data, unsigned int size);
+        int dsend(const void * data, unsigned int size, Buffer::List * train = 0);
 
         bool check_sequence();
         void process_fin();
 
+        // Sequence numbers are compared modulo 2^32 (RFC 793, 3.3)
+        static bool before(unsigned int s1, unsigned int s2) { return static_cast<int>(s1 - s2) < 0; }
+        static bool after(unsigned int s1, unsigned int s2) { return static_cast<int>(s1 - s2) > 0; }
+
+        bool acknowledge(unsigned int ack);
+        void estimate(const Microsecond & rtt);
+        void ack();
+
+        static void wake(Connection * c);
+        static void delayed_ack(Connection * c);
         static void timeout(Connection * c);
         void set_timeout(const Microsecond & time = TIMEOUT);
 
@@ -245,8 +268,31 @@ public:
 
         // Stream stuff
         volatile bool _streaming;
-        volatile bool _retransmiting;
-        Condition _stream;
+        volatile bool _retransmiting;   // going back to SND.UNA after a retransmission timeout
+        volatile bool _retransmit;      // the first unacknowledged segment must be sent again (fast retransmit)
+        volatile unsigned int _acks;    // acknowledgments that may let the writer proceed
+        Semaphore _stream;
+        alignas(int) volatile bool _awake; // the writer is not waiting on _stream (or it has already been posted)
+
+        // Congestion control (RFC 5681 and RFC 6582), all in bytes
+        unsigned int _cwnd;
+        unsigned int _ssthresh;
+        unsigned int _recover;          // SND.NXT when fast recovery started (host endianness)
+        unsigned int _duplicates;
+        bool _recovering;
+
+        // Round-trip time estimation (RFC 6298), a single segment is timed at a time
+        bool _timing;
+        unsigned int _timed;            // acknowledgment that completes the measurement (host endianness)
+        TSC::Time_Stamp _rtt_start;
+        Microsecond _srtt;
+        Microsecond _rttvar;
+        Microsecond _rto;
+
+        // Delayed acknowledgments (RFC 1122)
+        volatile bool _delayed;
+        Functor_Handler<Connection> _ack_handler;
+        Alarm * _ack_alarm;
 
         // Timeout stuff
         Functor_Handler<Connection> _timeout_handler;
@@ -305,7 +351,7 @@ private:
     }
 
 private:
-    static Observed _observed; // Channel protocols are singletons
+    static Demultiplexer _observed; // Channel protocols are singletons
 };
 
 __END_SYS
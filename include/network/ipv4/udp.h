@@ -21,6 +21,7 @@ public:
     static const bool connectionless = true;
 
     typedef IP::Buffer Buffer;
+    typedef IP::Chunk Chunk;
 
     typedef unsigned short Port;
 
@@ -62,6 +63,7 @@ public:
 
     typedef Data_Observer<Buffer, Port> Observer;
     typedef Data_Observed<Buffer, Port> Observed;
+    typedef Hashed_Data_Observed<Buffer, Port, 256> Demultiplexer; // by port
 
 
     class Header
@@ -108,6 +110,7 @@ public:
 
         void sum_header(const IP::Address & from, const IP::Address & to);
         void sum_data(const void * data, unsigned int size);
+        void copy_data(void * to, const void * from, unsigned int size); // memcpy() and sum_data() in a single pass
         void sum_trailer();
         bool check() { return Traits<UDP>::checksum ? (IP::checksum(this, length()) != 0xffff) : true; }
 
@@ -133,8 +136,13 @@ public:
     }
 
     static int send(const Address & from, const Address & to, const void * data, unsigned int size);
+    static int send(const Address & from, const Address & to, const Chunk * chunks, unsigned int n); // gather
     static int receive(Buffer * buf, void * data, unsigned int size);
 
+    // Maps the payload of a received datagram onto "chunks" pointing into the NIC's buffers (one per fragment, at most
+    // "n"), so it can be read in place. Returns the number of fragments, or 0 if the datagram is corrupted.
+    static unsigned int data(Buffer * buf, Chunk * chunks, unsigned int n);
+
     static void attach(Observer * obs, const Address & addr) { _observed.attach(obs, addr.port()); }
     static void detach(Observer * obs, const Address & addr) { _observed.detach(obs, addr.port()); }
     static bool notify(const Port & port, Buffer * buf) { return _observed.notify(port, buf); }
@@ -142,7 +150,7 @@ public:
 private:
     void update(IP::Observed * obs, const IP::Protocol & prot, Buffer * buf);
 
-    static Observed _observed; // Channel protocols are singletons
+    static Demultiplexer _observed; // Channel protocols are singletons
 };
 
 __END_SYS
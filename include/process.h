@@ -25,8 +25,11 @@ class Thread
     friend class Synchronizer_Common;           // for lock() and sleep()
     friend class Alarm;                         // for lock()
     friend class System;                        // for init()
-    friend class IC;                            // for link() for priority ceiling
+    friend class IC;                            // for link() for priority ceiling and fpu_trap()
     friend class Clerk<System>;                 // for _statistics
+    friend class Clerk<PMU>;                    // for _pmu_clerks
+    friend class Monitor;                       // for _thread_count and _daemon_count
+    friend class Agent;                         // for kernel_fpu_begin() and kernel_fpu_end()
     friend class EA_PEDF_RV64;  // FIX: Change this for a generic criterion definition
     friend volatile void * ::_running();        // for running()
     template<bool smp> 
@@ -36,9 +39,14 @@ class Thread
 protected:
     static const bool smp = Traits<Thread>::smp;
     static const bool monitored = Traits<Thread>::monitored;
+    static const bool queue_locking = smp && Traits<Thread>::queue_locking && (Traits<Thread>::Criterion::QUEUES > 1);
+    static const bool lock_profiling = smp && Traits<Thread>::lock_profiling;
+    static const bool work_stealing = smp && Traits<Thread>::work_stealing && (Traits<Thread>::Criterion::QUEUES > 1);
     static const bool preemptive = Traits<Thread>::Criterion::preemptive;
     static const bool multitask = Traits<System>::multitask;
     static const bool reboot = Traits<System>::reboot;
+    static const bool lazy_fpu = Traits<FPU>::enabled && Traits<FPU>::lazy;
+    static const bool pmu_virtualized = Traits<PMU>::enabled;
     static const unsigned int priority_inversion_protocol = Traits<Build>::NONE;  // TODO: Add a trait for this configuration
 
     static const unsigned int QUANTUM = Traits<Thread>::QUANTUM;
@@ -75,15 +83,55 @@ public:
     // Thread Configuration
     // t = 0 => Task::self()
     // ss = 0 => user-level stack on an auto expand segment
+    // f = false => the thread does not use the FPU, so it gets no FPU context and is terminated if it tries to (Traits<FPU>::lazy only)
     struct Configuration {
-        Configuration(State s = READY, Criterion c = NORMAL, Color a = WHITE, Task * t = 0, unsigned int ss = STACK_SIZE)
-        : state(s), criterion(c), color(a), task(t), stack_size(ss) {}
+        Configuration(State s = READY, Criterion c = NORMAL, Color a = WHITE, Task * t = 0, unsigned int ss = STACK_SIZE, bool f = true)
+        : state(s), criterion(c), color(a), task(t), stack_size(ss), fpu(f) {}
 
         State state;
         Criterion criterion;
         Color color;
         Task * task;
         unsigned int stack_size;
+        bool fpu;
+    };
+
+    // Scheduler Lock Statistics (per CPU, in TSC ticks)
+    struct Lock_Statistics {
+        Lock_Statistics(): acquisitions(0), wait_time(0), hold_time(0), _since(0), _nesting(0) {}
+
+        friend OStream & operator<<(OStream & os, const Lock_Statistics & s) {
+            os << "{acq=" << s.acquisitions << ",wait=" << s.wait_time << ",hold=" << s.hold_time << "}";
+            return os;
+        }
+
+        unsigned long long acquisitions;
+        TSC::Time_Stamp wait_time;
+        TSC::Time_Stamp hold_time;
+
+    private:
+        friend class Thread;
+
+        TSC::Time_Stamp _since;
+        unsigned int _nesting;
+    };
+
+    // Work Stealing Statistics (per CPU)
+    struct Steal_Statistics {
+        Steal_Statistics(): steals(0), migrations(0), _last(0) {}
+
+        friend OStream & operator<<(OStream & os, const Steal_Statistics & s) {
+            os << "{steals=" << s.steals << ",migrations=" << s.migrations << "}";
+            return os;
+        }
+
+        unsigned long steals;       // threads pulled into this CPU's queue
+        unsigned long migrations;   // threads pulled out of this CPU's queue by others
+
+    private:
+        friend class Thread;
+
+        TSC::Time_Stamp _last;
     };
 
 
@@ -107,12 +155,20 @@ public:
     void suspend();
     void resume();
 
+    // Marks a kernel service thread that blocks forever waiting for work (e.g. a NIC poller), so it doesn't keep the system alive (see idle())
+    void daemon();
+
     static Thread * volatile self() { return running(); }
     static void yield();
     static void exit(int status = 0);
 
+    static const Lock_Statistics & lock_statistics(unsigned int cpu = CPU::id()) { return _lock_statistics[cpu]; }
+    static void reset_lock_statistics();
+
+    static const Steal_Statistics & steal_statistics(unsigned int cpu = CPU::id()) { return _steal_statistics[work_stealing ? cpu : 0]; }
+
 protected:
-    void constructor_prologue(Color color, unsigned int stack_size);
+    void constructor_prologue(Color color, unsigned int stack_size, bool fpu = true);
     void constructor_epilogue(Log_Addr entry, unsigned int stack_size);
 
     Queue::Element * link() { return &_link; }
@@ -130,20 +186,107 @@ protected:
 
     static Thread * volatile running() { return _not_booting ? _scheduler.chosen() : reinterpret_cast<Thread * volatile>(CPU::id() + 1); }
 
+    // Scheduler locking
+    // With queue_locking, _lock still serializes everything that is not confined to a single scheduling queue
+    // (thread creation and destruction, synchronizers, alarms, migrations), while each queue gets its own lock.
+    // The lock order is _lock, local queue, remote queue (a single one at a time). Holders of _lock also hold
+    // the local queue lock, so dispatch() can always release it. Hot paths (time slicing, yield, rescheduling
+    // IPIs) only take the local queue lock through lock_local(). Nested lock()s are counted in _global_level, so
+    // both locks are only taken by the outermost lock() and only released by the matching unlock().
     static void lock() {
         CPU::int_disable();
-        if(smp)
-            _lock.acquire();
+        if(smp) {
+            if(!queue_locking)
+                acquire(_lock);
+            else if(_global_level[CPU::id()]++ == 0) {
+                acquire(_lock);
+                acquire(_queue_lock[Criterion::current_queue()]);
+            }
+        }
     }
 
     static void unlock() {
-        if(smp)
-            _lock.release();
+        if(smp) {
+            if(!queue_locking)
+                release(_lock);
+            else if(--_global_level[CPU::id()] == 0) {
+                release(_queue_lock[Criterion::current_queue()]);
+                release(_lock);
+            }
+        }
         if(_not_booting)
             CPU::int_enable();
     }
 
-    static volatile bool locked() { return (smp) ? _lock.taken() : CPU::int_disabled(); }
+    static volatile bool locked() {
+        if(!smp)
+            return CPU::int_disabled();
+        if(queue_locking)
+            return _queue_lock[Criterion::current_queue()].taken();
+        return _lock.taken();
+    }
+
+    // Returns true if it had to fall back to lock(), which must be informed to unlock_local()
+    static bool lock_local() {
+        if(!queue_locking) {
+            lock();
+            return true;
+        }
+
+        CPU::int_disable();
+        acquire(_queue_lock[Criterion::current_queue()]);
+        if(!_not_booting || (running()->_link.rank().queue() == Criterion::current_queue()))
+            return false;
+
+        // The running thread is migrating to another queue, so the full lock is needed
+        release(_queue_lock[Criterion::current_queue()]);
+        lock();
+        return true;
+    }
+
+    static void unlock_local(bool global) {
+        if(global)
+            unlock();
+        else {
+            release(_queue_lock[Criterion::current_queue()]);
+            if(_not_booting)
+                CPU::int_enable();
+        }
+    }
+
+    // Cross-queue operations (only while holding _lock)
+    static void lock_queue(unsigned int queue) {
+        if(queue_locking)
+            acquire(_queue_lock[queue]);
+    }
+
+    static void unlock_queue(unsigned int queue) {
+        if(queue_locking)
+            release(_queue_lock[queue]);
+    }
+
+    static void acquire(Spin & lock) {
+        if(lock_profiling) {
+            Lock_Statistics & s = _lock_statistics[CPU::id()];
+            TSC::Time_Stamp begin = TSC::time_stamp();
+            lock.acquire();
+            TSC::Time_Stamp end = TSC::time_stamp();
+            s.acquisitions++;
+            s.wait_time += end - begin;
+            if(s._nesting++ == 0)
+                s._since = end;
+        } else
+            lock.acquire();
+    }
+
+    static void release(Spin & lock) {
+        if(lock_profiling) {
+            Lock_Statistics & s = _lock_statistics[CPU::id()];
+            if(--s._nesting == 0)
+                s.hold_time += TSC::time_stamp() - s._since;
+        }
+        lock.release();
+    }
 
     static void sleep(Queue * q);
     static void wakeup(Queue * q);
@@ -162,17 +305,26 @@ protected:
     static void monitor_run(IC::Interrupt_Id interrupt);
 
     static void dispatch(Thread * prev, Thread * next, bool charge = true);
+    static void account(Thread * prev);
+    static void rerank(Thread * t);
 
     static void for_all_threads(Criterion::Event event) {
-        for(Queue::Iterator i = _scheduler.begin(); i != _scheduler.end(); ++i)
+        for(Scheduler<Thread>::Iterator i = _scheduler.begin(); i != _scheduler.end(); ++i)
             if(i->object()->criterion() != IDLE)
                 i->object()->criterion().handle(event);
     }
     static void for_all_threads_in_task(const Task * task, Criterion::Event event);
     static void for_all_threads_in_cpu(unsigned int cpu, Criterion::Event event);
 
+    static void steal();
+    static bool stealable(Thread * t);
+
     static int idle();
 
+    static void kernel_fpu_begin();
+    static void kernel_fpu_end();
+    static bool fpu_trap();
+
 private:
     static void init();
 
@@ -182,6 +334,9 @@ protected:
 
     char * _stack;
     Context * volatile _context;
+    CPU::FPU_Context * _fpu;
+    volatile unsigned int _fpu_cpu;
+    Clerk<PMU> * _pmu_clerks;
     volatile State _state;
     Criterion _natural_priority;
     Queue * _waiting;
@@ -190,10 +345,17 @@ protected:
 
     alignas (int) static bool _not_booting;
     static volatile unsigned int _thread_count;
+    static volatile unsigned int _daemon_count;
     static Scheduler_Timer * _timer;
     static Monitor_Timer * _monitor_timer;
     static Scheduler<Thread> _scheduler;
     static Spin _lock;
+    static Spin _queue_lock[queue_locking ? Criterion::QUEUES : 1];
+    static volatile unsigned int _global_level[queue_locking ? Traits<Machine>::CPUS : 1];
+    static Lock_Statistics _lock_statistics[lock_profiling ? Traits<Machine>::CPUS : 1];
+    static Steal_Statistics _steal_statistics[work_stealing ? Traits<Machine>::CPUS : 1];
+    static Thread * volatile _fpu_owner[lazy_fpu ? Traits<Machine>::CPUS : 1];
+    static volatile unsigned int _fpu_kernel[lazy_fpu ? Traits<Machine>::CPUS : 1];
 };
 
 
@@ -222,7 +384,7 @@ protected:
     // This constructor is only used by Thread::init()
     template<typename ... Tn>
     Task(Address_Space * as, Segment * cs, Segment * ds, Log_Addr code, Log_Addr data, int (* entry)(Tn ...), Tn ... an)
-    : _as(as), _cs(cs), _ds(ds), _code(code), _data(data), _entry(entry) {
+    : _as(as), _cs(cs), _ds(ds), _code(code), _data(data), _entry(entry), _ring(0), _kernel_page(0) {
         db<Task, Init>(TRC) << "Task(as=" << _as << ",cs=" << _cs << ",ds=" << _ds << ",code=" << _code << ",data=" << _data << ",entry=" << _entry << ") => " << this << endl;
 
         _current = this;
@@ -233,7 +395,7 @@ protected:
 public:
     template<typename ... Tn>
     Task(Segment * cs, Segment * ds, Log_Addr code, Log_Addr data, int (* entry)(Tn ...), Tn ... an)
-    : _as (new (SYSTEM) Address_Space), _cs(cs), _ds(ds), _code(_as->attach(_cs, code)), _data(_as->attach(_ds, data)), _entry(entry) {
+    : _as (new (SYSTEM) Address_Space), _cs(cs), _ds(ds), _code(_as->attach(_cs, code)), _data(_as->attach(_ds, data)), _entry(entry), _ring(0), _kernel_page(0) {
         db<Task>(TRC) << "Task(as=" << _as << ",cs=" << _cs << ",ds=" << _ds << ",entry=" << _entry << ",code=" << _code << ",data=" << _data << ") => " << this << endl;
 
         _cs->reflag(Segment::Flags::APPC);
@@ -243,7 +405,7 @@ public:
     
     template<typename ... Tn>
     Task(Thread::Configuration conf, Segment * cs, Segment * ds, Log_Addr code, Log_Addr data, int (* entry)(Tn ...), Tn ... an)
-    : _as (new (SYSTEM) Address_Space), _cs(cs), _ds(ds), _code(_as->attach(_cs, code)), _data(_as->attach(_ds, data)), _entry(entry) {
+    : _as (new (SYSTEM) Address_Space), _cs(cs), _ds(ds), _code(_as->attach(_cs, code)), _data(_as->attach(_ds, data)), _entry(entry), _ring(0), _kernel_page(0) {
         db<Task>(TRC) << "Task(as=" << _as << ",cs=" << _cs << ",ds=" << _ds << ",entry=" << _entry << ",code=" << _code << ",data=" << _data << ") => " << this << endl;
 
         _cs->reflag(Segment::Flags::APPC);
@@ -252,7 +414,7 @@ public:
     }
     
     template<typename ... Tn>
-    Task(Task * task = _current, int (* entry)(Tn ...) = 0, Tn ... an) { // fork-like constructor
+    Task(Task * task = _current, int (* entry)(Tn ...) = 0, Tn ... an): _ring(0), _kernel_page(0) { // fork-like constructor
         // Allocate resources
         _as = new (SYSTEM) Address_Space;
         _cs = new (SYSTEM) Segment(task->code_segment()->size());
@@ -304,6 +466,13 @@ public:
 
     Thread * main() const { return _main; }
 
+    // System call ring shared with the framework (see framework/ring.h), mapped on demand
+    Log_Addr syscall_ring() const { return _ring ? _ring_address : Log_Addr(0); }
+    Log_Addr syscall_ring(unsigned long size);
+
+    // Read-only kernel page (see system/kernel_page.h), mapped on demand
+    Log_Addr kernel_page();
+
     int join() { return _main->join(); }
 
     static Task * volatile self() { return current(); }
@@ -336,6 +505,9 @@ private:
     Log_Addr _entry;
     Thread * _main;
     Resources _resources;
+    Segment * _ring;
+    Log_Addr _ring_address;
+    Log_Addr _kernel_page;
 
     static Task * volatile _current;
 };
@@ -387,7 +559,7 @@ inline Thread::Thread(Configuration conf, int (* entry)(Tn ...), Tn ... an)
 : _task(conf.task ? conf.task : Task::self()), _state(conf.state), _waiting(0), _joining(0), _link(this, conf.criterion)
 {
     if(multitask && !conf.stack_size) { // auto-expand, user-level stack
-        constructor_prologue(conf.color, STACK_SIZE);
+        constructor_prologue(conf.color, STACK_SIZE, conf.fpu);
         _user_stack = new (SYSTEM) Segment(USER_STACK_SIZE);
 
         // Attach the thread's user-level stack to the current address space so we can initialize it
@@ -412,7 +584,7 @@ inline Thread::Thread(Configuration conf, int (* entry)(Tn ...), Tn ... an)
         // Initialize the thread's system-level stack
         _context = CPU::init_stack(usp, _stack + STACK_SIZE, &__exit, entry, an ...);
     } else { // single-task scenarios and idle thread, which is a kernel thread, don't have a user-level stack
-        constructor_prologue(conf.color, conf.stack_size);
+        constructor_prologue(conf.color, conf.stack_size, conf.fpu);
         _user_stack = 0;
         _context = CPU::init_stack(0, _stack + conf.stack_size, &__exit, entry, an ...);
     }
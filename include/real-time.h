@@ -34,7 +34,7 @@ struct Periodic_Thread_Configuration: public Thread::Configuration {
 
 template<>
 struct Periodic_Thread_Configuration<false>: public Thread::Configuration {
-    Periodic_Thread_Configuration(Microsecond p, Microsecond d = Thread::Criterion::SAME, Microsecond c = Thread::Criterion::UNKNOWN, Microsecond a = Thread::Criterion::NOW, const unsigned int n = INFINITE, unsigned int cpu = Thread::Criterion::ANY, Thread::State s = Thread::READY, Color cl = WHITE, Task * t = 0, unsigned int ss = Thread::STACK_SIZE)
+    Periodic_Thread_Configuration(Microsecond p, Microsecond d = Thread::Criterion::SAME, Microsecond c = Thread::Criterion::UNKNOWN, Microsecond a = Thread::Criterion::NOW, const unsigned int n = INFINITE, unsigned int cpu = Thread::Criterion::ANY, Thread::State s = Thread::READY, Color cl = WHITE, Task * t = 0, unsigned int ss = Thread::STACK_SIZE, Thread * thread = nullptr)
     : Thread::Configuration(s, Thread::Criterion(p, d, c), cl, t, ss), activation(a), times(n) {}
 
     Microsecond activation;
@@ -95,7 +95,7 @@ public:
 
     template<typename ... Tn>
     Periodic_Thread(Configuration conf, int (* entry)(Tn ...), Tn ... an)
-    : Thread(Thread::Configuration(SUSPENDED, conf.criterion, conf.color, conf.task, conf.stack_size), entry, an ...),
+    : Thread(Thread::Configuration(SUSPENDED, conf.criterion, conf.color, conf.task, conf.stack_size, conf.fpu), entry, an ...),
       _semaphore(0), _handler(&_semaphore, this), _alarm(conf.criterion.period(), &_handler, conf.times) {
         if((conf.state == READY) || (conf.state == RUNNING)) {
             _state = SUSPENDED;
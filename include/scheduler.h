@@ -15,6 +15,10 @@
 
 __BEGIN_SYS
 
+extern OStream kout;
+
+class CBS;
+
 // All scheduling criteria, or disciplines, must define operator int() with
 // the semantics of returning the desired order of a given object within the
 // scheduling list
@@ -67,6 +71,7 @@ public:
         JOB_EXECUTION_FINISH = 1 << 7,
         JOB_ALARM_HANDLE     = 1 << 8,
         TIMER_INTERRUPTION   = 1 << 9,
+        WAKEUP               = 1 << 10,     // the thread became ready after being suspended or waiting
     };
 
     // Policy operations
@@ -97,6 +102,8 @@ public:
     static const unsigned int QUEUES = 1;
     static const unsigned int HEADS = 1;
 
+    static unsigned int current_queue() { return 0; }
+
     // Runtime Statistics (for policies that don't use any; that's why its a union)
     union Dummy_Statistics {  // for Traits<System>::monitored = false
         // Thread related statistics
@@ -179,6 +186,8 @@ public:
     Microsecond period() { return 0;}
     Microsecond deadline() { return 0; }
     Microsecond capacity() { return 0; }
+    Microsecond budget() { return 0; }      // execution time left before the criterion must be reevaluated (0 means unbounded)
+    CBS * server() const { return 0; }      // the server whose deadline ranks the thread, if any (see EDF)
 
     bool periodic() { return false; }
 
@@ -189,6 +198,7 @@ protected:
 
     unsigned int queue() const { return 0; }
     void queue(unsigned int q) {}
+    bool pinned() const { return true; }
 
     static Tick now();
 
@@ -251,6 +261,7 @@ class RT_Common: public Priority
     friend class Thread;                // for handle() and queue()
     friend class Periodic_Thread;       // for handle() and queue()
     friend class RT_Thread;             // for handle() and queue()
+    friend class CBS;                   // for ticks(), time(), and now()
 
 public:
     static const bool timed = true;
@@ -281,8 +292,8 @@ public:
 protected:
     void handle(Event event);
 
-    Tick ticks(Microsecond time);
-    Microsecond time(Tick ticks);
+    static Tick ticks(Microsecond time);
+    static Microsecond time(Tick ticks);
 
 protected:
     Tick _period;
@@ -331,20 +342,94 @@ public:
     LM(const LM &lm) : RT_Common(lm) {}
 };
 
+// Constant Bandwidth Server (CBS)
+// Reserves budget / period of a CPU to the aperiodic threads it hosts under EDF-based criteria. Hosted threads are
+// scheduled by the server's deadline and their execution is charged to the server's budget, which is enforced with
+// the scheduler timer. When the budget is exhausted, it is recharged and the deadline is postponed by one period, so
+// hosted threads cannot take more than their share of the CPU away from the others, however much they try to run.
+// A thread that wakes up keeps the current (budget, deadline) pair unless using it would exceed the reserved bandwidth,
+// in which case the server restarts with a full budget and a deadline one period ahead.
+// When the deadline is postponed, the ready threads hosted by the server are reinserted in the queue of the thread that
+// was charged (see Thread::account()), so partitioned criteria (e.g. PEDF) place all threads hosted by a server in the
+// queue of the server's CPU (by default, the one that creates it). Servers can still be woken up from other CPUs (and
+// hosted threads be created on them), so their state is guarded by a lock of their own.
+class CBS
+{
+    friend class EDF;
+
+private:
+    typedef RT_Common::Tick Tick;
+
+public:
+    CBS(Microsecond budget, Microsecond period, unsigned int cpu = RT_Common::ANY);
+
+    Microsecond budget() const { return RT_Common::time(_budget); }
+    Microsecond period() const { return RT_Common::time(_period); }
+    unsigned int cpu() const { return _cpu; }
+    unsigned int postponements() const { return _postponements; }
+
+private:
+    void wakeup(Tick now);
+    bool charge(Tick time);
+
+    // Charges happen with interrupts disabled, so they must also be disabled while the lock is held
+    bool lock() {
+        bool disabled = CPU::int_disabled();
+        if(!disabled)
+            CPU::int_disable();
+        while(CPU::tsl(_locked));
+        return disabled;
+    }
+    void unlock(bool disabled) {
+        _locked = false;
+        if(!disabled)
+            CPU::int_enable();
+    }
+
+private:
+    Tick _budget;
+    Tick _period;
+    Tick _remaining;
+    Tick _deadline;
+    unsigned int _cpu;
+    volatile unsigned int _postponements;
+    volatile bool _locked;
+};
+
 // Earliest Deadline First
+// Aperiodic threads can be hosted by a CBS to get a bounded share of the CPU.
+// With Traits<Scheduler<Thread>>::enforce_capacity, periodic threads with a known capacity also have it enforced as
+// the budget of each job: a job that overruns it has its deadline postponed by one period, so it cannot make the other
+// threads miss their deadlines.
+// Charging a thread can change its rank, so it is only done on CHARGE, while the thread is not in the ready queue.
 class EDF: public RT_Common
 {
+private:
+    static const bool enforce_capacity = Traits<Scheduler<Thread>>::enforce_capacity;
+
 public:
     static const bool dynamic = true;
 
 public:
-    EDF(int p = APERIODIC): RT_Common(p) {}
+    EDF(int p = APERIODIC): RT_Common(p), _server(0), _budget(0), _since(0) {}
+    EDF(CBS * server);
 
-    EDF(const EDF &edf) : RT_Common(edf) {}
+    EDF(const EDF &edf) : RT_Common(edf), _server(edf._server), _budget(edf._budget), _since(edf._since) {}
 
     EDF(Microsecond p, Microsecond d = SAME, Microsecond c = UNKNOWN);
 
+    CBS * server() const { return _server; }
+    Microsecond budget();
+
     void handle(Event event);
+
+private:
+    void charge();
+
+private:
+    CBS * _server;
+    Tick _budget;       // budget left to the current job (if the capacity is known)
+    Tick _since;        // last time the budget was charged
 };
 
 // Least Laxity First
@@ -367,15 +452,19 @@ public:
 class Variable_Queue_Scheduler
 {
 protected:
-    Variable_Queue_Scheduler(unsigned int queue): _queue(queue) {};
+    Variable_Queue_Scheduler(unsigned int queue, bool pinned = true): _queue(queue), _pinned(pinned) {};
 
-    Variable_Queue_Scheduler(const Variable_Queue_Scheduler &variable_queue_scheduler) : _queue(variable_queue_scheduler._queue) {}
+    Variable_Queue_Scheduler(const Variable_Queue_Scheduler &variable_queue_scheduler) : _queue(variable_queue_scheduler._queue), _pinned(variable_queue_scheduler._pinned) {}
 
     unsigned int queue() const volatile { return _queue; }
     void queue(unsigned int q) { _queue = q; }
 
+    // Threads not explicitly bound to a CPU can be moved to another queue by work stealing
+    bool pinned() const volatile { return _pinned; }
+
 protected:
     volatile unsigned int _queue;
+    bool _pinned;
     static volatile unsigned int _next_queue;
 };
 
@@ -406,11 +495,13 @@ public:
 public:
     template <typename ... Tn>
     Fixed_CPU(int p = NORMAL, unsigned int cpu = ANY, Tn & ... an)
-    : Priority(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : (cpu != ANY) ? cpu : ++_next_queue %= CPU::cores()) {}
+    : Priority(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : (cpu != ANY) ? cpu : ++_next_queue %= CPU::cores(),
+                                            (_priority == IDLE) || (_priority == MAIN) || (cpu != ANY)) {}
 
     Fixed_CPU(const Fixed_CPU &fixed_cpu) : Priority(fixed_cpu), Variable_Queue_Scheduler(fixed_cpu) {}
 
     using Variable_Queue_Scheduler::queue;
+    using Variable_Queue_Scheduler::pinned;
     static unsigned int current_queue() { return CPU::id(); }
 };
 
@@ -424,13 +515,15 @@ public:
 public:
     template <typename ... Tn>
     CPU_Affinity(int p = NORMAL, unsigned int cpu = ANY, Tn & ... an)
-    : Priority(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : (cpu != ANY) ? cpu : ++_next_queue %= CPU::cores()) {}
+    : Priority(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : (cpu != ANY) ? cpu : ++_next_queue %= CPU::cores(),
+                                            (_priority == IDLE) || (_priority == MAIN) || (cpu != ANY)) {}
 
     CPU_Affinity(const CPU_Affinity &cpu_affinity) : Priority(cpu_affinity), Variable_Queue_Scheduler(cpu_affinity) {}
 
     void handle(Event event);
 
     using Variable_Queue_Scheduler::queue;
+    using Variable_Queue_Scheduler::pinned;
     static unsigned int current_queue() { return CPU::id(); }
 
 private:
@@ -446,7 +539,7 @@ public:
 
 public:
     PRM(int p = APERIODIC)
-    : RM(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : 0) {}
+    : RM(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : 0, (_priority == IDLE) || (_priority == MAIN)) {}
 
     PRM(const Microsecond & d, const Microsecond & p = SAME, const Microsecond & c = UNKNOWN, unsigned int cpu = ANY)
     : RM(d, p, c), Variable_Queue_Scheduler((cpu != ANY) ? cpu : ++_next_queue %= CPU::cores()) {}
@@ -454,6 +547,7 @@ public:
     PRM(const PRM &prm) : Variable_Queue_Scheduler(prm) {}
 
     using Variable_Queue_Scheduler::queue;
+    using Variable_Queue_Scheduler::pinned;
     static unsigned int current_queue() { return CPU::id(); }
 };
 
@@ -465,6 +559,7 @@ public:
 
 public:
     GEDF(int p = APERIODIC): EDF(p) {}
+    GEDF(CBS * server): EDF(server) {}
     GEDF(const Microsecond & d, const Microsecond & p = SAME, const Microsecond & c = UNKNOWN, unsigned int cpu = ANY)
     : EDF(d, p, c) {}
 
@@ -483,7 +578,10 @@ public:
 
 public:
     PEDF(int p = APERIODIC)
-    : EDF(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : 0) {}
+    : EDF(p), Variable_Queue_Scheduler(((_priority == IDLE) || (_priority == MAIN)) ? CPU::id() : 0, (_priority == IDLE) || (_priority == MAIN)) {}
+
+    PEDF(CBS * server)
+    : EDF(server), Variable_Queue_Scheduler(server->cpu()) {}
 
     PEDF(const PEDF &pedf): EDF(pedf), Variable_Queue_Scheduler(pedf) {}
 
@@ -491,6 +589,7 @@ public:
     : EDF(d, p, c), Variable_Queue_Scheduler((cpu != ANY) ? cpu : ++_next_queue %= CPU::cores()) {}
 
     using Variable_Queue_Scheduler::queue;
+    using Variable_Queue_Scheduler::pinned;
     static unsigned int current_queue() { return CPU::id(); }
 };
 
@@ -1236,6 +1335,7 @@ public:
     CEDF(const CEDF &cedf) : Variable_Queue_Scheduler(cedf) {}
 
     using Variable_Queue_Scheduler::queue;
+    using Variable_Queue_Scheduler::pinned;
 
     static unsigned int current_queue() { return CPU::id() / HEADS; }
     static unsigned int current_head() { return CPU::id() % HEADS; }
@@ -1248,39 +1348,39 @@ __BEGIN_UTIL
 // Scheduling Queues
 template<typename T>
 class Scheduling_Queue<T, GRR>:
-public Multihead_Scheduling_List<T> {};
+public Multihead_Scheduling_List<T, GRR, typename Run_Queue<T, GRR>::Element, GRR::HEADS, typename Run_Queue<T, GRR>::Result> {};
 
 template<typename T>
 class Scheduling_Queue<T, Fixed_CPU>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, Fixed_CPU, typename Run_Queue<T, Fixed_CPU>::Element, typename Run_Queue<T, Fixed_CPU>::List> {};
 
 template<typename T>
 class Scheduling_Queue<T, CPU_Affinity>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, CPU_Affinity, typename Run_Queue<T, CPU_Affinity>::Element, typename Run_Queue<T, CPU_Affinity>::List> {};
 
 template<typename T>
 class Scheduling_Queue<T, PRM>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, PRM, typename Run_Queue<T, PRM>::Element, typename Run_Queue<T, PRM>::List> {};
 
 template<typename T>
 class Scheduling_Queue<T, GEDF>:
-public Multihead_Scheduling_List<T> {};
+public Multihead_Scheduling_List<T, GEDF, typename Run_Queue<T, GEDF>::Element, GEDF::HEADS, typename Run_Queue<T, GEDF>::Result> {};
 
 template<typename T>
 class Scheduling_Queue<T, PEDF>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, PEDF, typename Run_Queue<T, PEDF>::Element, typename Run_Queue<T, PEDF>::List> {};
 
 template<typename T>
 class Scheduling_Queue<T, EA_PEDF_RV64>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, EA_PEDF_RV64, typename Run_Queue<T, EA_PEDF_RV64>::Element, typename Run_Queue<T, EA_PEDF_RV64>::List> {};
 
 template<typename T>
 class Scheduling_Queue<T, EA_PEDF>:
-public Scheduling_Multilist<T> {};
+public Scheduling_Multilist<T, EA_PEDF, typename Run_Queue<T, EA_PEDF>::Element, typename Run_Queue<T, EA_PEDF>::List> {};
 
 template<typename T>
 class Scheduling_Queue<T, CEDF>:
-public Multihead_Scheduling_Multilist<T> {};
+public Multihead_Scheduling_Multilist<T, CEDF, typename Run_Queue<T, CEDF>::Element, CEDF::QUEUES, CEDF::HEADS, typename Run_Queue<T, CEDF>::Result> {};
 
 __END_UTIL
 
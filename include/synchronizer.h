@@ -35,6 +35,27 @@ protected:
     bool tsl(volatile bool & lock) { return CPU::tsl(lock); }
     long finc(volatile long & number) { return CPU::finc(number); }
     long fdec(volatile long & number) { return CPU::fdec(number); }
+    long cas(volatile long & value, long compare, long replacement) { return CPU::cas(value, compare, replacement); }
+    long fas(volatile long & value, long replacement) {
+        long old;
+        do old = value; while(cas(value, old, replacement) != old);
+        return old;
+    }
+
+    // Futex-like fast paths: the counter is only updated without Thread::lock() while there are no waiters
+    // Acquire succeeds (decrementing the counter) while it is positive; release succeeds (incrementing it) while non-negative
+    bool try_acquire(volatile long & counter) {
+        for(long c = counter; c > 0; c = counter)
+            if(cas(counter, c, c - 1) == c)
+                return true;
+        return false;
+    }
+    bool try_release(volatile long & counter) {
+        for(long c = counter; c >= 0; c = counter)
+            if(cas(counter, c, c + 1) == c)
+                return true;
+        return false;
+    }
 
     // Thread operations
     void lock_for_acquiring() { Thread::lock(); /*Thread::prioritize(&_granted);*/ }
@@ -54,6 +75,14 @@ protected:
 
 class Mutex: protected Synchronizer_Common
 {
+private:
+    // Lock states
+    enum {
+        UNLOCKED,
+        LOCKED,   // no waiters, unlock() needs no kernel lock
+        CONTENDED // there might be waiters
+    };
+
 public:
     Mutex();
     ~Mutex();
@@ -62,7 +91,7 @@ public:
     void unlock();
 
 private:
-    alignas (int) volatile bool _locked;
+    volatile long _state;
 };
 
 
@@ -0,0 +1,156 @@
+// EPOS Kernel Page
+
+// Kernel_Page is a page maintained by the kernel and mapped read-only into the address spaces of tasks (KERNEL mode
+// only), so information queried often by applications (time, timer frequencies, and the identity of the running
+// thread and task) can be read without trapping.
+// Each group of fields is guarded by a sequence number that the kernel makes odd while updating it (seqlock), so
+// readers just retry until they get a consistent copy. The running thread and task are kept per CPU and can only
+// be read when the CPU id is available in user mode (e.g. RISC-V's tp register); otherwise, readers return 0 and the
+// caller must fall back to a system call.
+
+#ifndef __kernel_page_h
+#define __kernel_page_h
+
+#include <architecture/cpu.h>
+#include <machine/timer.h>
+
+__BEGIN_SYS
+
+class Kernel_Page
+{
+    friend class System;                        // for init()
+    friend class Thread;                        // for dispatch()
+    friend class Alarm;                         // for tick()
+    friend class Task;                          // for segment()
+
+public:
+    static const bool enabled = Traits<System>::multitask;
+
+private:
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
+    static const bool user_cpu_id = (CPUS == 1) || (Traits<Build>::ARCHITECTURE == Traits<Build>::RV32) || (Traits<Build>::ARCHITECTURE == Traits<Build>::RV64);
+
+    typedef Timer_Common::Tick Tick;
+
+    struct Running {
+        volatile unsigned long seq;
+        Thread * volatile thread;
+        Task * volatile task;
+    };
+
+public:
+    // User side (each returns 0 if the information cannot be obtained without a system call)
+    static Tick elapsed() {
+        const Kernel_Page * p = page();
+        if(!p || !p->_ticked)
+            return 0;
+
+        unsigned long s;
+        Tick t;
+        do {
+            s = read_begin(p->_seq);
+            t = p->_elapsed;
+        } while(!read_end(p->_seq, s));
+
+        return t;
+    }
+
+    static Hertz alarm_frequency() { const Kernel_Page * p = page(); return p ? p->_alarm_frequency : 0; }
+    static Hertz tsc_frequency() { const Kernel_Page * p = page(); return p ? p->_tsc_frequency : 0; }
+
+    static Thread * thread() { Running r; return running(&r) ? r.thread : 0; }
+    static Task * task() { Running r; return running(&r) ? r.task : 0; }
+
+private:
+    Kernel_Page(): _seq(0), _elapsed(0), _ticked(false), _alarm_frequency(0), _tsc_frequency(0) {
+        for(unsigned int i = 0; i < CPUS; i++) {
+            _running[i].seq = 0;
+            _running[i].thread = 0;
+            _running[i].task = 0;
+        }
+    }
+
+    // Kernel side
+    static Segment * segment() { return _segment; }
+
+    static void tick(Tick elapsed) {
+        if(!_page)
+            return;
+        write_begin(_page->_seq);
+        _page->_elapsed = elapsed;
+        write_end(_page->_seq);
+    }
+
+    static void dispatch(Thread * thread, Task * task) {
+        if(!_page)
+            return;
+        Running & r = _page->_running[CPU::id()];
+        write_begin(r.seq);
+        r.thread = thread;
+        r.task = task;
+        write_end(r.seq);
+    }
+
+    // The page is mapped into the task's address space on the first use (defined by the application binding)
+    static const Kernel_Page * page();
+
+    static bool running(Running * r) {
+        if(!user_cpu_id)
+            return false;
+
+        const Kernel_Page * p = page();
+        if(!p)
+            return false;
+
+        // The thread might migrate while reading, so the CPU id is checked again at the end
+        unsigned int cpu;
+        unsigned long s;
+        do {
+            cpu = CPU::id();
+            s = read_begin(p->_running[cpu].seq);
+            r->thread = p->_running[cpu].thread;
+            r->task = p->_running[cpu].task;
+        } while(!read_end(p->_running[cpu].seq, s) || (CPU::id() != cpu));
+
+        return r->thread;
+    }
+
+    static unsigned long read_begin(const volatile unsigned long & seq) {
+        unsigned long s;
+        while((s = seq) & 1);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return s;
+    }
+
+    static bool read_end(const volatile unsigned long & seq, unsigned long s) {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return seq == s;
+    }
+
+    static void write_begin(volatile unsigned long & seq) {
+        seq = seq + 1;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    static void write_end(volatile unsigned long & seq) {
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        seq = seq + 1;
+    }
+
+    static void init();
+
+private:
+    volatile unsigned long _seq;
+    volatile Tick _elapsed;
+    bool _ticked;
+    Hertz _alarm_frequency;
+    Hertz _tsc_frequency;
+    Running _running[CPUS];
+
+    static Kernel_Page * _page;                 // kernel's view in the kernel, task's (read-only) view in applications
+    static Segment * _segment;
+};
+
+__END_SYS
+
+#endif
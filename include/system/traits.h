@@ -276,6 +276,9 @@ enum System_Event {
     // FIX: These should be transducers
     CPU_CLOCK,
     CPU_VOLTAGE,
+
+    THREAD_STEALS,
+    THREAD_MIGRATIONS,
 };
 
 // Monitor events (PMU)
@@ -7,6 +7,7 @@
 #include <machine/timer.h>
 #include <process.h>
 #include <utility/queue.h>
+#include <utility/wheel.h>
 #include <utility/handler.h>
 #include <utility/spin.h>
 
@@ -36,8 +37,11 @@ class Alarm
 
 private:
     static const bool multitask = Traits<System>::multitask;
+    static const bool tickless = Traits<Alarm>::tickless;
+    static const unsigned int BATCH = 16; // handlers delivered per pass in tickless mode
 
-    typedef Relative_Queue<Alarm, Timer_Common::Tick> Queue;
+    typedef Timing_Wheel<Alarm> Wheel;
+    typedef Relative_Queue<Alarm, Wheel::Time> Queue; // shares the element type with Wheel
 
 public:
     typedef Timer_Common::Tick Tick;
@@ -53,12 +57,15 @@ public:
 
     void reset();
 
-    static volatile Tick elapsed() { return _elapsed; }
+    // Tickless mode counts microseconds since boot, so a 32-bit Tick wraps every 2^31 us (about 36 minutes); differences
+    // between readings are still right for shorter intervals (use TSC time stamps to measure longer ones)
+    static volatile Tick elapsed() { return tickless ? now() : _elapsed; }
 
-    static Tick ticks(Microsecond time) { return Timer_Common::ticks(time, _timer->frequency()); }
-    static Microsecond time(Tick ticks) { return Timer_Common::time(ticks, _timer->frequency()); }
+    // Tickless alarms count microseconds instead of timer ticks
+    static Tick ticks(Microsecond time) { return tickless ? Tick(time) : Timer_Common::ticks(time, _timer->frequency()); }
+    static Microsecond time(Tick ticks) { return tickless ? Microsecond(ticks) : Timer_Common::time(ticks, _timer->frequency()); }
 
-    static Hertz frequency() { return _timer->frequency(); }
+    static Hertz frequency() { return tickless ? 1000000 : _timer->frequency(); }
 
     static void delay(Microsecond time);
 
@@ -68,6 +75,16 @@ private:
 
     static void handler(IC::Interrupt_Id i);
 
+    // Tickless time base, in microseconds since boot
+    static Wheel::Time now() {
+        TSC::Time_Stamp ts = TSC::time_stamp();
+        return (ts / TSC::frequency()) * 1000000ULL + (ts % TSC::frequency()) * 1000000ULL / TSC::frequency();
+    }
+    static TSC::Time_Stamp time_stamp(const Wheel::Time & t) {
+        return (t / 1000000ULL) * TSC::frequency() + (t % 1000000ULL) * TSC::frequency() / 1000000ULL;
+    }
+    static void reprogram();
+
     static void init();
 
 private:
@@ -80,6 +97,7 @@ private:
     static Alarm_Timer * _timer;
     static volatile Tick _elapsed;
     static Queue _request;
+    static Wheel * _wheel;
 };
 
 
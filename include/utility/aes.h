@@ -11,112 +11,98 @@
 __BEGIN_UTIL
 
 // EPOS 128-bit Advanced Encryption Standard (AES) Software Implementation
-// Adapted from https://github.com/kokke/tiny-AES128-C
+// The key schedule is cached, so it is only expanded again when a different key is given, and blocks are processed as
+// 32-bit columns through T-tables (SubBytes, ShiftRows and MixColumns combined into 4 lookups per column and round).
+// CPUs featuring AES instructions (Traits<CPU>::aes_instructions) use them instead of the tables (RISC-V Zkne/Zknd only,
+// since AArch64 runs with FP/SIMD disabled).
 template<>
 class SWAES<16>: public AES_Common
 {
 private:
-    static const unsigned int Nb = 4; // number of columns comprising a _state
+    static const unsigned int Nb = 4; // number of columns comprising a state
     static const unsigned int Nk = 4; // number of 32 bit words in a key
-    static const int Nr = 10; // number of rounds in AES cipher
+    static const unsigned int Nr = 10; // number of rounds in AES cipher
 
-    typedef unsigned char State[4][4]; // array holding the intermediate results during decryption
+    typedef unsigned int Word;
+
+    struct Tables;
 
 public:
     static const unsigned int KEY_SIZE = 16;
+    static const unsigned int BLOCK_SIZE = 16;
+
+    enum Engine {
+        TABLES,         // 32-bit T-tables
+        INSTRUCTIONS    // RISC-V scalar crypto (Zkne/Zknd)
+    };
+    static const Engine ENGINE; // the fastest engine available in this CPU
 
 public:
-    SWAES(const Mode & m = ECB): _mode(m) {
+    SWAES(const Mode & m = ECB, const Engine & e = ENGINE): _mode(m), _engine(e), _keyed(false), _decryption_keyed(false) {
         assert((m == ECB) || (m == CBC));
-        for(unsigned int i = 0; i < 23; i++)
-            iv[i] = 0;
+        assert((e == TABLES) || (e == ENGINE));
     }
 
     Mode mode() { return _mode; }
+    Engine engine() { return _engine; }
 
-    void encrypt(const unsigned char * data, const unsigned char * key, unsigned char * result) { crypt(data, key, result, true); }
-    void decrypt(const unsigned char * data, const unsigned char * key, unsigned char * result) { crypt(data, key, result, false); }
-
-private:
-    void mode(const Mode & m) {
-        assert((m == ECB) || (m == CBC));
-        _mode = m;
+    // Single block (CBC with a null initialization vector, as each block is ciphered on its own, is the same as ECB)
+    void encrypt(const unsigned char * data, const unsigned char * key, unsigned char * result) {
+        db<Ciphers>(TRC) << "AES::encrypt(data=" << data << ",key=" << key << ",result=" << result << ")" << endl;
+        this->key(key);
+        encrypt_block(data, result);
+    }
+    void decrypt(const unsigned char * data, const unsigned char * key, unsigned char * result) {
+        db<Ciphers>(TRC) << "AES::decrypt(data=" << data << ",key=" << key << ",result=" << result << ")" << endl;
+        this->key(key);
+        decrypt_block(data, result);
     }
 
-    void crypt(const unsigned char * data, const unsigned char * key, unsigned char * result, bool encrypt) {
-        db<Ciphers>(TRC) << "AES::" << (encrypt ? "en" : "de") << "crypt(data=" << data << ",key=" << key << ",result=" << result << endl;
-        db<Ciphers>(INF) << "AES::" << (encrypt ? "en" : "de") << "crypt:data = {" << int(data[0]);
-        for(unsigned int i = 1; i < 16; i++)
-            db<Ciphers>(INF) << "," << int(data[i]);
-        db<Ciphers>(INF) << "}" << endl;
-        db<Ciphers>(INF) << "AES::" << (encrypt ? "en" : "de") << "crypt:key = {" << int(key[0]);
-        for(unsigned int i = 1; i < 16; i++)
-            db<Ciphers>(INF) << "," << int(key[i]);
-        db<Ciphers>(INF) << "}" << endl;
-
-        switch(_mode) {
-        case CBC:
-            if(encrypt)
-                cbc_encrypt_buffer(result, data, 16, key, iv);
-            else
-                cbc_decrypt_buffer(result, data, 16, key, iv);
-            break;
-        case ECB:
-            if(encrypt)
-                ebc_encrypt(data, key, result);
-            else
-                ebc_decrypt(data, key, result);
-            break;
-        }
-
-        db<Ciphers>(INF) << "AES::" << (encrypt ? "en" : "de") << "crypt:result = {" << int(result[0]);
-        for(unsigned int i = 1; i < 16; i++)
-            db<Ciphers>(INF) << "," << int(result[i]);
-        db<Ciphers>(INF) << "}" << endl;
+    // Multiple blocks, using the last key given (in place operation, with "out" == "in", is supported)
+    void key(const unsigned char * k) {
+        if(!_keyed || memcmp(k, _key, KEY_SIZE))
+            expand_key(k);
     }
+    void cbc_encrypt(const unsigned char * in, unsigned char * out, unsigned int blocks, unsigned char iv[BLOCK_SIZE]); // updates "iv"
+    void cbc_decrypt(const unsigned char * in, unsigned char * out, unsigned int blocks, unsigned char iv[BLOCK_SIZE]); // updates "iv"
+    void ctr(const unsigned char * in, unsigned char * out, unsigned int size, unsigned char counter[BLOCK_SIZE]); // "counter" is a big-endian 128-bit integer, updated to the next unused value
 
-    void cbc_encrypt_buffer(unsigned char * output, const unsigned char * input, int length, const unsigned char * key, unsigned char * iv);
-    void cbc_decrypt_buffer(unsigned char * output, const unsigned char * input, int length, const unsigned char * key, unsigned char * iv);
-    void ebc_encrypt(const unsigned char * input, const unsigned char * key, unsigned char *output);
-    void ebc_decrypt(const unsigned char * input, const unsigned char * key, unsigned char *output);
-
-    void expand_key();
-    void add_round_key(int round);
-    void sub_bytes();
-    void shift_rows();
-    void mix_columns();
-    void inv_mix_columns();
-    void inv_sub_bytes();
-    void inv_shift_rows();
-
-    void cipher();
-    void inv_cipher();
-
-    void block_copy(unsigned char * output, const unsigned char * input) { memcpy(output, input, KEY_SIZE); }
-
-    unsigned char xtime(unsigned char x) { return ((x<<1) ^ (((x>>7) & 1) * 0x1b)); }
-    unsigned char multiply(unsigned char x, unsigned char y) {
-        return (((y & 1) * x) ^
-                ((y >> 1 & 1) * xtime(x)) ^
-                ((y >> 2 & 1) * xtime(xtime(x))) ^
-                ((y >> 3 & 1) * xtime(xtime(xtime(x)))) ^
-                ((y >> 4 & 1) * xtime(xtime(xtime(xtime(x))))));
+private:
+    void expand_key(const unsigned char * k);
+    void expand_decryption_key();
+
+    void encrypt_block(const unsigned char * in, unsigned char * out) {
+        if(_engine == INSTRUCTIONS)
+            encrypt_instructions(in, out);
+        else
+            encrypt_tables(in, out);
+    }
+    void decrypt_block(const unsigned char * in, unsigned char * out) {
+        if(!_decryption_keyed)
+            expand_decryption_key();
+        if(_engine == INSTRUCTIONS)
+            decrypt_instructions(in, out);
+        else
+            decrypt_tables(in, out);
     }
 
-    void xor_with_iv(unsigned char * buf) { for(unsigned int i = 0; i < KEY_SIZE; ++i) buf[i] ^= _iv[i]; }
+    void encrypt_tables(const unsigned char * in, unsigned char * out);
+    void decrypt_tables(const unsigned char * in, unsigned char * out);
+    void encrypt_instructions(const unsigned char * in, unsigned char * out);
+    void decrypt_instructions(const unsigned char * in, unsigned char * out);
 
 private:
     Mode _mode;
-
-    State * _state;
-    unsigned char _round_key[176];
-    const unsigned char * _key;
-    unsigned char * _iv; // initial Vector used only for CBC mode
-    unsigned char iv[23];
+    Engine _engine;
+    bool _keyed;
+    bool _decryption_keyed;
+    unsigned char _key[KEY_SIZE];
+    Word _round_key[Nb * (Nr + 1)] __attribute__((aligned(16)));            // big-endian columns for TABLES, bytes in FIPS-197 order for INSTRUCTIONS
+    Word _decryption_round_key[Nb * (Nr + 1)] __attribute__((aligned(16))); // for the equivalent inverse cipher, in the same format
 
     static const unsigned char sbox[256];
     static const unsigned char rsbox[256];
-    static const unsigned char rcon[255];
+    static const Tables tables;
 };
 
 __END_UTIL
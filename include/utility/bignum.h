@@ -10,6 +10,10 @@ __BEGIN_UTIL
 // This class implements a prime finite field (Fp or GF(p))
 // It basically consists of (possibly) big numbers between 0 and a prime modulo, with + - * / operators
 // Primarily meant to be used primarily by asymmetric cryptography (e.g. Diffie-Hellman)
+// Products are reduced with Barrett's method, which works for any modulus, unless the modulus is a pseudo-Mersenne
+// prime of the form 2^(8 * SIZE) - 2^FOLD - 1, such as SECG's secp128r1 prime (2^128 - 2^97 - 1) used for Bignum<16>.
+// Those are reduced by folding the upper half of products onto the lower one, which takes only shifts and additions,
+// over 64-bit limbs on 64-bit CPUs.
 template<unsigned int SIZE>
 class Bignum
 {
@@ -25,7 +29,21 @@ public:
     typedef Digit Word[DIGITS];
     typedef Double_Digit Double_Word[DIGITS];
 
+    static const unsigned int FOLD = (SIZE == 16) ? 97 : 0; // modulus = 2^(8 * SIZE) - 2^FOLD - 1, _mod is then folding_modulus() (0 for any other modulus)
+
 private:
+#if defined(__armv8__) || defined(__rv64__)
+    typedef unsigned long Limb; // 64x64 -> 128-bit multiplications are native on these CPUs
+    __extension__ typedef unsigned __int128 Double_Limb;
+#else
+    typedef Digit Limb;
+    typedef Double_Digit Double_Limb;
+#endif
+
+    static const unsigned int LIMBS = SIZE / sizeof(Limb);
+    static const unsigned int BITS_PER_LIMB = sizeof(Limb) * 8;
+    static const unsigned int DIGITS_PER_LIMB = sizeof(Limb) / sizeof(Digit);
+
     union _Word {
         unsigned char bytes[sizeof(Word)];
         Digit data[sizeof(Word) / sizeof(Digit)];
@@ -97,12 +115,31 @@ public:
             db<Bignum>(TRC) << _mod.data[DIGITS - 1] << "]) => ";
         }
 
+        if constexpr(FOLD)
+            folding_multiply(b);
+        else
+            barrett_multiply(b);
+
+        if(Traits<Bignum>::hysterically_debugged)
+            db<Bignum>(TRC) << *this << endl;
+    }
+
+    // The two ways of multiplying, also made available for benchmarking and cross-checking (operator*= picks one)
+    void barrett_multiply(const Bignum & b) {
         Digit mult_result[2 * DIGITS];
         simple_mult(mult_result, _data, b._data, DIGITS);
         barrett_reduction(_data, mult_result, DIGITS);
+    }
 
-        if(Traits<Bignum>::hysterically_debugged)
-            db<Bignum>(TRC) << *this << endl;
+    void folding_multiply(const Bignum & b) {
+        static_assert(FOLD && (LIMBS * sizeof(Limb) == SIZE), "Folding requires a pseudo-Mersenne modulus that fills all limbs");
+
+        Limb x[LIMBS], y[LIMBS], mult_result[2 * LIMBS];
+        to_limbs(x, _data);
+        to_limbs(y, b._data);
+        limb_mult(mult_result, x, y);
+        folding_reduction(mult_result);
+        from_limbs(_data, mult_result);
     }
 
     void operator+=(const Bignum &b)__attribute__((noinline)) { // _data = (_data + b._data) % _mod
@@ -397,6 +434,98 @@ private:
             res[i] = r[i];
     }
 
+    static void to_limbs(Limb * res, const Digit * a) {
+        for(unsigned int i = 0; i < LIMBS; i++) {
+            res[i] = 0;
+            for(unsigned int j = 0; j < DIGITS_PER_LIMB; j++)
+                res[i] |= Limb(a[i * DIGITS_PER_LIMB + j]) << (j * BITS_PER_DIGIT);
+        }
+    }
+
+    static void from_limbs(Digit * res, const Limb * a) {
+        for(unsigned int i = 0; i < LIMBS; i++)
+            for(unsigned int j = 0; j < DIGITS_PER_LIMB; j++)
+                res[i * DIGITS_PER_LIMB + j] = a[i] >> (j * BITS_PER_DIGIT);
+    }
+
+    // res = (a * b)
+    // - Does not apply module
+    // - a and b are assumed to have LIMBS limbs
+    // - res is assumed to have 2 * LIMBS limbs
+    static void limb_mult(Limb * res, const Limb * a, const Limb * b) {
+        for(unsigned int i = 0; i < 2 * LIMBS; i++)
+            res[i] = 0;
+        for(unsigned int i = 0; i < LIMBS; i++) {
+            Limb carry = 0;
+            for(unsigned int j = 0; j < LIMBS; j++) {
+                Double_Limb tmp = Double_Limb(a[i]) * b[j] + res[i + j] + carry;
+                res[i + j] = tmp;
+                carry = tmp >> BITS_PER_LIMB;
+            }
+            res[i + LIMBS] = carry;
+        }
+    }
+
+    // a = a % _mod, for _mod = 2^(8 * SIZE) - 2^FOLD - 1
+    // - Intended to be used after a multiplication
+    // - a is assumed to have 2 * LIMBS limbs, the result is left in its lower LIMBS ones
+    // - As 2^(8 * SIZE) = 2^FOLD + 1 (mod _mod), the upper half h of a is folded as a = (a - h * 2^(8 * SIZE)) + h + (h << FOLD),
+    //   in a single pass per round, each round shrinking h by about 8 * SIZE - FOLD bits
+    static void folding_reduction(Limb * a) {
+        static const unsigned int OFFSET = FOLD / BITS_PER_LIMB;
+        static const unsigned int SHIFT = FOLD % BITS_PER_LIMB;
+        static_assert(SHIFT, "FOLD must not be a multiple of the limb size");
+
+        for(;;) {
+            unsigned int n = LIMBS; // non-zero limbs of h
+            for(; n && !a[LIMBS + n - 1]; n--);
+            if(!n)
+                break;
+
+            Limb h[LIMBS];
+            for(unsigned int i = 0; i < n; i++) {
+                h[i] = a[LIMBS + i];
+                a[LIMBS + i] = 0;
+            }
+
+            Double_Limb sum = 0;
+            for(unsigned int i = 0; i < 2 * LIMBS; i++) {
+                if((i > OFFSET + n) && !sum)
+                    break;
+                sum += a[i];
+                if(i < n)
+                    sum += h[i];
+                if((i >= OFFSET) && (i <= OFFSET + n)) {
+                    unsigned int j = i - OFFSET;
+                    if(j < n)
+                        sum += Limb(h[j] << SHIFT);
+                    if(j > 0)
+                        sum += h[j - 1] >> (BITS_PER_LIMB - SHIFT);
+                }
+                a[i] = sum;
+                sum >>= BITS_PER_LIMB;
+            }
+        }
+
+        // a < 2^(8 * SIZE) < 2 * _mod
+        Digit r[DIGITS];
+        from_limbs(r, a);
+        if(cmp(r, _mod.data, DIGITS) >= 0) {
+            simple_sub(r, r, _mod.data, DIGITS);
+            to_limbs(a, r);
+        }
+    }
+
+private:
+    // 2^(8 * SIZE) - 2^FOLD - 1 (all bits set but FOLD's), so moduli reduced by folding are defined by FOLD itself
+    static constexpr _Word folding_modulus() {
+        _Word m{};
+        for(unsigned int i = 0; i < SIZE; i++)
+            m.bytes[i] = 0xff;
+        m.bytes[FOLD / 8] &= ~(1 << (FOLD % 8));
+        return m;
+    }
+
 private:
     Word _data;
 
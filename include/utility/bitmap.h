@@ -34,6 +34,10 @@ public:
         return false;
     }
 
+    bool test(unsigned int index) const {
+        return (index < BITS) && (_map[index / BPI] & (1 << (index & mask)));
+    }
+
     bool full(unsigned int upto) const {
         unsigned int i;
         for(i = 0; i < upto / BPI; i++)
@@ -0,0 +1,267 @@
+// EPOS Buddy List Utility Declarations
+
+// Buddy_List is a drop-in replacement for Grouping_List used to manage physical frames. Free blocks are
+// aligned powers of two kept in one list per order, so alloc and free are O(log n): a request is served by
+// splitting the smallest large enough block and a freed block is merged with its buddy for as long as the
+// buddy is also free. Buddies are found by address and whether they are free blocks of the same order is kept
+// out of band, in one bitmap per order (a bit per aligned block of the machine's RAM), so nothing stored in the
+// frames themselves (which may have been mapped to a task before being freed) is trusted for merging.
+// Large regions (e.g. the memory handed over at initialization) are kept in a Grouping_List ("wilderness")
+// and are only touched at their first frame until needed, when a chunk is carved from their tail and split
+// into aligned blocks. Single frames are further cached per CPU, so page tables and page directories are
+// allocated and released without taking the lock.
+// Elements have the same type of those of Grouping_List and Element(object, size) must be placed at the
+// (logical) address of the region being freed, as MMUs already do with Grouping_List.
+
+#ifndef __buddy_h
+#define __buddy_h
+
+#include <architecture/cpu.h>
+#include <utility/list.h>
+#include <utility/bitmap.h>
+
+__BEGIN_UTIL
+
+template<typename T,
+          unsigned int ORDERS = 20,
+          typename El = List_Elements::Doubly_Linked_Grouping<T> >
+class Buddy_List
+{
+private:
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
+    static const unsigned int CACHE = 16;           // single frames cached per CPU
+    static const unsigned int CARVE = 9;            // minimum order carved from the wilderness
+    static const unsigned long BASE = Traits<Machine>::RAM_BASE / sizeof(T);
+    static const unsigned long FRAMES = (static_cast<unsigned long>(Traits<Machine>::RAM_TOP) - Traits<Machine>::RAM_BASE + 1) / sizeof(T);
+    static const unsigned long BITS = 2 * FRAMES + ORDERS; // FRAMES / 2^k + 1 bits for each order k
+
+public:
+    typedef T Object_Type;
+    typedef El Element;
+
+private:
+    // Free blocks are linked through their first frame, but merging only trusts _free
+    struct Block: public Element {
+        Block(T * o, unsigned int order): Element(o, 1UL << order) {}
+    };
+
+    typedef List<T, Element> Order;
+
+public:
+    Buddy_List(): _delta(0), _size(0), _occupied(0), _locked(false) {
+        for(unsigned int i = 0; i < CPUS; i++)
+            _cached[i] = 0;
+        _offset[0] = 0;
+        for(unsigned int k = 1; k < ORDERS; k++)
+            _offset[k] = _offset[k - 1] + (FRAMES >> (k - 1)) + 1;
+    }
+
+    unsigned long grouped_size() const {
+        unsigned long size = _size + _wilderness.grouped_size();
+        for(unsigned int i = 0; i < CPUS; i++)
+            size += _cached[i];
+        return size;
+    }
+
+    // The largest free block
+    Element * head() {
+        if(_occupied)
+            return _orders[msb(_occupied)].head();
+        return _wilderness.head();
+    }
+
+    void insert_merging(Element * e, Element ** m1, Element ** m2) {
+        db<Lists>(TRC) << "Buddy_List::insert_merging(e=" << e << ",o=" << e->object() << ",s=" << e->size() << ")" << endl;
+
+        *m1 = *m2 = 0;
+
+        T * o = e->object();
+        unsigned long n = e->size();
+        if(!n)
+            return;
+
+        bool disabled = enter();
+
+        if(!_delta) // the offset between the logical and the physical addresses of frames is constant
+            _delta = reinterpret_cast<char *>(e) - reinterpret_cast<char *>(o);
+
+        if((n == 1) && (_cached[CPU::id()] < CACHE))
+            _cache[CPU::id()][_cached[CPU::id()]++] = o;
+        else {
+            lock();
+            if(n < (1UL << CARVE))
+                release(o, n);
+            else
+                _wilderness.insert_merging(e, m1, m2); // touches only the first frame
+            unlock();
+        }
+
+        leave(disabled);
+    }
+
+    // Returns an element whose object() + size() is the beginning of the allocated region (as Grouping_List does)
+    Element * search_decrementing(unsigned long s) {
+        db<Lists>(TRC) << "Buddy_List::search_decrementing(s=" << s << ")" << endl;
+
+        if(!s)
+            return 0;
+
+        bool disabled = enter();
+
+        T * o = 0;
+        if((s == 1) && _cached[CPU::id()])
+            o = _cache[CPU::id()][--_cached[CPU::id()]];
+        else {
+            unsigned int k = order(s);
+            if(k < ORDERS) {
+                lock();
+                Block * b = take(k);
+                if(!b && carve(k))
+                    b = take(k);
+                if(b) {
+                    o = b->object();
+                    release(o + s, (1UL << k) - s); // give the unused tail back
+                }
+                unlock();
+            }
+        }
+
+        Element * e = 0;
+        if(o)
+            e = new (log(o)) Element(o, 0);
+        else { // fall back to the first fit in the wilderness
+            lock();
+            e = _wilderness.search_decrementing(s);
+            unlock();
+        }
+
+        leave(disabled);
+
+        return e;
+    }
+
+private:
+    static unsigned int msb(unsigned long v) { return sizeof(unsigned long) * 8 - 1 - __builtin_clzl(v); }
+    static unsigned int order(unsigned long n) { return (n <= 1) ? 0 : msb(n - 1) + 1; }
+
+    unsigned long index(T * o) const { return reinterpret_cast<unsigned long>(o) / sizeof(T); }
+    Block * log(T * o) const { return reinterpret_cast<Block *>(reinterpret_cast<char *>(o) + _delta); }
+
+    // Frames outside the machine's RAM are never merged
+    bool tracked(T * o) const { return (index(o) >= BASE) && (index(o) - BASE < FRAMES); }
+    unsigned int bit(T * o, unsigned int k) const { return _offset[k] + ((index(o) - BASE) >> k); }
+
+    // Smallest free block of order k or more, split down to order k
+    Block * take(unsigned int k) {
+        unsigned long candidates = _occupied & ~((1UL << k) - 1);
+        if(!candidates)
+            return 0;
+
+        unsigned int j = __builtin_ctzl(candidates);
+        Block * b = static_cast<Block *>(_orders[j].remove_head());
+        unlink(b, j);
+
+        T * o = b->object();
+        while(j > k) {
+            j--;
+            link(new (log(o + (1UL << j))) Block(o + (1UL << j), j), j);
+        }
+
+        return b;
+    }
+
+    // Free an arbitrary region as aligned blocks
+    void release(T * o, unsigned long n) {
+        while(n) {
+            unsigned int k = index(o) ? __builtin_ctzl(index(o)) : ORDERS - 1;
+            if(k >= ORDERS)
+                k = ORDERS - 1;
+            while((1UL << k) > n)
+                k--;
+            merge(o, k);
+            o += 1UL << k;
+            n -= 1UL << k;
+        }
+    }
+
+    // Insert a block of order k, merging it with its buddies
+    void merge(T * o, unsigned int k) {
+        for(; k + 1 < ORDERS; k++) {
+            T * buddy = reinterpret_cast<T *>((index(o) ^ (1UL << k)) * sizeof(T));
+            if(!tracked(buddy) || !_free.test(bit(buddy, k)))
+                break;
+
+            Block * b = log(buddy);
+            _orders[k].remove(b);
+            unlink(b, k);
+            if(buddy < o)
+                o = buddy;
+        }
+
+        link(new (log(o)) Block(o, k), k);
+    }
+
+    void link(Block * b, unsigned int k) {
+        if(tracked(b->object()))
+            _free.set(bit(b->object(), k));
+        _orders[k].insert(b);
+        _occupied |= 1UL << k;
+        _size += 1UL << k;
+    }
+
+    void unlink(Block * b, unsigned int k) {
+        if(tracked(b->object()))
+            _free.reset(bit(b->object(), k));
+        if(_orders[k].empty())
+            _occupied &= ~(1UL << k);
+        _size -= 1UL << k;
+    }
+
+    // Carve a chunk holding at least one aligned block of order k out of the wilderness
+    bool carve(unsigned int k) {
+        unsigned int m = (k > CARVE) ? k : CARVE;
+        if(m + 1 >= ORDERS)
+            return false;
+
+        unsigned long n = (1UL << (m + 1)) - 1;
+        Element * e = _wilderness.search_decrementing(n);
+        if(!e)
+            return false;
+
+        release(e->object() + e->size(), n);
+
+        return true;
+    }
+
+    // Single frames are cached with interrupts disabled; everything else is also under the lock
+    bool enter() {
+        bool disabled = CPU::int_disabled();
+        if(!disabled)
+            CPU::int_disable();
+        return disabled;
+    }
+    void leave(bool disabled) {
+        if(!disabled)
+            CPU::int_enable();
+    }
+
+    // Same as Simple_Spin, which cannot be used here since utility/spin.h includes the MMU
+    void lock() { if(CPUS > 1) while(CPU::tsl(_locked)); }
+    void unlock() { if(CPUS > 1) _locked = 0; }
+
+private:
+    long _delta;
+    unsigned long _size;
+    unsigned long _occupied;
+    Order _orders[ORDERS];
+    Bitmap<BITS> _free;                 // free blocks, order by order (2 bits per frame of RAM, i.e. 1/16384 of it for 4 KB frames)
+    unsigned long _offset[ORDERS];      // of each order's bits in _free
+    Grouping_List<T, El> _wilderness;
+    T * _cache[CPUS][CACHE];
+    unsigned int _cached[CPUS];
+    alignas(int) volatile bool _locked;
+};
+
+__END_UTIL
+
+#endif
@@ -18,15 +18,34 @@ public:
 private:
     typedef _UTIL::Bignum<SECRET_SIZE> Bignum;
 
+    // Scalar multiplications handle WINDOW bits of the scalar at a time, adding points taken from tables of POINTS points
+    static const unsigned int WINDOW = 4;
+    static const unsigned int POINTS = (1 << WINDOW) - 1;
+
     class Elliptic_Curve_Point
     {
     public:
         typedef typename Diffie_Hellman::Bignum Coordinate;
 
+        static const unsigned int BITS = sizeof(Coordinate) * 8;
+        static const unsigned int SPACING = BITS / WINDOW; // between the teeth of a comb
+
         Elliptic_Curve_Point() __attribute__((noinline)) {}
         Elliptic_Curve_Point(const Coordinate & _x, const Coordinate & _y, const Coordinate & _z) { x = _x; y = _y; z = _z; }
 
+        // this = b * this (this must be in affine coordinates, and so is the result)
+        // Fixed window: 1 * this to POINTS * this are computed first, so each WINDOW bits of b take WINDOW doublings
+        // and at most one addition, instead of one addition per bit set in b as in binary_multiply() (double-and-add)
         void operator*=(const Coordinate & b);
+        void binary_multiply(const Coordinate & b);
+
+        // this = b * G, for the fixed base point G whose comb is given (table[j - 1] = sum of 2^(i * SPACING) * G for
+        // each bit i set in j, in affine coordinates): SPACING doublings and at most SPACING additions
+        void comb_multiply(const Coordinate & b, const char table[POINTS][2][SECRET_SIZE]);
+
+        // Conversion to affine coordinates (z = 1), of many points with a single inversion (Montgomery's trick)
+        void normalize() { normalize(this, 1); }
+        static void normalize(Elliptic_Curve_Point * points, unsigned int n);
 
         friend Debug &operator<<(Debug &out, const Elliptic_Curve_Point &a) {
             out << "{x=" << a.x << ",y=" << a.y << ",z=" << a.z << "}";
@@ -41,6 +60,13 @@ private:
         void jacobian_double();
         void add_jacobian_affine(const Elliptic_Curve_Point &b);
 
+        static unsigned int bit(const Coordinate & b, unsigned int i) {
+            return (b[i / Coordinate::BITS_PER_DIGIT] >> (i % Coordinate::BITS_PER_DIGIT)) & 1;
+        }
+        static unsigned int window(const Coordinate & b, unsigned int i) { // i-th group of WINDOW bits
+            return (b[i * WINDOW / Coordinate::BITS_PER_DIGIT] >> (i * WINDOW % Coordinate::BITS_PER_DIGIT)) & POINTS;
+        }
+
     public:
         Coordinate x, y, z;
     };
@@ -49,20 +75,25 @@ public:
     typedef Elliptic_Curve_Point Public_Key;
     typedef Bignum Shared_Key;
     typedef Bignum Private_Key;
+    typedef const char (* Comb)[2][SECRET_SIZE];
 
-    Diffie_Hellman() {
+    Diffie_Hellman(): _comb(_default_base_point_comb) {
         new (&_base_point.x) Bignum(_default_base_point_x, SECRET_SIZE);
         new (&_base_point.y) Bignum(_default_base_point_y, SECRET_SIZE);
         _base_point.z = 1;
         generate_keypair();
     }
 
-    Diffie_Hellman(const Elliptic_Curve_Point & base_point): _base_point(base_point) {
+    Diffie_Hellman(const Elliptic_Curve_Point & base_point): _base_point(base_point), _comb(0) {
         generate_keypair();
     }
 
     Elliptic_Curve_Point public_key() { return _public; }
 
+    // For cross-checking the scalar multiplications (comb is 0 for base points other than the default one)
+    Elliptic_Curve_Point base_point() const { return _base_point; }
+    Comb comb() const { return _comb; }
+
     Shared_Key shared_key(Elliptic_Curve_Point public_key) {
         db<Diffie_Hellman>(TRC) << "Diffie_Hellman::shared_key(pub=" << public_key << ",priv=" << _private << ")" << endl;
 
@@ -82,8 +113,12 @@ private:
         db<Diffie_Hellman>(INF) << "Diffie_Hellman Private: " << _private << endl;
         db<Diffie_Hellman>(INF) << "Diffie_Hellman Base Point: " << _base_point << endl;
 
-        _public = _base_point;
-        _public *= _private;
+        if(_comb)
+            _public.comb_multiply(_private, _comb);
+        else {
+            _public = _base_point;
+            _public *= _private;
+        }
 
         db<Diffie_Hellman>(INF) << "Diffie_Hellman Public: " << _public << endl;
     }
@@ -92,8 +127,10 @@ private:
     Private_Key _private;
     Elliptic_Curve_Point _base_point;
     Elliptic_Curve_Point _public;
+    Comb _comb;
     static const char _default_base_point_x[SECRET_SIZE];
     static const char _default_base_point_y[SECRET_SIZE];
+    static const char _default_base_point_comb[POINTS][2][SECRET_SIZE];
 };
 
 //TODO: base point is dependent of SECRET_SIZE
@@ -115,8 +152,190 @@ const char Diffie_Hellman<Cipher>::_default_base_point_y[SECRET_SIZE] =
  '\x39', '\xC8', '\x5A', '\xCF'
 };
 
+// Comb of the default base point (x and y of each point, as above), precomputed by tools/epossectst/eposcomb.py
+template<typename Cipher>
+const char Diffie_Hellman<Cipher>::_default_base_point_comb[POINTS][2][SECRET_SIZE] =
+{
+ { // 2^0 * G
+  {'\x86', '\x5B', '\x2C', '\xA5', '\x7C', '\x60', '\x28', '\x0C',
+   '\x2D', '\x9B', '\x89', '\x8B', '\x52', '\xF7', '\x1F', '\x16'},
+  {'\x83', '\x7A', '\xED', '\xDD', '\x92', '\xA2', '\x2D', '\xC0',
+   '\x13', '\xEB', '\xAF', '\x5B', '\x39', '\xC8', '\x5A', '\xCF'}},
+ { // 2^32 * G
+  {'\x2C', '\x43', '\x6A', '\x66', '\xFB', '\xFE', '\x21', '\x5C',
+   '\x01', '\xA2', '\xD4', '\x7E', '\x2B', '\xB3', '\xD4', '\x2A'},
+  {'\x6B', '\xCA', '\x0C', '\xCA', '\x1E', '\xBA', '\x90', '\x88',
+   '\x51', '\x0D', '\xE9', '\x6C', '\x5B', '\x13', '\x02', '\xDA'}},
+ { // (2^0 + 2^32) * G
+  {'\x8E', '\xB8', '\x8C', '\x22', '\x9C', '\xB3', '\x78', '\x11',
+   '\xBF', '\x21', '\x16', '\x63', '\x6E', '\xF2', '\x79', '\xFE'},
+  {'\xD7', '\x77', '\x9C', '\xAD', '\x44', '\xCE', '\x99', '\xFA',
+   '\x22', '\xA2', '\x01', '\x7C', '\x66', '\x13', '\x31', '\x78'}},
+ { // 2^64 * G
+  {'\xF0', '\x3E', '\xA6', '\x40', '\x01', '\xF2', '\x10', '\x5B',
+   '\xFC', '\x33', '\x28', '\x91', '\x7E', '\x90', '\xB9', '\x8A'},
+  {'\x65', '\xCF', '\x3D', '\x6F', '\x3B', '\xDF', '\x13', '\x40',
+   '\x72', '\xCE', '\x21', '\x76', '\x33', '\xC2', '\x2F', '\xFA'}},
+ { // (2^0 + 2^64) * G
+  {'\x4F', '\x8E', '\xDF', '\xE6', '\xAE', '\x31', '\x71', '\xDA',
+   '\x4C', '\xEA', '\xC5', '\x1B', '\x09', '\x2C', '\xEF', '\x89'},
+  {'\x7E', '\x0A', '\xF2', '\xC5', '\x8C', '\x59', '\x35', '\x6B',
+   '\x29', '\x2F', '\x59', '\xC3', '\x65', '\x10', '\x64', '\xF6'}},
+ { // (2^32 + 2^64) * G
+  {'\xE4', '\x2F', '\xF6', '\x0F', '\xC8', '\x8F', '\xF0', '\x76',
+   '\x54', '\x78', '\xAB', '\x09', '\x18', '\x69', '\x54', '\xE0'},
+  {'\xE8', '\xCF', '\x2E', '\xAF', '\xD3', '\xD8', '\x85', '\x1E',
+   '\xAB', '\x1B', '\x33', '\xBE', '\xC9', '\xC0', '\x7D', '\x80'}},
+ { // (2^0 + 2^32 + 2^64) * G
+  {'\xA3', '\x5E', '\xA6', '\x31', '\x64', '\xB3', '\x96', '\xAE',
+   '\xDD', '\x9B', '\xB2', '\xDF', '\x5B', '\x2B', '\xDE', '\x25'},
+  {'\x56', '\xCA', '\x1E', '\x5D', '\x96', '\xF8', '\x54', '\xA4',
+   '\xCA', '\xE2', '\x91', '\xB4', '\x64', '\x2C', '\x5C', '\xA2'}},
+ { // 2^96 * G
+  {'\xBB', '\x36', '\x14', '\xEC', '\x6E', '\x7F', '\x79', '\xC4',
+   '\xB2', '\x0A', '\x29', '\xE7', '\x56', '\xB4', '\x8F', '\x40'},
+  {'\x8B', '\xE4', '\x23', '\xFC', '\x1A', '\xBB', '\x74', '\x3D',
+   '\xA4', '\x6D', '\xB3', '\x63', '\x6F', '\x7C', '\x9E', '\x9A'}},
+ { // (2^0 + 2^96) * G
+  {'\x01', '\x54', '\xFA', '\xD5', '\xFC', '\x06', '\xF5', '\x30',
+   '\x5E', '\xA2', '\xA0', '\x2E', '\xFD', '\x79', '\x19', '\xCC'},
+  {'\xDF', '\x61', '\x70', '\xF5', '\xB2', '\xA1', '\xB2', '\xB0',
+   '\xC6', '\x93', '\x23', '\xC6', '\x18', '\x2C', '\xB4', '\xD9'}},
+ { // (2^32 + 2^96) * G
+  {'\xC1', '\xDE', '\x6F', '\x46', '\x96', '\x02', '\x3F', '\xA8',
+   '\x11', '\x44', '\x10', '\x00', '\xD8', '\xE3', '\xB0', '\x0A'},
+  {'\x2C', '\xB3', '\x67', '\xCF', '\x10', '\x13', '\xC6', '\xAA',
+   '\xA0', '\x75', '\x2C', '\x71', '\xA6', '\xEF', '\xCB', '\x59'}},
+ { // (2^0 + 2^32 + 2^96) * G
+  {'\xE6', '\xFA', '\x24', '\x03', '\x0A', '\x8D', '\xEF', '\xF9',
+   '\x30', '\xAB', '\x56', '\xA1', '\x0E', '\x68', '\x27', '\x5A'},
+  {'\x0D', '\x53', '\xBB', '\x65', '\x65', '\x1B', '\xB4', '\x67',
+   '\xFB', '\x68', '\x6D', '\x05', '\x51', '\x5A', '\xC4', '\x58'}},
+ { // (2^64 + 2^96) * G
+  {'\xC6', '\x5A', '\x5A', '\x9E', '\x73', '\x6F', '\x47', '\x5B',
+   '\xD6', '\xC7', '\x7A', '\x9C', '\xD0', '\xDB', '\x1A', '\xFD'},
+  {'\x05', '\x86', '\xB8', '\x9C', '\x7D', '\x94', '\x13', '\x0F',
+   '\xB6', '\xE9', '\x51', '\xB6', '\xB6', '\x1D', '\x94', '\x07'}},
+ { // (2^0 + 2^64 + 2^96) * G
+  {'\x30', '\x6B', '\xF2', '\xB0', '\x09', '\x69', '\xBA', '\x60',
+   '\x8D', '\x70', '\x1D', '\xD0', '\x7A', '\x90', '\x0C', '\x8D'},
+  {'\x1E', '\x3B', '\x4A', '\x99', '\x35', '\x48', '\x68', '\x12',
+   '\xD7', '\xE4', '\x35', '\xEE', '\x8C', '\x89', '\xFB', '\x3E'}},
+ { // (2^32 + 2^64 + 2^96) * G
+  {'\xD0', '\x99', '\x69', '\xB5', '\x43', '\x40', '\x5F', '\x14',
+   '\x0F', '\xD7', '\xC6', '\x5C', '\xFD', '\xD4', '\xE9', '\xB0'},
+  {'\xB2', '\x9D', '\xA3', '\x09', '\xC4', '\x86', '\x89', '\x8A',
+   '\x23', '\x92', '\x45', '\xE3', '\x35', '\xD9', '\x96', '\x50'}},
+ { // (2^0 + 2^32 + 2^64 + 2^96) * G
+  {'\x87', '\x6D', '\xD9', '\x02', '\x90', '\xF9', '\x5E', '\x19',
+   '\xE3', '\x3C', '\x3A', '\x12', '\x96', '\x20', '\xE9', '\xA6'},
+  {'\xFE', '\x09', '\xB2', '\x1E', '\xC6', '\x6A', '\xF9', '\xE6',
+   '\xE9', '\x61', '\x1E', '\x12', '\x6D', '\x3A', '\x0D', '\x5F'}}
+};
+
 template<typename Cipher>
 void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::operator*=(const Coordinate & b)
+{
+    Elliptic_Curve_Point table[POINTS]; // table[i] = (i + 1) * this
+    table[0] = *this;
+    table[1] = *this;
+    table[1].jacobian_double();
+    for(unsigned int i = 2; i < POINTS; i++) {
+        table[i] = table[i - 1];
+        table[i].add_jacobian_affine(*this);
+    }
+    normalize(&table[1], POINTS - 1);
+
+    bool started = false;
+    for(int i = BITS / WINDOW - 1; i >= 0; i--) {
+        if(started)
+            for(unsigned int j = 0; j < WINDOW; j++)
+                jacobian_double();
+        unsigned int w = window(b, i);
+        if(w) {
+            if(started)
+                add_jacobian_affine(table[w - 1]);
+            else {
+                *this = table[w - 1];
+                started = true;
+            }
+        }
+    }
+
+    if(!started) {
+        x = 0;
+        y = 0;
+        z = 0;
+        return;
+    }
+
+    normalize();
+}
+
+template<typename Cipher>
+void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::comb_multiply(const Coordinate & b, const char table[POINTS][2][SECRET_SIZE])
+{
+    bool started = false;
+    for(int i = SPACING - 1; i >= 0; i--) {
+        if(started)
+            jacobian_double();
+        unsigned int teeth = 0;
+        for(unsigned int j = 0; j < WINDOW; j++)
+            teeth |= bit(b, i + j * SPACING) << j;
+        if(teeth) {
+            Elliptic_Curve_Point p(Coordinate(table[teeth - 1][0], SECRET_SIZE), Coordinate(table[teeth - 1][1], SECRET_SIZE), 1);
+            if(started)
+                add_jacobian_affine(p);
+            else {
+                *this = p;
+                started = true;
+            }
+        }
+    }
+
+    if(!started) {
+        x = 0;
+        y = 0;
+        z = 0;
+        return;
+    }
+
+    normalize();
+}
+
+template<typename Cipher>
+void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::normalize(Elliptic_Curve_Point * points, unsigned int n)
+{
+    Coordinate products[POINTS]; // products[i] = z[0] * ... * z[i]
+    assert(n <= POINTS);
+
+    products[0] = points[0].z;
+    for(unsigned int i = 1; i < n; i++) {
+        products[i] = products[i - 1];
+        products[i] *= points[i].z;
+    }
+
+    Coordinate inverse(products[n - 1]); // 1 / (z[0] * ... * z[i])
+    inverse.invert();
+
+    for(int i = n - 1; i >= 0; i--) {
+        Coordinate Z(inverse); // 1 / z[i]
+        if(i > 0) {
+            Z *= products[i - 1];
+            inverse *= points[i].z;
+        }
+
+        Coordinate Z2(Z);
+        Z2 *= Z;
+        points[i].x *= Z2;
+        Z2 *= Z;
+        points[i].y *= Z2;
+        points[i].z = 1;
+    }
+}
+
+template<typename Cipher>
+void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::binary_multiply(const Coordinate & b)
 {
     // Finding last '1' bit of b
     static const unsigned int bits_in_digit = sizeof(typename Coordinate::Digit) * 8;
@@ -161,16 +380,7 @@ void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::operator*=(const Coordinate &
         }
     }
 
-    Coordinate Z;
-    z.invert();
-    Z = z;
-    Z *= z;
-
-    x *= Z;
-    Z *= z;
-
-    y *= Z;
-    z = 1;
+    normalize();
 }
 
 template<typename Cipher>
@@ -178,20 +388,21 @@ void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::jacobian_double()
 {
     Coordinate B, C(x), aux(z);
 
+    // Multiplications by small constants are done with additions
     aux *= z; C -= aux;
     aux += x; C *= aux;
-    C *= 3;
+    aux = C; C += C; C += aux;
 
-    z *= y; z *= 2;
+    z *= y; z += z;
 
     y *= y; B = y;
 
-    y *= x; y *= 4;
+    y *= x; y += y; y += y;
 
-    B *= B; B *= 8;
+    B *= B; B += B; B += B; B += B;
 
     x = C; x *= x;
-    aux = y; aux *= 2;
+    aux = y; aux += aux;
     x -= aux;
 
     y -= x; y *= C;
@@ -221,7 +432,7 @@ void Diffie_Hellman<Cipher>::Elliptic_Curve_Point::add_jacobian_affine(const Ell
     Y = aux;
 
     aux2 = aux; aux *= C;
-    aux2 *= 2; aux2 *= x;
+    aux2 += aux2; aux2 *= x;
     aux += aux2; X -= aux;
 
     aux = Y; Y *= x;
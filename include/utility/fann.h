@@ -1571,6 +1571,212 @@ private: // Internal Online Train Methods
         }
     }
 
+public: // Frozen Networks
+
+    // Q15.16 fixed-point number, so Frozen networks can run on CPUs without an FPU
+    // Conversions from floating point are meant for constants and for freeze()
+    class Fixed
+    {
+    public:
+        static const unsigned int DECIMAL_POINT = 16;
+
+        Fixed() {}
+        constexpr Fixed(int i): _value(i * (1 << DECIMAL_POINT)) {}
+        constexpr Fixed(double d): _value(d * (1 << DECIMAL_POINT)) {}
+
+        explicit operator float() const { return static_cast<float>(_value) / (1 << DECIMAL_POINT); }
+
+        static Fixed raw(int v) { Fixed f; f._value = v; return f; }
+        int raw() const { return _value; }
+
+        friend Fixed operator+(const Fixed & a, const Fixed & b) { return raw(a._value + b._value); }
+        friend Fixed operator-(const Fixed & a, const Fixed & b) { return raw(a._value - b._value); }
+        friend Fixed operator*(const Fixed & a, const Fixed & b) { return raw((static_cast<long long>(a._value) * b._value) >> DECIMAL_POINT); }
+        friend Fixed operator/(const Fixed & a, const Fixed & b) { return raw((static_cast<long long>(a._value) << DECIMAL_POINT) / b._value); }
+        Fixed operator-() const { return raw(-_value); }
+
+        friend bool operator<(const Fixed & a, const Fixed & b) { return a._value < b._value; }
+        friend bool operator>(const Fixed & a, const Fixed & b) { return a._value > b._value; }
+
+    private:
+        int _value;
+    };
+
+    // Frozen network: the inference-only form of a fully connected FANN_NETTYPE_LAYER network whose layer sizes are known
+    // at compile time (INPUTS, followed by the number of neurons of each hidden layer and of the output layer, bias not
+    // included), e.g. Frozen<fann_type, 12, 2, 3, 1> for fann_create_from_config()'s network.
+    // Each layer keeps its weights, already multiplied by the activation steepness, as a contiguous matrix (one row per
+    // neuron, with the bias weight last and padded to LANES columns) and its activations as a contiguous vector, whose
+    // element past the last neuron is the bias (1). Inference is thus a sequence of dense dot products, each followed by
+    // the layer's activation function. Number is either fann_type or Fixed (in which case dot products accumulate in 64 bits).
+    // Dot products can be vectorized with NEON on armv8 and with RVV on rv64 (if Traits<CPU>::vector_instructions), but
+    // neither kernel has ever run: AArch64 runs with FP/SIMD disabled and no SiFive core (nor QEMU's sifive_u) implements V.
+    // Online training still takes place on the struct fann (e.g. with fann_train_data_incremental()), which must be frozen
+    // again for the trained weights to be used.
+    template<typename Number, unsigned int INPUTS, unsigned int ... NEURONS>
+    class Frozen
+    {
+    private:
+        typedef Number fann_type; // used by fann_activation_switch
+
+        static const bool FIXED = EQUAL<Number, Fixed>::Result;
+        static_assert(FIXED || EQUAL<Number, FANN::fann_type>::Result, "Frozen networks take either fann_type or Fixed");
+
+        static const unsigned int LANES = 4;
+
+        template<unsigned int IN, unsigned int ... OUT>
+        class Layer;
+
+        template<unsigned int IN>
+        class Layer<IN> // past the output layer
+        {
+        public:
+            static const unsigned int OUTPUTS = IN;
+
+            bool freeze(const struct fann_layer * layer, const FANN::fann_type * weights) { return true; }
+            const Number * run(const Number * input) { return input; }
+        };
+
+        template<unsigned int IN, unsigned int OUT, unsigned int ... REST>
+        class Layer<IN, OUT, REST ...>
+        {
+        private:
+            static const unsigned int COLUMNS = (IN + LANES) / LANES * LANES;   // inputs and bias, padded
+            static const unsigned int VALUES = (OUT + LANES) / LANES * LANES;   // outputs and bias, padded
+
+        public:
+            static const unsigned int OUTPUTS = Layer<OUT, REST ...>::OUTPUTS;
+
+            bool freeze(const struct fann_layer * layer, const FANN::fann_type * weights) {
+                const struct fann_neuron * neurons = layer->first_neuron;
+                if(static_cast<unsigned int>(layer->last_neuron - neurons) != OUT + 1)
+                    return false;
+
+                _function = neurons[0].activation_function;
+                FANN::fann_type steepness = neurons[0].activation_steepness;
+                _limit = 150 / steepness;
+
+                for(unsigned int j = 0; j < OUT; j++) {
+                    if((neurons[j].last_con - neurons[j].first_con != IN + 1) || (neurons[j].activation_function != _function)
+                        || (neurons[j].activation_steepness != steepness))
+                        return false;
+                    for(unsigned int i = 0; i < COLUMNS; i++)
+                        _weights[j][i] = (i <= IN) ? Number(weights[neurons[j].first_con + i] * steepness) : Number(0);
+                }
+
+                for(unsigned int i = 0; i < VALUES; i++)
+                    _values[i] = (i == OUT) ? 1 : 0;
+
+                return _next.freeze(layer + 1, weights);
+            }
+
+            const Number * run(const Number * input) {
+                for(unsigned int j = 0; j < OUT; j++) {
+                    Number sum = dot<COLUMNS>(_weights[j], input);
+                    if(sum > _limit)
+                        sum = _limit;
+                    else if(sum < -_limit)
+                        sum = -_limit;
+                    fann_activation_switch(_function, sum, _values[j]);
+                }
+
+                return _next.run(_values);
+            }
+
+        private:
+            Number _weights[OUT][COLUMNS] __attribute__((aligned(16)));
+            Number _values[VALUES] __attribute__((aligned(16)));
+            Number _limit;
+            fann_activationfunc_enum _function;
+            Layer<OUT, REST ...> _next;
+        };
+
+    public:
+        static const unsigned int LAYERS = sizeof...(NEURONS);
+        static const unsigned int OUTPUTS = Layer<INPUTS, NEURONS ...>::OUTPUTS;
+
+    public:
+        Frozen() {
+            for(unsigned int i = 0; i < sizeof(_input) / sizeof(Number); i++)
+                _input[i] = (i == INPUTS) ? 1 : 0;
+        }
+
+        // Copies the weights and activation functions of "ann", which must have the same shape, with a single activation
+        // function and steepness per layer (returns false otherwise)
+        bool freeze(const struct fann * ann) {
+            if((ann->network_type != FANN_NETTYPE_LAYER) || (ann->connection_rate < 1) || (ann->num_input != INPUTS)
+                || (ann->num_output != OUTPUTS) || (static_cast<unsigned int>(ann->last_layer - ann->first_layer) != LAYERS + 1))
+                return false;
+
+            return _layers.freeze(ann->first_layer + 1, ann->weights);
+        }
+
+        // Returns the OUTPUTS outputs, which remain valid until the next run()
+        const Number * run(const Number * input) {
+            for(unsigned int i = 0; i < INPUTS; i++)
+                _input[i] = input[i];
+
+            return _layers.run(_input);
+        }
+
+    private:
+        template<unsigned int COLUMNS>
+        static Number dot(const Number * w, const Number * x) {
+            if constexpr(FIXED) {
+                long long sum = 0;
+                for(unsigned int i = 0; i < COLUMNS; i++)
+                    sum += static_cast<long long>(w[i].raw()) * x[i].raw();
+                return Fixed::raw(sum >> Fixed::DECIMAL_POINT);
+            } else {
+#if defined(__armv8__)
+                // Untested: EPOS never sets CPACR_EL1.FPEN (nor saves the SIMD registers of threads), so this would trap
+                static_assert(!Traits<CPU>::vector_instructions, "NEON requires FP/SIMD, which is not enabled on AArch64");
+                if constexpr(Traits<CPU>::vector_instructions) {
+                    typedef float Vector __attribute__((vector_size(LANES * sizeof(float))));
+                    Vector sum = {0, 0, 0, 0};
+                    for(unsigned int i = 0; i < COLUMNS; i += LANES)
+                        sum += *reinterpret_cast<const Vector *>(&w[i]) * *reinterpret_cast<const Vector *>(&x[i]);
+                    return sum[0] + sum[1] + sum[2] + sum[3];
+                }
+#elif defined(__rv64__)
+                // Untested: neither SiFive's cores nor QEMU's sifive_u machine implement the V extension
+                if constexpr(Traits<CPU>::vector_instructions) {
+                    float sum;
+                    unsigned long n = COLUMNS;
+                    ASM(".option push                               \n"
+                        ".option arch, +v                           \n"
+                        "       vsetvli     t0, zero, e32, m1, ta, ma \n"
+                        "       vmv.v.i     v8, 0                   \n"
+                        "1:     vsetvli     t0, %[n], e32, m1, tu, ma \n"
+                        "       vle32.v     v0, (%[w])              \n"
+                        "       vle32.v     v1, (%[x])              \n"
+                        "       vfmacc.vv   v8, v0, v1              \n"
+                        "       sub         %[n], %[n], t0          \n"
+                        "       slli        t0, t0, 2               \n"
+                        "       add         %[w], %[w], t0          \n"
+                        "       add         %[x], %[x], t0          \n"
+                        "       bnez        %[n], 1b                \n"
+                        "       vsetvli     t0, zero, e32, m1, ta, ma \n"
+                        "       vmv.s.x     v9, zero                \n"
+                        "       vfredusum.vs v9, v8, v9             \n"
+                        "       vfmv.f.s    %[sum], v9              \n"
+                        ".option pop                                \n"
+                        : [n]"+r"(n), [w]"+r"(w), [x]"+r"(x), [sum]"=f"(sum) : : "t0", "memory");
+                    return sum;
+                }
+#endif
+                Number sum = 0;
+                for(unsigned int i = 0; i < COLUMNS; i += LANES)
+                    sum += w[i] * x[i] + w[i + 1] * x[i + 1] + w[i + 2] * x[i + 2] + w[i + 3] * x[i + 3];
+                return sum;
+            }
+        }
+
+    private:
+        Number _input[(INPUTS + LANES) / LANES * LANES] __attribute__((aligned(16)));
+        Layer<INPUTS, NEURONS ...> _layers;
+    };
+
 };
 
 __END_UTIL
@@ -36,29 +36,17 @@ public:
         if(!bytes)
             return 0;
 
-        if(!Traits<CPU>::unaligned_memory_access)
-            while((bytes % sizeof(void *)))
-                ++bytes;
-
-        if(typed)
-            bytes += sizeof(void *);  // add room for heap pointer
-        bytes += sizeof(long);        // add room for size
-        if(bytes < sizeof(Element))
-            bytes = sizeof(Element);
+        bytes = footprint(bytes);
 
-        Element * e = search_decrementing(bytes);
-        if(!e) {
+        void * block = grab(bytes);
+        if(!block) {
             out_of_memory(bytes);
             return 0;
         }
 
-        long * addr = reinterpret_cast<long *>(e->object() + e->size());
-
-        if(typed)
-            *addr++ = reinterpret_cast<long>(this);
-        *addr++ = bytes;
+        void * addr = format(block, bytes);
 
-        db<Heaps>(TRC) << ") => " << reinterpret_cast<void *>(addr) << endl;
+        db<Heaps>(TRC) << ") => " << addr << endl;
 
         return addr;
     }
@@ -86,7 +74,39 @@ public:
         heap->free(addr, bytes);
     }
 
-private:
+protected:
+    // Size of the block needed to satisfy a request of "bytes", including the header
+    static unsigned long footprint(unsigned long bytes) {
+        if(!Traits<CPU>::unaligned_memory_access)
+            while((bytes % sizeof(void *)))
+                ++bytes;
+
+        if(typed)
+            bytes += sizeof(void *);  // add room for heap pointer
+        bytes += sizeof(long);        // add room for size
+        if(bytes < sizeof(Element))
+            bytes = sizeof(Element);
+
+        return bytes;
+    }
+
+    // Raw block (without header) taken from the free list
+    void * grab(unsigned long bytes) {
+        Element * e = search_decrementing(bytes);
+        return e ? e->object() + e->size() : 0;
+    }
+
+    // Write the header of a block of "bytes" and return the address handed to the user
+    void * format(void * block, unsigned long bytes) {
+        long * addr = reinterpret_cast<long *>(block);
+
+        if(typed)
+            *addr++ = reinterpret_cast<long>(this);
+        *addr++ = bytes;
+
+        return addr;
+    }
+
     void out_of_memory(unsigned long bytes);
 };
 
@@ -125,7 +145,20 @@ public:
         leave();
     }
 
-private:
+    static void typed_free(void * ptr) {
+        long * addr = reinterpret_cast<long *>(ptr);
+        unsigned long bytes = *--addr;
+        Atomic_Heap * heap = reinterpret_cast<Atomic_Heap *>(*--addr);
+        heap->free(addr, bytes);
+    }
+
+    static void untyped_free(Atomic_Heap * heap, void * ptr) {
+        long * addr = reinterpret_cast<long *>(ptr);
+        unsigned long bytes = *--addr;
+        heap->free(addr, bytes);
+    }
+
+protected:
     void enter() { _lock.acquire(); }
     void leave() { _lock.release(); }
 
@@ -133,7 +166,197 @@ private:
     Simple_Spin _lock;
 };
 
-typedef IF<Traits<System>::multicore, Atomic_Heap, Heap_Base>::Result Heap;
+
+// Slab heap
+// Blocks of up to MAX_CLASS bytes (header included) are rounded up to a power-of-two size class and
+// served from per-CPU magazines (LIFO free lists), touched only by their own CPU with interrupts disabled.
+// Empty magazines are refilled with BATCH blocks carved from a single chunk of the underlying heap, and
+// full ones give BATCH blocks back, so the heap lock is taken once per batch. Larger blocks go straight
+// to the heap. Class blocks keep the regular header, so typed_free() and untyped_free() still work.
+class Slab_Heap: public Atomic_Heap
+{
+private:
+    static const unsigned int CPUS = Traits<Machine>::CPUS;
+
+public:
+    static const unsigned long MIN_CLASS = 16;
+    static const unsigned int CLASSES = 7; // 16 .. 1024 bytes
+    static const unsigned long MAX_CLASS = MIN_CLASS << (CLASSES - 1);
+    static const unsigned int BATCH = 16;
+    static const unsigned int CAPACITY = 2 * BATCH;
+
+    struct Statistics {
+        unsigned long hits;     // served from the magazine
+        unsigned long misses;   // required a refill
+        unsigned long flushes;  // batches given back to the heap
+    };
+
+private:
+    struct Link {
+        Link * next;
+    };
+
+    struct Magazine {
+        Link * head;
+        unsigned int count;
+    };
+
+public:
+    Slab_Heap() { clear(); }
+    Slab_Heap(void * addr, unsigned int bytes): Atomic_Heap(addr, bytes) { clear(); }
+
+    void * alloc(unsigned long bytes) {
+        if(!bytes)
+            return 0;
+
+        unsigned long size = footprint(bytes);
+        if(size > MAX_CLASS)
+            return Atomic_Heap::alloc(bytes);
+
+        unsigned int c = size_class(size);
+
+        bool disabled = CPU::int_disabled();
+        if(!disabled)
+            CPU::int_disable();
+
+        Magazine * m = &_magazines[CPU::id()][c];
+        if(m->head)
+            _statistics[CPU::id()][c].hits++;
+        else {
+            _statistics[CPU::id()][c].misses++;
+            refill(m, c);
+        }
+
+        Link * l = m->head;
+        if(l) {
+            m->head = l->next;
+            m->count--;
+        }
+
+        if(!disabled)
+            CPU::int_enable();
+
+        db<Heaps>(TRC) << "Slab_Heap::alloc(this=" << this << ",bytes=" << bytes << ",c=" << c << ") => " << reinterpret_cast<void *>(l) << endl;
+
+        return l ? format(l, class_size(c)) : 0;
+    }
+
+    void free(void * ptr, unsigned long bytes) {
+        if(!ptr || (bytes > MAX_CLASS) || (bytes != class_size(size_class(bytes)))) {
+            Atomic_Heap::free(ptr, bytes);
+            return;
+        }
+
+        unsigned int c = size_class(bytes);
+
+        bool disabled = CPU::int_disabled();
+        if(!disabled)
+            CPU::int_disable();
+
+        Magazine * m = &_magazines[CPU::id()][c];
+        Link * l = reinterpret_cast<Link *>(ptr);
+        l->next = m->head;
+        m->head = l;
+        if(++m->count > CAPACITY) {
+            _statistics[CPU::id()][c].flushes++;
+            flush(m, c);
+        }
+
+        if(!disabled)
+            CPU::int_enable();
+    }
+
+    static void typed_free(void * ptr) {
+        long * addr = reinterpret_cast<long *>(ptr);
+        unsigned long bytes = *--addr;
+        Slab_Heap * heap = reinterpret_cast<Slab_Heap *>(*--addr);
+        heap->free(addr, bytes);
+    }
+
+    static void untyped_free(Slab_Heap * heap, void * ptr) {
+        long * addr = reinterpret_cast<long *>(ptr);
+        unsigned long bytes = *--addr;
+        heap->free(addr, bytes);
+    }
+
+    static unsigned long class_size(unsigned int c) { return MIN_CLASS << c; }
+
+    // Per-class statistics, summed over all CPUs and slab heaps
+    static Statistics statistics(unsigned int c) {
+        Statistics s = { 0, 0, 0 };
+        for(unsigned int i = 0; i < CPUS; i++) {
+            s.hits += _statistics[i][c].hits;
+            s.misses += _statistics[i][c].misses;
+            s.flushes += _statistics[i][c].flushes;
+        }
+        return s;
+    }
+
+    static void reset_statistics() {
+        for(unsigned int i = 0; i < CPUS; i++)
+            for(unsigned int c = 0; c < CLASSES; c++)
+                _statistics[i][c].hits = _statistics[i][c].misses = _statistics[i][c].flushes = 0;
+    }
+
+private:
+    static unsigned int size_class(unsigned long bytes) {
+        unsigned int c = 0;
+        while(class_size(c) < bytes)
+            c++;
+        return c;
+    }
+
+    void clear() {
+        for(unsigned int i = 0; i < CPUS; i++)
+            for(unsigned int c = 0; c < CLASSES; c++) {
+                _magazines[i][c].head = 0;
+                _magazines[i][c].count = 0;
+            }
+    }
+
+    void refill(Magazine * m, unsigned int c) {
+        unsigned long size = class_size(c);
+
+        enter();
+        unsigned int n = BATCH;
+        char * chunk = reinterpret_cast<char *>(grab(n * size));
+        if(!chunk) { // fragmented or nearly exhausted heap, so try a single block
+            n = 1;
+            chunk = reinterpret_cast<char *>(grab(size));
+        }
+        leave();
+
+        if(!chunk) {
+            out_of_memory(size);
+            return;
+        }
+
+        for(unsigned int i = 0; i < n; i++) {
+            Link * l = reinterpret_cast<Link *>(chunk + i * size);
+            l->next = m->head;
+            m->head = l;
+        }
+        m->count += n;
+    }
+
+    void flush(Magazine * m, unsigned int c) {
+        enter();
+        for(unsigned int i = 0; i < BATCH; i++) {
+            Link * l = m->head;
+            m->head = l->next;
+            Heap_Base::free(l, class_size(c));
+        }
+        leave();
+        m->count -= BATCH;
+    }
+
+private:
+    Magazine _magazines[CPUS][CLASSES];
+
+    static Statistics _statistics[CPUS][CLASSES];
+};
+
+typedef IF<Traits<Heaps>::slab, Slab_Heap, IF<Traits<System>::multicore, Atomic_Heap, Heap_Base>::Result>::Result Heap;
 typedef Heap Application_Heap;
 
 __END_UTIL
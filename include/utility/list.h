@@ -239,7 +239,7 @@ namespace List_Elements
         typedef Doubly_Linked_Scheduling Element;
 
     public:
-        Doubly_Linked_Scheduling(const T * o,  const R & r = 0): _object(o), _rank(r), _prev(0), _next(0) {}
+        Doubly_Linked_Scheduling(const T * o,  const R & r = 0): _object(o), _rank(r), _prev(0), _next(0), _child(0), _order(0) {}
 
         T * object() const { return const_cast<T *>(_object); }
 
@@ -253,11 +253,19 @@ namespace List_Elements
         int promote(const R & n = 1) { _rank -= n; return _rank; }
         int demote(const R & n = 1) { _rank += n; return _rank; }
 
+        // Only used by heap-based scheduling queues (see Pairing_Heap)
+        Element * child() const { return _child; }
+        void child(Element * e) { _child = e; }
+        unsigned int order() const { return _order; }
+        void order(unsigned int o) { _order = o; }
+
     private:
         const T * _object;
         R _rank;
         Element * _prev;
         Element * _next;
+        Element * _child;
+        unsigned int _order;
     };
 
 
@@ -356,6 +364,53 @@ namespace List_Iterators
     private:
         Element * _current;
     };
+
+    // Pre-order iterator for trees in which next() is the next sibling, child() the first child and prev()
+    // either the previous sibling or, for first children, the parent (as in Pairing_Heap)
+    template<typename El>
+    class Preorder
+    {
+    private:
+        typedef Preorder<El> Iterator;
+
+    public:
+        typedef El Element;
+
+    public:
+        Preorder(): _current(0) {}
+        Preorder(Element * e): _current(e) {}
+
+        operator Element *() const { return _current; }
+
+        Element & operator*() const { return *_current; }
+        Element * operator->() const { return _current; }
+
+        Iterator & operator++() {
+            if(_current->child())
+                _current = _current->child();
+            else {
+                while(_current && !_current->next())
+                    _current = parent(_current);
+                if(_current)
+                    _current = _current->next();
+            }
+            return *this;
+        }
+        Iterator operator++(int) { Iterator tmp = *this; ++*this; return tmp; }
+
+        bool operator==(const Iterator & i) const { return _current == i._current; }
+        bool operator!=(const Iterator & i) const { return _current != i._current; }
+
+    private:
+        static Element * parent(Element * e) {
+            Element * p = e->prev();
+            for(; p && (p->child() != e); e = p, p = p->prev());
+            return p;
+        }
+
+    private:
+        Element * _current;
+    };
 }
 
 // Singly-Linked List
@@ -1032,23 +1087,296 @@ template<typename T = void,
 class Typed_List: public List<T, El> {};
 
 
+// Doubly-Linked, Priority Bitmap List
+// Same ordering as Ordered_List (ascending ranks, FIFO among equal ranks), but ranks are mapped onto a
+// bitmap of BUCKETS FIFOs, so insertions don't walk the list. Buckets are log-linear (exact for ranks
+// in [-4, 3], then four buckets per power of two) and are kept sorted internally, so ranks need not be
+// small. Since the bucket of an element is computed from its rank, ranks must not change while
+// elements are in the list (i.e. for static scheduling criteria).
+template<typename T,
+          typename R = List_Element_Rank,
+          typename El = List_Elements::Doubly_Linked_Ordered<T, R> >
+class Priority_Bitmap_List: public List<T, El>
+{
+private:
+    typedef List<T, El> Base;
+
+    static const unsigned int BUCKETS = 256;
+    static const unsigned int WORDS = BUCKETS / 32;
+
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+    typedef typename Base::Iterator Iterator;
+
+public:
+    Priority_Bitmap_List(): _summary(0) {
+        for(unsigned int i = 0; i < WORDS; i++)
+            _bitmap[i] = 0;
+        for(unsigned int i = 0; i < BUCKETS; i++)
+            _last[i] = 0;
+    }
+
+    using Base::empty;
+    using Base::size;
+    using Base::head;
+    using Base::tail;
+    using Base::begin;
+    using Base::end;
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Priority_Bitmap_List::insert(e=" << e << ",r=" << int(e->rank()) << ")" << endl;
+
+        int r = e->rank();
+        unsigned int b = bucket(r);
+
+        // The new element goes after the last one whose rank is not larger, within its bucket or in a previous one
+        Element * prev;
+        if(_last[b]) {
+            for(prev = _last[b]; prev && (int(prev->rank()) > r) && (bucket(prev->rank()) == b); prev = prev->prev());
+        } else {
+            int p = previous(b);
+            prev = (p >= 0) ? _last[p] : 0;
+        }
+
+        if(!prev)
+            Base::insert_head(e);
+        else if(prev == tail())
+            Base::insert_tail(e);
+        else
+            Base::insert(e, prev, prev->next());
+
+        if(!_last[b] || (prev == _last[b])) {
+            _last[b] = e;
+            mark(b);
+        }
+    }
+
+    Element * remove() { return remove_head(); }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Priority_Bitmap_List::remove(e=" << e << ",r=" << int(e->rank()) << ")" << endl;
+
+        unsigned int b = bucket(e->rank());
+        if(e == _last[b]) {
+            Element * p = e->prev();
+            if(p && (bucket(p->rank()) == b))
+                _last[b] = p;
+            else {
+                _last[b] = 0;
+                unmark(b);
+            }
+        }
+
+        return Base::remove(e);
+    }
+
+    Element * remove_head() { return empty() ? 0 : remove(head()); }
+
+private:
+    static unsigned int bucket(int r) { return (r >= 0) ? BUCKETS / 2 + log_linear(r) : BUCKETS / 2 - 1 - log_linear(-(r + 1)); }
+
+    static unsigned int log_linear(unsigned int u) {
+        if(u < 4)
+            return u;
+        unsigned int m = 31 - __builtin_clz(u);
+        return (m - 1) * 4 + ((u >> (m - 2)) & 3);
+    }
+
+    void mark(unsigned int b) { _bitmap[b / 32] |= 1U << (b % 32); _summary |= 1U << (b / 32); }
+    void unmark(unsigned int b) {
+        _bitmap[b / 32] &= ~(1U << (b % 32));
+        if(!_bitmap[b / 32])
+            _summary &= ~(1U << (b / 32));
+    }
+
+    // Highest non-empty bucket below b (or -1)
+    int previous(unsigned int b) const {
+        unsigned int w = b / 32;
+        unsigned int bits = _bitmap[w] & ((1U << (b % 32)) - 1);
+        if(!bits) {
+            unsigned int words = _summary & ((1U << w) - 1);
+            if(!words)
+                return -1;
+            w = 31 - __builtin_clz(words);
+            bits = _bitmap[w];
+        }
+        return w * 32 + 31 - __builtin_clz(bits);
+    }
+
+private:
+    unsigned int _summary;
+    unsigned int _bitmap[WORDS];
+    Element * _last[BUCKETS];
+};
+
+
+// Pairing Heap
+// A min-heap of elements ordered by rank, with ties broken by insertion order (so elements of equal rank
+// are served FIFO, as in Ordered_List). Insertion is O(1) and removals are O(log n) amortized.
+// Besides prev() and next(), elements must have child() and order(): next() points to the next sibling,
+// child() to the first child and prev() to the previous sibling or, for first children, to the parent.
+// Ranks must not change while elements are in the heap.
+template<typename T,
+          typename R = List_Element_Rank,
+          typename El = List_Elements::Doubly_Linked_Scheduling<T, R> >
+class Pairing_Heap
+{
+public:
+    typedef T Object_Type;
+    typedef R Rank_Type;
+    typedef El Element;
+    typedef List_Iterators::Preorder<El> Iterator;
+
+public:
+    Pairing_Heap(): _size(0), _order(0), _root(0) {}
+
+    bool empty() const { return (_size == 0); }
+    unsigned long size() const { return _size; }
+
+    Element * head() { return _root; }
+    Element * tail() { // O(n), for completeness only
+        Element * t = _root;
+        for(Iterator i = begin(); i != end(); ++i)
+            if(before(t, i))
+                t = i;
+        return t;
+    }
+
+    Iterator begin() { return Iterator(_root); }
+    Iterator end() { return Iterator(0); }
+
+    void insert(Element * e) {
+        db<Lists>(TRC) << "Pairing_Heap::insert(e=" << e << ",r=" << int(e->rank()) << ")" << endl;
+
+        e->prev(0);
+        e->next(0);
+        e->child(0);
+        e->order(_order++);
+        _root = _root ? meld(_root, e) : e;
+        _size++;
+    }
+
+    Element * remove() { return remove_head(); }
+
+    Element * remove(Element * e) {
+        db<Lists>(TRC) << "Pairing_Heap::remove(e=" << e << ",r=" << int(e->rank()) << ")" << endl;
+
+        if(e == _root)
+            _root = combine(e->child());
+        else {
+            // Detach the subtree rooted at e and meld its children back into the heap
+            if(e->prev()->child() == e)
+                e->prev()->child(e->next());
+            else
+                e->prev()->next(e->next());
+            if(e->next())
+                e->next()->prev(e->prev());
+
+            Element * sub = combine(e->child());
+            if(sub)
+                _root = meld(_root, sub);
+        }
+        _size--;
+
+        e->prev(0);
+        e->next(0);
+        e->child(0);
+
+        return e;
+    }
+
+    Element * remove_head() { return empty() ? 0 : remove(_root); }
+
+private:
+    static bool before(Element * a, Element * b) {
+        int ra = a->rank();
+        int rb = b->rank();
+        return (ra < rb) || ((ra == rb) && (int(a->order() - b->order()) < 0));
+    }
+
+    // Link two roots, the loser becoming the first child of the winner
+    static Element * meld(Element * a, Element * b) {
+        if(before(b, a)) {
+            Element * tmp = a;
+            a = b;
+            b = tmp;
+        }
+
+        b->prev(a);
+        b->next(a->child());
+        if(a->child())
+            a->child()->prev(b);
+        a->child(b);
+
+        return a;
+    }
+
+    // Two-pass pairing of a list of siblings into a single tree
+    static Element * combine(Element * first) {
+        if(!first)
+            return 0;
+
+        // Left to right, meld pairs, stacking the results through next()
+        Element * stack = 0;
+        while(first) {
+            Element * a = first;
+            Element * b = a->next();
+            first = b ? b->next() : 0;
+
+            a->prev(0);
+            a->next(0);
+            if(b) {
+                b->prev(0);
+                b->next(0);
+                a = meld(a, b);
+            }
+            a->next(stack);
+            stack = a;
+        }
+
+        // Right to left, meld each pair into the result
+        Element * root = stack;
+        stack = stack->next();
+        root->next(0);
+        while(stack) {
+            Element * a = stack;
+            stack = a->next();
+            a->next(0);
+            root = meld(root, a);
+        }
+
+        return root;
+    }
+
+private:
+    unsigned long _size;
+    unsigned int _order;
+    Element * _root;
+};
+
+
 // Doubly-Linked, Scheduling List
 // Objects subject to scheduling must export a type "Criterion" compatible
 // with those available at scheduler.h .
 // In this implementation, the chosen element is kept outside the list
 // referenced by the _chosen attribute.
+// The remaining elements are kept in B, which can be any container with the
+// interface of Ordered_List (e.g. Priority_Bitmap_List or Pairing_Heap).
 template<typename T,
           typename R = typename T::Criterion,
-          typename El = List_Elements::Doubly_Linked_Scheduling<T, R> >
-class Scheduling_List: private Ordered_List<T, R, El>
+          typename El = List_Elements::Doubly_Linked_Scheduling<T, R>,
+          typename B = Ordered_List<T, R, El> >
+class Scheduling_List: private B
 {
-    template<typename FT, typename FR, typename FEl, unsigned int FH>
+    template<typename FT, typename FR, typename FEl, unsigned int FH, typename FB>
     friend class Multihead_Scheduling_List;     // for chosen() and remove()
     template<typename FT, typename FR, typename FEl, typename FL, unsigned int FQ>
     friend class Scheduling_Multilist;          // for chosen() and remove()
 
 private:
-    typedef Ordered_List<T, R, El> Base;
+    typedef B Base;
 
 public:
     typedef T Object_Type;
@@ -1151,14 +1479,15 @@ private:
 template<typename T,
           typename R = typename T::Criterion,
           typename El = List_Elements::Doubly_Linked_Scheduling<T, R>,
-          unsigned int H = R::HEADS>
-class Multihead_Scheduling_List: private Ordered_List<T, R, El>
+          unsigned int H = R::HEADS,
+          typename B = Ordered_List<T, R, El> >
+class Multihead_Scheduling_List: private B
 {
     template<typename FT, typename FR, typename FEl, typename FL, unsigned int FQ>
     friend class Scheduling_Multilist;          // for chosen() and remove()
 
 private:
-    typedef Ordered_List<T, R, El> Base;
+    typedef B Base;
 
 public:
     typedef T Object_Type;
@@ -1356,8 +1685,9 @@ template<typename T,
           typename R = typename T::Criterion,
           typename El = List_Elements::Doubly_Linked_Scheduling<T, R>,
           unsigned int Q = R::QUEUES,
-          unsigned int H = R::HEADS>
-class Multihead_Scheduling_Multilist: public Scheduling_Multilist<T, R, El, Multihead_Scheduling_List<T, R, El, H>, Q> {};
+          unsigned int H = R::HEADS,
+          typename B = Ordered_List<T, R, El> >
+class Multihead_Scheduling_Multilist: public Scheduling_Multilist<T, R, El, Multihead_Scheduling_List<T, R, El, H, B>, Q> {};
 
 // Doubly-Linked, Grouping List
 template<typename T,
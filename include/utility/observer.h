@@ -186,7 +186,7 @@ class Data_Observed
 {
     friend class Data_Observer<D, C>;
 
-private:
+protected:
     typedef Data_Observer<D, C> _Observer;
     typedef typename Simple_Ordered_List<Data_Observer<D, C>, C>::Element Element;
 
@@ -247,10 +247,95 @@ public:
 
     virtual unsigned int observers() const { return _observers.size(); }
 
+protected:
+    static Element * link(_Observer * o) { return &o->_link; }
+
 private:
     Simple_Ordered_List<Data_Observer<D, C>, C> _observers;
 };
 
+// (Conditional) Observer x (Conditionally) Observed with Data, indexed by a hash of the condition
+// Meant for demultiplexers with many observers (e.g. ports), since notify() only scans the observers whose conditions
+// fall in the same bucket as the notified one. Observers sharing a condition are chained and all notified.
+template<typename D, typename C, unsigned int BUCKETS>
+class Hashed_Data_Observed: public Data_Observed<D, C>
+{
+private:
+    typedef Data_Observed<D, C> Base;
+    typedef typename Base::_Observer _Observer;
+    typedef typename Base::Element Element;
+
+public:
+    Hashed_Data_Observed() {
+        db<Observers>(TRC) << "Hashed_Data_Observed() => " << this << endl;
+    }
+
+    virtual ~Hashed_Data_Observed() {
+        db<Observers>(TRC) << "~Hashed_Data_Observed(this=" << this << ")" << endl;
+    }
+
+    virtual void attach(Data_Observer<D, C> * o, const C & c) {
+        db<Observers>(TRC) << "Hashed_Data_Observed::attach(obs=" << o << ",cond=" << c << ")" << endl;
+
+        Element * e = Base::link(o);
+        *e = Element(o, c);
+        _table[bucket(c)].insert(e);
+    }
+
+    virtual void detach(Data_Observer<D, C> * o, const C & c) {
+        db<Observers>(TRC) << "Hashed_Data_Observed::detach(obs=" << o << ",cond=" << c << ")" << endl;
+
+        _table[bucket(c)].remove(Base::link(o));
+    }
+
+    virtual bool notify(const C & c, D * d) {
+        bool notified = false;
+
+        db<Observers>(TRC) << "Hashed_Data_Observed::notify(this=" << this << ",cond=" << c << ")" << endl;
+
+        // Observers may reattach themselves under another condition while being updated (e.g. TCP listeners)
+        for(Element * e = _table[bucket(c)].head(), * next; e; e = next) {
+            next = e->next();
+            if(e->rank() == c) {
+                db<Observers>(INF) << "Hashed_Data_Observed::notify(this=" << this << ",obs=" << e->object() << ")" << endl;
+                e->object()->update(this, c, d);
+                notified = true;
+            }
+        }
+
+        return notified;
+    }
+
+    virtual _Observer * observer(const C & c, unsigned int index = 0) {
+        for(Element * e = _table[bucket(c)].head(); e; e = e->next()) {
+            if(e->rank() == c) {
+                if(!index)
+                    return e->object();
+                else
+                    index--;
+            }
+        }
+        return 0;
+    }
+
+    virtual unsigned int observers() const {
+        unsigned int n = 0;
+        for(unsigned int i = 0; i < BUCKETS; i++)
+            n += _table[i].size();
+        return n;
+    }
+
+private:
+    // Folds wide conditions (e.g. TCP connection ids), so all their bits take part in the hash
+    static unsigned int bucket(const C & c) {
+        unsigned long long k = c;
+        return (static_cast<unsigned int>(k) ^ static_cast<unsigned int>(k >> 32)) % BUCKETS;
+    }
+
+private:
+    Simple_Ordered_List<Data_Observer<D, C>, C> _table[BUCKETS];
+};
+
 template<typename D, typename C>
 class Data_Observer
 {
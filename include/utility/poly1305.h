@@ -33,8 +33,7 @@ public:
         }
 
         unsigned char ciphertext[16];
-        Cipher cipher;
-        cipher.encrypt(nonce, reinterpret_cast<const unsigned char *>(_k._data), ciphertext);
+        _cipher.encrypt(nonce, reinterpret_cast<const unsigned char *>(_k._data), ciphertext);
 
         // out = (cr + aes(k,n)) % 2^128
         Bignum::simple_add(reinterpret_cast<Bignum::Digit *>(out), reinterpret_cast<const Bignum::Digit *>(ciphertext), cr._data, 4);
@@ -66,6 +65,7 @@ private:
 
     Bignum _k;
     Bignum _r;
+    Cipher _cipher; // kept, so its key schedule for "k" is reused by every stamp()
 };
 
 __END_UTIL
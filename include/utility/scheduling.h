@@ -11,9 +11,21 @@ __BEGIN_UTIL
 // the semantics of returning the desired order of a given object within the
 // scheduling list
 
+// Run_Queue
+// Selects the container of the ready elements not chosen: a sorted list or, if Traits<Scheduler<T>>::indexed_queues,
+// a priority bitmap for static criteria and a pairing heap for dynamic ones (whose ranks change from job to job)
+template<typename T, typename R = typename T::Criterion>
+struct Run_Queue
+{
+    typedef List_Elements::Doubly_Linked_Scheduling<T, R> Element;
+    typedef typename IF<!Traits<Scheduler<T>>::indexed_queues, Ordered_List<T, R, Element>,
+                        typename IF<R::dynamic, Pairing_Heap<T, R, Element>, Priority_Bitmap_List<T, R, Element>>::Result>::Result Result;
+    typedef Scheduling_List<T, R, Element, Result> List;
+};
+
 // Scheduling_Queue
 template<typename T, typename R = typename T::Criterion>
-class Scheduling_Queue: public Scheduling_List<T> {};
+class Scheduling_Queue: public Run_Queue<T, R>::List {};
 
 
 // Scheduler
@@ -29,8 +41,9 @@ private:
 
 public:
     typedef typename T::Criterion Criterion;
-    typedef Scheduling_List<T, Criterion> Queue;
+    typedef typename Run_Queue<T>::List Queue;
     typedef typename Queue::Element Element;
+    typedef typename Base::Iterator Iterator;
 
 public:
     Scheduler() {}
@@ -103,6 +116,41 @@ public:
 
         return obj;
     }
+
+    // Work stealing (only meaningful for criteria with multiple queues)
+    unsigned int busiest() {
+        unsigned int queue = Criterion::current_queue();
+        if constexpr(Criterion::QUEUES > 1) {
+            unsigned long longest = 0;
+            for(unsigned int q = 0; q < Criterion::QUEUES; q++)
+                if(Base::size(q) > longest) {
+                    longest = Base::size(q);
+                    queue = q;
+                }
+        }
+
+        return queue;
+    }
+
+    T * steal(unsigned int from, unsigned int to, bool (* eligible)(T *)) {
+        db<Scheduler>(TRC) << "Scheduler[chosen=" << chosen() << "]::steal(from=" << from << ",to=" << to << ") => ";
+
+        T * obj = 0;
+        if constexpr(Criterion::QUEUES > 1) {
+            for(Iterator i = Base::begin(from); i != Base::end(); ++i)
+                if(eligible(i->object())) {
+                    obj = i->object();
+                    Base::remove(obj->link());
+                    obj->criterion().queue(to);
+                    Base::insert(obj->link());
+                    break;
+                }
+        }
+
+        db<Scheduler>(TRC) << obj << endl;
+
+        return obj;
+    }
 };
 
 __END_UTIL
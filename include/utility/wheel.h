@@ -0,0 +1,151 @@
+// EPOS Timing Wheel Utility Declarations
+
+// Timing_Wheel is a hierarchical timing wheel (Varghese & Lauck) that keeps
+// elements ranked by an absolute expiration time. Each level has 2^BITS slots
+// and covers BITS more bits of time than the level below it. An element is kept
+// at the level of the most significant bit group in which its expiration time
+// differs from the wheel's current time, so insert() and remove() are O(1):
+// the slot is always recomputed from "rank" and "now". Advancing the wheel
+// moves due elements to an expired list and cascades higher-level slots down
+// as their time comes. Elements due at the same instant are collected together.
+// Example (BITS=2): now=5 (00 01 01), insert(A,6) -> level 0, slot 2
+//                                     insert(B,9) -> level 1, slot 2
+//                                     insert(C,37) -> level 2, slot 2
+
+#ifndef __wheel_h
+#define __wheel_h
+
+#include <utility/list.h>
+
+__BEGIN_UTIL
+
+template<typename T,
+          unsigned int BITS = 6,
+          typename El = List_Elements::Doubly_Linked_Ordered<T, long long> >
+class Timing_Wheel
+{
+public:
+    typedef T Object_Type;
+    typedef El Element;
+    typedef long long Time;
+
+    static const unsigned int SLOTS = 1 << BITS;
+    static const unsigned int LEVELS = (sizeof(Time) * 8 + BITS - 1) / BITS;
+    static const Time NEVER = ~(1ULL << (sizeof(Time) * 8 - 1));
+
+private:
+    typedef List<T, El> Slot;
+    typedef unsigned long long Bitmap;
+
+public:
+    Timing_Wheel(const Time & now = 0): _now(now), _size(0) {
+        for(unsigned int i = 0; i < LEVELS; i++)
+            _occupied[i] = 0;
+    }
+
+    bool empty() const { return (_size == 0); }
+    unsigned long size() const { return _size; }
+
+    const Time & now() const { return _now; }
+
+    // Elements already due get the next instant, so expirations never go back in time
+    void insert(Element * e) {
+        if(e->rank() <= _now)
+            e->rank(_now + 1);
+
+        unsigned int l = level(e->rank());
+        unsigned int s = slot(e->rank(), l);
+        _slots[l][s].insert(e);
+        _occupied[l] |= 1ULL << s;
+        _size++;
+    }
+
+    Element * remove(Element * e) {
+        if(e->rank() <= _now) // already expired
+            _expired.remove(e);
+        else {
+            unsigned int l = level(e->rank());
+            unsigned int s = slot(e->rank(), l);
+            _slots[l][s].remove(e);
+            if(_slots[l][s].empty())
+                _occupied[l] &= ~(1ULL << s);
+        }
+        _size--;
+
+        return e;
+    }
+
+    // The earliest instant at which something may happen (an expiration or a cascade)
+    Time next() const { return _expired.empty() ? earliest() : _now; }
+
+    // Move the wheel forward, collecting the elements that expire up to (and including) "now"
+    void advance(const Time & now) {
+        for(Time t = earliest(); (t != NEVER) && (t <= now); t = earliest()) {
+            _now = t;
+
+            for(unsigned int l = 0; l < LEVELS; l++) {
+                unsigned int s = slot(t, l);
+                if(!(_occupied[l] & (1ULL << s)))
+                    continue;
+
+                _occupied[l] &= ~(1ULL << s);
+                while(Element * e = _slots[l][s].remove()) {
+                    if(e->rank() <= _now)
+                        _expired.insert(e);
+                    else { // cascade
+                        _size--;
+                        insert(e);
+                    }
+                }
+            }
+        }
+
+        if(now > _now)
+            _now = now;
+    }
+
+    Element * expired() {
+        Element * e = _expired.remove();
+        if(e)
+            _size--;
+        return e;
+    }
+
+private:
+    // Elements in the lowest non-empty level always expire before the slots of higher levels start
+    Time earliest() const {
+        for(unsigned int l = 0; l < LEVELS; l++) {
+            Bitmap pending = _occupied[l] & above(l);
+            if(pending) {
+                Time base = (l + 1 < LEVELS) ? (_now >> (BITS * (l + 1))) << (BITS * (l + 1)) : 0;
+                return base | (Time(__builtin_ctzll(pending)) << (BITS * l));
+            }
+        }
+
+        return NEVER;
+    }
+
+    unsigned int level(const Time & t) const {
+        unsigned long long diff = static_cast<unsigned long long>(t ^ _now);
+        return (63 - __builtin_clzll(diff)) / BITS;
+    }
+
+    static unsigned int slot(const Time & t, unsigned int l) { return (t >> (BITS * l)) & (SLOTS - 1); }
+
+    // Slots after the current one at level l (earlier ones would belong to the past)
+    Bitmap above(unsigned int l) const {
+        unsigned int s = slot(_now, l);
+        return (s + 1 >= 64) ? 0 : ~0ULL << (s + 1);
+    }
+
+private:
+    Time _now;
+    unsigned long _size;
+    Bitmap _occupied[LEVELS];
+    Slot _slots[LEVELS][SLOTS];
+    Slot _expired;
+};
+
+__END_UTIL
+
+#endif
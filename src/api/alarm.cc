@@ -4,12 +4,14 @@
 #include <synchronizer.h>
 #include <time.h>
 #include <process.h>
+#include <system/kernel_page.h>
 
 __BEGIN_SYS
 
 Alarm_Timer * Alarm::_timer;
 volatile Alarm::Tick Alarm::_elapsed;
 Alarm::Queue Alarm::_request;
+Alarm::Wheel * Alarm::_wheel;
 
 Alarm::Alarm(Microsecond time, Handler * handler, unsigned int times)
 : _time(time), _handler(handler), _times(times), _ticks(ticks(time)), _link(this, _ticks)
@@ -19,10 +21,16 @@ Alarm::Alarm(Microsecond time, Handler * handler, unsigned int times)
     db<Alarm>(TRC) << "Alarm(t=" << time << ",tk=" << _ticks << ",h=" << reinterpret_cast<void *>(handler) << ",x=" << times << ") => " << this << endl;
 
     if(_ticks) {
-        _request.insert(&_link);
+        if(tickless) {
+            _link.rank(now() + _ticks);
+            _wheel->insert(&_link);
+            reprogram();
+        } else
+            _request.insert(&_link);
         unlock();
     } else {
         assert(times == 1);
+        _times = 0; // already fired
         unlock();
         (*handler)();
     }
@@ -39,7 +47,13 @@ Alarm::~Alarm()
 
     db<Alarm>(TRC) << "~Alarm(this=" << this << ")" << endl;
 
-    _request.remove(this);
+    if(tickless) {
+        if(_times) { // still in the wheel
+            _wheel->remove(&_link);
+            reprogram();
+        }
+    } else
+        _request.remove(this);
 
     if(multitask) {
         assert(Task::self());
@@ -57,9 +71,18 @@ void Alarm::reset()
 
     db<Alarm>(TRC) << "Alarm::reset(this=" << this << ")" << endl;
 
-    _request.remove(this);
-    _link.rank(_ticks);
-    _request.insert(&_link);
+    if(tickless) {
+        if(_times) {
+            _wheel->remove(&_link);
+            _link.rank(now() + _ticks);
+            _wheel->insert(&_link);
+            reprogram();
+        }
+    } else {
+        _request.remove(this);
+        _link.rank(_ticks);
+        _request.insert(&_link);
+    }
 
     if(!locked)
         unlock();
@@ -73,10 +96,21 @@ void Alarm::period(Microsecond p)
 
     db<Alarm>(TRC) << "Alarm::period(this=" << this << ",p=" << p << ")" << endl;
 
-    _request.remove(this);
-    _time = p;
-    _ticks = ticks(p);
-    _request.insert(&_link);
+    if(tickless) {
+        _time = p;
+        _ticks = ticks(p);
+        if(_times) {
+            _wheel->remove(&_link);
+            _link.rank(now() + _ticks);
+            _wheel->insert(&_link);
+            reprogram();
+        }
+    } else {
+        _request.remove(this);
+        _time = p;
+        _ticks = ticks(p);
+        _request.insert(&_link);
+    }
 
     if(!locked)
         unlock();
@@ -96,10 +130,44 @@ void Alarm::delay(Microsecond time)
 
 void Alarm::handler(IC::Interrupt_Id i)
 {
+    if(tickless) {
+        // Deliver every alarm that is due, not just one per tick
+        Handler * handlers[BATCH];
+        unsigned int n = 0;
+
+        lock();
+
+        _wheel->advance(now());
+        for(Queue::Element * e; (n < BATCH) && (e = _wheel->expired()); ) {
+            Alarm * alarm = e->object();
+            if(alarm->_times != INFINITE)
+                alarm->_times--;
+            if(alarm->_times > 0) {
+                e->rank(e->rank() + alarm->_ticks); // periodic alarms don't drift
+                _wheel->insert(e);
+            }
+            handlers[n++] = alarm->_handler;
+        }
+
+        reprogram(); // immediately, if more than BATCH alarms were due
+
+        unlock();
+
+        for(unsigned int j = 0; j < n; j++) {
+            db<Alarm>(TRC) << "Alarm::handler(h=" << reinterpret_cast<void *>(handlers[j]) << ")" << endl;
+            (*handlers[j])();
+        }
+
+        return;
+    }
+
     lock();
 
     _elapsed++;
 
+    if(Kernel_Page::enabled)
+        Kernel_Page::tick(_elapsed);
+
     if(Traits<Alarm>::visible) {
         Display display;
         int lin, col;
@@ -134,4 +202,12 @@ void Alarm::handler(IC::Interrupt_Id i)
     }
 }
 
+
+void Alarm::reprogram()
+{
+    // The timer is armed in one-shot mode for the earliest expiration (or cascade) in the wheel
+    Wheel::Time next = _wheel->next();
+    _timer->deadline((next == Wheel::NEVER) ? 0 : time_stamp(next));
+}
+
 __END_SYS
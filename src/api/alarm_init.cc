@@ -9,6 +9,9 @@ void Alarm::init()
 {
     db<Init, Alarm>(TRC) << "Alarm::init()" << endl;
 
+    if(tickless)
+        _wheel = new (SYSTEM) Wheel(now());
+
     _timer = new (SYSTEM) Alarm_Timer(handler);
 }
 
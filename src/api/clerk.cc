@@ -11,6 +11,11 @@ bool Clerk<PMU>::_in_use[Traits<Build>::CPUS][CHANNELS];
 Simple_List<Monitor> Monitor::_monitors[Traits<Build>::CPUS];
 Monitor::Time_Stamp Monitor::_sync_now[Traits<Build>::CPUS];
 volatile bool Monitor::_enable;
+Thread * Monitor::_drainer;
+
+// Trace
+Trace::Ring * Trace::_rings;
+UART * Trace::_uart;
 
 void Monitor::run()
 {
@@ -23,10 +28,27 @@ void Monitor::run()
     }
 }
 
+// Streams the trace while anybody else besides the idle threads, the daemons and itself is alive (see Thread::idle())
+int Monitor::drain()
+{
+    db<Monitor>(TRC) << "Monitor::drain()" << endl;
+
+    while(Thread::_thread_count > CPU::cores() + Thread::_daemon_count + 1) {
+        Trace::drain();
+        Alarm::delay(Traits<Monitor>::TRACE_PERIOD);
+    }
+    Trace::drain();
+
+    return 0;
+}
+
 void Monitor::init()
 {
     db<Monitor>(TRC) << "Monitor::init()" << endl;
 
+    if(Trace::enabled && (CPU::id() == CPU::BSP))
+        Trace::init();
+
     if(Traits<System>::monitored)
         init_system_monitoring<0>();
 
@@ -0,0 +1,10 @@
+// EPOS Kernel Page Implementation
+
+#include <system/kernel_page.h>
+
+__BEGIN_SYS
+
+Kernel_Page * Kernel_Page::_page;
+Segment * Kernel_Page::_segment;
+
+__END_SYS
@@ -0,0 +1,24 @@
+// EPOS Kernel Page Initialization
+
+#include <system/kernel_page.h>
+#include <memory.h>
+#include <time.h>
+
+__BEGIN_SYS
+
+void Kernel_Page::init()
+{
+    db<Init, System>(TRC) << "Kernel_Page::init()" << endl;
+
+    // Readable, but not writable, by tasks; the kernel writes it through its own mapping of the physical memory
+    _segment = new (SYSTEM) Segment(sizeof(Kernel_Page), Segment::Flags(Segment::Flags::PRE | Segment::Flags::RD | Segment::Flags::USR));
+    _page = new (MMU::phy2log(_segment->phy_address())) Kernel_Page;
+
+    _page->_ticked = Traits<Alarm>::enabled && !Traits<Alarm>::tickless;
+    _page->_alarm_frequency = Traits<Alarm>::enabled ? Alarm::frequency() : 0;
+    _page->_tsc_frequency = TSC::frequency();
+
+    db<Init, System>(INF) << "Kernel_Page::init: page=" << _page << ",size=" << sizeof(Kernel_Page) << endl;
+}
+
+__END_SYS
@@ -4,7 +4,7 @@
 
 __BEGIN_SYS
 
-Mutex::Mutex(): _locked(false)
+Mutex::Mutex(): _state(UNLOCKED)
 {
     db<Synchronizer>(TRC) << "Mutex() => " << this << endl;
 
@@ -30,9 +30,12 @@ void Mutex::lock()
 {
     db<Synchronizer>(TRC) << "Mutex::lock(this=" << this << ")" << endl;
 
+    if(cas(_state, UNLOCKED, LOCKED) == UNLOCKED) // uncontended
+        return;
+
     lock_for_acquiring();
-    if(tsl(_locked))
-        sleep();
+    if(fas(_state, CONTENDED) != UNLOCKED)
+        sleep(); // ownership is handed over by unlock()
     unlock_for_acquiring();
 }
 
@@ -41,11 +44,14 @@ void Mutex::unlock()
 {
     db<Synchronizer>(TRC) << "Mutex::unlock(this=" << this << ")" << endl;
 
+    if(cas(_state, LOCKED, UNLOCKED) == LOCKED) // uncontended
+        return;
+
     lock_for_releasing();
     if(_waiting.empty())
-        _locked = false;
+        _state = UNLOCKED;
     else
-        wakeup();
+        wakeup(); // _state remains CONTENDED for the new owner
     unlock_for_releasing();
 }
 
@@ -54,6 +54,9 @@ void Scheduling_Criterion_Common::handle(Event event)
     if(event & JOB_FINISH) {
         db<Thread>(TRC) << "JOB_FINISH";
     }
+    if(event & WAKEUP) {
+        db<Thread>(TRC) << "WAKEUP";
+    }
 
     if(event & COLLECT) {
         db<Thread>(TRC) << "|COLLECT";
@@ -123,7 +126,86 @@ template <typename ... Tn>
 FCFS::FCFS(int i, Tn & ... an): Priority((i == IDLE) ? IDLE : RT_Common::now()) {}
 
 
-EDF::EDF(Microsecond p, Microsecond d, Microsecond c): RT_Common(int(now() + ticks(d)), p, d, c) {}
+CBS::CBS(Microsecond budget, Microsecond period, unsigned int cpu)
+: _budget(RT_Common::ticks(budget)), _period(RT_Common::ticks(period)), _remaining(0), _deadline(0), _cpu((cpu != RT_Common::ANY) ? cpu : CPU::id()), _postponements(0), _locked(false)
+{
+    db<Thread>(TRC) << "CBS(b=" << budget << ",p=" << period << ",cpu=" << _cpu << ") => " << this << endl;
+
+    assert(_budget && (_budget <= _period));
+    assert(_cpu < Traits<Machine>::CPUS);
+}
+
+void CBS::wakeup(Tick now)
+{
+    bool disabled = lock();
+
+    // Serving from now on with the remaining budget would exceed budget / period (i.e. _remaining / (_deadline - now) >= _budget / _period)
+    if((_deadline <= now) || (static_cast<unsigned long long>(_remaining) * _period >= static_cast<unsigned long long>(_deadline - now) * _budget)) {
+        _remaining = _budget;
+        _deadline = now + _period;
+    }
+
+    unlock(disabled);
+}
+
+bool CBS::charge(Tick time)
+{
+    bool disabled = lock();
+
+    bool postponed = false;
+    while(time >= _remaining) {
+        time -= _remaining;
+        _remaining = _budget;
+        _deadline += _period;
+        _postponements++;
+        postponed = true;
+    }
+    _remaining -= time;
+
+    unlock(disabled);
+
+    return postponed;
+}
+
+
+EDF::EDF(Microsecond p, Microsecond d, Microsecond c): RT_Common(int(now() + ticks(d)), p, d, c), _server(0), _budget(_capacity), _since(now()) {}
+
+EDF::EDF(CBS * server): RT_Common(APERIODIC), _server(server), _budget(0), _since(now())
+{
+    server->wakeup(now());
+    _priority = int(server->_deadline);
+}
+
+Microsecond EDF::budget()
+{
+    if(_server)
+        return time(_server->_remaining);
+    else if(enforce_capacity && _capacity)
+        return time(_budget);
+    else
+        return 0;
+}
+
+void EDF::charge()
+{
+    Tick t = now();
+    Tick used = t - _since;
+    _since = t;
+
+    if(_server) {
+        if(_server->charge(used))
+            db<Thread>(TRC) << "EDF::charge(this=" << this << ") => server " << _server << " exhausted" << endl;
+        _priority = int(_server->_deadline);
+    } else {
+        // Overrunning jobs are treated as if hosted by a dedicated CBS with budget = capacity and period = period
+        while(used >= _budget) {
+            used -= _budget;
+            _budget = _capacity;
+            _priority = _priority + int(_period);
+        }
+        _budget -= used;
+    }
+}
 
 void EDF::handle(Event event) {
     RT_Common::handle(event);
@@ -131,6 +213,26 @@ void EDF::handle(Event event) {
     // Update the priority of the thread at job releases, before _alarm->v(), so it enters the queue in the right order (called from Periodic_Thread::Xxx_Handler)
     if(periodic() && (event & JOB_RELEASE))
         _priority = now() + _deadline;
+    if(event & JOB_RELEASE)
+        _budget = _capacity;
+
+    if(!_server && !(enforce_capacity && _capacity))
+        return;
+
+    // Hosted threads are ordered by the server's deadline, which might have been postponed while they were not running
+    if(_server && (event & WAKEUP)) {
+        _server->wakeup(now());
+        _priority = int(_server->_deadline);
+    }
+    if(event & DISPATCH) {
+        if(_server)
+            _priority = int(_server->_deadline);
+        _since = now();
+    }
+    if(event & CHARGE)
+        charge();
+    if(_server && (event & UPDATE)) // the server's deadline was postponed while the thread was ready (see Thread::account())
+        _priority = int(_server->_deadline);
 }
 
 
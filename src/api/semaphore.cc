@@ -30,6 +30,9 @@ void Semaphore::p()
 {
     db<Synchronizer>(TRC) << "Semaphore::p(this=" << this << ",value=" << _value << ")" << endl;
 
+    if(try_acquire(_value)) // no need to sleep
+        return;
+
     lock_for_acquiring();
     if(fdec(_value) < 1)
         sleep();
@@ -41,6 +44,9 @@ void Semaphore::v()
 {
     db<Synchronizer>(TRC) << "Semaphore::v(this=" << this << ",value=" << _value << ")" << endl;
 
+    if(try_release(_value)) // nobody waiting
+        return;
+
     lock_for_releasing();
     if(finc(_value) < 0)
         wakeup();
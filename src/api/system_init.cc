@@ -3,6 +3,7 @@
 #include <system.h>
 #include <time.h>
 #include <process.h>
+#include <system/kernel_page.h>
 
 __BEGIN_SYS
 
@@ -14,6 +15,8 @@ void System::init()
             Page_Coloring::init();
         if(Traits<Alarm>::enabled)
             Alarm::init();
+        if(Kernel_Page::enabled)
+            Kernel_Page::init();
     }
 
     // These abstractions are initialized by all CPUs
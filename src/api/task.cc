@@ -4,6 +4,7 @@
 #include <synchronizer.h>
 #include <time.h>
 #include <memory.h>
+#include <system/kernel_page.h>
 
 __BEGIN_SYS
 
@@ -47,10 +48,43 @@ Task::~Task()
     //     }
     // }
 
+    if(_kernel_page)
+        _as->detach(Kernel_Page::segment(), _kernel_page);
+
+    if(_ring) {
+        _as->detach(_ring, _ring_address);
+        delete _ring;
+    }
+
     _as->detach(_cs, _code);
     _as->detach(_ds, _data);
 
     delete _as;
 }
 
+
+CPU::Log_Addr Task::syscall_ring(unsigned long size)
+{
+    if(!_ring) {
+        _ring = new (SYSTEM) Segment(size, Segment::Flags::APPD);
+        _ring_address = _as->attach(_ring);
+
+        db<Task>(TRC) << "Task::syscall_ring(this=" << this << ",size=" << size << ") => " << _ring_address << endl;
+    }
+
+    return _ring_address;
+}
+
+
+CPU::Log_Addr Task::kernel_page()
+{
+    if(!_kernel_page && Kernel_Page::segment()) {
+        _kernel_page = _as->attach(Kernel_Page::segment());
+
+        db<Task>(TRC) << "Task::kernel_page(this=" << this << ") => " << _kernel_page << endl;
+    }
+
+    return _kernel_page;
+}
+
 __END_SYS
@@ -4,6 +4,7 @@
 #include <system.h>
 #include <process.h>
 #include <clerk.h>
+#include <system/kernel_page.h>
 
 __BEGIN_SYS
 
@@ -11,23 +12,36 @@ extern OStream kout;
 
 bool Thread::_not_booting;
 volatile unsigned int Thread::_thread_count;
+volatile unsigned int Thread::_daemon_count;
 Scheduler_Timer * Thread::_timer;
 Monitor_Timer * Thread::_monitor_timer;
 Scheduler<Thread> Thread::_scheduler;
 Spin Thread::_lock;
+Spin Thread::_queue_lock[queue_locking ? Criterion::QUEUES : 1];
+volatile unsigned int Thread::_global_level[queue_locking ? Traits<Machine>::CPUS : 1];
+Thread::Lock_Statistics Thread::_lock_statistics[lock_profiling ? Traits<Machine>::CPUS : 1];
+Thread::Steal_Statistics Thread::_steal_statistics[work_stealing ? Traits<Machine>::CPUS : 1];
+Thread * volatile Thread::_fpu_owner[lazy_fpu ? Traits<Machine>::CPUS : 1];
+volatile unsigned int Thread::_fpu_kernel[lazy_fpu ? Traits<Machine>::CPUS : 1];
 
 
-void Thread::constructor_prologue(Color color, unsigned int stack_size)
+void Thread::constructor_prologue(Color color, unsigned int stack_size, bool fpu)
 {
     lock();
 
     _thread_count++;
+    lock_queue(_link.rank().queue());
     _scheduler.insert(this);
+    unlock_queue(_link.rank().queue());
 
     if(Traits<MMU>::colorful && color != WHITE)
         _stack = new (color) char[stack_size];
     else
         _stack = new (SYSTEM) char[stack_size];
+
+    _fpu = (lazy_fpu && fpu) ? new (SYSTEM) CPU::FPU_Context : 0;
+    _fpu_cpu = 0;
+    _pmu_clerks = 0;
 }
 
 
@@ -47,8 +61,11 @@ void Thread::constructor_epilogue(Log_Addr entry, unsigned int stack_size)
     if(multitask && (_link.rank() != IDLE))
         _task->enroll(this);
 
-    if((_state != READY) && (_state != RUNNING))
+    if((_state != READY) && (_state != RUNNING)) {
+        lock_queue(_link.rank().queue());
         _scheduler.suspend(this);
+        unlock_queue(_link.rank().queue());
+    }
 
     criterion().handle(Criterion::CREATION);
 
@@ -73,6 +90,7 @@ Thread::~Thread()
     // The running thread cannot delete itself!
     assert(_state != RUNNING);
 
+    lock_queue(_link.rank().queue());
     switch(_state) {
     case RUNNING:  // For switch completion only: the running thread would have deleted itself! Stack wouldn't have been released!
         exit(-1);
@@ -95,6 +113,7 @@ Thread::~Thread()
     case FINISHING: // Already called exit()
         break;
     }
+    unlock_queue(_link.rank().queue());
 
     if(multitask) {
         _task->dismiss(this);
@@ -104,9 +123,20 @@ Thread::~Thread()
     if(_joining)
         _joining->resume();
 
+    // A thread later allocated at the same address must not be taken for the owner of the FPU registers
+    if(lazy_fpu)
+        for(unsigned int i = 0; i < Traits<Machine>::CPUS; i++)
+            if(_fpu_owner[i] == this)
+                _fpu_owner[i] = 0;
+
+    if(pmu_virtualized && _pmu_clerks)
+        Clerk<PMU>::unbind(this);
+
     unlock();
 
     delete _stack;
+    if(_fpu)
+        delete _fpu;
 }
 
 
@@ -120,11 +150,18 @@ void Thread::priority(Criterion c)
     unsigned long new_cpu = c.queue();
 
     if(_state != RUNNING) { // reorder the scheduling queue
+        lock_queue(old_cpu);
         _scheduler.suspend(this);
         _link.rank(c);
+        unlock_queue(old_cpu);
+        lock_queue(new_cpu);
         _scheduler.resume(this);
-    } else
+        unlock_queue(new_cpu);
+    } else {
+        lock_queue(old_cpu); // the owner of old_cpu might be checking for migrations
         _link.rank(c);
+        unlock_queue(old_cpu);
+    }
 
     if(preemptive) {
     	if(smp) {
@@ -177,7 +214,10 @@ void Thread::pass()
     db<Thread>(TRC) << "Thread::pass(this=" << this << ")" << endl;
 
     Thread * prev = running();
+    lock_queue(_link.rank().queue());
+    account(prev);
     Thread * next = _scheduler.choose(this);
+    unlock_queue(_link.rank().queue());
 
     if(next)
         dispatch(prev, next, false);
@@ -197,7 +237,9 @@ void Thread::suspend()
     Thread * prev = running();
 
     _state = SUSPENDED;
+    lock_queue(_link.rank().queue());
     _scheduler.suspend(this);
+    unlock_queue(_link.rank().queue());
 
     Thread * next = _scheduler.chosen();
 
@@ -215,7 +257,11 @@ void Thread::resume()
 
     if(_state == SUSPENDED) {
         _state = READY;
+        criterion().handle(Criterion::WAKEUP);
+        lock_queue(_link.rank().queue());
         _scheduler.resume(this);
+        rerank(this);
+        unlock_queue(_link.rank().queue());
 
         if(preemptive)
             reschedule(_link.rank().queue());
@@ -226,18 +272,34 @@ void Thread::resume()
 }
 
 
-void Thread::yield()
+void Thread::daemon()
 {
     lock();
 
+    db<Thread>(TRC) << "Thread::daemon(this=" << this << ")" << endl;
+
+    _daemon_count++;
+
+    unlock();
+}
+
+
+void Thread::yield()
+{
+    bool global = lock_local();
+
     db<Thread>(TRC) << "Thread::yield(running=" << running() << ")" << endl;
 
     Thread * prev = running();
+    unsigned int queue = prev->_link.rank().queue(); // choose_another() reinserts a migrating prev in its new queue
+    lock_queue(queue);
+    account(prev);
     Thread * next = _scheduler.choose_another();
+    unlock_queue(queue);
 
     dispatch(prev, next);
 
-    unlock();
+    unlock_local(global);
 }
 
 
@@ -257,7 +319,11 @@ void Thread::exit(int status)
 
     if(prev->_joining) {
         prev->_joining->_state = READY;
+        prev->_joining->criterion().handle(Criterion::WAKEUP);
+        lock_queue(prev->_joining->_link.rank().queue());
         _scheduler.resume(prev->_joining);
+        rerank(prev->_joining);
+        unlock_queue(prev->_joining->_link.rank().queue());
         prev->_joining = 0;
     }
 
@@ -297,7 +363,11 @@ void Thread::wakeup(Queue * q)
         Thread * t = q->remove()->object();
         t->_state = READY;
         t->_waiting = 0;
+        t->criterion().handle(Criterion::WAKEUP);
+        lock_queue(t->_link.rank().queue());
         _scheduler.resume(t);
+        rerank(t);
+        unlock_queue(t->_link.rank().queue());
 
         if(preemptive)
             reschedule(t->_link.rank().queue());
@@ -318,7 +388,11 @@ void Thread::wakeup_all(Queue * q)
             Thread * t = q->remove()->object();
             t->_state = READY;
             t->_waiting = 0;
+            t->criterion().handle(Criterion::WAKEUP);
+            lock_queue(t->_link.rank().queue());
             _scheduler.resume(t);
+            rerank(t);
+            unlock_queue(t->_link.rank().queue());
             cpus |= 1 << t->_link.rank().queue();
         }
 
@@ -346,9 +420,12 @@ void Thread::prioritize(Queue * q)
             r->_natural_priority = r->criterion();
             Criterion c = /* (priority_inversion_protocol == Traits<Build>::CEILING) ? CEILING :*/ r->criterion();
             if(r->_state == READY) {
+                unsigned int queue = r->_link.rank().queue();
+                lock_queue(queue);
                 _scheduler.suspend(r);
                 r->_link.rank(c);
                 _scheduler.resume(r);
+                unlock_queue(queue);
             } else if(r->state() == WAITING) {
                 r->_waiting->remove(&r->_link);
                 r->_link.rank(c);
@@ -374,9 +451,12 @@ void Thread::deprioritize(Queue * q)
     for(Queue::Iterator i = q->begin(); i != q->end(); ++i) {
         if(i->object()->priority() != c) {
             if(r->_state == READY) {
+                unsigned int queue = r->_link.rank().queue();
+                lock_queue(queue);
                 _scheduler.suspend(r);
                 r->_link.rank(c);
                 _scheduler.resume(r);
+                unlock_queue(queue);
             } else if(r->state() == WAITING) {
                 r->_waiting->remove(&r->_link);
                 r->_link.rank(c);
@@ -445,7 +525,11 @@ void Thread::reschedule()
     //     IC::ipi(target_cpu, IC::INT_RESCHEDULER);
     // }
 
+    unsigned int queue = prev->_link.rank().queue(); // choose() reinserts a migrating prev in its new queue
+    lock_queue(queue);
+    account(prev);
     Thread * next = _scheduler.choose();
+    unlock_queue(queue);
 
     dispatch(prev, next);
 }
@@ -466,18 +550,20 @@ void Thread::reschedule(unsigned int cpu)
 
 void Thread::rescheduler(IC::Interrupt_Id i)
 {
-    lock();
+    bool global = lock_local();
     reschedule();
-    unlock();
+    unlock_local(global);
 }
 
 
 void Thread::time_slicer(IC::Interrupt_Id i)
 {
-    lock();
+    bool global = lock_local();
     running()->criterion().handle(Criterion::TIMER_INTERRUPTION);
+    if(pmu_virtualized && running()->_pmu_clerks)
+        Clerk<PMU>::sample(running());  // so counters are accumulated at least once per quantum, before they wrap
     reschedule();
-    unlock();
+    unlock_local(global);
 }
 
 
@@ -487,8 +573,16 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
 
     assert(CPU::int_disabled());
 
+    // prev's FPU state is saved before the criteria run, since they might use the FPU themselves (e.g. EA_PEDF)
+    if(lazy_fpu && (prev != next))
+        kernel_fpu_begin();
+
+    // A prev still RUNNING was accounted for before it went back to the ready queue; charging it might change next's budget (e.g. a shared CBS)
+    if((prev != next) && (prev->_state != RUNNING))
+        account(prev);
+
     if(charge && Criterion::timed)
-        _timer->restart();
+        _timer->restart(next->criterion().budget()); // a quantum, or less if next has a shorter budget left (e.g. EDF)
 
     // if(monitored)
     //     Monitor::run();
@@ -501,6 +595,19 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
             prev->_state = READY;
         next->_state = RUNNING;
 
+        if(Kernel_Page::enabled)
+            Kernel_Page::dispatch(next, next->_task);
+
+        if(monitored)
+            Monitor::trace(Trace::event(Trace::SCHEDULER_EVENT, Trace::DISPATCH), reinterpret_cast<unsigned long>(next));
+
+        if(pmu_virtualized) {
+            if(prev->_pmu_clerks)
+                Clerk<PMU>::save(prev);
+            if(next->_pmu_clerks)
+                Clerk<PMU>::restore(next);
+        }
+
 //        db<Thread>(WRN) << "Thread::dispatch(prev=" << prev << ",next=" << next << ")" << endl;
 ////        if(Traits<Thread>::debugged && Traits<Debug>::info) {
 //            CPU::Context tmp;
@@ -516,8 +623,28 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
 
         assert(CPU::int_disabled());
 
-        if(smp)
-            _lock.release();
+        // With queue_locking, the thread being switched out might be holding either the full lock or only its
+        // local queue lock (see lock_local()); whatever it holds is reacquired when it gets switched back in
+        unsigned int level = 0;
+        if(smp) {
+            if(queue_locking) {
+                level = _global_level[CPU::id()];
+                release(_queue_lock[Criterion::current_queue()]);
+                if(level) {
+                    _global_level[CPU::id()] = 0;
+                    release(_lock);
+                }
+            } else
+                release(_lock);
+        }
+
+        // Kernel FPU sections are per thread: new threads start outside of them with the FPU off
+        unsigned int fpu_kernel = 0;
+        if(lazy_fpu) {
+            fpu_kernel = _fpu_kernel[CPU::id()];
+            _fpu_kernel[CPU::id()] = 0;
+            CPU::fpu_off();
+        }
 
         // The non-volatile pointer to volatile pointer to a non-volatile context is correct
         // and necessary because of context switches, but here, we are locked() and
@@ -531,24 +658,203 @@ void Thread::dispatch(Thread * prev, Thread * next, bool charge)
 
 //        assert(CPU::int_disabled() || (running()->criterion() == IDLE));
 
-        if(smp)
-            _lock.acquire();
+        if(lazy_fpu) {
+            _fpu_kernel[CPU::id()] = fpu_kernel;
+            kernel_fpu_end();
+        }
+
+        if(smp) {
+            if(queue_locking) {
+                if(level) {
+                    acquire(_lock);
+                    _global_level[CPU::id()] = level;
+                }
+                acquire(_queue_lock[Criterion::current_queue()]);
+            } else
+                acquire(_lock);
+        }
+    }
+}
+
+
+// Charges "prev" for the time it has been running, which might change its rank (e.g. EDF budgets), so it must not be
+// in the ready queue. If that postponed the deadline of the CBS hosting "prev", the other threads hosted by the server
+// that are ready are reinserted in the queue with the new deadline.
+void Thread::account(Thread * prev)
+{
+    if(!Criterion::dynamic)
+        return;
+
+    int rank = prev->criterion();
+    prev->criterion().handle(Criterion::CHARGE);
+
+    if(int(prev->criterion()) != rank)
+        rerank(prev);
+}
+
+
+// Reinserts the ready threads hosted by the same CBS as "t" that are still ranked by a previous deadline of the server,
+// which changes when it is postponed (see account()) and when a hosted thread wakes up (see EDF::handle(WAKEUP))
+void Thread::rerank(Thread * t)
+{
+    if(!Criterion::dynamic)
+        return;
+
+    CBS * server = t->criterion().server();
+    if(!server)
+        return;
+
+    for(bool stale = true; stale;) {
+        stale = false;
+        for(Scheduler<Thread>::Iterator i = _scheduler.begin(); i != _scheduler.end(); ++i) {
+            Thread * h = i->object();
+            if((h->criterion().server() == server) && (int(h->criterion()) != int(t->criterion()))) {
+                _scheduler.suspend(h);
+                h->criterion().handle(Criterion::UPDATE);
+                _scheduler.resume(h);
+                stale = true;
+                break;
+            }
+        }
     }
 }
 
 
+// Lazy FPU context switching: outside the kernel, the FPU is only enabled for the thread whose state its registers hold,
+// _fpu_owner[cpu], and only while that thread is running. Any other thread's first use of the FPU traps into fpu_trap(),
+// which loads the thread's FPU context. The registers of each CPU belong to _fpu_owner[cpu] only while the owner's
+// _fpu_cpu is that CPU, so a thread that migrated reloads its context. Kernel code that runs on behalf of some other
+// thread (i.e. interrupt handlers and dispatch(), including the criteria) runs in a kernel FPU section: the owner's state
+// is saved on entry, if it has changed, and the FPU is disabled. If such code uses the FPU, the registers no longer hold
+// the owner's state, so it will be reloaded on the owner's next use. Threads that don't touch the FPU never pay for it.
+void Thread::kernel_fpu_begin()
+{
+    if(!lazy_fpu)
+        return;
+
+    unsigned int cpu = CPU::id();
+
+    if((_fpu_kernel[cpu]++ == 0) && CPU::fpu_enabled()) {
+        if(CPU::fpu_dirty() && _fpu_owner[cpu])
+            CPU::fpu_save(_fpu_owner[cpu]->_fpu);
+        CPU::fpu_off();
+    }
+}
+
+
+void Thread::kernel_fpu_end()
+{
+    if(!lazy_fpu)
+        return;
+
+    unsigned int cpu = CPU::id();
+
+    if(--_fpu_kernel[cpu] == 0) {
+        Thread * t = running();
+        if(t->_fpu && (_fpu_owner[cpu] == t) && (t->_fpu_cpu == cpu))
+            CPU::fpu_on();
+        else
+            CPU::fpu_off();
+    }
+}
+
+
+bool Thread::fpu_trap()
+{
+    if(!lazy_fpu || CPU::fpu_enabled()) // not an FPU trap
+        return false;
+
+    unsigned int cpu = CPU::id();
+
+    if(_fpu_kernel[cpu]) { // the owner's state was saved by kernel_fpu_begin(), but will no longer be in the registers
+        db<Thread>(TRC) << "Thread::fpu_trap(kernel,cpu=" << cpu << ",owner=" << _fpu_owner[cpu] << ")" << endl;
+        _fpu_owner[cpu] = 0;
+        CPU::fpu_on();
+        return true;
+    }
+
+    Thread * t = running();
+
+    if(!t->_fpu) // a thread configured without the FPU
+        return false;
+
+    db<Thread>(TRC) << "Thread::fpu_trap(this=" << t << ",cpu=" << cpu << ",owner=" << _fpu_owner[cpu] << ")" << endl;
+
+    CPU::fpu_on();
+    if((_fpu_owner[cpu] != t) || (t->_fpu_cpu != cpu)) {
+        CPU::fpu_restore(t->_fpu);
+        _fpu_owner[cpu] = t;
+        t->_fpu_cpu = cpu;
+    }
+
+    return true;
+}
+
+
+void Thread::reset_lock_statistics()
+{
+    for(unsigned int i = 0; i < (lock_profiling ? Traits<Machine>::CPUS : 1); i++) {
+        _lock_statistics[i].acquisitions = 0;
+        _lock_statistics[i].wait_time = 0;
+        _lock_statistics[i].hold_time = 0;
+        _lock_statistics[i]._since = TSC::time_stamp();
+    }
+}
+
+
+// Called by idle CPUs to pull a best-effort thread from the busiest queue. Steals are rate-limited per CPU
+// (Traits<Thread>::STEAL_INTERVAL), so threads don't bounce among CPUs that become idle at the same time.
+void Thread::steal()
+{
+    lock();
+
+    unsigned int queue = Criterion::current_queue();
+    Steal_Statistics & s = _steal_statistics[CPU::id()];
+    TSC::Time_Stamp now = TSC::time_stamp();
+
+    if((_scheduler.schedulables() == 0) && (now - s._last >= TSC::frequency() / 1000000 * Traits<Thread>::STEAL_INTERVAL)) {
+        unsigned int victim = _scheduler.busiest();
+        if(victim != queue) {
+            lock_queue(victim);
+            Thread * t = _scheduler.steal(victim, queue, &stealable);
+            unlock_queue(victim);
+
+            if(t) {
+                db<Thread>(TRC) << "Thread::steal(cpu=" << CPU::id() << ",from=" << victim << ") => " << t << endl;
+
+                s.steals++;
+                _steal_statistics[victim].migrations++;
+                s._last = now;
+            }
+        }
+    }
+
+    unlock();
+}
+
+
+// Periodic (real-time) threads and threads bound to a CPU stay where they are
+bool Thread::stealable(Thread * t)
+{
+    return !t->criterion().pinned() && !t->criterion().periodic() && (t->_link.rank() != IDLE) && (t->_link.rank() != MAIN);
+}
+
+
 int Thread::idle()
 {
     db<Thread>(TRC) << "Thread::idle(cpu=" << CPU::id() << ",this=" << running() << ")" << endl;
 
-    while(_thread_count > CPU::cores()) { // someone else besides idles
+    while(_thread_count > CPU::cores() + _daemon_count) { // someone else besides idles and daemons
         if(Traits<Thread>::trace_idle)
             db<Thread>(TRC) << "Thread::idle(cpu=" << CPU::id() << ",this=" << running() << ")" << endl;
 
         CPU::int_enable();
         CPU::halt();
 
-        if(_scheduler.schedulables() > 0) // a thread might have been woken up by another CPU
+        if(work_stealing && (_scheduler.schedulables() == 0))
+            steal();
+
+        if(_scheduler.schedulables() > 0) // a thread might have been woken up by (or stolen from) another CPU
             yield();
     }
 
@@ -5,7 +5,6 @@
 #include <system.h>
 #include <process.h>
 #include <clerk.h>
-#include "machine/riscv/riscv_timer.h"
 
 __BEGIN_SYS
 
@@ -86,6 +85,10 @@ void Thread::init()
     // No more interrupts until we reach init_end
     CPU::int_disable();
 
+    // The FPU registers belong to no thread yet, so the first thread to use them must trap (see fpu_trap())
+    if(lazy_fpu)
+        CPU::fpu_off();
+
     CPU::smp_barrier();
 
     // Transition from CPU-based locking to thread-based locking
@@ -182,9 +182,17 @@ void IC::dispatch()
     if(_eoi_vector[i])
         _eoi_vector[i](i);
 
+    if(Traits<FPU>::lazy)
+        Thread::kernel_fpu_begin();     // interrupt handlers must not touch the interrupted thread's FPU state
+
     CPU::int_enable();  // ARM disables interrupts at each interrupt handling
 
     _int_vector[i](i);
+
+    if(Traits<FPU>::lazy) {
+        CPU::int_disable();
+        Thread::kernel_fpu_end();
+    }
 }
 
 #endif
@@ -218,6 +226,11 @@ void IC::prefetch_abort()
 void IC::undefined_instruction()
 {
     CPU::svc_enter(CPU::MODE_UNDEFINED, false); // enter SVC to capture LR (the faulting address) in r1
+    if(Traits<FPU>::lazy) {
+        if(Thread::fpu_trap())                  // first FPU instruction since dispatch
+            CPU::svc_leave();                   // return to the faulting address to retry it with the FPU enabled
+        ASM("ldr r1, [sp, #28]");               // recover the faulting address saved by svc_enter() in r1
+    }
     db<IC, Machine>(WRN) << "IC::undefined_instruction() [addr=" << CPU::Log_Addr(CPU::r1()) << "]" << endl;
     CPU::svc_stay();  // undo the context saving of svc_enter(), but do not leave SVC
     kill();
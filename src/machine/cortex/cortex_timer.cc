@@ -6,6 +6,10 @@
 __BEGIN_SYS
 
 Timer * Timer::_channels[CHANNELS];
+volatile TSC::Time_Stamp Timer::_deadline;
+volatile unsigned int Timer::_deadline_cpu;
+alignas(int) volatile bool Timer::_programming;
+volatile TSC::Time_Stamp Timer::_next_tick[Traits<Machine>::CPUS];
 
 #ifdef __raspberry_pi3__
 System_Timer_Engine::Count System_Timer_Engine::_count;
@@ -19,7 +23,28 @@ System_Timer_Engine::Count System_Timer_Engine::_count;
 
 void Timer::int_handler(Interrupt_Id i)
 {
-    if((CPU::id() == CPU::BSP) && _channels[ALARM] && (--_channels[ALARM]->_current[CPU::BSP] <= 0)) {
+    if(tickless) {
+        TSC::Time_Stamp now = TSC::time_stamp();
+
+        bool alarm = (CPU::id() == _deadline_cpu) && _deadline && (now >= _deadline);
+        if(alarm)
+            _deadline = 0; // the ALARM handler will set the next one
+
+        bool tick = (now >= _next_tick[CPU::id()]);
+        if(tick)
+            while(_next_tick[CPU::id()] <= now)
+                _next_tick[CPU::id()] += TSC::frequency() / FREQUENCY;
+
+        program(); // before calling handlers, which might not return soon
+
+        if(alarm && _channels[ALARM])
+            _channels[ALARM]->_handler(i);
+
+        if(!tick)
+            return;
+    }
+
+    if(!tickless && (CPU::id() == CPU::BSP) && _channels[ALARM] && (--_channels[ALARM]->_current[CPU::BSP] <= 0)) {
         _channels[ALARM]->_current[CPU::BSP] = _channels[ALARM]->_initial;
         _channels[ALARM]->_handler(i);
     }
@@ -27,7 +52,7 @@ void Timer::int_handler(Interrupt_Id i)
     if(_channels[SCHEDULER] && (--_channels[SCHEDULER]->_current[CPU::id()] <= 0)) {
         _channels[SCHEDULER]->_current[CPU::id()] = _channels[SCHEDULER]->_initial;
 
-        if((Traits<Build>::MODEL != Traits<Build>::Realview_PBX) && (CPU::id() == CPU::BSP))
+        if(!private_engines && (CPU::id() == CPU::BSP))
             for(unsigned int cpu = 1; cpu < CPU::cores(); cpu++)
                 IC::ipi(cpu, IC::INT_RESCHEDULER);
 
@@ -39,6 +64,35 @@ void Timer::eoi(Interrupt_Id i) {
     Engine::eoi(i);
 }
 
+void Timer::program()
+{
+    // A global engine is shared by all cores, so they take turns to arm it for the BSP
+    static const bool shared = multicore && !private_engines;
+    unsigned int cpu = private_engines ? CPU::id() : CPU::BSP;
+    if(shared)
+        while(CPU::tsl(_programming));
+
+    TSC::Time_Stamp now = TSC::time_stamp();
+    TSC::Time_Stamp next = periodic() ? _next_tick[cpu] : TSC::Time_Stamp(~0ULL);
+    if((cpu == _deadline_cpu) && _deadline && (_deadline < next))
+        next = _deadline;
+
+    unsigned long long delta = (next > now) ? next - now : 0;
+    if(delta > TSC::frequency()) // keeps the conversion below from overflowing
+        delta = TSC::frequency();
+
+    unsigned long long count = delta * Engine::clock() / TSC::frequency();
+    if(count < MIN_COUNT)
+        count = MIN_COUNT;
+    if(count > MAX_COUNT)
+        count = MAX_COUNT;
+
+    Engine::arm(count);
+
+    if(shared)
+        _programming = false;
+}
+
 #ifndef __fz3__
 void User_Timer::eoi(Interrupt_Id i) {
     Engine::eoi(i);
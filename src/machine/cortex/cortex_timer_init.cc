@@ -10,6 +10,10 @@ void Timer::init()
     db<Init, Timer>(TRC) << "Timer::init()" << endl;
 
     Engine::init();
+    if(tickless) {
+        _next_tick[CPU::id()] = TSC::time_stamp() + TSC::frequency() / FREQUENCY;
+        program();
+    }
     IC::int_vector(IC::INT_SYS_TIMER, int_handler, eoi);
     IC::enable(IC::INT_SYS_TIMER);
 }
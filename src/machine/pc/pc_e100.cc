@@ -2,6 +2,8 @@
 
 #include <machine/machine.h>
 #include <machine/pc/pc_e100.h>
+#include <process.h>
+#include <synchronizer.h>
 
 __BEGIN_SYS
 
@@ -481,68 +483,15 @@ void E100::handle_int() {
             _rx_ruc_no_more_resources++;
         }
 
-        for(int count = RX_BUFS; count && (_rx_ring[_rx_cur].status & cb_complete); count--, ++_rx_cur %= RX_BUFS) {
-            db<E100>(TRC) << "@ count = " << count << ", _rx_cur = " << _rx_cur << endl;
-
-            // NIC received a frame in _rx_buffer[_rx_cur], let's check if it has already been handled
-            if(_rx_buffer[_rx_cur]->lock()) { // if it wasn't, let's handle it
-                Buffer * buf = _rx_buffer[_rx_cur];
-                Rx_Desc * desc = &_rx_ring[_rx_cur];
-                Frame * frame = buf->frame();
-
-                Frame * desc_frame = reinterpret_cast<Frame *>(desc->frame);
-
-                // For the upper layers, size will represent the size of frame->data<T>()
-                unsigned int size = 0;
-                if(_rx_ring[_rx_cur].actual_count & (RFD_EOF_MASK | RFD_F_MASK)) {
-                    size = _rx_ring[_rx_cur].actual_count & RFD_ACTUAL_COUNT_MASK;
-                }
-                else if(_rx_ring[_rx_cur].actual_count & RFD_F_MASK) {
-                    db<E100>(WRN) << "HDS size" << endl;
-                }
-                else if(! (_rx_ring[_rx_cur].actual_count & RFD_F_MASK)) {
-                    db<E100>(WRN) << "Invalid RFD" << endl;
-                    // Workaround if QEMU patch not applied
-                    // http://patchwork.ozlabs.org/patch/662355/
-                    db<E100>(WRN) << "Assuming size to be 1500" << endl;
-                    size = 1500;
-                    // ----
-                }
-                buf->size(size);
-
-                if(! (_rx_ring[_rx_cur].status & RFD_OK_MASK))
-                    db<E100>(WRN) << "Error on frame reception" << endl;
-
-                db<E100>(INF) << "E100::int:receive desc_frame(s=" << desc_frame->src() << ",d=" << desc_frame->dst() << ",p=" << hex << desc_frame->prot() << dec << ",t=" << (char *) desc_frame->data<void>() << ",s=" << buf->size() << ")" << endl;
-
-                new (frame) Frame(desc_frame->src(), desc_frame->dst(), desc_frame->prot(), desc_frame->data<void>(), buf->size()); // TODO: FIXME. That is creating a copy on a Zero-copy implementation. :P
-
-                db<E100>(INF) << "E100::int:receive(s=" << frame->src() << ",d=" << frame->dst() << ",p=" << hex << frame->header()->prot() << dec << ",t=" << (char *) frame->data<void>() << ",s=" << buf->size() << ")" << endl;
-
-                db<E100>(INF) << "E100::handle_int:desc[" << _rx_cur << "]=" << desc << " => " << *desc << endl;
-
-                _rx_ring[_rx_cur].command = cb_el;
-                _rx_ring[_rx_cur].status = Rx_RFD_NOT_FILLED;
-
-                // try to avoid ruc stop interrupts by "walking" the el bit
-                _rx_ring[_rx_last_el].command &= ~cb_el; // remove previous el bit
-                _rx_last_el = _rx_cur;
-
-                _statistics.rx_packets++;
-                _statistics.rx_bytes += size;
-
-                buf->sfdts = ts;
-
-                db<E100>(TRC) << "Will notify!" << endl;
-                if(!notify(frame->header()->prot(), buf)) { // No one was waiting for this frame, so let it free for receive()
-                    free(buf);
-                    db<E100>(TRC) << "Not notified!" << endl;
-                }
-                else {
-                    db<E100>(TRC) << "Notified!" << endl;
-                }
+        _statistics.rx_interrupts++;
+
+        if(polling && _poller) { // mask receive interrupts and let the poller drain the ring
+            if(stat_ack & (FR | RNR)) {
+                write8(irq_mask_rx, &_csr->scb.cmd_hi);
+                _rx_ready->v();
             }
-        }
+        } else
+            receive(RX_BUFS, ts);
     }
 
     db<E100>(TRC) << "<" << endl;
@@ -551,6 +500,109 @@ void E100::handle_int() {
     // IC::enable(IC::irq2int(_irq));
 }
 
+unsigned int E100::receive(unsigned int budget, const TSC::Time_Stamp & ts)
+{
+    db<E100>(TRC) << "E100::receive(b=" << budget << ")" << endl;
+
+    unsigned int handled = 0;
+    for(int count = RX_BUFS; count && (handled < budget) && (_rx_ring[_rx_cur].status & cb_complete); count--, ++_rx_cur %= RX_BUFS) {
+        db<E100>(TRC) << "@ count = " << count << ", _rx_cur = " << _rx_cur << endl;
+
+        // NIC received a frame in _rx_buffer[_rx_cur], let's check if it has already been handled
+        if(_rx_buffer[_rx_cur]->lock()) { // if it wasn't, let's handle it
+            handled++;
+            Buffer * buf = _rx_buffer[_rx_cur];
+            Rx_Desc * desc = &_rx_ring[_rx_cur];
+            Frame * frame = buf->frame();
+
+            Frame * desc_frame = reinterpret_cast<Frame *>(desc->frame);
+
+            // For the upper layers, size will represent the size of frame->data<T>()
+            unsigned int size = 0;
+            if(_rx_ring[_rx_cur].actual_count & (RFD_EOF_MASK | RFD_F_MASK)) {
+                size = _rx_ring[_rx_cur].actual_count & RFD_ACTUAL_COUNT_MASK;
+            }
+            else if(_rx_ring[_rx_cur].actual_count & RFD_F_MASK) {
+                db<E100>(WRN) << "HDS size" << endl;
+            }
+            else if(! (_rx_ring[_rx_cur].actual_count & RFD_F_MASK)) {
+                db<E100>(WRN) << "Invalid RFD" << endl;
+                // Workaround if QEMU patch not applied
+                // http://patchwork.ozlabs.org/patch/662355/
+                db<E100>(WRN) << "Assuming size to be 1500" << endl;
+                size = 1500;
+                // ----
+            }
+            buf->size(size);
+
+            if(! (_rx_ring[_rx_cur].status & RFD_OK_MASK))
+                db<E100>(WRN) << "Error on frame reception" << endl;
+
+            db<E100>(INF) << "E100::receive desc_frame(s=" << desc_frame->src() << ",d=" << desc_frame->dst() << ",p=" << hex << desc_frame->prot() << dec << ",t=" << (char *) desc_frame->data<void>() << ",s=" << buf->size() << ")" << endl;
+
+            new (frame) Frame(desc_frame->src(), desc_frame->dst(), desc_frame->prot(), desc_frame->data<void>(), buf->size()); // TODO: FIXME. That is creating a copy on a Zero-copy implementation. :P
+
+            db<E100>(INF) << "E100::receive(s=" << frame->src() << ",d=" << frame->dst() << ",p=" << hex << frame->header()->prot() << dec << ",t=" << (char *) frame->data<void>() << ",s=" << buf->size() << ")" << endl;
+
+            db<E100>(INF) << "E100::receive:desc[" << _rx_cur << "]=" << desc << " => " << *desc << endl;
+
+            _rx_ring[_rx_cur].command = cb_el;
+            _rx_ring[_rx_cur].status = Rx_RFD_NOT_FILLED;
+
+            // try to avoid ruc stop interrupts by "walking" the el bit
+            _rx_ring[_rx_last_el].command &= ~cb_el; // remove previous el bit
+            _rx_last_el = _rx_cur;
+
+            _statistics.rx_packets++;
+            _statistics.rx_bytes += size;
+
+            buf->sfdts = ts;
+
+            db<E100>(TRC) << "Will notify!" << endl;
+            if(!notify(frame->header()->prot(), buf)) { // No one was waiting for this frame, so let it free for receive()
+                free(buf);
+                db<E100>(TRC) << "Not notified!" << endl;
+            }
+            else {
+                db<E100>(TRC) << "Notified!" << endl;
+            }
+        }
+    }
+
+    return handled;
+}
+
+void E100::start_poller()
+{
+    db<E100>(TRC) << "E100::start_poller()" << endl;
+
+    _rx_ready = new (SYSTEM) Semaphore(0);
+    _poller = new (SYSTEM) Thread(Thread::Configuration(Thread::READY, Thread::HIGH), &poll, this);
+    _poller->daemon(); // it never exits, so it must not keep the system alive
+}
+
+// Same as PCNet32::poll(), but the ring is handled with interrupts disabled, as handle_int() does
+int E100::poll(E100 * dev)
+{
+    while(true) {
+        dev->_rx_ready->p();
+
+        while(true) {
+            TSC::Time_Stamp ts = (Buffer::Metadata::collect_sfdts) ? TSC::time_stamp() : 0;
+            CPU::int_disable();
+            unsigned int handled = dev->receive(BUDGET, ts);
+            CPU::int_enable();
+            if(handled < BUDGET)
+                break;
+            Thread::yield();
+        }
+
+        dev->i82559_enable_irq();
+    }
+
+    return 0;
+}
+
 void E100::i82559_configure(void)
 {
     configCB->command = cb_config;
@@ -46,6 +46,8 @@ E100::E100(unsigned int unit, const Log_Addr & io_mem, const IO_Irq & irq, DMA_B
     // Rx_Desc Ring
     _rx_cur = 0;
     _rx_last_el = RX_BUFS - 1;
+    _poller = 0;
+    _rx_ready = 0;
     _rx_ring = log;
     _rx_ring_phy = phy;
 
@@ -3,6 +3,7 @@
 #include <architecture.h>
 #include <machine/ic.h>
 #include <machine/timer.h>
+#include <process.h>
 
 extern "C" { void _exit(int s); }
 extern "C" { void __exit(); }
@@ -74,7 +75,12 @@ void IC::dispatch(unsigned int i)
         if((i != INT_SYS_TIMER) || Traits<IC>::hysterically_debugged)
             db<IC>(TRC) << "IC::dispatch(i=" << i << ")" << endl;
 
-        _int_vector[i](i);
+        if(Traits<FPU>::lazy && (i >= INT_FIRST_HARD)) {   // interrupt handlers must not touch the interrupted thread's FPU state
+            Thread::kernel_fpu_begin();
+            _int_vector[i](i);
+            Thread::kernel_fpu_end();
+        } else
+            _int_vector[i](i);
     } else {
         if(i != INT_LAST_HARD)
             db<IC>(TRC) << "IC::spurious interrupt (" << i << ")" << endl;
@@ -917,6 +923,16 @@ void IC::exc_gpf(Reg eip, Reg cs, Reg eflags, Reg error)
 
 void IC::exc_fpu(Reg eip, Reg cs, Reg eflags, Reg error)
 {
+    // EXC_NODEV carries no error code, so the stack has the same layout of an interrupt
+    if(Traits<FPU>::lazy) {
+        CPU::Context::push(true);
+        if(Thread::fpu_trap())          // first FPU instruction since dispatch
+            CPU::Context::pop(true);    // IRET retries it with the FPU enabled
+        db<IC,Machine>(WRN) << "IC::exc_fpu: FPU used by a thread configured without it!" << endl;
+        db<IC,Machine>(WRN) << "The running thread will now be terminated!" << endl;
+        _exit(-1);
+    }
+
     db<IC,Machine>(WRN) << "IC::exc_fpu(cs=" << hex << cs << ",ip=" << reinterpret_cast<void *>(eip) << ",fl=" << eflags << ")" << endl;
     db<IC,Machine>(WRN) << "The running thread will now be terminated!" << endl;
     _exit(-1);
@@ -4,6 +4,8 @@
 #include <machine/pc/pc_pcnet32.h>
 #include <system.h>
 #include <time.h>
+#include <process.h>
+#include <synchronizer.h>
 
 __BEGIN_SYS
 
@@ -17,40 +19,20 @@ PCNet32::~PCNet32()
 
 int PCNet32::send(const Address & dst, const Protocol & prot, const void * data, unsigned int size)
 {
-    // _tx_cur and _rx_cur are simple accelerators to avoid scanning the ring buffer from the beginning.
-    // Losing a write in a race condition is assumed to be harmless. The FINC + CAS alternative seems too expensive.
-
     // Wait for a buffer to become free and seize it
-    int i = _tx_cur;
-    for(bool locked = false; !locked; ) {
-        for(; _tx_ring[i].status & Tx_Desc::OWN; ++i %= TX_BUFS);
-        locked = _tx_buffer[i]->lock();
-    }
-    _tx_cur = (i + 1) % TX_BUFS; // _tx_cur and _rx_cur are simple accelerators to avoid scanning the ring buffer from the beginning.
-                                 // Losing a write in a race condition is assumed to be harmless. The FINC + CAS alternative seems too expensive.
-    Tx_Desc * desc = &_tx_ring[i];
+    unsigned int i = seize();
     Buffer * buf = _tx_buffer[i];
 
     db<PCNet32>(TRC) << "PCNet32::send(s=" << _configuration.address << ",d=" << dst << ",p=" << hex << prot << dec << ",d=" << data << ",s=" << size << ")" << endl;
 
     // Assemble the Ethernet frame
     new (buf->frame()) Frame(_configuration.address, dst, prot, data, size);
+    buf->size(size);
 
-    desc->size = -(size + sizeof(Header)); // 2's comp.
+    post(buf);
+    kick();
 
-    // Status must be set last, since it can trigger a send
-    desc->status = Tx_Desc::OWN | Tx_Desc::STP | Tx_Desc::ENP;
-
-    // Trigger an immediate send poll
-    csr(0, csr(0) | CSR0_TDMD);
-
-    _statistics.tx_packets++;
-    _statistics.tx_bytes += size;
-
-    // Wait for packet to be sent
-    // while(desc->status & Tx_Desc::OWN);
-
-    db<PCNet32>(INF) << "PCNet32::send:desc[" << i << "]=" << desc << " => " << *desc << endl;
+    db<PCNet32>(INF) << "PCNet32::send:desc[" << i << "]=" << &_tx_ring[i] << " => " << _tx_ring[i] << endl;
 
     buf->unlock();
 
@@ -115,12 +97,7 @@ PCNet32::Buffer * PCNet32::alloc(const Address & dst, const Protocol & prot, uns
     // Calculate how many frames are needed to hold the transport PDU and allocate enough buffers
     for(int size = once + payload; size > 0; size -= max_data) {
         // Wait for the next buffer to become free and seize it
-        unsigned int i = _tx_cur;
-        for(bool locked = false; !locked; ) {
-            for(; _tx_ring[i].status & Tx_Desc::OWN; ++i %= TX_BUFS);
-            locked = _tx_buffer[i]->lock();
-        }
-        _tx_cur = (i + 1) % TX_BUFS;
+        unsigned int i = seize();
         Tx_Desc * desc = &_tx_ring[i];
         Buffer * buf = _tx_buffer[i];
 
@@ -136,37 +113,95 @@ PCNet32::Buffer * PCNet32::alloc(const Address & dst, const Protocol & prot, uns
     return pool.head()->object();
 }
 
+unsigned int PCNet32::alloc_batch(Buffer::List * list, const Address & dst, const Protocol & prot, unsigned int n, unsigned int size)
+{
+    db<PCNet32>(TRC) << "PCNet32::alloc_batch(d=" << dst << ",p=" << hex << prot << dec << ",n=" << n << ",s=" << size << ")" << endl;
+
+    if(n > TX_BUFS) {
+        db<PCNet32>(WRN) << "PCNet32::alloc_batch: n > TX_BUFS!" << endl;
+        n = TX_BUFS;
+    }
+
+    for(unsigned int k = 0; k < n; k++) {
+        Buffer * buf = _tx_buffer[seize()];
+        buf->fill(size, _configuration.address, dst, prot);
+        list->insert(buf->link());
+    }
+
+    return n;
+}
+
+// All frames of a chain (e.g. the fragments of a datagram) are handed over to the NIC before it is kicked
 int PCNet32::send(Buffer * buf)
 {
-    unsigned int size = 0;
+    db<PCNet32>(TRC) << "PCNet32::send(buf=" << buf << ")" << endl;
 
-    for(Buffer::Element * el = buf->link(); el; el = el->next()) {
-        buf = el->object();
-        Tx_Desc * desc = reinterpret_cast<Tx_Desc *>(buf->back());
+    unsigned int size = 0;
 
-        db<PCNet32>(TRC) << "PCNet32::send(buf=" << buf << ")" << endl;
+    Buffer::Element * el = buf->link();
+    for(Buffer::Element * next; el; el = next) {
+        next = el->next(); // the buffer can be seized again as soon as it's posted
+        size += post(el->object());
+    }
 
-        db<PCNet32>(INF) << "PCNet32::send:buf=" << buf << " => " << *buf << endl;
+    kick();
 
-        desc->size = -(buf->size() + sizeof(Header)); // 2's comp.
+    return size;
+}
 
-        // Status must be set last, since it can trigger a send
-        desc->status = Tx_Desc::OWN | Tx_Desc::STP | Tx_Desc::ENP;
+int PCNet32::send(Buffer::List * list)
+{
+    db<PCNet32>(TRC) << "PCNet32::send(list=" << list << ",n=" << list->size() << ")" << endl;
 
-        // Trigger an immediate send poll
-        csr(0, csr(0) | CSR0_TDMD);
+    unsigned int size = 0;
 
-        size += buf->size();
+    while(Buffer::Element * el = list->remove())
+        size += post(el->object());
 
-        _statistics.tx_packets++;
-        _statistics.tx_bytes += buf->size();
+    kick();
 
-        db<PCNet32>(INF) << "PCNet32::send:desc=" << desc << " => " << *desc << endl;
+    return size;
+}
 
-        // Wait for packet to be sent and unlock the respective buffer
-        while(desc->status & Tx_Desc::OWN);
-        buf->unlock();
+// Seize the next free transmit buffer. Descriptors are given back by the NIC as it clears OWN, so completions are reclaimed
+// lazily and in bulk by this scan instead of by waiting for each frame or by taking transmit interrupts.
+unsigned int PCNet32::seize()
+{
+    // _tx_cur and _rx_cur are simple accelerators to avoid scanning the ring buffer from the beginning.
+    // Losing a write in a race condition is assumed to be harmless. The FINC + CAS alternative seems too expensive.
+    unsigned int i = _tx_cur;
+    for(bool locked = false; !locked; ) {
+        for(; _tx_ring[i].status & Tx_Desc::OWN; ++i %= TX_BUFS);
+        locked = _tx_buffer[i]->lock();
+        if(locked && (_tx_ring[i].status & Tx_Desc::OWN)) { // posted by someone else in between
+            _tx_buffer[i]->unlock();
+            locked = false;
+        }
     }
+    _tx_cur = (i + 1) % TX_BUFS;
+
+    return i;
+}
+
+// Hand a seized buffer over to the NIC (which will only notice it after the next kick()) and release it
+unsigned int PCNet32::post(Buffer * buf)
+{
+    Tx_Desc * desc = reinterpret_cast<Tx_Desc *>(buf->back());
+    unsigned int size = buf->size();
+
+    db<PCNet32>(INF) << "PCNet32::post:buf=" << buf << " => " << *buf << endl;
+
+    desc->size = -(size + sizeof(Header)); // 2's comp.
+
+    // Status must be set last, since it can trigger a send
+    desc->status = Tx_Desc::OWN | Tx_Desc::STP | Tx_Desc::ENP;
+
+    _statistics.tx_packets++;
+    _statistics.tx_bytes += size;
+
+    db<PCNet32>(INF) << "PCNet32::post:desc=" << desc << " => " << *desc << endl;
+
+    buf->unlock();
 
     return size;
 }
@@ -195,15 +230,17 @@ void PCNet32::free(Buffer * buf)
     }
 }
 
-void PCNet32::receive()
+unsigned int PCNet32::receive(unsigned int budget)
 {
     TSC::Time_Stamp ts = (Buffer::Metadata::collect_sfdts) ? TSC::time_stamp() : 0;
 
-    db<PCNet32>(TRC) << "PCNet32::receive()" << endl;
+    db<PCNet32>(TRC) << "PCNet32::receive(b=" << budget << ")" << endl;
 
-    for(unsigned int count = RX_BUFS, i = _rx_cur; count && !(_rx_ring[i].status & Rx_Desc::OWN); count--, ++i %= RX_BUFS, _rx_cur = i) {
+    unsigned int handled = 0;
+    for(unsigned int count = RX_BUFS, i = _rx_cur; count && (handled < budget) && !(_rx_ring[i].status & Rx_Desc::OWN); count--, ++i %= RX_BUFS, _rx_cur = i) {
         // NIC received a frame in _rx_buffer[_rx_cur], let's check if it has already been handled
         if(_rx_buffer[i]->lock()) { // if it wasn't, let's handle it
+            handled++;
             Buffer * buf = _rx_buffer[i];
             Rx_Desc * desc = &_rx_ring[i];
             Frame * frame = buf->frame();
@@ -225,6 +262,35 @@ void PCNet32::receive()
                 free(buf);
         }
     }
+
+    return handled;
+}
+
+void PCNet32::start_poller()
+{
+    db<PCNet32>(TRC) << "PCNet32::start_poller()" << endl;
+
+    _rx_ready = new (SYSTEM) Semaphore(0);
+    _poller = new (SYSTEM) Thread(Thread::Configuration(Thread::READY, Thread::HIGH), &poll, this);
+    _poller->daemon(); // it never exits, so it must not keep the system alive
+}
+
+// Frames are handled in rounds of at most BUDGET, yielding the CPU in between, and receive interrupts
+// are only unmasked once the ring is empty (a frame arriving meanwhile sets RINT and raises a new one).
+// Each frame still reaches the observers through its own notify(), there is no batched notification.
+int PCNet32::poll(PCNet32 * dev)
+{
+    while(true) {
+        dev->_rx_ready->p();
+
+        while(dev->receive(BUDGET) == BUDGET)
+            Thread::yield();
+
+        if(dev->observers())
+            dev->csr(3, dev->csr(3) & ~CSR3_RINTM);
+    }
+
+    return 0;
 }
 
 bool PCNet32::reconfigure(const Configuration * c = 0)
@@ -370,13 +436,20 @@ void PCNet32::handle_int()
         }
 
         if(csr0 & CSR0_RINT) { // Frame received (possibly multiple, let's handle a whole round on the ring buffer)
-            // Note that ISRs in EPOS are reentrant, that's why locking was carefully made atomic
-            // Therefore, several instances of this code can compete to handle received buffers
-
-            // TODO: this serialization is much too restrictive. It was done this way for students to play with
-            IC::disable(IC::irq2int(_irq));
-            receive();
-            IC::enable(IC::irq2int(_irq));
+            _statistics.rx_interrupts++;
+
+            if(polling && _poller) { // mask receive interrupts and let the poller drain the ring
+                csr(3, csr(3) | CSR3_RINTM);
+                _rx_ready->v();
+            } else {
+                // Note that ISRs in EPOS are reentrant, that's why locking was carefully made atomic
+                // Therefore, several instances of this code can compete to handle received buffers
+
+                // TODO: this serialization is much too restrictive. It was done this way for students to play with
+                IC::disable(IC::irq2int(_irq));
+                receive(RX_BUFS);
+                IC::enable(IC::irq2int(_irq));
+            }
  	}
 
         if(csr0 & CSR0_ERR) { // Error
@@ -20,6 +20,8 @@ PCNet32::PCNet32(unsigned int unit, IO_Port io_port, IO_Irq irq, DMA_Buffer * dm
     _io_port = io_port;
     _irq = irq;
     _dma_buf = dma_buf;
+    _poller = 0;
+    _rx_ready = 0;
 
     // Distribute the DMA_Buffer allocated by init()
     Log_Addr log = _dma_buf->log_address();
@@ -6,6 +6,7 @@
 #include <machine/machine.h>
 #include <machine/pc/pc_rtl8139.h>
 #include <process.h>
+#include <synchronizer.h>
 #include <system.h>
 #include <time.h>
 
@@ -286,50 +287,94 @@ void RTL8139::handle_int()
         // NIC received frame(s)
         db<RTL8139>(TRC) << "ROK" << endl;
 
-        while ((CPU::in16(_io_port + CBR) < _rx_read) || 
-            ((_rx_read + sizeof(Frame)) < CPU::in16(_io_port + CBR)) // while there is pending receive packets
-            ) {
-            db<RTL8139>(TRC) << "CBR=" << (CPU::in16(_io_port + CBR)) << ",rx=" << _rx_read << endl;
-            unsigned int * rx = (unsigned int *) (_rx_buffer + _rx_read);
-            db<RTL8139>(TRC) << "rx=" << rx << endl;
-            unsigned int header = *rx;
-            db<RTL8139>(TRC) << "header=" << hex << header << endl;
-            unsigned int packet_len = (header >> 16);
-            unsigned int status = header & 0xffff;
-            rx++;
-
-            db<RTL8139>(TRC) << "packet_len=" << packet_len << endl;
-            db<RTL8139>(TRC) << "status=" << status << endl;
-
-            Frame * frame = reinterpret_cast<Frame *>(rx);
-            db<RTL8139>(TRC) << "frame src " << frame->src() << endl;
-            Buffer * buf = new (SYSTEM) Buffer(this, rx);
-            memcpy(reinterpret_cast<void *>(buf->frame()), frame, sizeof(Frame));
-            db<RTL8139>(TRC) << "buff src " << buf->frame()->src() << endl;
-
-            buf->sfdts = ts;
-            IC::disable(IC::irq2int(_irq));
-            if(!notify(buf->frame()->prot(), buf))
-                free(buf);
-
-            // update CAPR
-            _rx_read += packet_len + 4;
-            _rx_read =  (_rx_read + 3) & ~3;
-
-            if(_rx_read > RX_NO_WRAP_SIZE) {
-                _rx_read -= RX_NO_WRAP_SIZE;
-                db<RTL8139>(TRC) << "\tWRAPPED " << _rx_read << endl;
-            }
+        _statistics.rx_interrupts++;
+
+        if(polling && _poller) { // mask receive interrupts and let the poller drain the buffer
+            CPU::out16(_io_port + IMR, CPU::in16(_io_port + IMR) & ~ROK);
+            _rx_ready->v();
+        } else
+            receive(~0U, ts);
+    }
+}
 
-            _statistics.rx_packets++;
-            _statistics.rx_bytes += packet_len;
-            CPU::out16(_io_port + CAPR, _rx_read - 0x10);
-            IC::enable(IC::irq2int(_irq));
+unsigned int RTL8139::receive(unsigned int budget, const TSC::Time_Stamp & ts)
+{
+    db<RTL8139>(TRC) << "RTL8139::receive(b=" << budget << ")" << endl;
+
+    unsigned int handled = 0;
+    while ((handled < budget) && ((CPU::in16(_io_port + CBR) < _rx_read) || 
+        ((_rx_read + sizeof(Frame)) < CPU::in16(_io_port + CBR))) // while there is pending receive packets
+        ) {
+        handled++;
+        db<RTL8139>(TRC) << "CBR=" << (CPU::in16(_io_port + CBR)) << ",rx=" << _rx_read << endl;
+        unsigned int * rx = (unsigned int *) (_rx_buffer + _rx_read);
+        db<RTL8139>(TRC) << "rx=" << rx << endl;
+        unsigned int header = *rx;
+        db<RTL8139>(TRC) << "header=" << hex << header << endl;
+        unsigned int packet_len = (header >> 16);
+        unsigned int status = header & 0xffff;
+        rx++;
+
+        db<RTL8139>(TRC) << "packet_len=" << packet_len << endl;
+        db<RTL8139>(TRC) << "status=" << status << endl;
+
+        Frame * frame = reinterpret_cast<Frame *>(rx);
+        db<RTL8139>(TRC) << "frame src " << frame->src() << endl;
+        Buffer * buf = new (SYSTEM) Buffer(this, rx);
+        memcpy(reinterpret_cast<void *>(buf->frame()), frame, sizeof(Frame));
+        db<RTL8139>(TRC) << "buff src " << buf->frame()->src() << endl;
+
+        buf->sfdts = ts;
+        IC::disable(IC::irq2int(_irq));
+        if(!notify(buf->frame()->prot(), buf))
+            free(buf);
+
+        // update CAPR
+        _rx_read += packet_len + 4;
+        _rx_read =  (_rx_read + 3) & ~3;
+
+        if(_rx_read > RX_NO_WRAP_SIZE) {
+            _rx_read -= RX_NO_WRAP_SIZE;
+            db<RTL8139>(TRC) << "\tWRAPPED " << _rx_read << endl;
         }
 
+        _statistics.rx_packets++;
+        _statistics.rx_bytes += packet_len;
+        CPU::out16(_io_port + CAPR, _rx_read - 0x10);
+        IC::enable(IC::irq2int(_irq));
     }
+
+    return handled;
+}
+
+void RTL8139::start_poller()
+{
+    db<RTL8139>(TRC) << "RTL8139::start_poller()" << endl;
+
+    _rx_ready = new (SYSTEM) Semaphore(0);
+    _poller = new (SYSTEM) Thread(Thread::Configuration(Thread::READY, Thread::HIGH), &poll, this);
+    _poller->daemon(); // it never exits, so it must not keep the system alive
 }
 
+// Same as PCNet32::poll(); frames arriving while ROK is masked are still flagged in ISR, so unmasking it raises a new interrupt
+int RTL8139::poll(RTL8139 * dev)
+{
+    while(true) {
+        dev->_rx_ready->p();
+
+        while(true) {
+            TSC::Time_Stamp ts = (Buffer::Metadata::collect_sfdts) ? TSC::time_stamp() : 0;
+            if(dev->receive(BUDGET, ts) < BUDGET)
+                break;
+            Thread::yield();
+        }
+
+        if(dev->observers())
+            CPU::out16(dev->_io_port + IMR, CPU::in16(dev->_io_port + IMR) | ROK);
+    }
+
+    return 0;
+}
 
 void RTL8139::int_handler(IC::Interrupt_Id interrupt)
 {
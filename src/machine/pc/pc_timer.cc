@@ -6,16 +6,40 @@
 __BEGIN_SYS
 
 Timer * Timer::_channels[CHANNELS];
+volatile TSC::Time_Stamp Timer::_deadline;
+volatile unsigned int Timer::_deadline_cpu;
+volatile TSC::Time_Stamp Timer::_next_tick[Traits<Machine>::CPUS];
 
 void Timer::int_handler(Interrupt_Id i)
 {
+    if(tickless) {
+        TSC::Time_Stamp now = TSC::time_stamp();
+
+        bool alarm = (CPU::id() == _deadline_cpu) && _deadline && (now >= _deadline);
+        if(alarm)
+            _deadline = 0; // the ALARM handler will set the next one
+
+        bool tick = (now >= _next_tick[CPU::id()]);
+        if(tick)
+            while(_next_tick[CPU::id()] <= now)
+                _next_tick[CPU::id()] += TSC::frequency() / FREQUENCY;
+
+        program(); // before calling handlers, which might not return soon
+
+        if(alarm && _channels[ALARM])
+            _channels[ALARM]->_handler(i);
+
+        if(!tick)
+            return;
+    }
+
     if((CPU::id() == CPU::BSP) && _channels[USER] && (--_channels[USER]->_current[CPU::BSP] <= 0)) {
         if(_channels[USER]->_retrigger)
             _channels[USER]->_current[CPU::BSP] = _channels[USER]->_initial;
         _channels[USER]->_handler(i);
     }
 
-    if((CPU::id() == CPU::BSP) && _channels[ALARM] && (--_channels[ALARM]->_current[CPU::BSP] <= 0)) {
+    if(!tickless && (CPU::id() == CPU::BSP) && _channels[ALARM] && (--_channels[ALARM]->_current[CPU::BSP] <= 0)) {
         _channels[ALARM]->_current[CPU::BSP] = _channels[ALARM]->_initial;
         _channels[ALARM]->_handler(i);
     }
@@ -26,4 +50,24 @@ void Timer::int_handler(Interrupt_Id i)
     }
 }
 
+void Timer::program()
+{
+    TSC::Time_Stamp now = TSC::time_stamp();
+    TSC::Time_Stamp next = periodic() ? _next_tick[CPU::id()] : ~0ULL;
+    if((CPU::id() == _deadline_cpu) && _deadline && (_deadline < next))
+        next = _deadline;
+
+    unsigned long long delta = (next > now) ? next - now : 0;
+    if(delta > TSC::frequency()) // keeps the conversion below from overflowing
+        delta = TSC::frequency();
+
+    unsigned long long count = delta * Engine::clock() / TSC::frequency();
+    if(count < MIN_COUNT)
+        count = MIN_COUNT;
+    if(count > MAX_COUNT)
+        count = MAX_COUNT;
+
+    Engine::config(0, count, true, false);
+}
+
 __END_SYS
@@ -15,7 +15,11 @@ void Timer::init()
         IC::int_vector(IC::INT_SYS_TIMER, int_handler);
 
     disable();
-    reset();
+    if(tickless) {
+        _next_tick[CPU::id()] = TSC::time_stamp() + TSC::frequency() / FREQUENCY;
+        program();
+    } else
+        reset();
     enable();
 
     IC::enable(IC::INT_SYS_TIMER);
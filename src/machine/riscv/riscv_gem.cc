@@ -178,6 +178,73 @@ int GEM::send(Buffer * buf)
     return size;
 }
 
+unsigned int GEM::alloc_batch(Buffer::List * list, const Address & dst, const Protocol & prot, unsigned int n, unsigned int size)
+{
+    db<GEM>(TRC) << "GEM::alloc_batch(d=" << dst << ",p=" << hex << prot << dec << ",n=" << n << ",s=" << size << ")" << endl;
+
+    if(n > TX_BUFS) {
+        db<GEM>(WRN) << "GEM::alloc_batch: n > TX_BUFS!" << endl;
+        n = TX_BUFS;
+    }
+
+    // Unlike alloc(), descriptors stay with the host until send(list)
+    for(unsigned int k = 0; k < n; k++) {
+        Buffer * buf = _tx_buffer[seize()];
+        buf->fill(size, _configuration.address, dst, prot);
+        list->insert(buf->link());
+    }
+
+    return n;
+}
+
+// All frames in the list are handed over to the NIC before transmission is started, so the whole batch costs a single TXSTART
+int GEM::send(Buffer::List * list)
+{
+    db<GEM>(TRC) << "GEM::send(list=" << list << ",n=" << list->size() << ")" << endl;
+
+    unsigned int size = 0;
+
+    while(Buffer::Element * el = list->remove()) {
+        Buffer * buf = el->object();
+        Tx_Desc * desc = reinterpret_cast<Tx_Desc *>(buf->back());
+
+        db<GEM>(INF) << "GEM::send:buf=" << buf << " => " << *buf << endl;
+
+        desc->size(buf->size() + sizeof(Header));
+
+        // Give the NIC ownership of the buffer (so it can send it)
+        desc->ctrl &= ~Tx_Desc::OWN;
+
+        size += buf->size();
+
+        _statistics.tx_packets++;
+        _statistics.tx_bytes += buf->size();
+
+        buf->unlock();
+    }
+
+    start_tx();
+
+    return size;
+}
+
+// Seize the next transmit buffer given back by the NIC (OWN set)
+unsigned int GEM::seize()
+{
+    unsigned int i = _tx_cur;
+    for(bool locked = false; !locked; ) {
+        for(; !(_tx_ring[i].ctrl & Tx_Desc::OWN); ++i %= TX_BUFS);
+        locked = _tx_buffer[i]->lock();
+        if(locked && !(_tx_ring[i].ctrl & Tx_Desc::OWN)) { // handed over by someone else in between
+            _tx_buffer[i]->unlock();
+            locked = false;
+        }
+    }
+    _tx_cur = (i + 1) % TX_BUFS;
+
+    return i;
+}
+
 void GEM::free(Buffer * buf)
 {
     db<GEM>(TRC) << "GEM::free(buf=" << buf << ")" << endl;
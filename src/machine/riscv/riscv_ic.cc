@@ -62,7 +62,12 @@ void IC::dispatch()
 
     CPU::gp(a0); // ensure exit() gets the correct return code in gp (a0 will be used to pass id)
     CPU::a1(a1); // ensure syscalled() gets the correct message in a1
-    _int_vector[id](id);
+    if(Traits<FPU>::lazy && (id >= EXCS)) {     // interrupt handlers must not touch the interrupted thread's FPU state
+        Thread::kernel_fpu_begin();
+        _int_vector[id](id);
+        Thread::kernel_fpu_end();
+    } else
+        _int_vector[id](id);
 
     if(id > HARD_INT) {
         complete(int2irq(id));
@@ -77,6 +82,10 @@ void IC::int_not(Interrupt_Id id)
 
 void IC::exception(Interrupt_Id id)
 {
+    if((id == CPU::EXC_IILLEGAL) && Thread::fpu_trap()) // first FPU instruction since dispatch (see Traits<FPU>::lazy)
+        return;
+
+    // No kernel FPU section here: exceptions only log and terminate the faulting thread, without FP code (system calls get one in Agent::exec())
     CPU::Log_Addr ksp = CPU::sp();
     CPU::Log_Addr usp = multitask ? CPU::sscratch() : 0;
     CPU::Log_Addr atp = supervisor ? CPU::satp() : 0;
@@ -6,10 +6,32 @@
 __BEGIN_SYS
 
 Timer * Timer::_channels[CHANNELS];
+volatile TSC::Time_Stamp Timer::_deadline;
+volatile unsigned int Timer::_deadline_cpu;
+volatile TSC::Time_Stamp Timer::_next_tick[Traits<Machine>::CPUS];
 
 void Timer::int_handler(Interrupt_Id i)
 {
-    if((CPU::id() == CPU::BSP) && _channels[ALARM] && (--_channels[ALARM]->_current[CPU::BSP] <= 0)) {
+    if(tickless) {
+        TSC::Time_Stamp now = TSC::time_stamp();
+
+        bool alarm = (CPU::id() == _deadline_cpu) && _deadline && (now >= _deadline);
+        if(alarm)
+            _deadline = 0; // the ALARM handler will set the next one
+
+        bool tick = (now >= _next_tick[CPU::id()]);
+        if(tick)
+            while(_next_tick[CPU::id()] <= now)
+                _next_tick[CPU::id()] += CLOCK / FREQUENCY;
+
+        program(); // before calling handlers, which might not return soon
+
+        if(alarm && _channels[ALARM])
+            _channels[ALARM]->_handler(i);
+
+        if(!tick)
+            return;
+    } else if((CPU::id() == CPU::BSP) && _channels[ALARM] && (--_channels[ALARM]->_current[CPU::BSP] <= 0)) {
         _channels[ALARM]->_current[CPU::BSP] = _channels[ALARM]->_initial;
         _channels[ALARM]->_handler(i);
     }
@@ -25,4 +47,13 @@ void Timer::int_handler(Interrupt_Id i)
     }
 }
 
+void Timer::program()
+{
+    TSC::Time_Stamp next = periodic() ? _next_tick[CPU::id()] : ~0ULL;
+    if((CPU::id() == _deadline_cpu) && _deadline && (_deadline < next))
+        next = _deadline;
+
+    mtimecmp(next); // MTIME is the TSC, so no conversion is needed
+}
+
 __END_SYS
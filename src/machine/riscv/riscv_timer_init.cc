@@ -15,7 +15,11 @@ void Timer::init()
     if(CPU::id() == CPU::BSP)
         IC::int_vector(IC::INT_SYS_TIMER, int_handler);
 
-    reset();
+    if(tickless) {
+        _next_tick[CPU::id()] = TSC::time_stamp() + CLOCK / FREQUENCY;
+        program();
+    } else
+        reset();
     IC::enable(IC::INT_SYS_TIMER);
 }
 
@@ -48,20 +48,212 @@ IP::~IP()
     _nic->detach(this, NIC<Ethernet>::PROTO_IP);
 }
 
+void IP::Router::insert(NIC<Ethernet> * nic, IP * ip, ARP<NIC<Ethernet>, IP> * arp, const Address & d, const Address & g, const Address & m, unsigned int t, unsigned int w)
+{
+    Route * route = new (SYSTEM) Route(nic, ip, arp, d, g, m, t, w);
+
+    db<IP>(TRC) << "IP::Router::insert() => " << *route << endl;
+
+    unsigned int length = ~bits(m) ? __builtin_clz(~bits(m)) : 32;
+    if(bits(m) != mask(length))
+        db<IP>(WRN) << "IP::Router::insert: non-contiguous genmask " << m << " taken as /" << length << endl;
+    unsigned int prefix = bits(d) & mask(length);
+
+    // At most two nodes are needed and they are allocated beforehand, since the heap must not be used under the lock
+    Node * leaf = new (SYSTEM) Node(prefix, length);
+    Node * fork = new (SYSTEM) Node(0, 0);
+
+    lock();
+
+    Node * n;
+    for(Node ** link = &_root; ; ) {
+        n = *link;
+        if(!n) {
+            n = *link = leaf;
+            leaf = 0;
+            break;
+        }
+
+        unsigned int common = (n->length < length) ? n->length : length;
+        unsigned int diff = (n->prefix ^ prefix) & mask(common);
+        if(diff)
+            common = __builtin_clz(diff);
+
+        if(common == n->length) {
+            if(common == length) // same prefix
+                break;
+            link = &n->child[bit(prefix, n->length)];
+        } else { // the new prefix diverges from n's (or contains it), so a node for the common part takes n's place
+            fork->prefix = prefix & mask(common);
+            fork->length = common;
+            fork->child[bit(n->prefix, common)] = n;
+            *link = fork;
+            if(common == length)
+                n = fork;
+            else {
+                fork->child[bit(prefix, common)] = leaf;
+                n = leaf;
+                leaf = 0;
+            }
+            fork = 0;
+            break;
+        }
+    }
+
+    Route ** r = &n->routes;
+    while(*r)
+        r = &(*r)->_next;
+    *r = route;
+
+    invalidate();
+
+    unlock();
+
+    if(leaf)
+        delete leaf;
+    if(fork)
+        delete fork;
+}
+
+void IP::Router::remove(const Address & to)
+{
+    db<IP>(TRC) << "IP::Router::remove(to=" << to << ")" << endl;
+
+    Route * route = 0;
+    Node * garbage[2] = { 0, 0 };
+
+    lock();
+
+    Node ** up = 0;
+    Node ** link = find(bits(to), &up);
+    if(link) {
+        Node * n = *link;
+
+        route = best(n->routes);
+        Route ** r = &n->routes;
+        while(*r != route)
+            r = &(*r)->_next;
+        *r = route->_next;
+
+        // Keep the trie compressed: nodes without routes must have two children
+        if(!n->routes && !(n->child[0] && n->child[1])) {
+            *link = n->child[0] ? n->child[0] : n->child[1];
+            garbage[0] = n;
+            if(!*link && up && !(*up)->routes) {
+                Node * p = *up;
+                *up = p->child[0] ? p->child[0] : p->child[1];
+                garbage[1] = p;
+            }
+        }
+
+        invalidate();
+    }
+
+    unlock();
+
+    if(route) {
+        db<IP>(INF) << "IP::Router::remove: removing and deleting " << *route << endl;
+        delete route;
+    }
+    for(unsigned int i = 0; i < 2; i++)
+        if(garbage[i])
+            delete garbage[i];
+}
+
+IP::Route * IP::Router::search(const Address & to, MAC_Address * mac)
+{
+    db<IP>(TRC) << "IP::Router::search(to=" << to << ")" << endl;
+
+    Entry * e = &_cache[hash(to)];
+    MAC_Address ha = MAC_Address(MAC_Address::NULL);
+    Route * route;
+    bool hit;
+
+    lock();
+    unsigned int version = _version;
+    hit = e->route && (e->to == to);
+    if(hit) {
+        route = e->route;
+        ha = e->mac;
+    } else {
+        Node ** link = find(bits(to));
+        route = link ? best((*link)->routes) : 0;
+    }
+    unlock();
+
+    if(!route) {
+        db<IP>(INF) << "IP::Router::search: no route to " << to << endl;
+        return 0;
+    }
+
+    if(mac && !ha) {
+        ha = route->arp()->resolve((route->gateway() == route->ip()->address()) ? to : route->gateway());
+        hit = false;
+    }
+
+    if(!hit) {
+        lock();
+        if(version == _version) { // routes didn't change meanwhile
+            e->to = to;
+            e->route = route;
+            e->mac = ha;
+        }
+        unlock();
+    }
+
+    if(mac)
+        *mac = ha;
+
+    db<IP>(INF) << "IP::Router::search: found route to " << to << " => " << *route << endl;
+
+    return route;
+}
+
+// Link to the deepest node with routes whose prefix matches "key" (and, in "up", the link to its parent)
+IP::Router::Node ** IP::Router::find(unsigned int key, Node *** up)
+{
+    Node ** found = 0;
+    Node ** parent = 0;
+
+    for(Node ** link = &_root; *link && !(((*link)->prefix ^ key) & mask((*link)->length)); ) {
+        Node * n = *link;
+        if(n->routes) {
+            found = link;
+            if(up)
+                *up = parent;
+        }
+        if(n->length == 32)
+            break;
+        parent = link;
+        link = &n->child[bit(key, n->length)];
+    }
+
+    return found;
+}
+
+IP::Route * IP::Router::best(Route * routes)
+{
+    Route * route = routes;
+    for(Route * r = routes->_next; r; r = r->_next)
+        if(r->_metric < route->_metric)
+            route = r;
+    return route;
+}
+
 IP::Buffer * IP::alloc(const Address & to, const Protocol & prot, unsigned int once, unsigned int payload)
 {
     db<IP>(TRC) << "IP::alloc(to=" << to << ",prot=" << prot << ",on=" << once<< ",pl=" << payload << ")" << endl;
 
-    Route * through = _router.search(to);
-    IP * ip = through->ip();
-    NIC<Ethernet> * nic = through->nic();
-
-    MAC_Address mac = through->arp()->resolve((through->gateway() == through->ip()->address()) ? to : through->gateway());
-    if(!mac) {
+    MAC_Address mac;
+    Route * through = _router.search(to, &mac);
+    if(!through || !mac) {
          db<IP>(WRN) << "IP::alloc: destination host (" << to << ") unreachable!" << endl;
          return 0;
     }
 
+    IP * ip = through->ip();
+    NIC<Ethernet> * nic = through->nic();
+
     Buffer * pool = nic->alloc(mac, NIC<Ethernet>::PROTO_IP, once, sizeof(IP::Header), payload);
     if(!pool)
         return 0;
@@ -93,6 +285,17 @@ int IP::send(Buffer * buf)
     return buf->nic()->send(buf); // implicitly releases the pool
 }
 
+// Datagrams to the same destination (e.g. a train of TCP segments) handed over to the NIC at once
+int IP::send(Buffer::List * train)
+{
+    db<IP>(TRC) << "IP::send(train=" << train << ",n=" << train->size() << ")" << endl;
+
+    if(train->empty())
+        return 0;
+
+    return train->head()->object()->nic()->send(train); // implicitly releases all pools
+}
+
 void IP::update(NIC<Ethernet>::Observed * obs, const NIC<Ethernet>::Protocol & prot, Buffer * buf)
 {
     db<IP>(TRC) << "IP::update(obs=" << obs << ",prot=" << hex << prot << dec << ",buf=" << buf << ")" << endl;
@@ -173,19 +376,119 @@ unsigned short IP::checksum(const void * data, unsigned int size)
 {
     db<IP>(TRC) << "IP::checksum(d=" << data << ",s=" << size << ")" << endl;
 
+    return ~sum(data, size);
+}
+
+// Data is added in native 16- and 32-bit words to a 64-bit accumulator, which is folded and converted to network
+// order only at the end, since one's complement sums are independent of byte order (RFC 1071)
+unsigned long IP::sum(const void * data, unsigned int size, unsigned long partial)
+{
     const unsigned char * ptr = reinterpret_cast<const unsigned char *>(data);
-    unsigned long sum = 0;
 
-    for(unsigned int i = 0; i < size; i += 2)
-        sum += (ptr[i] << 8) | ptr[i+1];
+    if(!size)
+        return fold(partial);
 
-    if(size & 1)
-        sum += ptr[size - 1];
+    if(reinterpret_cast<unsigned long>(ptr) & 1) {
+        // Sum the rest from an even address: that swaps the bytes of every word and hence of the sum
+        unsigned long rest = sum(ptr + 1, size - 1);
+        return fold(partial + (ptr[0] << 8) + (((rest & 0xff) << 8) | (rest >> 8)));
+    }
 
-    while(sum >> 16)
-        sum = (sum & 0xffff) + (sum >> 16);
+    unsigned long long acc = 0;
 
-    return ~sum;
+    if(!Traits<CPU>::unaligned_memory_access && (reinterpret_cast<unsigned long>(ptr) & 2) && (size >= 2)) {
+        acc += *reinterpret_cast<const unsigned short *>(ptr);
+        ptr += 2;
+        size -= 2;
+    }
+
+    const unsigned int * w = reinterpret_cast<const unsigned int *>(ptr);
+    for(; size >= 32; size -= 32, w += 8) {
+        acc += w[0]; acc += w[1]; acc += w[2]; acc += w[3];
+        acc += w[4]; acc += w[5]; acc += w[6]; acc += w[7];
+    }
+    for(; size >= 4; size -= 4)
+        acc += *w++;
+
+    ptr = reinterpret_cast<const unsigned char *>(w);
+    if(size >= 2) {
+        acc += *reinterpret_cast<const unsigned short *>(ptr);
+        ptr += 2;
+        size -= 2;
+    }
+    if(size)
+        acc += trailer(ptr[0]);
+
+    return fold(partial + ntohs(fold(acc)));
+}
+
+unsigned long IP::copy_and_sum(void * to, const void * from, unsigned int size, unsigned long partial)
+{
+    unsigned char * dst = reinterpret_cast<unsigned char *>(to);
+    const unsigned char * src = reinterpret_cast<const unsigned char *>(from);
+    unsigned long d = reinterpret_cast<unsigned long>(dst);
+    unsigned long s = reinterpret_cast<unsigned long>(src);
+
+    // Words can only be used if both addresses are even and (for strict alignment) equally aligned
+    if((d & 1) || (s & 1) || (!Traits<CPU>::unaligned_memory_access && ((d ^ s) & 3))) {
+        memcpy(to, from, size);
+        return sum(to, size, partial);
+    }
+
+    unsigned long long acc = 0;
+
+    if(!Traits<CPU>::unaligned_memory_access && (d & 2) && (size >= 2)) {
+        unsigned short h = *reinterpret_cast<const unsigned short *>(src);
+        *reinterpret_cast<unsigned short *>(dst) = h;
+        acc += h;
+        dst += 2;
+        src += 2;
+        size -= 2;
+    }
+
+    unsigned int * dw = reinterpret_cast<unsigned int *>(dst);
+    const unsigned int * sw = reinterpret_cast<const unsigned int *>(src);
+    for(; size >= 32; size -= 32, dw += 8, sw += 8) {
+        unsigned int w0 = sw[0], w1 = sw[1], w2 = sw[2], w3 = sw[3];
+        unsigned int w4 = sw[4], w5 = sw[5], w6 = sw[6], w7 = sw[7];
+        dw[0] = w0; dw[1] = w1; dw[2] = w2; dw[3] = w3;
+        dw[4] = w4; dw[5] = w5; dw[6] = w6; dw[7] = w7;
+        acc += w0; acc += w1; acc += w2; acc += w3;
+        acc += w4; acc += w5; acc += w6; acc += w7;
+    }
+    for(; size >= 4; size -= 4) {
+        unsigned int w = *sw++;
+        *dw++ = w;
+        acc += w;
+    }
+
+    dst = reinterpret_cast<unsigned char *>(dw);
+    src = reinterpret_cast<const unsigned char *>(sw);
+    if(size >= 2) {
+        unsigned short h = *reinterpret_cast<const unsigned short *>(src);
+        *reinterpret_cast<unsigned short *>(dst) = h;
+        acc += h;
+        dst += 2;
+        src += 2;
+        size -= 2;
+    }
+    if(size) {
+        dst[0] = src[0];
+        acc += trailer(src[0]);
+    }
+
+    return fold(partial + ntohs(fold(acc)));
+}
+
+// RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m')
+unsigned short IP::checksum(unsigned short checksum, unsigned short from, unsigned short to)
+{
+    return ~fold((~checksum & 0xffff) + (~from & 0xffff) + to);
+}
+
+unsigned short IP::checksum(unsigned short checksum, const void * from, const void * to, unsigned int size)
+{
+    return ~fold((~checksum & 0xffff) + (~sum(from, size) & 0xffff) + sum(to, size));
 }
 
 __END_SYS
@@ -30,7 +30,7 @@ IP::IP(NIC<Ethernet> * nic, unsigned int config, const Address & a, const Addres
     _router.insert(_nic, this, &_arp, _address & _netmask, _address, _netmask);
 
     if(_gateway) {
-        _router.insert(_nic, this, &_arp, Address::NULL, _gateway, Address::NULL); // Default route must be the last one in table
+        _router.insert(_nic, this, &_arp, Address::NULL, _gateway, Address::NULL);
         _arp.resolve(_gateway);
     }
 }
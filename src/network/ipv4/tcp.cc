@@ -7,7 +7,7 @@
 __BEGIN_SYS
 
 // Class attributes
-TCP::Observed TCP::_observed;
+TCP::Demultiplexer TCP::_observed;
 
 TCP::Connection::State_Handler TCP::Connection::_handlers[] = {&TCP::Connection::listening,
                                                                &TCP::Connection::syn_sent,
@@ -49,32 +49,22 @@ void TCP::update(IP::Observed * obs, const IP::Protocol & prot, Buffer * pool)
         pool->nic()->free(pool);
 }
 
-void TCP::Segment::sum(const IP::Address & from, const IP::Address & to, const void * data, unsigned int size)
+void TCP::Segment::sum(const IP::Address & from, const IP::Address & to, const void * data, unsigned int size, bool copy)
 {
     _checksum = 0;
 
     IP::Pseudo_Header pseudo(from, to, IP::TCP, sizeof(Header) + size);
 
-    unsigned long sum = 0;
-    const unsigned char * ptr = reinterpret_cast<const unsigned char *>(&pseudo);
-    for(unsigned int i = 0; i < sizeof(IP::Pseudo_Header); i += 2)
-        sum += (ptr[i] << 8) | ptr[i+1];
-
-    ptr = reinterpret_cast<const unsigned char *>(header());
-    for(unsigned int i = 0; i < sizeof(Header); i += 2)
-        sum += (ptr[i] << 8) | ptr[i+1];
+    unsigned long sum = IP::sum(&pseudo, sizeof(IP::Pseudo_Header));
+    sum = IP::sum(header(), sizeof(Header), sum);
 
     if(data) {
-        ptr = reinterpret_cast<const unsigned char *>(data);
-        for(unsigned int i = 0; i < size; i += 2)
-            sum += (ptr[i] << 8) | ptr[i+1];
-        if(size & 1)
-            sum += ptr[size - 1];
+        if(copy)
+            sum = IP::copy_and_sum(this->data<void>(), data, size, sum);
+        else
+            sum = IP::sum(data, size, sum);
     }
 
-    while(sum >> 16)
-        sum = (sum & 0xffff) + (sum >> 16);
-
     _checksum = htons(~sum);
 }
 
@@ -82,6 +72,7 @@ void TCP::Connection::fsend(const Flags & flags)
 {
     _flags = flags;
     if(!_retransmiting) _sequence = htonl(_next);
+    if(flags & ACK) _delayed = false;
 
     db<TCP>(TRC) << "TCP::Connection::send(flags=" << ((flags & ACK) ? 'A' : '-') << ((flags & RST) ? 'R' : '-') << ((flags & SYN) ? 'S' : '-') << ((flags & FIN) ? 'F' : '-') << "): SND.NXT=" << _next << ",SND.SEQ=" << sequence() << endl;
 
@@ -115,57 +106,109 @@ int TCP::Connection::write(const void * d, unsigned int size)
 
     db<TCP>(TRC) << "TCP::Connection::write(f=" << from() << ",t=" << peer() << ":" << to() << ",d=" << data << ",s=" << size << ")" << endl;
 
-    unsigned int allowed = WINDOW;
-    unsigned int left = size; // bytes that have not been sent at all
+    unsigned int initial_seq = _next; // sequence number when stream is started
     unsigned int acknowledged = 0; // bytes that were sent AND acknowledged
-    unsigned int initial_seq = sequence(); // sequence number when stream is started
+
+    _streaming = true;
 
     unsigned int tries = 0;
-    for(; (tries < RETRIES) && (acknowledged != size) && (_state == ESTABLISHED || _state == CLOSE_WAIT);
-        acknowledged = _current->header()->acknowledgment() - initial_seq, allowed = _peer_window - (sequence() - _current->header()->acknowledgment())) {
-        _streaming = true;
-        allowed = (allowed > MSS) ? MSS: allowed;
+    for(; (tries < RETRIES) && (acknowledged != size) && (_state == ESTABLISHED || _state == CLOSE_WAIT); acknowledged = _unacknowledged - initial_seq) {
+        unsigned int acks = _acks;
 
-        if(allowed && left) {
-            db<TCP>(TRC) << "TCP::Connection::write: send" << endl;
+        if(_retransmiting && !before(sequence(), _next))
+            _retransmiting = false;
+
+        if(_retransmit) { // fast retransmit (or a partial acknowledgment during fast recovery)
+            db<TCP>(TRC) << "TCP::Connection::write: fast retransmission" << endl;
+
+            _retransmit = false;
+            _timing = false; // Karn's algorithm
 
-            int payload = (allowed > left) ? left : allowed;
+            bool retransmiting = _retransmiting;
+            unsigned int resume = sequence();
 
-            if(!dsend(data, payload)) // FIXME we should wait until there are available buffers
+            _retransmiting = true;
+            _sequence = htonl(_unacknowledged);
+            if(!dsend(data + acknowledged, (size - acknowledged > MSS) ? MSS : size - acknowledged))
                 return -1;
 
-            data += payload;
-            left -= payload;
-            if(sequence() == _next)
-                _retransmiting = false;
+            _retransmiting = retransmiting;
+            if(retransmiting)
+                _sequence = htonl(resume);
+
+            continue;
+        }
+
+        // Bytes sent so far (going back to SND.UNA after a timeout), those still in flight and how many more may be
+        unsigned int sent = (_retransmiting ? sequence() : _next) - initial_seq;
+        unsigned int in_flight = sent - acknowledged;
+        unsigned int window = (_peer_window < _cwnd) ? _peer_window : _cwnd;
+        unsigned int allowed = (window > in_flight) ? window - in_flight : 0;
+
+        if(allowed && (sent < size)) {
+            db<TCP>(TRC) << "TCP::Connection::write: send" << endl;
+
+            // Segments the window lets go right away are sent as a train, so the NIC is started only once
+            Buffer::List train;
+            for(unsigned int n = 0; allowed && (sent < size) && (n < TRAIN); n++) {
+                if(_retransmiting && !before(sequence(), _next))
+                    _retransmiting = false;
+
+                unsigned int payload = (allowed > MSS) ? MSS : allowed;
+                payload = (payload > size - sent) ? size - sent : payload;
+
+                if(!dsend(data + sent, payload, &train))
+                    break;
+
+                sent += payload;
+                allowed -= payload;
+            }
+
+            if(!IP::send(&train)) // FIXME we should wait until there are available buffers
+                return -1;
         } else { // Either window's full or we've sent all there was to
             db<TCP>(TRC) << "TCP::Connection::write: wait" << endl;
 
-            unsigned int old_ack = _current->header()->acknowledgment();
+            unsigned int old_ack = _unacknowledged;
+            Microsecond rto = _rto;
+            TSC::Time_Stamp start = TSC::time_stamp();
 
-            Condition_Handler h(&_stream);
-            Alarm a(TIMEOUT, &h);
+            // _stream is only posted by an acknowledgment or the alarm that finds _awake cleared, and the writer consumes
+            // that post even if it did not get to sleep, so it never wakes up on stale ones
+            _awake = false;
+            Functor_Handler<Connection> h(&wake, this);
+            Alarm a(rto, &h);
 
-            _stream.wait();
+            if((_acks == acks) && !_retransmit)
+                _stream.p();
+            else if(CPU::tsl(_awake))
+                _stream.p();
 
-            if(_current->header()->acknowledgment() == old_ack) {
-                // Retransmission
+            if(_unacknowledged != old_ack)
+                tries = 0;
+            else if(TSC::time(TSC::time_stamp() - start) >= rto) {
+                // Retransmission timeout: go back to SND.UNA with a single segment window (RFC 5681, 3.1)
                 db<TCP>(TRC) << "TCP::Connection::write: retransmission" << endl;
 
+                unsigned int flight = _next - _unacknowledged;
+                _ssthresh = (flight / 2 > 2 * MSS) ? flight / 2 : 2 * MSS;
+                _cwnd = MSS;
+                _recovering = false;
+                _duplicates = 0;
+                _timing = false;
+                _rto = (2 * _rto > MAX_RTO) ? MAX_RTO : 2 * _rto;
+
                 _retransmiting = true;
-                _sequence = htonl(_current->header()->acknowledgment());
-                _unacknowledged = _current->header()->acknowledgment();
-                data = reinterpret_cast<const unsigned char*>(d) + acknowledged;
-                left = size - acknowledged;
+                _sequence = htonl(_unacknowledged);
 
                 tries++;
-            } else
-                tries = 0;
+            }
         }
     }
 
     _streaming = false;
     _retransmiting = false;
+    _retransmit = false;
 
     if(tries == RETRIES) {
         db<TCP>(TRC) << "TCP::write: enough tries already!" << endl;
@@ -181,13 +224,14 @@ int TCP::Connection::write(const void * d, unsigned int size)
     return size;
 }
 
-int TCP::Connection::dsend(const void * d, unsigned int size)
+int TCP::Connection::dsend(const void * d, unsigned int size, Buffer::List * train)
 {
     const unsigned char * data = reinterpret_cast<const unsigned char *>(d);
 
     db<TCP>(TRC) << "TCP::dsend(f=" << from() << ",t=" << peer() << ":" << to() << ",d=" << data << ",s=" << size << ")" << endl;
 
     _flags = ACK;
+    _delayed = false; // acknowledgments ride along
     if(!_retransmiting)
         _sequence = htonl(_next);
 
@@ -212,8 +256,7 @@ int TCP::Connection::dsend(const void * d, unsigned int size)
         if(el == pool->link()) {
             Segment * segment = packet->data<Segment>();
             memcpy(reinterpret_cast<void *>(segment), header(), sizeof(Header));
-            segment->sum(packet->from(), packet->to(), data, buf->size() - sizeof(Header) - sizeof(IP::Header));
-            memcpy(segment->data<void>(), data, buf->size() - sizeof(Header) - sizeof(IP::Header));
+            segment->sum(packet->from(), packet->to(), data, buf->size() - sizeof(Header) - sizeof(IP::Header), true);
             data += buf->size() - sizeof(Header) - sizeof(IP::Header);
 
             db<TCP>(INF) << "TCP::send:msg=" << segment << " => " << *segment << endl;
@@ -225,11 +268,25 @@ int TCP::Connection::dsend(const void * d, unsigned int size)
         headers += sizeof(IP::Header);
     }
 
-    if(!_retransmiting)
+    if(!_retransmiting) {
+        if(!_timing) {
+            _timing = true;
+            _timed = _next + size;
+            _rtt_start = TSC::time_stamp();
+        }
         _next += size;
-    else
+    } else
         _sequence = htonl(header()->sequence() + size);
 
+    if(train) { // the caller sends the whole train at once
+        Buffer::Element * el = pool->link();
+        for(Buffer::Element * next; el; el = next) {
+            next = el->next();
+            train->insert(el);
+        }
+        return size;
+    }
+
     return IP::send(pool) - headers; // implicitly releases the pool
 }
 
@@ -271,6 +328,30 @@ int TCP::Connection::read(Buffer * pool, void * d, unsigned int s)
     return size;
 }
 
+unsigned int TCP::Connection::data(Buffer * pool, Chunk * chunks, unsigned int n)
+{
+    db<TCP>(TRC) << "TCP::data(buf=" << pool << ",c=" << chunks << ",n=" << n << ")" << endl;
+
+    Buffer::Element * head = pool->link();
+    unsigned int i = 0;
+    for(Buffer::Element * el = head; el; el = el->next(), i++) {
+        if(i >= n)
+            continue;
+
+        Buffer * buf = el->object();
+        Packet * packet = buf->frame()->data<Packet>();
+        if(el == head) {
+            chunks[i].data = packet->data<Segment>()->data<void>();
+            chunks[i].size = buf->size() - sizeof(IP::Header) - sizeof(Header);
+        } else {
+            chunks[i].data = packet->data<void>();
+            chunks[i].size = buf->size() - sizeof(IP::Header);
+        }
+    }
+
+    return i;
+}
+
 void TCP::Connection::update(TCP::Observed * obs, const TCP::Connection_Id & cid, Buffer * pool)
 {
     db<TCP>(TRC) << "TCP::Connection::update(obs=" << obs << ",sock=" << hex << cid << ",buf=" << pool << ")" << endl;
@@ -296,14 +377,17 @@ void TCP::Connection::update(TCP::Observed * obs, const TCP::Connection_Id & cid
 
     db<TCP>(INF) << "TCP::Connection::update:conn=" << this << " => " << *this << endl;
 
-    if(!((_state == LISTENING) || (_state == SYN_SENT)) && _current->header()->sequence() > acknowledgment()) {
+    if(!((_state == LISTENING) || (_state == SYN_SENT)) && after(_current->header()->sequence(), acknowledgment())) {
         // SEG.SEQ musn't be > than RCV.NXT, this forces segments to be accepted in order, except when connecting or listening, then one may receive stuff out of the blue
         // If SEG.SEQ < RCV.NXT, i.e. delayed or repeated segment, the treatment happens later
+        // A duplicate acknowledgment is sent at once, so the peer can retransmit what is missing (RFC 5681, 4.2)
         pool->nic()->free(pool);
+        if(_length && (_state == ESTABLISHED))
+            fsend(ACK);
         return;
     }
 
-    if(_current->header()->acknowledgment() > _next) {
+    if(after(_current->header()->acknowledgment(), _next)) {
         // SEG.ACK must be <= to SND.NXT, for one cannot ack what one is yet to receive
         fsend(RST);
         state(CLOSED);
@@ -312,20 +396,8 @@ void TCP::Connection::update(TCP::Observed * obs, const TCP::Connection_Id & cid
     }
 
     bool relevant = false; // The segment is relevant to the sliding window
-    if(_streaming) {
-        if(_current->header()->acknowledgment() <= sequence()) {
-            // Regular ack, i.e. SEG.ACK is <= than the last sequence I sent
-            if(_current->header()->acknowledgment() > _unacknowledged)
-                relevant = true; // A segment must ack something in order to be relevant
-
-            _unacknowledged = _current->header()->acknowledgment();
-        } else if(_current->header()->acknowledgment() > sequence()) {
-            // Forward ack, i.e. SEG.ACK > SEG.SEQ, but not > than the SND.NXT. This scenario is only possible in this code and in the FSM during retransmission
-            _sequence = htonl(_current->header()->acknowledgment());
-            _unacknowledged = _current->header()->acknowledgment();
-            relevant = true;
-        }
-    }
+    if(_streaming && (_current->header()->flags() & ACK))
+        relevant = acknowledge(_current->header()->acknowledgment());
 
     State state_at_arrival = _state;
 
@@ -344,8 +416,10 @@ void TCP::Connection::update(TCP::Observed * obs, const TCP::Connection_Id & cid
             if(!notify(cid, pool))
                 pool->nic()->free(pool);
 
-    if(_streaming && relevant)
-        _stream.signal();
+    if(_streaming && relevant) {
+        _acks++;
+        wake(this);
+    }
 }
 
 void TCP::Connection::listen()
@@ -369,7 +443,7 @@ void TCP::Connection::connect()
     state(SYN_SENT);
     fsend(SYN);
     _unacknowledged = sequence();
-    set_timeout();
+    set_timeout(_rto);
     _transition.wait();
 }
 
@@ -388,7 +462,7 @@ void TCP::Connection::close()
         else if(_state == CLOSE_WAIT)
             state(LAST_ACK);
         fsend(ACK | FIN);
-        set_timeout(TIMEOUT / 2);
+        set_timeout(_rto);
         _transition.wait();
     }
 }
@@ -420,7 +494,7 @@ void TCP::Connection::syn_sent()
     db<TCP>(TRC) << "TCP::Connection::syn_sent()" << endl;
 
     if(_current->header()->flags() & ACK) {
-        if((_current->header()->acknowledgment() <= _initial) || (_current->header()->acknowledgment() > _next)) {
+        if(!after(_current->header()->acknowledgment(), _initial) || after(_current->header()->acknowledgment(), _next)) {
             db<TCP>(WRN) << "TCP::Connection::syn_sent: bad acknowledgment number!" << endl;
 
             _valid = false;
@@ -429,8 +503,8 @@ void TCP::Connection::syn_sent()
             return;
         }
 
-        if((_current->header()->acknowledgment() >= _unacknowledged)
-            && (_current->header()->acknowledgment() <= _next)) {
+        if(!before(_current->header()->acknowledgment(), _unacknowledged)
+            && !after(_current->header()->acknowledgment(), _next)) {
             if(_current->header()->flags() & RST) {
                 _valid = false;
                 state(CLOSED);
@@ -443,7 +517,7 @@ void TCP::Connection::syn_sent()
                 _unacknowledged = _current->header()->acknowledgment();
                 _peer_window = _current->header()->window();
 
-                if(_unacknowledged > _initial) {
+                if(after(_unacknowledged, _initial)) {
                     db<TCP>(INF) << "TCP::Connection::syn_sent: connection established!" << endl;
 
                     fsend(ACK);
@@ -514,8 +588,8 @@ void TCP::Connection::syn_received()
     }
 
     if(_current->header()->flags() & ACK) {
-        if((_unacknowledged <= _current->header()->acknowledgment())
-            && (_current->header()->acknowledgment() <= _next)) {
+        if(!after(_unacknowledged, _current->header()->acknowledgment())
+            && !after(_current->header()->acknowledgment(), _next)) {
             db<TCP>(INF) << "TCP::Connection::syn_received: connection established!" << endl;
 
             state(ESTABLISHED);
@@ -573,14 +647,15 @@ void TCP::Connection::established()
     }
 
     if(_current->header()->flags() & ACK) {
-        if(_unacknowledged <= _current->header()->acknowledgment()
-            && _current->header()->acknowledgment() <= _next) { // implicit reject out-of-order segments
+        if(!after(_unacknowledged, _current->header()->acknowledgment())
+            && !after(_current->header()->acknowledgment(), _next)) { // implicit reject out-of-order segments
             db<TCP>(TRC) << "TCP::Connection::established: ACK received"
                 << endl;
 
             if(_length) {
                 _acknowledgment = htonl(acknowledgment() + _length);
-                fsend(ACK);
+                if(!(_current->header()->flags() & FIN))
+                    ack();
             }
 
             if(_current->header()->flags() & FIN) {
@@ -629,7 +704,7 @@ void TCP::Connection::fin_wait1()
             fsend(ACK);
         }
 
-        if(_current->header()->acknowledgment() >= _next) { // our FIN has been acknowledged
+        if(!before(_current->header()->acknowledgment(), _next)) { // our FIN has been acknowledged
             db<TCP>(TRC) << "TCP::Connection::fin_wait1: our FIN has been acknowledged" << endl;
 
             if(_current->header()->flags() & FIN) {
@@ -728,8 +803,8 @@ void TCP::Connection::close_wait()
     }
 
     if((_current->header()->flags() & ACK)
-        && (_unacknowledged < _current->header()->acknowledgment())
-        && (_current->header()->acknowledgment() <= _next)) {
+        && before(_unacknowledged, _current->header()->acknowledgment())
+        && !after(_current->header()->acknowledgment(), _next)) {
         _unacknowledged = _current->header()->acknowledgment();
 
         if(_current->header()->flags() & FIN) {
@@ -767,9 +842,9 @@ void TCP::Connection::closing()
     }
 
     if((_current->header()->flags() & ACK)
-        && (_unacknowledged < _current->header()->acknowledgment())
-        && (_current->header()->acknowledgment() <= _next)
-        && (_next <= _current->header()->acknowledgment())) { // check if our FIN has been acknowledged
+        && before(_unacknowledged, _current->header()->acknowledgment())
+        && !after(_current->header()->acknowledgment(), _next)
+        && !after(_next, _current->header()->acknowledgment())) { // check if our FIN has been acknowledged
         db<TCP>(TRC) << "TCP::Connection::closing: our FIN has been acknowledged" << endl;
         db<TCP>(TRC) << "TCP::Connection:closing-->time_wait" << endl;
 
@@ -805,9 +880,9 @@ void TCP::Connection::last_ack()
     }
 
     if((_current->header()->flags() & ACK)
-        && (_unacknowledged < _current->header()->acknowledgment())
-        && (_current->header()->acknowledgment() <= _next)
-        && (_next <= _current->header()->acknowledgment())) { // check if our FIN has been acknowledged
+        && before(_unacknowledged, _current->header()->acknowledgment())
+        && !after(_current->header()->acknowledgment(), _next)
+        && !after(_next, _current->header()->acknowledgment())) { // check if our FIN has been acknowledged
         db<TCP>(TRC) << "TCP::Connection::last_ack: our FIN has been acknowledged" << endl;
 
         state(CLOSED);
@@ -843,8 +918,8 @@ void TCP::Connection::time_wait()
     }
 
     if((_current->header()->flags() & ACK)
-        && (_unacknowledged < _current->header()->acknowledgment())
-        && (_current->header()->acknowledgment() <= _next)
+        && before(_unacknowledged, _current->header()->acknowledgment())
+        && !after(_current->header()->acknowledgment(), _next)
         && (_current->header()->flags() & FIN)) {
         process_fin();
         set_timeout();
@@ -904,7 +979,7 @@ bool TCP::Connection::check_sequence()
     }
 
     if(_length) {
-        if((acknowledgment() <= _current->header()->sequence()) && (_current->header()->sequence() < (acknowledgment() + WINDOW)))
+        if(!before(_current->header()->sequence(), acknowledgment()) && before(_current->header()->sequence(), acknowledgment() + WINDOW))
             return (_valid = true);
 
         db<TCP>(TRC) << "TCP::Connection::check_seq() == false: SEG.LEN > 0 AND !(RCV.NXT <= SEG.SEQ < (RCV.NXT + RCV.WND))" << endl;
@@ -912,8 +987,8 @@ bool TCP::Connection::check_sequence()
         return (_valid = false);
     }
 
-    if(((acknowledgment() <= _current->header()->sequence()) && (_current->header()->sequence() < (acknowledgment() + WINDOW)))
-        || (acknowledgment() <= (_current->header()->sequence() + _length - 1) && (_current->header()->sequence() + _length - 1) < (acknowledgment() + WINDOW)))
+    if((!before(_current->header()->sequence(), acknowledgment()) && before(_current->header()->sequence(), acknowledgment() + WINDOW))
+        || (!before(_current->header()->sequence() + _length - 1, acknowledgment()) && before(_current->header()->sequence() + _length - 1, acknowledgment() + WINDOW)))
         return (_valid = true);
 
     db<TCP>(TRC) << "TCP::Connection::check_seq() == false" << endl;
@@ -921,6 +996,115 @@ bool TCP::Connection::check_sequence()
     return (_valid = false);
 }
 
+// Sender side of an acknowledgment: slides the window, grows or shrinks the congestion window and detects losses
+// through duplicate acknowledgments (NewReno). Returns whether the writer might be able to proceed.
+bool TCP::Connection::acknowledge(unsigned int ack)
+{
+    if(after(ack, _unacknowledged) && !after(ack, _next)) {
+        unsigned int acked = ack - _unacknowledged;
+        _unacknowledged = ack;
+
+        if(_retransmiting && after(ack, sequence())) // forward ack, i.e. the peer already had what we were about to send again
+            _sequence = htonl(ack);
+
+        if(_timing && !before(ack, _timed)) {
+            _timing = false;
+            estimate(TSC::time(TSC::time_stamp() - _rtt_start));
+        }
+
+        if(_recovering) {
+            if(!before(ack, _recover)) { // full acknowledgment: leave fast recovery with a deflated window
+                _recovering = false;
+                _cwnd = _ssthresh;
+            } else { // partial acknowledgment: the next segment was also lost
+                _cwnd = ((_cwnd > acked) ? _cwnd - acked : 0) + MSS;
+                _retransmit = true;
+            }
+        } else if(_cwnd < _ssthresh)
+            _cwnd += (acked < MSS) ? acked : MSS; // slow start
+        else
+            _cwnd += (MSS * MSS / _cwnd) ? MSS * MSS / _cwnd : 1; // congestion avoidance
+
+        _duplicates = 0;
+
+        return true;
+    }
+
+    if((ack == _unacknowledged) && (_next != _unacknowledged) && !_length && !(_current->header()->flags() & (SYN | FIN))) {
+        _duplicates++;
+
+        if((_duplicates == 3) && !_recovering) {
+            db<TCP>(TRC) << "TCP::Connection::acknowledge: 3 duplicate acknowledgments, fast retransmit" << endl;
+
+            unsigned int flight = _next - _unacknowledged;
+            _ssthresh = (flight / 2 > 2 * MSS) ? flight / 2 : 2 * MSS;
+            _cwnd = _ssthresh + 3 * MSS;
+            _recover = _next;
+            _recovering = true;
+            _retransmit = true;
+
+            return true;
+        }
+
+        if(_recovering) { // each duplicate means a segment has left the network
+            _cwnd += MSS;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Jacobson/Karels estimator with the gains and bounds of RFC 6298
+void TCP::Connection::estimate(const Microsecond & rtt)
+{
+    if(!_srtt) {
+        _srtt = rtt;
+        _rttvar = rtt / 2;
+    } else {
+        Microsecond delta = (_srtt > rtt) ? _srtt - rtt : rtt - _srtt;
+        _rttvar = (3 * _rttvar + delta) / 4;
+        _srtt = (7 * _srtt + rtt) / 8;
+    }
+
+    _rto = _srtt + 4 * _rttvar;
+    if(_rto < MIN_RTO)
+        _rto = MIN_RTO;
+    if(_rto > MAX_RTO)
+        _rto = MAX_RTO;
+
+    db<TCP>(TRC) << "TCP::Connection::estimate(rtt=" << rtt << ") => srtt=" << _srtt << ",rttvar=" << _rttvar << ",rto=" << _rto << endl;
+}
+
+// Full-sized segments are acknowledged every other one or after ACK_DELAY, the others (usually the last of a write) at once
+void TCP::Connection::ack()
+{
+    if(_delayed || (_length < MSS)) {
+        fsend(ACK);
+        return;
+    }
+
+    _delayed = true;
+    if(_ack_alarm && !_ack_alarm->times()) { // fired already, but it can't be deleted by its own handler
+        delete _ack_alarm;
+        _ack_alarm = 0;
+    }
+    if(!_ack_alarm)
+        _ack_alarm = new (SYSTEM) Alarm(ACK_DELAY, &_ack_handler);
+}
+
+void TCP::Connection::wake(Connection * c)
+{
+    if(!CPU::tsl(c->_awake))
+        c->_stream.v();
+}
+
+void TCP::Connection::delayed_ack(Connection * c)
+{
+    if(c->_delayed)
+        c->fsend(ACK);
+}
+
 void TCP::Connection::process_fin()
 {
     db<TCP>(TRC) << "TCP::Connection::process_fin(): FIN received" << endl;
@@ -956,7 +1140,8 @@ void TCP::Connection::timeout(Connection* c)
         c->_tries++;
         c->_next--;
         c->fsend(FIN | ACK);
-        c->set_timeout(1000 * 1000 * 2.5);
+        c->_rto = (2 * c->_rto > MAX_RTO) ? MAX_RTO : 2 * c->_rto;
+        c->set_timeout(c->_rto);
         return;
     }
 
@@ -965,7 +1150,8 @@ void TCP::Connection::timeout(Connection* c)
         c->_tries++;
         c->_next--;
         c->fsend(SYN);
-        c->set_timeout();
+        c->_rto = (2 * c->_rto > MAX_RTO) ? MAX_RTO : 2 * c->_rto;
+        c->set_timeout(c->_rto);
         return;
     }
 }
@@ -7,7 +7,7 @@
 __BEGIN_SYS
 
 // Class attributes
-UDP::Observed UDP::_observed;
+UDP::Demultiplexer UDP::_observed;
 
 // Methods
 int UDP::send(const Address & from, const Address & to, const void * d, unsigned int s)
@@ -33,14 +33,12 @@ int UDP::send(const Address & from, const Address & to, const void * d, unsigned
             message = packet->data<Message>();
             new(packet->data<void>()) Header(from.port(), to.port(), size);
             message->sum_header(packet->from(), packet->to());
-            memcpy(message->data<void>(), data, buf->size() - sizeof(Header) - sizeof(IP::Header));
-            message->sum_data(data, buf->size() - sizeof(Header) - sizeof(IP::Header));
+            message->copy_data(message->data<void>(), data, buf->size() - sizeof(Header) - sizeof(IP::Header));
             data += buf->size() - sizeof(Header) - sizeof(IP::Header);
 
             db<UDP>(INF) << "UDP::send:msg=" << message << " => " << *message << endl;
         } else {
-            memcpy(packet->data<void>(), data, buf->size() - sizeof(IP::Header));
-            message->sum_data(data, buf->size() - sizeof(IP::Header));
+            message->copy_data(packet->data<void>(), data, buf->size() - sizeof(IP::Header));
             data += buf->size() - sizeof(IP::Header);
         }
 
@@ -53,6 +51,74 @@ int UDP::send(const Address & from, const Address & to, const void * d, unsigned
 }
 
 
+int UDP::send(const Address & from, const Address & to, const Chunk * chunks, unsigned int n)
+{
+    unsigned int s = 0;
+    for(unsigned int i = 0; i < n; i++)
+        s += chunks[i].size;
+    unsigned int size = (s > sizeof(Data)) ? sizeof(Data) : s;
+
+    db<UDP>(TRC) << "UDP::send(f=" << from << ",t=" << to << ",c=" << chunks << ",n=" << n << ",s=" << size << ")" << endl;
+
+    Buffer * pool = IP::alloc(to.ip(), IP::UDP, sizeof(Header), size);
+    if(!pool)
+        return 0;
+
+    Message * message = 0;
+    unsigned int headers = sizeof(Header);
+    unsigned int chunk = 0;
+    const unsigned char * data = 0;
+    unsigned int left = 0; // bytes of the current chunk not yet copied
+    for(Buffer::Element * el = pool->link(); el; el = el->next()) {
+        Buffer * buf = el->object();
+        Packet * packet = buf->frame()->data<Packet>();
+
+        db<UDP>(INF) << "UDP::send:buf=" << buf << " => " << *buf<< endl;
+
+        unsigned char * frame;
+        unsigned int room = buf->size() - sizeof(IP::Header);
+        if(el == pool->link()) {
+            message = packet->data<Message>();
+            new(packet->data<void>()) Header(from.port(), to.port(), size);
+            message->sum_header(packet->from(), packet->to());
+            frame = message->data<unsigned char>();
+            room -= sizeof(Header);
+        } else
+            frame = packet->data<unsigned char>();
+
+        // Partial sums can only be chained over even-sized pieces, so chunks are copied and summed in a single pass
+        // only while the frame is filled at even offsets; whatever follows an odd-sized chunk is summed after copied
+        unsigned int filled = 0;
+        unsigned int summed = 0;
+        while(filled < room) {
+            for(; !left; chunk++) {
+                data = reinterpret_cast<const unsigned char *>(chunks[chunk].data);
+                left = chunks[chunk].size;
+            }
+
+            unsigned int piece = (left > room - filled) ? room - filled : left;
+            if((summed == filled) && !(piece & 1)) {
+                message->copy_data(frame + filled, data, piece);
+                summed += piece;
+            } else
+                memcpy(frame + filled, data, piece);
+
+            filled += piece;
+            data += piece;
+            left -= piece;
+        }
+        if(summed < filled)
+            message->sum_data(frame + summed, filled - summed);
+
+        headers += sizeof(IP::Header);
+    }
+
+    message->sum_trailer();
+
+    return IP::send(pool) - headers; // implicitly releases the pool
+}
+
+
 int UDP::receive(Buffer * pool, void * d, unsigned int s)
 {
     unsigned char * data = reinterpret_cast<unsigned char *>(d);
@@ -97,6 +163,37 @@ int UDP::receive(Buffer * pool, void * d, unsigned int s)
 }
 
 
+unsigned int UDP::data(Buffer * pool, Chunk * chunks, unsigned int n)
+{
+    db<UDP>(TRC) << "UDP::data(buf=" << pool << ",c=" << chunks << ",n=" << n << ")" << endl;
+
+    Buffer::Element * head = pool->link();
+    Message * message = head->object()->frame()->data<Packet>()->data<Message>();
+
+    if(!message->check()) {
+        db<UDP>(WRN) << "UDP::data: wrong message checksum!" << endl;
+        return 0;
+    }
+
+    unsigned int i = 0;
+    for(Buffer::Element * el = head; el; el = el->next(), i++) {
+        if(i >= n)
+            continue;
+
+        Buffer * buf = el->object();
+        if(el == head) {
+            chunks[i].data = message->data<void>();
+            chunks[i].size = buf->size() - sizeof(IP::Header) - sizeof(Header);
+        } else {
+            chunks[i].data = buf->frame()->data<Packet>()->data<void>();
+            chunks[i].size = buf->size() - sizeof(IP::Header);
+        }
+    }
+
+    return i;
+}
+
+
 void UDP::update(IP::Observed * obs, const IP::Protocol & prot, Buffer * pool)
 {
     db<UDP>(TRC) << "UDP::update(obs=" << obs << ",prot=" << prot << ",buf=" << pool << ")" << endl;
@@ -116,44 +213,29 @@ void UDP::Message::sum_header(const IP::Address & from, const IP::Address & to)
     _checksum = 0;
     if(Traits<UDP>::checksum) {
         IP::Pseudo_Header pseudo(from, to, IP::UDP, length());
-        unsigned long sum = 0;
-
-        const unsigned char * ptr = reinterpret_cast<const unsigned char *>(&pseudo);
-        for(unsigned int i = 0; i < sizeof(IP::Pseudo_Header); i += 2)
-            sum += (ptr[i] << 8) | ptr[i+1];
-
-        ptr = reinterpret_cast<const unsigned char *>(header());
-        for(unsigned int i = 0; i < sizeof(Header); i += 2)
-            sum += (ptr[i] << 8) | ptr[i+1];
-
-        _checksum = sum;
+        _checksum = IP::sum(header(), sizeof(Header), IP::sum(&pseudo, sizeof(IP::Pseudo_Header))); // partial sum, folded to 16 bits
     }
 }
 
 void UDP::Message::sum_data(const void * data, unsigned int size)
 {
-    if(Traits<UDP>::checksum) {
-        unsigned long sum = _checksum;
-
-        const unsigned char * ptr = reinterpret_cast<const unsigned char *>(data);
-        for(unsigned int i = 0; i < size; i += 2)
-            sum += (ptr[i] << 8) | ptr[i+1];
-        if(size & 1)
-            sum += ptr[size - 1];
+    if(Traits<UDP>::checksum)
+        _checksum = IP::sum(data, size, _checksum);
+}
 
-        _checksum = sum;
-    }
+void UDP::Message::copy_data(void * to, const void * from, unsigned int size)
+{
+    if(Traits<UDP>::checksum)
+        _checksum = IP::copy_and_sum(to, from, size, _checksum);
+    else
+        memcpy(to, from, size);
 }
 
 void UDP::Message::sum_trailer()
 {
     if(Traits<UDP>::checksum) {
-        unsigned long sum = _checksum;
-
-        while(sum >> 16)
-            sum = (sum & 0xffff) + (sum >> 16);
-
-        _checksum = htons(~sum);
+        unsigned short sum = ~_checksum;
+        _checksum = htons(sum ? sum : 0xffff); // zero means no checksum (RFC 768)
     }
 }
 
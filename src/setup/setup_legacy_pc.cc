@@ -1075,7 +1075,7 @@ void _entry()
 
         // Move the boot image to after SETUP, so there will be nothing else below SETUP to be preserved
         // SETUP code + data + 1 stack per CPU
-        register char * dst = MMU::align_page(entry + size + 2 * sizeof(MMU::Page) * (Traits<Machine>::CPUS));
+        char * dst = MMU::align_page(entry + size + 2 * sizeof(MMU::Page) * (Traits<Machine>::CPUS));
         assert((dst + si->bm.img_size) < reinterpret_cast<char *>(Memory_Map::INIT)); // check if it wouldn't overwrite INIT
         memcpy(dst, bi, si->bm.img_size);
 
@@ -1125,7 +1125,7 @@ void _entry()
     // SP = "entry" + "size" + #CPU * sizeof(Page)
     // Be careful: we'll loose our old stack now, so everything we still
     // need to reach Setup() must be in regs or globals!
-    register char * sp = const_cast<char *>(Stacks) - 2 * sizeof(MMU::Page) * APIC::id();
+    char * sp = const_cast<char *>(Stacks) - 2 * sizeof(MMU::Page) * APIC::id();
     ASM("movl %0, %%esp" : : "r" (sp));
 
     // Pass the boot image to SETUP
@@ -8,6 +8,22 @@
 // Framework class attributes
 __BEGIN_SYS
 Framework::Cache Framework::_cache;
+Syscall_Ring * Syscall_Ring::_ring;
+Kernel_Page * Kernel_Page::_page;
+__END_SYS
+
+
+// Kernel_Page is mapped into the task's address space by the kernel on the first use
+__BEGIN_SYS
+const Kernel_Page * Kernel_Page::page()
+{
+    if(!_page) {
+        Message msg(Id(UTILITY_ID, 0), Message::KERNEL_PAGE);
+        msg.act();
+        _page = reinterpret_cast<Kernel_Page *>(msg.result());
+    }
+    return _page;
+}
 __END_SYS
 
 
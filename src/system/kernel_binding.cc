@@ -7,7 +7,7 @@
 // Framework class attributes
 __BEGIN_SYS
 
-IPC::Observed IPC::_observed;
+IPC::Demultiplexer IPC::_observed;
 
 // The order of components in Agent::_handlers must match the respective Type<Component>::ID
 Agent::Member Agent::_handlers[] = {&Agent::handle_thread,
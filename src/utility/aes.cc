@@ -45,367 +45,285 @@ const unsigned char SWAES<16>::rsbox[256] = {
 	   0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
 	   0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d };
 
-
-// The round constant word array, rcon[i], contains the values given by
-// x to th e power (i-1) being powers of x (x is denoted as {02}) in the field GF(2^8)
-// Note that i starts at 1, not 0).
-const unsigned char SWAES<16>::rcon[255] = {
-	// 0     1     2     3     4     5     6     7     8     9     a     b     c     d     e     f
-           0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a,
-	   0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39,
-	   0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a,
-	   0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8,
-	   0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef,
-	   0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc,
-	   0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b,
-	   0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3,
-	   0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94,
-	   0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20,
-	   0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97, 0x35,
-	   0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 0x61, 0xc2, 0x9f,
-	   0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb, 0x8d, 0x01, 0x02, 0x04,
-	   0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63,
-	   0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd,
-	   0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb  };
-
-void SWAES<16>::ebc_encrypt(const unsigned char * input, const unsigned char * key, unsigned char * output)
+// T-tables, computed at compile time from the AES field arithmetic
+// te[x] holds column (2.S[x], S[x], S[x], 3.S[x]) and td[x] holds column (14.Si[x], 9.Si[x], 13.Si[x], 11.Si[x]), with the
+// first row in the most significant byte. The tables for the other rows are rotations of them.
+struct SWAES<16>::Tables
 {
-    // Copy input to output, and work in-memory on output
-    block_copy(output, input);
-    _state = reinterpret_cast<State *>(output);
-
-    _key = key;
-    expand_key();
+    Word te[256];
+    Word td[256];
 
-    // The next function call encrypts the PlainText with the _key using AES algorithm.
-    cipher();
-}
-
-void SWAES<16>::ebc_decrypt(const unsigned char * input, const unsigned char * key, unsigned char *output)
-{
-    // Copy input to output, and work in-memory on output
-    block_copy(output, input);
-    _state = reinterpret_cast<State *>(output);
+    static constexpr unsigned char xtime(unsigned char x) { return (x << 1) ^ ((x & 0x80) ? 0x1b : 0); }
 
-    // The expand_key routine must be called before encryption.
-    _key = key;
-    expand_key();
-
-    inv_cipher();
-}
-
-void SWAES<16>::cbc_encrypt_buffer(unsigned char * output, const unsigned char * _input, int length, const unsigned char * key, unsigned char * iv)
-{
-    unsigned char remainders = length % KEY_SIZE; /* Remaining bytes in the last non-full block */
+    static constexpr unsigned char multiply(unsigned char x, unsigned char y) {
+        unsigned char p = 0;
+        for(; y; y >>= 1, x = xtime(x))
+            if(y & 1)
+                p ^= x;
+        return p;
+    }
 
-    block_copy(output, _input);
-    _state = reinterpret_cast<State *>(output);
+    static constexpr unsigned char inverse(unsigned char x) { // x^254 = x^-1 in GF(2^8)
+        unsigned char p = 1;
+        for(unsigned int i = 0; i < 254; i++)
+            p = multiply(p, x);
+        return p;
+    }
 
-    // Skip the key expansion if key is passed as 0
-    if(0 != key) {
-        _key = key;
-        expand_key();
+    static constexpr unsigned char sub(unsigned char x) { // S-box entry = affine transformation of the inverse
+        unsigned char b = inverse(x);
+        return b ^ ((b << 1) | (b >> 7)) ^ ((b << 2) | (b >> 6)) ^ ((b << 3) | (b >> 5)) ^ ((b << 4) | (b >> 4)) ^ 0x63;
     }
 
-    if(iv != 0)
-        _iv = iv;
-
-    int i;
-    for(i = 0; i < length; i += KEY_SIZE) {
-        unsigned char input[KEY_SIZE];
-        for(int j=0; (j<(int)KEY_SIZE) && (j+i < length); j++)
-            input[j] = _input[j+i];
-        xor_with_iv(input);
-        block_copy(output, input);
-        _state = reinterpret_cast<State *>(output);
-        cipher();
-        _iv = output;
-        output += KEY_SIZE;
+    static constexpr Word column(unsigned char s, unsigned char a, unsigned char b, unsigned char c, unsigned char d) {
+        return (Word(multiply(s, a)) << 24) | (Word(multiply(s, b)) << 16) | (Word(multiply(s, c)) << 8) | Word(multiply(s, d));
     }
 
-    if(remainders) {
-        block_copy(output, _input+i);
-        memset(output + remainders, 0, KEY_SIZE - remainders); /* add 0-padding */
-        _state = reinterpret_cast<State *>(output);
-        cipher();
+    constexpr Tables(): te(), td() {
+        for(unsigned int x = 0; x < 256; x++) {
+            unsigned char s = sub(x);
+            te[x] = column(s, 2, 1, 1, 3);
+            td[s] = column(x, 14, 9, 13, 11);
+        }
     }
-}
+};
 
-void SWAES<16>::cbc_decrypt_buffer(unsigned char * output, const unsigned char * input, int length, const unsigned char * key, unsigned char * iv)
-{
-    int i;
-    unsigned char remainders = length % KEY_SIZE; /* Remaining bytes in the last non-full block */
+const SWAES<16>::Tables SWAES<16>::tables;
 
-    block_copy(output, input);
-    _state = reinterpret_cast<State *>(output);
+#if defined(__rv64__)
+const SWAES<16>::Engine SWAES<16>::ENGINE = Traits<CPU>::aes_instructions ? INSTRUCTIONS : TABLES;
+#else
+const SWAES<16>::Engine SWAES<16>::ENGINE = TABLES;
+#endif
 
-    // Skip the key expansion if key is passed as 0
-    if(0 != key) {
-        _key = key;
-        expand_key();
-    }
+static inline unsigned int ror(unsigned int w, unsigned int n) { return (w >> n) | (w << (32 - n)); }
 
-    // If iv is passed as 0, we continue to encrypt without re-setting the _iv
-    if(iv != 0)
-        _iv = iv;
-
-    for(i = 0; i < length; i += KEY_SIZE) {
-        block_copy(output, input);
-        _state = reinterpret_cast<State *>(output);
-        inv_cipher();
-        xor_with_iv(output);
-        _iv = const_cast<unsigned char *>(input);
-        input += KEY_SIZE;
-        output += KEY_SIZE;
-    }
+static inline unsigned int load(const unsigned char * p) {
+    return (static_cast<unsigned int>(p[0]) << 24) | (static_cast<unsigned int>(p[1]) << 16) | (static_cast<unsigned int>(p[2]) << 8) | p[3];
+}
 
-    if(remainders) {
-        block_copy(output, input);
-        memset(output+remainders, 0, KEY_SIZE - remainders); /* add 0-padding */
-        _state = reinterpret_cast<State *>(output);
-        inv_cipher();
-    }
+static inline void store(unsigned char * p, unsigned int w) {
+    p[0] = w >> 24;
+    p[1] = w >> 16;
+    p[2] = w >> 8;
+    p[3] = w;
 }
 
-// This function produces Nb(Nr+1) round keys. The round keys are used in each round to decrypt the states.
-void SWAES<16>::expand_key(void)
+// Produces the Nb(Nr+1) round keys, as big-endian columns
+void SWAES<16>::expand_key(const unsigned char * k)
 {
-    unsigned int i, j, k;
-    unsigned char tempa[4]; // Used for the column/row operations
-
-    // The first round key is the key itself.
-    for(i = 0; i < Nk; ++i) {
-        _round_key[(i * 4) + 0] = _key[(i * 4) + 0];
-        _round_key[(i * 4) + 1] = _key[(i * 4) + 1];
-        _round_key[(i * 4) + 2] = _key[(i * 4) + 2];
-        _round_key[(i * 4) + 3] = _key[(i * 4) + 3];
-    }
+    db<Ciphers>(TRC) << "AES::expand_key(key=" << k << ")" << endl;
+
+    memcpy(_key, k, KEY_SIZE);
+
+    Word * w = _round_key;
+    for(unsigned int i = 0; i < Nk; i++)
+        w[i] = load(&k[i * 4]);
 
-    // All other round keys are found from the previous round keys.
-    for(; (i < (Nb * (Nr + 1))); ++i) {
-        for(j = 0; j < 4; ++j)
-            tempa[j]=_round_key[(i-1) * 4 + j];
+    unsigned char rcon = 1;
+    for(unsigned int i = Nk; i < Nb * (Nr + 1); i++) {
+        Word t = w[i - 1];
         if(i % Nk == 0) {
-            // This function rotates the 4 bytes in a word to the left once.
-            // [a0,a1,a2,a3] becomes [a1,a2,a3,a0]
-
-            // Function RotWord()
-            {
-                k = tempa[0];
-                tempa[0] = tempa[1];
-                tempa[1] = tempa[2];
-                tempa[2] = tempa[3];
-                tempa[3] = k;
-            }
-
-            // SubWord() is a function that takes a four-byte input word and
-            // applies the S-box to each of the four bytes to produce an output word.
-
-            // Function Subword()
-            {
-                tempa[0] = sbox[static_cast<int>(tempa[0])];
-                tempa[1] = sbox[static_cast<int>(tempa[1])];
-                tempa[2] = sbox[static_cast<int>(tempa[2])];
-                tempa[3] = sbox[static_cast<int>(tempa[3])];
-            }
-
-            tempa[0] =  tempa[0] ^ rcon[i/Nk];
+            // SubWord(RotWord(t)) ^ Rcon[i/Nk]
+            t = (Word(sbox[(t >> 16) & 0xff]) << 24) ^ (Word(sbox[(t >> 8) & 0xff]) << 16) ^ (Word(sbox[t & 0xff]) << 8) ^ Word(sbox[t >> 24]) ^ (Word(rcon) << 24);
+            rcon = Tables::xtime(rcon);
         }
-        else if(Nk > 6 && i % Nk == 4) {
-            // Function Subword()
-            {
-                tempa[0] = sbox[static_cast<int>(tempa[0])];
-                tempa[1] = sbox[static_cast<int>(tempa[1])];
-                tempa[2] = sbox[static_cast<int>(tempa[2])];
-                tempa[3] = sbox[static_cast<int>(tempa[3])];
-            }
-        }
-        _round_key[i * 4 + 0] = _round_key[(i - Nk) * 4 + 0] ^ tempa[0];
-        _round_key[i * 4 + 1] = _round_key[(i - Nk) * 4 + 1] ^ tempa[1];
-        _round_key[i * 4 + 2] = _round_key[(i - Nk) * 4 + 2] ^ tempa[2];
-        _round_key[i * 4 + 3] = _round_key[(i - Nk) * 4 + 3] ^ tempa[3];
+        w[i] = w[i - Nk] ^ t;
     }
-}
 
-// This function adds the round key to _state.
-// The round key is added to the _state by an XOR function.
-void SWAES<16>::add_round_key(int round)
-{
-    int i,j;
-    for(i=0;i<4;++i) {
-        for(j = 0; j < 4; ++j) {
-            (*_state)[i][j] ^= _round_key[round * Nb * 4 + i * Nb + j];
-        }
-    }
+    // The instructions take the round keys as byte strings
+    if(_engine == INSTRUCTIONS)
+        for(unsigned int i = 0; i < Nb * (Nr + 1); i++)
+            store(reinterpret_cast<unsigned char *>(&w[i]), w[i]);
+
+    _keyed = true;
+    _decryption_keyed = false;
 }
 
-// The sub_bytes Function Substitutes the values in the
-// _state matrix with values in an S-box.
-void SWAES<16>::sub_bytes(void)
+// Produces the round keys of the equivalent inverse cipher: the encryption ones in reverse order, with InvMixColumns
+// applied to all but the first and last
+void SWAES<16>::expand_decryption_key()
 {
-    int i, j;
-    for(i = 0; i < 4; ++i) {
-        for(j = 0; j < 4; ++j) {
-            (*_state)[j][i] = sbox[static_cast<int>((*_state)[j][i])];
+    const Word * w = _round_key;
+    Word * dw = _decryption_round_key;
+
+    for(unsigned int r = 0; r <= Nr; r++)
+        for(unsigned int c = 0; c < Nb; c++) {
+            Word t = w[(Nr - r) * Nb + c];
+            if(_engine == INSTRUCTIONS)
+                t = load(reinterpret_cast<const unsigned char *>(&t));
+            if((r > 0) && (r < Nr)) // td[sbox[x]] is InvMixColumns of column (x, 0, 0, 0)
+                t = tables.td[sbox[t >> 24]] ^ ror(tables.td[sbox[(t >> 16) & 0xff]], 8) ^ ror(tables.td[sbox[(t >> 8) & 0xff]], 16) ^ ror(tables.td[sbox[t & 0xff]], 24);
+            if(_engine == INSTRUCTIONS)
+                store(reinterpret_cast<unsigned char *>(&dw[r * Nb + c]), t);
+            else
+                dw[r * Nb + c] = t;
         }
-    }
-}
 
-// The shift_rows() function shifts the rows in the _state to the left.
-// Each row is shifted with different offset.
-// Offset = Row number. So the first row is not shifted.
-void SWAES<16>::shift_rows(void)
-{
-    unsigned char temp;
-
-    // Rotate first row 1 columns to left
-    temp            = (*_state)[0][1];
-    (*_state)[0][1] = (*_state)[1][1];
-    (*_state)[1][1] = (*_state)[2][1];
-    (*_state)[2][1] = (*_state)[3][1];
-    (*_state)[3][1] = temp;
-
-    // Rotate second row 2 columns to left
-    temp            = (*_state)[0][2];
-    (*_state)[0][2] = (*_state)[2][2];
-    (*_state)[2][2] = temp;
-
-    temp            = (*_state)[1][2];
-    (*_state)[1][2] = (*_state)[3][2];
-    (*_state)[3][2] = temp;
-
-    // Rotate third row 3 columns to left
-    temp            = (*_state)[0][3];
-    (*_state)[0][3] = (*_state)[3][3];
-    (*_state)[3][3] = (*_state)[2][3];
-    (*_state)[2][3] = (*_state)[1][3];
-    (*_state)[1][3] = temp;
+    _decryption_keyed = true;
 }
 
-// mix_columns function mixes the columns of the _state matrix
-void SWAES<16>::mix_columns(void)
+void SWAES<16>::encrypt_tables(const unsigned char * in, unsigned char * out)
 {
-    int i;
-    unsigned char Tmp,Tm,t;
-    for(i = 0; i < 4; ++i) {
-        t   = (*_state)[i][0];
-        Tmp = (*_state)[i][0] ^ (*_state)[i][1] ^ (*_state)[i][2] ^ (*_state)[i][3] ;
-        Tm  = (*_state)[i][0] ^ (*_state)[i][1] ; Tm = xtime(Tm);  (*_state)[i][0] ^= Tm ^ Tmp ;
-        Tm  = (*_state)[i][1] ^ (*_state)[i][2] ; Tm = xtime(Tm);  (*_state)[i][1] ^= Tm ^ Tmp ;
-        Tm  = (*_state)[i][2] ^ (*_state)[i][3] ; Tm = xtime(Tm);  (*_state)[i][2] ^= Tm ^ Tmp ;
-        Tm  = (*_state)[i][3] ^ t ;        Tm = xtime(Tm);  (*_state)[i][3] ^= Tm ^ Tmp ;
+    const Word * rk = _round_key;
+    const Word * te = tables.te;
+
+    Word s0 = load(&in[0]) ^ rk[0];
+    Word s1 = load(&in[4]) ^ rk[1];
+    Word s2 = load(&in[8]) ^ rk[2];
+    Word s3 = load(&in[12]) ^ rk[3];
+
+    for(unsigned int r = 1; r < Nr; r++) {
+        rk += Nb;
+        Word t0 = te[s0 >> 24] ^ ror(te[(s1 >> 16) & 0xff], 8) ^ ror(te[(s2 >> 8) & 0xff], 16) ^ ror(te[s3 & 0xff], 24) ^ rk[0];
+        Word t1 = te[s1 >> 24] ^ ror(te[(s2 >> 16) & 0xff], 8) ^ ror(te[(s3 >> 8) & 0xff], 16) ^ ror(te[s0 & 0xff], 24) ^ rk[1];
+        Word t2 = te[s2 >> 24] ^ ror(te[(s3 >> 16) & 0xff], 8) ^ ror(te[(s0 >> 8) & 0xff], 16) ^ ror(te[s1 & 0xff], 24) ^ rk[2];
+        Word t3 = te[s3 >> 24] ^ ror(te[(s0 >> 16) & 0xff], 8) ^ ror(te[(s1 >> 8) & 0xff], 16) ^ ror(te[s2 & 0xff], 24) ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
     }
+
+    // The last round has no MixColumns
+    rk += Nb;
+    store(&out[0],  (Word(sbox[s0 >> 24]) << 24) ^ (Word(sbox[(s1 >> 16) & 0xff]) << 16) ^ (Word(sbox[(s2 >> 8) & 0xff]) << 8) ^ Word(sbox[s3 & 0xff]) ^ rk[0]);
+    store(&out[4],  (Word(sbox[s1 >> 24]) << 24) ^ (Word(sbox[(s2 >> 16) & 0xff]) << 16) ^ (Word(sbox[(s3 >> 8) & 0xff]) << 8) ^ Word(sbox[s0 & 0xff]) ^ rk[1]);
+    store(&out[8],  (Word(sbox[s2 >> 24]) << 24) ^ (Word(sbox[(s3 >> 16) & 0xff]) << 16) ^ (Word(sbox[(s0 >> 8) & 0xff]) << 8) ^ Word(sbox[s1 & 0xff]) ^ rk[2]);
+    store(&out[12], (Word(sbox[s3 >> 24]) << 24) ^ (Word(sbox[(s0 >> 16) & 0xff]) << 16) ^ (Word(sbox[(s1 >> 8) & 0xff]) << 8) ^ Word(sbox[s2 & 0xff]) ^ rk[3]);
 }
 
-// mix_columns function mixes the columns of the _state matrix.
-// The method used to multiply may be difficult to understand for the inexperienced.
-// Please use the references to gain more information.
-void SWAES<16>::inv_mix_columns(void)
+void SWAES<16>::decrypt_tables(const unsigned char * in, unsigned char * out)
 {
-    int i;
-    unsigned char a,b,c,d;
-    for(i = 0; i < 4; ++i) {
-        a = (*_state)[i][0];
-        b = (*_state)[i][1];
-        c = (*_state)[i][2];
-        d = (*_state)[i][3];
-
-        (*_state)[i][0] = multiply(a, 0x0e) ^ multiply(b, 0x0b) ^ multiply(c, 0x0d) ^ multiply(d, 0x09);
-        (*_state)[i][1] = multiply(a, 0x09) ^ multiply(b, 0x0e) ^ multiply(c, 0x0b) ^ multiply(d, 0x0d);
-        (*_state)[i][2] = multiply(a, 0x0d) ^ multiply(b, 0x09) ^ multiply(c, 0x0e) ^ multiply(d, 0x0b);
-        (*_state)[i][3] = multiply(a, 0x0b) ^ multiply(b, 0x0d) ^ multiply(c, 0x09) ^ multiply(d, 0x0e);
+    const Word * rk = _decryption_round_key;
+    const Word * td = tables.td;
+
+    Word s0 = load(&in[0]) ^ rk[0];
+    Word s1 = load(&in[4]) ^ rk[1];
+    Word s2 = load(&in[8]) ^ rk[2];
+    Word s3 = load(&in[12]) ^ rk[3];
+
+    for(unsigned int r = 1; r < Nr; r++) {
+        rk += Nb;
+        Word t0 = td[s0 >> 24] ^ ror(td[(s3 >> 16) & 0xff], 8) ^ ror(td[(s2 >> 8) & 0xff], 16) ^ ror(td[s1 & 0xff], 24) ^ rk[0];
+        Word t1 = td[s1 >> 24] ^ ror(td[(s0 >> 16) & 0xff], 8) ^ ror(td[(s3 >> 8) & 0xff], 16) ^ ror(td[s2 & 0xff], 24) ^ rk[1];
+        Word t2 = td[s2 >> 24] ^ ror(td[(s1 >> 16) & 0xff], 8) ^ ror(td[(s0 >> 8) & 0xff], 16) ^ ror(td[s3 & 0xff], 24) ^ rk[2];
+        Word t3 = td[s3 >> 24] ^ ror(td[(s2 >> 16) & 0xff], 8) ^ ror(td[(s1 >> 8) & 0xff], 16) ^ ror(td[s0 & 0xff], 24) ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
     }
+
+    // The last round has no InvMixColumns
+    rk += Nb;
+    store(&out[0],  (Word(rsbox[s0 >> 24]) << 24) ^ (Word(rsbox[(s3 >> 16) & 0xff]) << 16) ^ (Word(rsbox[(s2 >> 8) & 0xff]) << 8) ^ Word(rsbox[s1 & 0xff]) ^ rk[0]);
+    store(&out[4],  (Word(rsbox[s1 >> 24]) << 24) ^ (Word(rsbox[(s0 >> 16) & 0xff]) << 16) ^ (Word(rsbox[(s3 >> 8) & 0xff]) << 8) ^ Word(rsbox[s2 & 0xff]) ^ rk[1]);
+    store(&out[8],  (Word(rsbox[s2 >> 24]) << 24) ^ (Word(rsbox[(s1 >> 16) & 0xff]) << 16) ^ (Word(rsbox[(s0 >> 8) & 0xff]) << 8) ^ Word(rsbox[s3 & 0xff]) ^ rk[2]);
+    store(&out[12], (Word(rsbox[s3 >> 24]) << 24) ^ (Word(rsbox[(s2 >> 16) & 0xff]) << 16) ^ (Word(rsbox[(s1 >> 8) & 0xff]) << 8) ^ Word(rsbox[s0 & 0xff]) ^ rk[3]);
 }
 
+#if defined(__rv64__)
 
-// The sub_bytes Function Substitutes the values in the
-// _state matrix with values in an S-box.
-void SWAES<16>::inv_sub_bytes(void)
+// RISC-V scalar cryptography (Zkne/Zknd), encoded with .insn so the rest of the system does not need to be built for it
+// This path has not been run yet: neither SiFive's cores nor QEMU's sifive_u machine implement Zkne/Zknd (see tests/aes_engines_test)
+// Each instruction yields half of the next state from the whole current one (rs1 = bytes 0-7, rs2 = bytes 8-15), so
+// the other half comes from swapping the operands; the *sm variants also do (Inv)MixColumns
+typedef unsigned long long Half;
+
+static inline Half aes64es(Half rs1, Half rs2) { Half rd; ASM(".insn r 0x33, 0, 0x19, %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2)); return rd; }
+static inline Half aes64esm(Half rs1, Half rs2) { Half rd; ASM(".insn r 0x33, 0, 0x1b, %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2)); return rd; }
+static inline Half aes64ds(Half rs1, Half rs2) { Half rd; ASM(".insn r 0x33, 0, 0x1d, %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2)); return rd; }
+static inline Half aes64dsm(Half rs1, Half rs2) { Half rd; ASM(".insn r 0x33, 0, 0x1f, %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2)); return rd; }
+
+void SWAES<16>::encrypt_instructions(const unsigned char * in, unsigned char * out)
 {
-    int i,j;
-    for(i=0;i<4;++i) {
-        for(j=0;j<4;++j) {
-            (*_state)[j][i] = rsbox[static_cast<int>((*_state)[j][i])];
-        }
+    const Half * rk = reinterpret_cast<const Half *>(_round_key);
+    Half s[2];
+
+    memcpy(s, in, BLOCK_SIZE); // "in" might not be aligned
+    s[0] ^= rk[0];
+    s[1] ^= rk[1];
+    for(unsigned int r = 1; r < Nr; r++) {
+        Half t0 = aes64esm(s[0], s[1]);
+        Half t1 = aes64esm(s[1], s[0]);
+        s[0] = t0 ^ rk[2 * r];
+        s[1] = t1 ^ rk[2 * r + 1];
     }
+    Half t0 = aes64es(s[0], s[1]);
+    Half t1 = aes64es(s[1], s[0]);
+    s[0] = t0 ^ rk[2 * Nr];
+    s[1] = t1 ^ rk[2 * Nr + 1];
+    memcpy(out, s, BLOCK_SIZE);
 }
 
-void SWAES<16>::inv_shift_rows(void)
+void SWAES<16>::decrypt_instructions(const unsigned char * in, unsigned char * out)
 {
-    unsigned char temp;
-
-    // Rotate first row 1 columns to right
-    temp            = (*_state)[3][1];
-    (*_state)[3][1] = (*_state)[2][1];
-    (*_state)[2][1] = (*_state)[1][1];
-    (*_state)[1][1] = (*_state)[0][1];
-    (*_state)[0][1] = temp;
-
-    // Rotate second row 2 columns to right
-    temp            = (*_state)[0][2];
-    (*_state)[0][2] = (*_state)[2][2];
-    (*_state)[2][2] = temp;
-
-    temp            = (*_state)[1][2];
-    (*_state)[1][2] = (*_state)[3][2];
-    (*_state)[3][2] = temp;
-
-    // Rotate third row 3 columns to right
-    temp            = (*_state)[0][3];
-    (*_state)[0][3] = (*_state)[1][3];
-    (*_state)[1][3] = (*_state)[2][3];
-    (*_state)[2][3] = (*_state)[3][3];
-    (*_state)[3][3] = temp;
+    const Half * rk = reinterpret_cast<const Half *>(_decryption_round_key);
+    Half s[2];
+
+    memcpy(s, in, BLOCK_SIZE);
+    s[0] ^= rk[0];
+    s[1] ^= rk[1];
+    for(unsigned int r = 1; r < Nr; r++) {
+        Half t0 = aes64dsm(s[0], s[1]);
+        Half t1 = aes64dsm(s[1], s[0]);
+        s[0] = t0 ^ rk[2 * r];
+        s[1] = t1 ^ rk[2 * r + 1];
+    }
+    Half t0 = aes64ds(s[0], s[1]);
+    Half t1 = aes64ds(s[1], s[0]);
+    s[0] = t0 ^ rk[2 * Nr];
+    s[1] = t1 ^ rk[2 * Nr + 1];
+    memcpy(out, s, BLOCK_SIZE);
 }
 
+#else
+
+// No AES instructions used in this architecture (ENGINE is always TABLES)
+// AArch64's Cryptographic Extension would need FP/SIMD, which EPOS neither enables (CPACR_EL1.FPEN) nor saves on context switches
+void SWAES<16>::encrypt_instructions(const unsigned char * in, unsigned char * out) { encrypt_tables(in, out); }
+void SWAES<16>::decrypt_instructions(const unsigned char * in, unsigned char * out) { decrypt_tables(in, out); }
 
-// cipher is the main function that encrypts the PlainText.
-void SWAES<16>::cipher(void)
+#endif
+
+void SWAES<16>::cbc_encrypt(const unsigned char * in, unsigned char * out, unsigned int blocks, unsigned char iv[BLOCK_SIZE])
 {
-    unsigned char round = 0;
-
-    // Add the First round key to the _state before starting the rounds.
-    add_round_key(0);
-
-    // There will be Nr rounds.
-    // The first Nr-1 rounds are identical.
-    // These Nr-1 rounds are executed in the loop below.
-    for(round = 1; round < Nr; ++round) {
-        sub_bytes();
-        shift_rows();
-        mix_columns();
-        add_round_key(round);
+    db<Ciphers>(TRC) << "AES::cbc_encrypt(in=" << in << ",out=" << out << ",blocks=" << blocks << ",iv=" << iv << ")" << endl;
+
+    unsigned char block[BLOCK_SIZE];
+    for(unsigned int b = 0; b < blocks; b++, in += BLOCK_SIZE, out += BLOCK_SIZE) {
+        for(unsigned int i = 0; i < BLOCK_SIZE; i++)
+            block[i] = in[i] ^ iv[i];
+        encrypt_block(block, out);
+        memcpy(iv, out, BLOCK_SIZE);
     }
-
-    // The last round is given below.
-    // The mix_columns function is not here in the last round.
-    sub_bytes();
-    shift_rows();
-    add_round_key(Nr);
 }
 
-void SWAES<16>::inv_cipher(void)
+void SWAES<16>::cbc_decrypt(const unsigned char * in, unsigned char * out, unsigned int blocks, unsigned char iv[BLOCK_SIZE])
 {
-    unsigned char round=0;
-
-    // Add the First round key to the _state before starting the rounds.
-    add_round_key(Nr);
-
-    // There will be Nr rounds.
-    // The first Nr-1 rounds are identical.
-    // These Nr-1 rounds are executed in the loop below.
-    for(round = Nr - 1; round > 0; round--) {
-        inv_shift_rows();
-        inv_sub_bytes();
-        add_round_key(round);
-        inv_mix_columns();
+    db<Ciphers>(TRC) << "AES::cbc_decrypt(in=" << in << ",out=" << out << ",blocks=" << blocks << ",iv=" << iv << ")" << endl;
+
+    unsigned char block[BLOCK_SIZE];
+    for(unsigned int b = 0; b < blocks; b++, in += BLOCK_SIZE, out += BLOCK_SIZE) {
+        memcpy(block, in, BLOCK_SIZE); // "in" is overwritten if ciphering in place
+        decrypt_block(in, out);
+        for(unsigned int i = 0; i < BLOCK_SIZE; i++)
+            out[i] ^= iv[i];
+        memcpy(iv, block, BLOCK_SIZE);
     }
+}
 
-    // The last round is given below.
-    // The mix_columns function is not here in the last round.
-    inv_shift_rows();
-    inv_sub_bytes();
-    add_round_key(0);
+void SWAES<16>::ctr(const unsigned char * in, unsigned char * out, unsigned int size, unsigned char counter[BLOCK_SIZE])
+{
+    db<Ciphers>(TRC) << "AES::ctr(in=" << in << ",out=" << out << ",size=" << size << ",counter=" << counter << ")" << endl;
+
+    unsigned char stream[BLOCK_SIZE];
+    while(size) {
+        encrypt_block(counter, stream);
+        for(int i = BLOCK_SIZE - 1; (i >= 0) && !++counter[i]; i--);
+
+        unsigned int n = (size < BLOCK_SIZE) ? size : BLOCK_SIZE;
+        for(unsigned int i = 0; i < n; i++)
+            out[i] = in[i] ^ stream[i];
+        in += n;
+        out += n;
+        size -= n;
+    }
 }
 
 __END_UTIL
@@ -4,11 +4,10 @@
 
 __BEGIN_UTIL
 
+// 2^128 - 2^97 - 1: SECG's secp128r1 prime, reduced by folding (FOLD = 97), used by Diffie_Hellman
+// (ff ff ff ff ff ff ff ff ff ff ff ff fd ff ff ff, generated from FOLD so the two never disagree)
 template<>
-const Bignum<16>::_Word Bignum<16>::_mod = {{ 0xff, 0xff, 0xff, 0xff,
-                                              0xff, 0xff, 0xff, 0xff,
-                                              0xff, 0xff, 0xff, 0xff,
-                                              0xfd, 0xff, 0xff, 0xff }};
+const Bignum<16>::_Word Bignum<16>::_mod = folding_modulus();
 
 template<>
 const Bignum<16>::_Barrett Bignum<16>::_barrett_u = {{ 17, 0, 0, 0,
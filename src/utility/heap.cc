@@ -4,6 +4,8 @@
 
 __BEGIN_UTIL
 
+Slab_Heap::Statistics Slab_Heap::_statistics[Slab_Heap::CPUS][Slab_Heap::CLASSES];
+
 void Heap_Base::out_of_memory(unsigned long bytes)
 {
     db<Heaps, System>(ERR) << "Heap::alloc(this=" << this << "): out of memory while allocating " << bytes << " bytes!" << endl;
@@ -0,0 +1,68 @@
+// EPOS Alarm Timing Wheel Benchmark
+//
+// Measures the cost of creating and destroying alarms while many others are pending,
+// and the jitter of a periodic alarm (deviation of each activation from its period).
+// Compare runs with Traits<Alarm>::tickless enabled and disabled.
+
+#include <time.h>
+
+using namespace EPOS;
+
+const unsigned int pending = 1000;
+const unsigned int iterations = 10000;
+const unsigned int activations = 100;
+const Microsecond period = 1000;
+
+OStream cout;
+
+volatile unsigned int count;
+TSC::Time_Stamp stamps[activations];
+
+void nop() {}
+void stamp() { if(count < activations) stamps[count++] = TSC::time_stamp(); }
+
+int main()
+{
+    cout << "Alarm Timing Wheel Benchmark" << endl;
+    cout << "tickless=" << Traits<Alarm>::tickless << ", pending=" << pending << ", iterations=" << iterations << endl;
+
+    Function_Handler nop_handler(&nop);
+    Alarm * alarms[pending];
+    for(unsigned int i = 0; i < pending; i++)
+        alarms[i] = new Alarm(60000000 + i * 997, &nop_handler); // far enough not to fire during the test
+
+    TSC::Time_Stamp begin = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++) {
+        Alarm * alarm = new Alarm(1000000 + (i % 1000) * 1013, &nop_handler);
+        delete alarm;
+    }
+    TSC::Time_Stamp end = TSC::time_stamp();
+
+    cout << "Create+destroy: " << (end - begin) * 1000000000ULL / TSC::frequency() / iterations << " ns per alarm" << endl;
+
+    Function_Handler stamp_handler(&stamp);
+    Alarm * periodic = new Alarm(period, &stamp_handler, activations);
+    while(count < activations)
+        Alarm::delay(period * 10);
+    delete periodic;
+
+    unsigned long long min = ~0ULL, max = 0, sum = 0;
+    for(unsigned int i = 1; i < activations; i++) {
+        unsigned long long interval = (stamps[i] - stamps[i - 1]) * 1000000ULL / TSC::frequency();
+        unsigned long long jitter = (interval > period) ? interval - period : period - interval;
+        if(jitter < min)
+            min = jitter;
+        if(jitter > max)
+            max = jitter;
+        sum += jitter;
+    }
+
+    cout << "Jitter (us): min=" << min << ", avg=" << sum / (activations - 1) << ", max=" << max << endl;
+
+    for(unsigned int i = 0; i < pending; i++)
+        delete alarms[i];
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+// EPOS Bignum and Elliptic Curve Diffie-Hellman Benchmark
+//
+// Compares the ways of multiplying available for Bignum<SIZE> (Barrett and folding reductions) and for the elliptic
+// curve points of Diffie_Hellman (double-and-add, fixed window and, for the default base point, fixed-base comb),
+// reporting operations per second. The results of each way are cross-checked against each other first.
+// This benchmark runs on RV64, where products use 64-bit limbs and the TSC is available (bignum_test's LM3S811 has
+// neither a usable TSC nor the stack for the window tables).
+
+#include <time.h>
+#include <machine.h>
+#include <utility/bignum.h>
+#include <utility/random.h>
+#include <utility/aes.h>
+#include <utility/diffie_hellman.h>
+
+using namespace EPOS;
+
+const unsigned int SIZE = 16;
+const unsigned int MULTIPLICATIONS = 10000;
+const unsigned int SCALAR_MULTIPLICATIONS = 20;
+
+typedef Diffie_Hellman<SWAES<SIZE>> DH;
+
+OStream cout;
+
+unsigned long long ops(unsigned int n, const TSC::Time_Stamp & ticks)
+{
+    return ticks ? static_cast<unsigned long long>(n) * TSC::frequency() / ticks : 0;
+}
+
+int main()
+{
+    cout << "Bignum Benchmark" << endl;
+
+    unsigned int seed = Random::random();
+    Random::seed(seed);
+    cout << "Random seed = " << seed << endl;
+
+    unsigned int failed = 0;
+    Bignum<SIZE> a, b, c;
+
+    for(unsigned int i = 0; i < MULTIPLICATIONS; i++) {
+        a.randomize();
+        b.randomize();
+        c = a;
+        a.barrett_multiply(b);
+        c.folding_multiply(b);
+        failed += (a != c);
+    }
+
+    a.randomize();
+    b.randomize();
+    c = a;
+    TSC::Time_Stamp t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < MULTIPLICATIONS; i++)
+        a.barrett_multiply(b);
+    TSC::Time_Stamp barrett = TSC::time_stamp() - t0;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < MULTIPLICATIONS; i++)
+        c.folding_multiply(b);
+    TSC::Time_Stamp folding = TSC::time_stamp() - t0;
+    failed += (a != c);
+
+    cout << "multiplication\tverified\tops/s" << endl;
+    cout << "Barrett\t\t" << (failed ? "ERROR" : "OK") << "\t\t" << ops(MULTIPLICATIONS, barrett) << endl;
+    cout << "folding\t\t" << (failed ? "ERROR" : "OK") << "\t\t" << ops(MULTIPLICATIONS, folding) << endl;
+
+    // Scalar multiplications of an arbitrary point (a public key) and of the base point (key pair generation),
+    // all checked against double-and-add
+    DH dh;
+    DH::Public_Key point = dh.public_key();
+    DH::Public_Key base = dh.base_point();
+    DH::Comb comb = dh.comb();
+    DH::Public_Key p, q;
+    unsigned int window_mismatches = 0;
+    unsigned int comb_mismatches = 0;
+    for(unsigned int i = 0; i < SCALAR_MULTIPLICATIONS; i++) {
+        a.randomize();
+        p = point;
+        p.binary_multiply(a);
+        q = point;
+        q *= a;
+        window_mismatches += (p.x != q.x) || (p.y != q.y);
+
+        p = base;
+        p.binary_multiply(a);
+        q.comb_multiply(a, comb);
+        comb_mismatches += (p.x != q.x) || (p.y != q.y);
+    }
+    failed += window_mismatches + comb_mismatches;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < SCALAR_MULTIPLICATIONS; i++) {
+        p = point;
+        p.binary_multiply(a);
+    }
+    TSC::Time_Stamp binary = TSC::time_stamp() - t0;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < SCALAR_MULTIPLICATIONS; i++) {
+        q = point;
+        q *= a;
+    }
+    TSC::Time_Stamp window = TSC::time_stamp() - t0;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < SCALAR_MULTIPLICATIONS; i++)
+        q.comb_multiply(a, comb);
+    TSC::Time_Stamp fixed_base = TSC::time_stamp() - t0;
+
+    cout << "scalar multiplication\tverified\tops/s" << endl;
+    cout << "double-and-add\t\t" << "-" << "\t\t" << ops(SCALAR_MULTIPLICATIONS, binary) << endl;
+    cout << "fixed window\t\t" << (window_mismatches ? "ERROR" : "OK") << "\t\t" << ops(SCALAR_MULTIPLICATIONS, window) << endl;
+    cout << "fixed-base comb\t\t" << (comb_mismatches ? "ERROR" : "OK") << "\t\t" << ops(SCALAR_MULTIPLICATIONS, fixed_base) << endl;
+
+    if(failed)
+        cout << "Benchmark cross-checks failed!" << endl;
+    else
+        cout << "The end!" << endl;
+
+    return 0;
+}
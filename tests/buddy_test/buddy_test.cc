@@ -0,0 +1,139 @@
+// EPOS Buddy Frame Allocator Test Program
+//
+// With Traits<MMU>::buddy, MMU::alloc() must return blocks aligned to the power of two that holds them. A region taken
+// from the MMU is then handed to a private Buddy_List, whose state can be inspected, to check that blocks are split on
+// allocation and merged back on release, that single frames go through the per-CPU cache, and that concurrent
+// allocations from all CPUs neither overlap nor lose frames.
+
+#include <memory.h>
+#include <process.h>
+#include <utility/buddy.h>
+#include <utility/random.h>
+
+using namespace EPOS;
+
+typedef MMU::Frame Frame;
+typedef Buddy_List<Frame> List;
+
+const unsigned int CPUS = Traits<Machine>::CPUS;
+const unsigned long REGION = 2048; // frames
+const unsigned long BLOCK = 300; // frames, split from a 512-frame block
+const unsigned int OUTSTANDING = 16; // blocks per thread
+const unsigned int ROUNDS = 1000;
+
+OStream cout;
+
+List list;
+unsigned int failures;
+
+unsigned int block_order(unsigned long n) { unsigned int k = 0; while((1UL << k) < n) k++; return k; }
+unsigned long number(Frame * f) { return reinterpret_cast<unsigned long>(f) / sizeof(Frame); }
+unsigned long * stamp(Frame * f) { return MMU::phy2log(f); }
+
+Frame * allocate(unsigned long n)
+{
+    List::Element * e = list.search_decrementing(n);
+    return e ? e->object() + e->size() : 0;
+}
+
+void release(Frame * f, unsigned long n)
+{
+    List::Element * m1, * m2;
+    list.insert_merging(new (MMU::phy2log(f)) List::Element(f, n), &m1, &m2);
+}
+
+void check(bool condition, const char * what)
+{
+    if(!condition) {
+        cout << "  " << what << " => failed!" << endl;
+        failures++;
+    }
+}
+
+int worker(unsigned int id);
+
+int main()
+{
+    cout << "Buddy test" << endl;
+    cout << "CPUS=" << CPUS << ", buddy=" << Traits<MMU>::buddy << endl;
+
+    cout << "MMU::alloc() alignment:" << endl;
+    const unsigned long sizes[] = {1, 3, 16, 100, REGION};
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        Frame * f = MMU::alloc(sizes[i]);
+        check(f && !(number(f) & ((1UL << block_order(sizes[i])) - 1)), "aligned block");
+        MMU::free(f, sizes[i]);
+    }
+
+    Frame * region = MMU::alloc(REGION);
+    release(region, REGION);
+    check(list.grouped_size() == REGION, "initial size");
+
+    cout << "Split and merge:" << endl;
+    Frame * b = allocate(BLOCK);
+    check(b && (b >= region) && (b + BLOCK <= region + REGION), "block inside region");
+    check(!(number(b) & ((1UL << block_order(BLOCK)) - 1)), "aligned block");
+    check(list.grouped_size() == REGION - BLOCK, "unused tail given back");
+    check(list.head()->size() < (1UL << block_order(BLOCK)), "block split");
+    release(b, BLOCK);
+    check(list.grouped_size() == REGION, "size after release");
+    check(list.head()->size() == (1UL << block_order(BLOCK)), "buddies merged");
+
+    cout << "Per-CPU cache:" << endl;
+    Frame * f = allocate(1);
+    release(f, 1);
+    check(list.grouped_size() == REGION, "cached frame counted");
+    check(allocate(1) == f, "cached frame reused");
+    release(f, 1);
+
+    cout << "Concurrent allocations:" << endl;
+    Thread * threads[CPUS];
+    for(unsigned int i = 0; i < CPUS; i++)
+        threads[i] = new Thread(&worker, i);
+    for(unsigned int i = 0; i < CPUS; i++)
+        failures += threads[i]->join();
+    for(unsigned int i = 0; i < CPUS; i++)
+        delete threads[i];
+    check(list.grouped_size() == REGION, "no frames lost");
+
+    MMU::free(region, REGION);
+
+    if(failures)
+        cout << "FAILED: " << failures << " checks!" << endl;
+    else
+        cout << "The end!" << endl;
+
+    return 0;
+}
+
+// Each block is stamped with its owner in its first word, so blocks handed out twice are caught when released
+int worker(unsigned int id)
+{
+    const unsigned long sizes[] = {1, 1, 1, 2, 3, 5, 8, 16};
+
+    Frame * blocks[OUTSTANDING];
+    unsigned long lengths[OUTSTANDING];
+    int failed = 0;
+
+    for(unsigned int r = 0; r < ROUNDS; r++) {
+        unsigned int n = 0;
+        for(; n < OUTSTANDING; n++) {
+            lengths[n] = sizes[Random::random() % (sizeof(sizes) / sizeof(sizes[0]))];
+            blocks[n] = allocate(lengths[n]);
+            if(!blocks[n])
+                break;
+            *stamp(blocks[n]) = (id << 16) | n;
+        }
+
+        for(unsigned int i = 0; i < n; i++) {
+            if(*stamp(blocks[i]) != ((id << 16) | i))
+                failed++;
+            release(blocks[i], lengths[i]);
+        }
+    }
+
+    if(failed)
+        cout << "  worker(" << id << ") => " << failed << " blocks overlapped!" << endl;
+
+    return failed;
+}
@@ -0,0 +1,330 @@
+#ifndef __traits_h
+#define __traits_h
+
+#include <system/config.h>
+
+__BEGIN_SYS
+
+// Build
+template<> struct Traits<Build>: public Traits_Tokens
+{
+    // Basic configuration
+    static const unsigned int SMOD = LIBRARY;
+    static const unsigned int ARCHITECTURE = RV64;
+    static const unsigned int MACHINE = RISCV;
+    static const unsigned int MODEL = SiFive_U;
+    static const unsigned int CPUS = ((MODEL == Legacy_PC) || (MODEL == Raspberry_Pi3) || (MODEL == Realview_PBX) || (MODEL == Zynq) || (MODEL == SiFive_U)) ? 2 : 1;
+    static const unsigned int NETWORKING = STANDALONE;
+    static const unsigned int EXPECTED_SIMULATION_TIME = 60; // s (0 => not simulated)
+
+    // Default flags
+    static const bool enabled = true;
+    static const bool monitored = false;
+    static const bool debugged = true;
+    static const bool hysterically_debugged = false;
+};
+
+
+// Utilities
+template<> struct Traits<Debug>: public Traits<Build>
+{
+    static const bool error   = true;
+    static const bool warning = true;
+    static const bool info    = false;
+    static const bool trace   = false;
+};
+
+template<> struct Traits<Lists>: public Traits<Build>
+{
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<Spin>: public Traits<Build>
+{
+    static const bool debugged = hysterically_debugged;
+};
+
+template<> struct Traits<Heaps>: public Traits<Build>
+{
+    static const bool debugged = hysterically_debugged;
+    static const bool slab = false; // per-CPU size-class magazines in front of the heaps
+};
+
+template<> struct Traits<Observers>: public Traits<Build>
+{
+    // Some observed objects are created before initializing the Display
+    // Enabling debug may cause trouble in some Machines
+    static const bool debugged = false;
+};
+
+
+// System Parts (mostly to fine control debugging)
+template<> struct Traits<Boot>: public Traits<Build>
+{
+};
+
+template<> struct Traits<Setup>: public Traits<Build>
+{
+};
+
+template<> struct Traits<Init>: public Traits<Build>
+{
+};
+
+template<> struct Traits<Framework>: public Traits<Build>
+{
+    static const bool syscall_ring = false; // batched submission of non-blocking system calls through a ring shared with the kernel
+};
+
+template<> struct Traits<Aspect>: public Traits<Build>
+{
+    static const bool debugged = hysterically_debugged;
+};
+
+
+// Mediators (architecture traits are inlined to enable the buddy frame allocator)
+template<> struct Traits<CPU>: public Traits<Build>
+{
+    enum {LITTLE, BIG};
+    static const unsigned int ENDIANESS         = LITTLE;
+    static const unsigned int WORD_SIZE         = 64;
+    static const unsigned long CLOCK            = (MODEL == SiFive_U) ? 1000000000L : (MODEL == VisionFive2) ? 600000000L : 50000000;
+    static const bool unaligned_memory_access   = false;
+    static const bool atomic_memory_operations  = (MODEL == SiFive_U || MODEL == VisionFive2);
+    static const bool aes_instructions          = false;    // scalar cryptography (Zkne/Zknd), not in SiFive's U54 nor U74 (nor in QEMU's sifive_u), so still untested
+    static const bool vector_instructions       = false;    // V extension (RVV 1.0), not in SiFive's U54 nor U74
+};
+
+template<> struct Traits<MMU>: public Traits<Build>
+{
+    static const bool colorful = false;
+    static const unsigned int COLORS = 1;
+    static const bool buddy = true;  // buddy frame allocator with per-CPU single frame caches
+};
+
+template<> struct Traits<FPU>: public Traits<Build>
+{
+    static const bool enabled = true;
+    static const bool user_save = true;
+    static const bool lazy = false;     // disable the FPU on dispatch and save/restore its state only for threads that use it
+};
+
+template<> struct Traits<TSC>: public Traits<Build>
+{
+    static const bool enabled = true;
+};
+
+template<> struct Traits<PMU>: public Traits<Build>
+{
+    static const bool enabled = true;
+};
+
+__END_SYS
+
+#include __MACHINE_TRAITS_H
+
+__BEGIN_SYS
+
+
+// API Components
+template<> struct Traits<Application>: public Traits<Build>
+{
+    static const unsigned int STACK_SIZE = Traits<Machine>::STACK_SIZE;
+    static const unsigned int HEAP_SIZE = Traits<Machine>::HEAP_SIZE;
+    static const unsigned int MAX_THREADS = Traits<Machine>::MAX_THREADS;
+};
+
+template<> struct Traits<System>: public Traits<Build>
+{
+    static const bool multithread = (Traits<Application>::MAX_THREADS > 1) || (CPUS > 1);
+    static const bool multitask = (SMOD != LIBRARY);
+    static const bool multicore = multithread && (CPUS > 1);
+    static const bool multiheap = multitask || Traits<Scratchpad>::enabled;
+
+    static const unsigned long LIFE_SPAN = 1 * YEAR; // s
+    static const unsigned int DUTY_CYCLE = 1000000; // ppm
+
+    static const bool reboot = true;
+
+    static const unsigned int STACK_SIZE = Traits<Machine>::STACK_SIZE;
+    static const unsigned int HEAP_SIZE = (Traits<Application>::MAX_THREADS + Traits<Build>::CPUS) * (multitask ? STACK_SIZE : Traits<Application>::STACK_SIZE);
+};
+
+template<> struct Traits<Task>: public Traits<Build>
+{
+    static const bool enabled = Traits<System>::multitask;
+};
+
+template<> struct Traits<Thread>: public Traits<Build>
+{
+    static const bool enabled = Traits<System>::multithread;
+    static const bool smp = Traits<System>::multicore;
+    static const bool trace_idle = hysterically_debugged;
+    static const bool simulate_capacity = false;
+    static const bool queue_locking = false;  // per-queue scheduler locks for partitioned criteria (e.g. Fixed_CPU, PEDF)
+    static const bool lock_profiling = false; // per-CPU scheduler lock wait and hold times
+    static const bool work_stealing = false;  // idle CPUs pull best-effort threads from the busiest queue of partitioned criteria (e.g. Fixed_CPU)
+    static const unsigned int STEAL_INTERVAL = 1000; // us, minimum time between two steals by the same CPU
+
+    typedef IF<(CPUS > 1), Fixed_CPU, Priority>::Result Criterion;
+    static const unsigned int QUANTUM = 10000; // us
+};
+
+template<> struct Traits<Scheduler<Thread>>: public Traits<Build>
+{
+    static const bool debugged = Traits<Thread>::trace_idle || hysterically_debugged;
+    static const bool indexed_queues = false; // priority bitmap (static criteria) or pairing heap (dynamic criteria) run-queues
+    static const bool enforce_capacity = false; // periodic EDF jobs that overrun their capacity have their deadlines postponed (see EDF)
+};
+
+template<> struct Traits<Synchronizer>: public Traits<Build>
+{
+    static const bool enabled = Traits<System>::multithread;
+};
+
+template<> struct Traits<Alarm>: public Traits<Build>
+{
+    static const bool visible = hysterically_debugged;
+    static const bool tickless = false; // one-shot timer programming and a timing wheel instead of periodic ticks
+};
+
+template<> struct Traits<SmartData>: public Traits<Build>
+{
+    static const unsigned char PREDICTOR = NONE;
+};
+
+template<> struct Traits<Network>: public Traits<Build>
+{
+    typedef LIST<> NETWORKS;
+
+    static const unsigned int RETRIES = 3;
+    static const unsigned int TIMEOUT = 10; // s
+
+    static const bool enabled = (Traits<Build>::NETWORKING != STANDALONE) && (NETWORKS::Length > 0);
+};
+
+template<> struct Traits<ELP>: public Traits<Network>
+{
+    typedef Ethernet NIC_Family;
+    static constexpr unsigned int NICS[] = {0}; // relative to NIC_Family (i.e. Traits<Ethernet>::DEVICES[NICS[i]]
+    static const unsigned int UNITS = COUNTOF(NICS);
+
+    static const bool enabled = Traits<Network>::enabled && (NETWORKS::Count<ELP>::Result > 0);
+};
+
+template<> struct Traits<TSTP>: public Traits<Network>
+{
+    typedef Ethernet NIC_Family;
+    static constexpr unsigned int NICS[] = {0}; // relative to NIC_Family (i.e. Traits<Ethernet>::DEVICES[NICS[i]]
+    static const unsigned int UNITS = COUNTOF(NICS);
+
+    static const unsigned int KEY_SIZE = 16;
+    static const unsigned int RADIO_RANGE = 8000; // approximated radio range in centimeters
+
+    static const bool enabled = Traits<Network>::enabled && (NETWORKS::Count<TSTP>::Result > 0);
+};
+
+template<> struct Traits<IP>: public Traits<Network>
+{
+    typedef Ethernet NIC_Family;
+    static constexpr unsigned int NICS[] = {0};  // relative to NIC_Family (i.e. Traits<Ethernet>::DEVICES[NICS[i]]
+    static const unsigned int UNITS = COUNTOF(NICS);
+
+    struct Default_Config {
+        static const unsigned int  TYPE    = DHCP;
+        static const unsigned long ADDRESS = 0;
+        static const unsigned long NETMASK = 0;
+        static const unsigned long GATEWAY = 0;
+    };
+
+    template<unsigned int UNIT>
+    struct Config: public Default_Config {};
+
+    static const unsigned int TTL  = 0x40; // Time-to-live
+
+    static const bool enabled = Traits<Network>::enabled && (NETWORKS::Count<IP>::Result > 0);
+};
+
+template<> struct Traits<UDP>: public Traits<Network>
+{
+    static const bool checksum = true;
+};
+
+template<> struct Traits<TCP>: public Traits<Network>
+{
+    static const unsigned int WINDOW = 4096;
+};
+
+template<> struct Traits<DHCP>: public Traits<Network>
+{
+};
+
+template<> struct Traits<Monitor>: public Traits<Build>
+{
+    static const bool enabled = monitored;
+    static const bool trace = false;                    // stream a binary trace instead of keeping snapshots until shutdown (see tools/epostrace)
+    static const unsigned int TRACE_SIZE = 4096;        // bytes per CPU (a power of 2)
+    static const unsigned int TRACE_PERIOD = 10000;     // us between drains
+
+    static constexpr System_Event       SYSTEM_EVENTS[]                 = { RUNNING_THREAD,
+                                                                            JOB_UTILIZATION,
+                                                                            CPU_CLOCK,
+                                                                          };
+    static constexpr Hertz              SYSTEM_EVENTS_FREQUENCIES[]     = { 34,
+                                                                            34,
+                                                                            34,
+                                                                          }; // in Hz
+    // FIX: Temporary solution
+    static constexpr unsigned long long SYSTEM_EVENTS_CORES[]        = { 0b1110,
+                                                                         0b1110,
+                                                                         0b0001,
+                                                                       };
+
+    // Reading PMU while in QEMU is only available with KVM enabled, thus, if this feature is not available
+    // the execution will stop at the first Monitor::run() with Monitor::_enable set to true due to PMU::read() execution (PMU::config works fine)
+    // (after the execution of Monitor::enable_captures(), which only this test is using)
+    // This code is functional when running this application in a real machine (or enabling the KVM feature) 
+    static constexpr PMU_Event          PMU_EVENTS[]                    = { CPU_CYCLES,
+                                                                            INSTRUCTIONS_RETIRED,
+
+                                                                            L1_DATA_CACHE_WRITEBACKS,
+                                                                            ARCHITECTURE_DEPENDENT_EVENT60,
+
+                                                                            // ARCHITECTURE_DEPENDENT_EVENT113,
+                                                                            // ARCHITECTURE_DEPENDENT_EVENT114,
+                                                                            // ARCHITECTURE_DEPENDENT_EVENT101,
+                                                                            // ARCHITECTURE_DEPENDENT_EVENT106,
+                                                                            // ARCHITECTURE_DEPENDENT_EVENT109,
+                                                                            // ARCHITECTURE_DEPENDENT_EVENT112
+                                                                          };
+    static constexpr Hertz              PMU_EVENTS_FREQUENCIES[]        = { 34,
+                                                                            34,
+                                                                            34,
+                                                                            34,
+                                                                            // 34,
+                                                                            // 34,
+                                                                            // 34,
+                                                                            // 34,
+                                                                            // 34,
+                                                                            // 34
+                                                                          }; // in Hz
+    // FIX: Temporary solution
+    static constexpr unsigned long long PMU_EVENTS_CORES[]              = { 0b0000,
+                                                                            0b0000,
+                                                                            0b0000,
+                                                                            0b0000,
+                                                                            // 0b0001,
+                                                                            // 0b0001,
+                                                                            // 0b0001,
+                                                                            // 0b0001,
+                                                                            // 0b0001,
+                                                                            // 0b0001,
+                                                                          };
+
+    static constexpr Transducer_Event   TRANSDUCER_EVENTS[]             = { };
+    static constexpr Hertz              TRANSDUCER_EVENTS_FREQUENCIES[] = { }; // in Hz
+};
+
+__END_SYS
+
+#endif
@@ -0,0 +1,121 @@
+// EPOS Constant Bandwidth Server Test Program
+//
+// On each CPU, a periodic thread shares the CPU with two aperiodic threads that never block, hosted by a CBS that
+// reserves 20% of that CPU for them. Without the server, the aperiodic threads would run as much as EDF let them; with
+// it, the periodic thread must not miss any deadline and the aperiodic threads must get about their reserved share.
+// All threads are created by the main thread on the first CPU, so servers of the other CPUs are woken up remotely,
+// but threads hosted by a server must only run on the server's CPU.
+// A second periodic thread on the first CPU overruns its declared capacity every other job, so it has its deadline
+// postponed instead of delaying the first one.
+// This test requires an EDF-based Traits<Thread>::Criterion (PEDF on multicores) and
+// Traits<Scheduler<Thread>>::enforce_capacity.
+
+#include <time.h>
+#include <real-time.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Machine>::CPUS;
+const unsigned int JOBS = 50;
+const Microsecond PERIOD = 50000;
+const Microsecond WCET = 20000;
+const Microsecond OVERRUN_PERIOD = 100000;
+const Microsecond OVERRUN_WCET = 10000;
+const Microsecond SERVER_BUDGET = 10000;
+const Microsecond SERVER_PERIOD = 50000;
+
+OStream cout;
+Chronometer chrono;
+
+CBS * servers[CPUS];
+
+volatile bool done;
+volatile unsigned int misses[CPUS];
+volatile unsigned int jobs[CPUS];
+volatile unsigned int strays[CPUS];
+volatile unsigned long long spins[CPUS][2];
+
+void busy(Microsecond time)
+{
+    for(Microsecond end = chrono.read() + time; chrono.read() < end;);
+}
+
+void job()
+{
+    // Jobs are released every PERIOD since the chronometer started, on the CPU the thread was created for
+    unsigned int cpu = CPU::id();
+    Microsecond release = jobs[cpu] * PERIOD;
+    busy(WCET);
+    if(chrono.read() > release + PERIOD)
+        misses[cpu]++;
+    jobs[cpu]++;
+}
+
+void overrunning_job()
+{
+    static unsigned int n;
+    busy(OVERRUN_WCET * ((n++ % 2) ? 3 : 1));
+}
+
+int hog(unsigned int cpu, unsigned int id)
+{
+    while(!done) {
+        spins[cpu][id]++;
+        if(CPU::id() != servers[cpu]->cpu())
+            strays[cpu]++;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    cout << "CBS Test" << endl;
+
+    for(unsigned int i = 0; i < CPUS; i++)
+        servers[i] = new CBS(SERVER_BUDGET, SERVER_PERIOD, i);
+
+    RT_Thread * periodic[CPUS];
+    Thread * hogs[CPUS][2];
+
+    chrono.start();
+    for(unsigned int i = 0; i < CPUS; i++)
+        periodic[i] = new RT_Thread(&job, PERIOD, PERIOD, WCET, RT_Thread::NOW, JOBS, i);
+    RT_Thread * overrunning = new RT_Thread(&overrunning_job, OVERRUN_PERIOD, OVERRUN_PERIOD, OVERRUN_WCET, RT_Thread::NOW, JOBS * PERIOD / OVERRUN_PERIOD, 0);
+    for(unsigned int i = 0; i < CPUS; i++)
+        for(unsigned int j = 0; j < 2; j++)
+            hogs[i][j] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(servers[i])), &hog, i, j);
+
+    for(unsigned int i = 0; i < CPUS; i++)
+        periodic[i]->join();
+    overrunning->join();
+    done = true;
+    for(unsigned int i = 0; i < CPUS; i++)
+        for(unsigned int j = 0; j < 2; j++)
+            hogs[i][j]->join();
+    chrono.stop();
+
+    unsigned int failures = 0;
+    for(unsigned int i = 0; i < CPUS; i++) {
+        cout << "CPU " << i << ":" << endl;
+        cout << "  Periodic thread: " << jobs[i] << " jobs, " << misses[i] << " deadline misses" << endl;
+        cout << "  Server: " << servers[i]->postponements() << " budget exhaustions in " << chrono.read() / SERVER_PERIOD << " periods" << endl;
+        cout << "  Aperiodic threads: " << spins[i][0] << " and " << spins[i][1] << " iterations, " << strays[i] << " away from the server's CPU" << endl;
+        failures += misses[i] + strays[i];
+    }
+
+    for(unsigned int i = 0; i < CPUS; i++) {
+        delete periodic[i];
+        for(unsigned int j = 0; j < 2; j++)
+            delete hogs[i][j];
+        delete servers[i];
+    }
+    delete overrunning;
+
+    if(failures)
+        cout << "The servers did not protect the periodic threads or let hosted threads migrate!" << endl;
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -1,13 +1,116 @@
 // EPOS Cipher Mediator Test Program
 
 #include <utility/random.h>
+#include <utility/aes.h>
 #include <machine.h>
+#include <time.h>
 
 using namespace EPOS;
 
 OStream cout;
 
 static const unsigned int ITERATIONS = 100;
+static const unsigned int STREAM = 4096; // bytes ciphered to measure throughput
+
+typedef SWAES<16> Engine;
+
+unsigned long long throughput(unsigned int bytes, const TSC::Time_Stamp & ticks)
+{
+    return ticks ? static_cast<unsigned long long>(bytes) * TSC::frequency() / ticks / 1000000 : 0;
+}
+
+// Checks each software AES engine against the NIST SP 800-38A vectors and against the T-tables engine, reporting
+// the throughput of each mode
+unsigned int engines_test()
+{
+    // NIST SP 800-38A F.2.1 (CBC-AES128.Encrypt) and F.5.1 (CTR-AES128.Encrypt), same key as F.1.1
+    const unsigned char key[] = {0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c};
+    const unsigned char clear_text[64] = {0x6b,0xc1,0xbe,0xe2,0x2e,0x40,0x9f,0x96,0xe9,0x3d,0x7e,0x11,0x73,0x93,0x17,0x2a,
+                                          0xae,0x2d,0x8a,0x57,0x1e,0x03,0xac,0x9c,0x9e,0xb7,0x6f,0xac,0x45,0xaf,0x8e,0x51,
+                                          0x30,0xc8,0x1c,0x46,0xa3,0x5c,0xe4,0x11,0xe5,0xfb,0xc1,0x19,0x1a,0x0a,0x52,0xef,
+                                          0xf6,0x9f,0x24,0x45,0xdf,0x4f,0x9b,0x17,0xad,0x2b,0x41,0x7b,0xe6,0x6c,0x37,0x10};
+    const unsigned char cbc_iv[16] = {0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f};
+    const unsigned char cbc[64] = {0x76,0x49,0xab,0xac,0x81,0x19,0xb2,0x46,0xce,0xe9,0x8e,0x9b,0x12,0xe9,0x19,0x7d,
+                                   0x50,0x86,0xcb,0x9b,0x50,0x72,0x19,0xee,0x95,0xdb,0x11,0x3a,0x91,0x76,0x78,0xb2,
+                                   0x73,0xbe,0xd6,0xb8,0xe3,0xc1,0x74,0x3b,0x71,0x16,0xe6,0x9e,0x22,0x22,0x95,0x16,
+                                   0x3f,0xf1,0xca,0xa1,0x68,0x1f,0xac,0x09,0x12,0x0e,0xca,0x30,0x75,0x86,0xe1,0xa7};
+    const unsigned char ctr_counter[16] = {0xf0,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa,0xfb,0xfc,0xfd,0xfe,0xff};
+    const unsigned char ctr[64] = {0x87,0x4d,0x61,0x91,0xb6,0x20,0xe3,0x26,0x1b,0xef,0x68,0x64,0x99,0x0d,0xb6,0xce,
+                                   0x98,0x06,0xf6,0x6b,0x79,0x70,0xfd,0xff,0x86,0x17,0x18,0x7b,0xb9,0xff,0xfd,0xff,
+                                   0x5a,0xe4,0xdf,0x3e,0xdb,0xd5,0xd3,0x5e,0x5b,0x4f,0x09,0x02,0x0d,0xb0,0x3e,0xab,
+                                   0x1e,0x03,0x1d,0xda,0x2f,0xbe,0x03,0xd1,0x79,0x21,0x70,0xa0,0xf3,0x00,0x9c,0xee};
+
+    static unsigned char data[STREAM];
+    static unsigned char reference[STREAM];
+    static unsigned char result[STREAM];
+    for(unsigned int i = 0; i < STREAM; i++)
+        data[i] = Random::random();
+
+    unsigned int failed = 0;
+    unsigned char buf[64];
+    unsigned char iv[16];
+
+    Engine::Engine engines[] = {Engine::TABLES, Engine::ENGINE};
+    unsigned int count = (Engine::ENGINE == Engine::TABLES) ? 1 : 2;
+
+    cout << endl;
+    cout << "engine\tverified\tECB\tCBC enc\tCBC dec\tCTR (MB/s)" << endl;
+    for(unsigned int e = 0; e < count; e++) {
+        Engine aes(Engine::ECB, engines[e]);
+        bool ok = true;
+
+        aes.key(key);
+        memcpy(iv, cbc_iv, 16);
+        aes.cbc_encrypt(clear_text, buf, 4, iv);
+        ok &= !memcmp(buf, cbc, 64);
+        memcpy(iv, cbc_iv, 16);
+        aes.cbc_decrypt(buf, buf, 4, iv); // in place
+        ok &= !memcmp(buf, clear_text, 64);
+
+        memcpy(iv, ctr_counter, 16);
+        aes.ctr(clear_text, buf, 64, iv);
+        ok &= !memcmp(buf, ctr, 64);
+
+        // Cross-check on random data with a random key
+        unsigned char k[16];
+        for(unsigned int i = 0; i < 16; i++)
+            k[i] = data[i] ^ 0x5a;
+        aes.key(k);
+        memset(iv, 0, 16);
+        aes.cbc_encrypt(data, result, STREAM / 16, iv);
+        if(e == 0)
+            memcpy(reference, result, STREAM);
+        else
+            ok &= !memcmp(result, reference, STREAM);
+
+        TSC::Time_Stamp t0 = TSC::time_stamp();
+        for(unsigned int i = 0; i < STREAM; i += 16)
+            aes.encrypt(&data[i], k, &result[i]);
+        TSC::Time_Stamp ecb = TSC::time_stamp() - t0;
+
+        memset(iv, 0, 16);
+        t0 = TSC::time_stamp();
+        aes.cbc_encrypt(data, result, STREAM / 16, iv);
+        TSC::Time_Stamp cbc_enc = TSC::time_stamp() - t0;
+
+        memset(iv, 0, 16);
+        t0 = TSC::time_stamp();
+        aes.cbc_decrypt(result, result, STREAM / 16, iv);
+        TSC::Time_Stamp cbc_dec = TSC::time_stamp() - t0;
+        ok &= !memcmp(result, data, STREAM);
+
+        memset(iv, 0, 16);
+        t0 = TSC::time_stamp();
+        aes.ctr(data, result, STREAM, iv);
+        TSC::Time_Stamp ctr_enc = TSC::time_stamp() - t0;
+
+        failed += !ok;
+        cout << ((engines[e] == Engine::TABLES) ? "tables" : "instructions") << "\t" << (ok ? "OK" : "ERROR") << "\t\t"
+             << throughput(STREAM, ecb) << "\t" << throughput(STREAM, cbc_enc) << "\t" << throughput(STREAM, cbc_dec) << "\t" << throughput(STREAM, ctr_enc) << endl;
+    }
+
+    return failed;
+}
 
 int main()
 {
@@ -156,6 +259,8 @@ int main()
         cout << endl;
     }
 
+    tests_failed += engines_test();
+
     cout << endl;
     cout << "Tests finished with " << tests_failed << " error" << (tests_failed > 1 ? "s" : "") << " detected." << endl;
     cout << endl;
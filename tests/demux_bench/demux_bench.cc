@@ -0,0 +1,105 @@
+// EPOS Demultiplexing Benchmark
+//
+// Binds from 1 to 1000 observers to distinct ports, as UDP sockets would do, and measures how long it takes to
+// notify one of them through a Data_Observed, which scans all observers, and through a Hashed_Data_Observed with as
+// many buckets as UDP::Demultiplexer, which only scans the bucket of the notified port.
+// Each notification must reach exactly the observer bound to the port, and notifying an unbound port must fail.
+
+#include <time.h>
+#include <utility/random.h>
+#include <utility/observer.h>
+
+using namespace EPOS;
+
+typedef unsigned short Port_Number;
+typedef int Datum;
+
+const unsigned int MAX_PORTS = 1000;
+const unsigned int BUCKETS = 256;
+const unsigned int NOTIFICATIONS = 10000;
+
+typedef Data_Observed<Datum, Port_Number> Linear;
+typedef Hashed_Data_Observed<Datum, Port_Number, BUCKETS> Hashed;
+
+class Socket: public Data_Observer<Datum, Port_Number>
+{
+public:
+    Socket(): _port(0), _updates(0) {}
+
+    void bind(Port_Number port) { _port = port; }
+    Port_Number port() const { return _port; }
+    unsigned int updates() const { return _updates; }
+
+    void update(Data_Observed<Datum, Port_Number> * obs, const Port_Number & port, Datum * d) {
+        if(port == _port)
+            _updates++;
+    }
+
+private:
+    Port_Number _port;
+    unsigned int _updates;
+};
+
+OStream cout;
+
+Socket sockets[MAX_PORTS];
+Port_Number targets[NOTIFICATIONS];
+
+template<typename Observed>
+unsigned long long measure(unsigned int ports, int * errors)
+{
+    Observed observed;
+    Datum datum = 0;
+
+    for(unsigned int i = 0; i < ports; i++)
+        observed.attach(&sockets[i], sockets[i].port());
+
+    for(unsigned int i = 0; i < NOTIFICATIONS; i++)
+        targets[i] = sockets[Random::random() % ports].port();
+
+    unsigned int before = 0;
+    for(unsigned int i = 0; i < ports; i++)
+        before += sockets[i].updates();
+
+    TSC::Time_Stamp t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < NOTIFICATIONS; i++)
+        if(!observed.notify(targets[i], &datum))
+            (*errors)++;
+    TSC::Time_Stamp t1 = TSC::time_stamp();
+
+    unsigned int after = 0;
+    for(unsigned int i = 0; i < ports; i++)
+        after += sockets[i].updates();
+    if(after - before != NOTIFICATIONS)
+        (*errors)++;
+    if(observed.notify(0, &datum) || (observed.observers() != ports))
+        (*errors)++;
+
+    for(unsigned int i = 0; i < ports; i++)
+        observed.detach(&sockets[i], sockets[i].port());
+
+    return (t1 - t0) * 1000000000ULL / TSC::frequency() / NOTIFICATIONS;
+}
+
+int main()
+{
+    cout << "Demultiplexing Benchmark" << endl;
+
+    // Mostly ephemeral ports (consecutive), plus some well-known ones spread over the whole range
+    for(unsigned int i = 0; i < MAX_PORTS; i++)
+        sockets[i].bind((i % 10) ? 49152 + i : 1 + (i * 251) % 49151);
+
+    int errors = 0;
+    cout << "ports\tlinear\thashed (ns per notification)" << endl;
+    for(unsigned int ports = 1; ports <= MAX_PORTS; ports *= 10) {
+        unsigned long long linear = measure<Linear>(ports, &errors);
+        unsigned long long hashed = measure<Hashed>(ports, &errors);
+        cout << ports << "\t" << linear << "\t" << hashed << endl;
+    }
+
+    cout << "Verification: " << (errors ? "failed" : "passed") << " (" << errors << " errors)" << endl;
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+// EPOS FANN Inference Benchmark
+//
+// Runs the network of FANN::fann_create_from_config() (12 inputs, hidden layers of 2 and 3 neurons, 1 output) on
+// random inputs through FANN::fann_run(), through a floating-point FANN::Frozen network and through a fixed-point one,
+// reporting the latency of each inference as min/avg/max in ns.
+// Frozen outputs must match fann_run()'s (closely, for fixed point), both before and after the network is trained
+// online with FANN::fann_train_data_incremental() and frozen again.
+// This test requires Traits<Build>::SMOD == LIBRARY, since networks are allocated in the SYSTEM heap.
+
+#include <time.h>
+#include <utility/random.h>
+#include <utility/fann.h>
+
+using namespace EPOS;
+
+typedef EPOS::S::TSC TSC;
+typedef TSC::Time_Stamp Stamp;
+typedef FANN::fann_type Float;
+typedef FANN::Fixed Fixed;
+
+const unsigned int INPUTS = 12;
+const unsigned int SAMPLES = 1000;
+const unsigned int TRAINING_ROUNDS = 20;
+const Float FLOAT_TOLERANCE = 0.0001;
+const Float FIXED_TOLERANCE = 0.01;
+
+typedef FANN::Frozen<Float, INPUTS, 2, 3, 1> Frozen_Float;
+typedef FANN::Frozen<Fixed, INPUTS, 2, 3, 1> Frozen_Fixed;
+
+OStream cout;
+
+Float inputs[SAMPLES][INPUTS];
+Fixed fixed_inputs[SAMPLES][INPUTS];
+Float outputs[SAMPLES];
+Stamp latencies[SAMPLES];
+
+Frozen_Float frozen_float;
+Frozen_Fixed frozen_fixed;
+
+Float absolute(Float f) { return (f < 0) ? -f : f; }
+
+void report(const char * what)
+{
+    Stamp min = latencies[0], max = latencies[0];
+    unsigned long long sum = 0;
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        if(latencies[i] < min)
+            min = latencies[i];
+        if(latencies[i] > max)
+            max = latencies[i];
+        sum += latencies[i];
+    }
+
+    cout << what << "\t" << min * 1000000000ULL / TSC::frequency() << "\t" << sum / SAMPLES * 1000000000ULL / TSC::frequency() << "\t" << max * 1000000000ULL / TSC::frequency() << endl;
+}
+
+// Runs all samples through each representation, returning the number of outputs that differ from fann_run()'s
+unsigned int run(FANN::fann * ann)
+{
+    unsigned int mismatches = 0;
+
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        Stamp t0 = TSC::time_stamp();
+        outputs[i] = *FANN::fann_run(ann, inputs[i], false);
+        latencies[i] = TSC::time_stamp() - t0;
+    }
+    report("fann_run");
+
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        Stamp t0 = TSC::time_stamp();
+        Float output = *frozen_float.run(inputs[i]);
+        latencies[i] = TSC::time_stamp() - t0;
+        mismatches += (absolute(output - outputs[i]) > FLOAT_TOLERANCE);
+    }
+    report("frozen float");
+
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        Stamp t0 = TSC::time_stamp();
+        Fixed output = *frozen_fixed.run(fixed_inputs[i]);
+        latencies[i] = TSC::time_stamp() - t0;
+        mismatches += (absolute(static_cast<Float>(output) - outputs[i]) > FIXED_TOLERANCE);
+    }
+    report("frozen fixed");
+
+    return mismatches;
+}
+
+int main()
+{
+    cout << "FANN Inference Benchmark" << endl;
+
+    FANN::fann * ann = FANN::fann_create_from_config();
+
+    for(unsigned int i = 0; i < SAMPLES; i++)
+        for(unsigned int j = 0; j < INPUTS; j++) {
+            inputs[i][j] = static_cast<Float>(static_cast<unsigned int>(Random::random()) % 1000) / 1000;
+            fixed_inputs[i][j] = inputs[i][j];
+        }
+
+    if(!frozen_float.freeze(ann) || !frozen_fixed.freeze(ann)) {
+        cout << "The network could not be frozen!" << endl;
+        return -1;
+    }
+
+    cout << "latency\t\tmin\tavg\tmax (ns)" << endl;
+    unsigned int mismatches = run(ann);
+    cout << "Mismatches: " << mismatches << endl;
+
+    // Online training towards the mean of the inputs, then freezing the trained network again
+    for(unsigned int r = 0; r < TRAINING_ROUNDS; r++)
+        for(unsigned int i = 0; i < SAMPLES; i++) {
+            Float desired = 0;
+            for(unsigned int j = 0; j < INPUTS; j++)
+                desired += inputs[i][j] / INPUTS;
+            FANN::fann_train_data_incremental(ann, inputs[i], &desired);
+        }
+    frozen_float.freeze(ann);
+    frozen_fixed.freeze(ann);
+
+    cout << "After training:" << endl;
+    unsigned int trained_mismatches = run(ann);
+    cout << "Mismatches: " << trained_mismatches << endl;
+
+    if(mismatches || trained_mismatches)
+        cout << "Frozen networks do not match fann_run()!" << endl;
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -7,9 +7,223 @@ using namespace EPOS;
 
 const int ITERATIONS = 3;
 const int PDU = 2000;
+const int STREAM = 128; // PDUs written back-to-back to measure TCP throughput
 
 OStream cout;
 
+// Straightforward RFC 1071 checksum used as a reference
+unsigned short reference_checksum(const void * data, unsigned int size)
+{
+    const unsigned char * ptr = reinterpret_cast<const unsigned char *>(data);
+    unsigned long sum = 0;
+
+    for(unsigned int i = 0; i + 1 < size; i += 2)
+        sum += (ptr[i] << 8) | ptr[i+1];
+    if(size & 1)
+        sum += ptr[size - 1] << 8;
+
+    while(sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+
+    return ~sum;
+}
+
+int checksum_test()
+{
+    cout << "\n\n--------------------------------------------------------------------------------" << endl;
+    cout << "Checksum Test" << endl;
+
+    static unsigned char src[PDU + 8];
+    static unsigned char dst[PDU + 8];
+    for(unsigned int i = 0; i < sizeof(src); i++)
+        src[i] = Random::random();
+
+    int errors = 0;
+
+    // RFC 1071 example
+    const unsigned char example[] = {0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7};
+    if(IP::checksum(example, sizeof(example)) != 0x220d)
+        errors++;
+
+    for(unsigned int size = 0; size <= PDU; size += (size < 64) ? 1 : 61)
+        for(unsigned int from = 0; from < 4; from++) {
+            unsigned short ref = reference_checksum(&src[from], size);
+            if(IP::checksum(&src[from], size) != ref)
+                errors++;
+
+            for(unsigned int to = 0; to < 4; to++) {
+                memset(dst, 0, sizeof(dst));
+                unsigned short sum = ~IP::copy_and_sum(&dst[to], &src[from], size);
+                if((sum != ref) || memcmp(&dst[to], &src[from], size))
+                    errors++;
+            }
+
+            // Chained partial sums (all but the last piece even)
+            unsigned int half = (size / 2) & ~1u;
+            unsigned short chained = ~IP::sum(&src[from + half], size - half, IP::sum(&src[from], half));
+            if(chained != ref)
+                errors++;
+        }
+
+    // Incremental updates (RFC 1624)
+    IP::Header header(IP::Address("10.0.0.1"), IP::Address("10.0.0.2"), IP::UDP, sizeof(IP::Header));
+    header.sum();
+    for(unsigned int ttl = 64; ttl > 0; ttl--) {
+        header.ttl(ttl - 1);
+        unsigned short incremental = header.checksum();
+        header.sum();
+        if(header.checksum() != incremental)
+            errors++;
+    }
+
+    cout << "  Verification: " << (errors ? "failed" : "passed") << " (" << errors << " errors)" << endl;
+
+    const unsigned int size = 1500;
+    const unsigned int iterations = 10000;
+    volatile unsigned short sink = 0;
+    TSC::Time_Stamp t0, t1;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++)
+        sink = sink + reference_checksum(src, size);
+    t1 = TSC::time_stamp();
+    cout << "  Byte pairs:      " << (unsigned long long)size * iterations * TSC::frequency() / (t1 - t0) / 1000000 << " MB/s" << endl;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++)
+        sink = sink + IP::checksum(src, size);
+    t1 = TSC::time_stamp();
+    cout << "  Word-wide:       " << (unsigned long long)size * iterations * TSC::frequency() / (t1 - t0) / 1000000 << " MB/s" << endl;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++) {
+        memcpy(dst, src, size);
+        sink = sink + IP::checksum(dst, size);
+    }
+    t1 = TSC::time_stamp();
+    cout << "  memcpy + sum:    " << (unsigned long long)size * iterations * TSC::frequency() / (t1 - t0) / 1000000 << " MB/s" << endl;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++)
+        sink = sink + IP::copy_and_sum(dst, src, size);
+    t1 = TSC::time_stamp();
+    cout << "  Copy-and-sum:    " << (unsigned long long)size * iterations * TSC::frequency() / (t1 - t0) / 1000000 << " MB/s" << endl;
+
+    return errors;
+}
+
+// Route that the old linear routing table would take (longest prefix first, then insertion order)
+int reference_route(unsigned int to, const unsigned int * destination, const unsigned int * length, const bool * removed, unsigned int routes)
+{
+    int found = -1;
+    for(unsigned int i = 0; i < routes; i++) {
+        unsigned int mask = length[i] ? ~0U << (32 - length[i]) : 0;
+        if(!removed[i] && ((to & mask) == destination[i]) && ((found < 0) || (length[i] > length[found])))
+            found = i;
+    }
+    return found;
+}
+
+int routing_test()
+{
+    cout << "\n\n--------------------------------------------------------------------------------" << endl;
+    cout << "Routing Test" << endl;
+
+    const unsigned int ROUTES = 64;
+    const unsigned int DESTINATIONS = 1024;
+
+    static unsigned int destination[ROUTES];
+    static unsigned int length[ROUTES];
+    static bool removed[ROUTES];
+    static unsigned int order[ROUTES];
+    static unsigned int to[DESTINATIONS];
+
+    IP::Router router;
+
+    // Default route, then /8, /16 and /24 networks nested under 10.0.0.0/8
+    for(unsigned int i = 0; i < ROUTES; i++) {
+        length[i] = i ? 8 + (i % 3) * 8 : 0;
+        unsigned int mask = length[i] ? ~0U << (32 - length[i]) : 0;
+        destination[i] = ((10U << 24) | ((i % 4) << 16) | ((i % 8) << 8)) & mask;
+        removed[i] = false;
+        router.insert(0, 0, 0, IP::Address(destination[i]), IP::Address((192U << 24) | (168U << 16) | i), IP::Address(mask));
+    }
+
+    // The same routes in the order the old table needed them
+    unsigned int n = 0;
+    for(int l = 32; l >= 0; l--)
+        for(unsigned int i = 0; i < ROUTES; i++)
+            if(length[i] == static_cast<unsigned int>(l))
+                order[n++] = i;
+
+    for(unsigned int i = 0; i < DESTINATIONS; i++)
+        to[i] = (i % 8) ? ((10U << 24) | ((Random::random() % 4) << 16) | ((Random::random() % 8) << 8) | (Random::random() & 0xff)) : Random::random();
+
+    int errors = 0;
+    for(unsigned int pass = 0; pass < 2; pass++) {
+        for(unsigned int i = 0; i < DESTINATIONS; i++) {
+            int expected = reference_route(to[i], destination, length, removed, ROUTES);
+            IP::Route * route = router.search(IP::Address(to[i]));
+            if(expected < 0 ? (route != 0) : (!route || (route->gateway() != IP::Address((192U << 24) | (168U << 16) | expected))))
+                errors++;
+        }
+
+        // Remove the routes used to reach the /16 networks (and hence some inner trie nodes) and check again
+        if(!pass)
+            for(unsigned int i = 2; i < ROUTES; i += 3) {
+                int r = reference_route(destination[i], destination, length, removed, ROUTES);
+                router.remove(IP::Address(destination[i]));
+                if(r >= 0)
+                    removed[r] = true;
+            }
+    }
+
+    cout << "  Verification: " << (errors ? "failed" : "passed") << " (" << errors << " errors)" << endl;
+
+    for(unsigned int i = 0; i < ROUTES; i++)
+        if(removed[i]) {
+            router.insert(0, 0, 0, IP::Address(destination[i]), IP::Address((192U << 24) | (168U << 16) | i), IP::Address(length[i] ? ~0U << (32 - length[i]) : 0));
+            removed[i] = false;
+        }
+
+    const unsigned int iterations = 10000;
+    volatile unsigned long sink = 0;
+    TSC::Time_Stamp t0, t1;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++) {
+        unsigned int d = to[i % DESTINATIONS];
+        unsigned int j = 0;
+        for(; j < ROUTES; j++) {
+            unsigned int k = order[j];
+            if((d & (length[k] ? ~0U << (32 - length[k]) : 0)) == destination[k])
+                break;
+        }
+        sink = sink + j;
+    }
+    t1 = TSC::time_stamp();
+    cout << "  Linear scan (" << ROUTES << " routes): " << (t1 - t0) * 1000000000ULL / TSC::frequency() / iterations << " ns per lookup" << endl;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++)
+        sink = sink + reinterpret_cast<unsigned long>(router.search(IP::Address(to[i % DESTINATIONS])));
+    t1 = TSC::time_stamp();
+    cout << "  Trie (" << DESTINATIONS << " destinations):  " << (t1 - t0) * 1000000000ULL / TSC::frequency() / iterations << " ns per lookup" << endl;
+
+    t0 = TSC::time_stamp();
+    for(unsigned int i = 0; i < iterations; i++)
+        sink = sink + reinterpret_cast<unsigned long>(router.search(IP::Address(to[i % 8])));
+    t1 = TSC::time_stamp();
+    cout << "  Cached (8 destinations):     " << (t1 - t0) * 1000000000ULL / TSC::frequency() / iterations << " ns per lookup" << endl;
+
+    for(unsigned int i = 0; i < ROUTES; i++)
+        router.remove(IP::Address(destination[i]));
+    if(router.search(IP::Address(to[0])))
+        errors++;
+
+    return errors;
+}
+
 int icmp_test()
 {
     cout << "\n\n--------------------------------------------------------------------------------" << endl;
@@ -73,7 +287,8 @@ int icmp_test()
          << "  Tx Packets: " << stat.tx_packets << "\n"
          << "  Tx Bytes:   " << stat.tx_bytes << "\n"
          << "  Rx Packets: " << stat.rx_packets << "\n"
-         << "  Rx Bytes:   " << stat.rx_bytes << endl;
+         << "  Rx Bytes:   " << stat.rx_bytes << "\n"
+         << "  Rx Packets per Interrupt: " << stat.packets_per_interrupt() / 100 << "." << ((stat.packets_per_interrupt() % 100 < 10) ? "0" : "") << stat.packets_per_interrupt() % 100 << endl;
 
     return stat.tx_bytes + stat.rx_bytes;
 }
@@ -135,6 +350,22 @@ int udp_test()
             else
                 cout << "  Data was not correctly sent. It was " << sizeof(data) << " bytes long, but only " << sent << " bytes were sent!"<< endl;
         }
+
+        // Copying sends, then gather sends of a small header and the payload, each paced so the receiver keeps up
+        unsigned int header = STREAM;
+        UDP::Chunk chunks[2] = {{&header, sizeof(header)}, {&data[sizeof(header)], sizeof(data) - sizeof(header)}};
+        unsigned long long bytes[2] = {0, 0};
+        TSC::Time_Stamp ticks[2] = {0, 0};
+        for(int i = 0; i < 2 * STREAM; i++) {
+            Delay(1000);
+            TSC::Time_Stamp t0 = TSC::time_stamp();
+            int sent = (i < STREAM) ? com->send(&data, sizeof(data)) : com->send(chunks, 2);
+            ticks[i / STREAM] += TSC::time_stamp() - t0;
+            if(sent > 0)
+                bytes[i / STREAM] += sent;
+        }
+        cout << "  Copy:     " << bytes[0] << " bytes => " << (ticks[0] ? bytes[0] * 1000 / ticks[0] : 0) << " bytes/kcycle" << endl;
+        cout << "  Gather:   " << bytes[1] << " bytes => " << (ticks[1] ? bytes[1] * 1000 / ticks[1] : 0) << " bytes/kcycle" << endl;
     } else { // receiver
         cout << "Receiver:" << endl;
 
@@ -150,6 +381,33 @@ int udp_test()
             else
                 cout << "  Data was not correctly received. It was " << sizeof(data) << " bytes long, but " << received << " bytes were received!"<< endl;
         }
+
+        // Copying receives, then zero-copy ones that read the payload in place from the loaned buffers
+        unsigned long long bytes[2] = {0, 0};
+        TSC::Time_Stamp ticks[2] = {0, 0};
+        volatile unsigned char sink = 0;
+        for(int i = 0; i < 2 * STREAM; i++) {
+            Link<UDP>::Buffer * buf = com->receive();
+            TSC::Time_Stamp t0 = TSC::time_stamp();
+            if(i < STREAM) {
+                int received = UDP::receive(buf, &data, sizeof(data));
+                if(received > 0) {
+                    bytes[0] += received;
+                    sink = sink + data[received - 1];
+                }
+            } else {
+                UDP::Chunk chunks[4];
+                unsigned int n = com->data(buf, chunks, 4);
+                for(unsigned int j = 0; (j < n) && (j < 4); j++) {
+                    bytes[1] += chunks[j].size;
+                    sink = sink + reinterpret_cast<const unsigned char *>(chunks[j].data)[chunks[j].size - 1];
+                }
+                com->release(buf);
+            }
+            ticks[i / STREAM] += TSC::time_stamp() - t0;
+        }
+        cout << "  Copy:      " << bytes[0] << " bytes => " << (ticks[0] ? bytes[0] * 1000 / ticks[0] : 0) << " bytes/kcycle" << endl;
+        cout << "  Zero-copy: " << bytes[1] << " bytes => " << (ticks[1] ? bytes[1] * 1000 / ticks[1] : 0) << " bytes/kcycle" << endl;
     }
 
     delete com;
@@ -159,7 +417,8 @@ int udp_test()
          << "  Tx Packets: " << stat.tx_packets << "\n"
          << "  Tx Bytes:   " << stat.tx_bytes << "\n"
          << "  Rx Packets: " << stat.rx_packets << "\n"
-         << "  Rx Bytes:   " << stat.rx_bytes << endl;
+         << "  Rx Bytes:   " << stat.rx_bytes << "\n"
+         << "  Rx Packets per Interrupt: " << stat.packets_per_interrupt() / 100 << "." << ((stat.packets_per_interrupt() % 100 < 10) ? "0" : "") << stat.packets_per_interrupt() % 100 << endl;
 
     return stat.tx_bytes + stat.rx_bytes;
 }
@@ -221,6 +480,13 @@ int tcp_test()
             else
                 cout << "  Data was not correctly sent. It was " << sizeof(data) << " bytes long, but only " << sent << "bytes were sent!"<< endl;
         }
+
+        unsigned long long bytes = 0;
+        TSC::Time_Stamp t0 = TSC::time_stamp();
+        for(int i = 0; (i < STREAM) && (com->write(&data, sizeof(data)) == sizeof(data)); i++)
+            bytes += sizeof(data);
+        Microsecond elapsed = TSC::time(TSC::time_stamp() - t0);
+        cout << "  Throughput: " << bytes << " bytes in " << elapsed << " us => " << (elapsed ? bytes * 1000000 / elapsed / 1024 : 0) << " KB/s" << endl;
     } else { // receiver
         cout << "Receiver:" << endl;
 
@@ -236,6 +502,13 @@ int tcp_test()
             else
                 cout << "  Data was not correctly received. It was " << sizeof(data) << " bytes long, but " << received << " bytes were received!"<< endl;
         }
+
+        unsigned long long bytes = 0;
+        TSC::Time_Stamp t0 = TSC::time_stamp();
+        for(int i = 0; (i < STREAM) && (com->read(&data, sizeof(data)) == sizeof(data)); i++)
+            bytes += sizeof(data);
+        Microsecond elapsed = TSC::time(TSC::time_stamp() - t0);
+        cout << "  Throughput: " << bytes << " bytes in " << elapsed << " us => " << (elapsed ? bytes * 1000000 / elapsed / 1024 : 0) << " KB/s" << endl;
     }
 
     delete com;
@@ -245,7 +518,8 @@ int tcp_test()
          << "  Tx Packets: " << stat.tx_packets << "\n"
          << "  Tx Bytes:   " << stat.tx_bytes << "\n"
          << "  Rx Packets: " << stat.rx_packets << "\n"
-         << "  Rx Bytes:   " << stat.rx_bytes << endl;
+         << "  Rx Bytes:   " << stat.rx_bytes << "\n"
+         << "  Rx Packets per Interrupt: " << stat.packets_per_interrupt() / 100 << "." << ((stat.packets_per_interrupt() % 100 < 10) ? "0" : "") << stat.packets_per_interrupt() % 100 << endl;
 
     return stat.tx_bytes + stat.rx_bytes;
 }
@@ -258,6 +532,8 @@ int main()
     cout << "  IP::Header => " << sizeof(IP::Header) << endl;
     cout << "  UDP::Header => " << sizeof(UDP::Header) << endl;
 
+    checksum_test();
+    routing_test();
     icmp_test();
     Alarm::delay(2000000);
     udp_test();
@@ -0,0 +1,55 @@
+// EPOS Kernel Page Benchmark
+//
+// Measures the rate of Thread::self(), Task::self(), and Alarm::elapsed(), which are served by the read-only
+// Kernel_Page whenever possible, against that of a system call that always traps (Semaphore::v() on a semaphore
+// nobody waits on). Each call is repeated for one second, as measured by Alarm::elapsed() itself, so the figures
+// also include the cost of the latter.
+// This test requires Traits<Build>::SMOD == KERNEL.
+// Compare runs on rv64 (where the running thread and task are read from the page) and ia32 with CPUS > 1 (where
+// they still require a system call).
+
+#include <time.h>
+#include <process.h>
+#include <synchronizer.h>
+
+using namespace EPOS;
+
+OStream cout;
+
+template<typename F>
+unsigned long rate(F f)
+{
+    long start = Alarm::elapsed();
+    while(Alarm::elapsed() == start);
+
+    long end = Alarm::elapsed() + Alarm::alarm_frequency();
+    unsigned long n = 0;
+    while(Alarm::elapsed() < end) {
+        f();
+        n++;
+    }
+
+    return n;
+}
+
+void report(const char * call, unsigned long n)
+{
+    cout << call << "\t" << n << "\t" << 1000000000ULL / n << endl;
+}
+
+int main()
+{
+    cout << "Kernel Page Benchmark" << endl;
+    cout << "call\t\tcalls/s\tns/call" << endl;
+
+    Semaphore semaphore(0);
+
+    report("elapsed()", rate([]() { Alarm::elapsed(); }));
+    report("Thread::self()", rate([]() { Thread::self(); }));
+    report("Task::self()", rate([]() { Task::self(); }));
+    report("v() (trap)", rate([&]() { semaphore.v(); }));
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+// EPOS Latency Benchmark
+//
+// Measures, sample by sample with TSC::time_stamp(), the latency of:
+// - thread switch: two threads on the same CPU yielding to each other (Thread::yield() -> Thread::dispatch() -> CPU::switch_context());
+// - semaphore ping-pong: two threads on the same CPU handing control over to each other through a pair of semaphores;
+// - IPI (CPUS > 1): the same ping-pong between threads on different CPUs, so each wakeup goes through Thread::reschedule(cpu);
+// - IRQ (LIBRARY mode, CPUS > 1): a self-IPI whose handler, temporarily installed with IC::int_vector(), is reached through IC::entry();
+// - task switch (KERNEL mode): the ping-pong with the main thread of a forked task, so each handover also switches address spaces.
+// Round trips are halved, so all figures are one-way. They are printed as min/avg/p99/max in ns.
+// In KERNEL mode, the TSC must be readable in user mode (currently, only on ia32), its frequency is calibrated against
+// Alarm::elapsed(), and threads are placed by the scheduler (so use CPUS = 1 to keep both sides of each ping-pong on
+// the same CPU).
+
+#include <time.h>
+#include <process.h>
+#include <synchronizer.h>
+
+using namespace EPOS;
+
+typedef EPOS::S::TSC::Time_Stamp Stamp;
+
+const bool kernel = (EPOS::S::Traits<EPOS::S::Build>::SMOD == EPOS::S::Traits<EPOS::S::Build>::KERNEL);
+const bool user_tsc = !kernel || (EPOS::S::Traits<EPOS::S::Build>::ARCHITECTURE == EPOS::S::Traits<EPOS::S::Build>::IA32);
+const unsigned int CPUS = EPOS::S::Traits<EPOS::S::Build>::CPUS;
+const unsigned int SAMPLES = 1000;
+
+OStream cout;
+
+Stamp frequency;
+Stamp samples[SAMPLES];
+volatile bool done;
+volatile Stamp irq_stamp;
+
+// Global, so a forked task gets copies that refer to the same semaphores
+Semaphore ping(0);
+Semaphore pong(0);
+
+Stamp stamp() { return EPOS::S::TSC::time_stamp(); }
+
+unsigned long long ns(Stamp ts) { return ts * 1000000000ULL / frequency; }
+
+template<typename A>
+Stamp calibrate()
+{
+    if constexpr(!kernel)
+        return EPOS::S::TSC::frequency();
+    else {
+        // Count the TSC ticks during one second of Alarm ticks
+        long start = A::elapsed();
+        while(A::elapsed() == start);
+        Stamp begin = stamp();
+        long end = A::elapsed() + A::alarm_frequency();
+        while(A::elapsed() < end);
+        return stamp() - begin;
+    }
+}
+
+void report(const char * what)
+{
+    for(unsigned int i = 1; i < SAMPLES; i++) {
+        Stamp s = samples[i];
+        unsigned int j = i;
+        for(; (j > 0) && (samples[j - 1] > s); j--)
+            samples[j] = samples[j - 1];
+        samples[j] = s;
+    }
+
+    unsigned long long sum = 0;
+    for(unsigned int i = 0; i < SAMPLES; i++)
+        sum += samples[i];
+
+    cout << what << "\t" << ns(samples[0]) << "\t" << ns(sum / SAMPLES) << "\t" << ns(samples[(SAMPLES * 99 + 99) / 100 - 1]) << "\t" << ns(samples[SAMPLES - 1]) << endl;
+}
+
+template<typename T>
+T * spawn(int (* entry)(), unsigned int cpu)
+{
+    if constexpr(kernel)
+        return new T(entry);
+    else
+        return new T(typename T::Configuration(T::READY, typename T::Criterion(T::NORMAL, cpu)), entry);
+}
+
+int yielder()
+{
+    while(!done)
+        Thread::yield();
+
+    return 0;
+}
+
+int switcher()
+{
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        Stamp t0 = stamp();
+        Thread::yield();
+        samples[i] = (stamp() - t0) / 2;
+    }
+    done = true;
+
+    return 0;
+}
+
+int ponger()
+{
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        ping.p();
+        pong.v();
+    }
+
+    return 0;
+}
+
+int pinger()
+{
+    for(unsigned int i = 0; i < SAMPLES; i++) {
+        Stamp t0 = stamp();
+        ping.v();
+        pong.p();
+        samples[i] = (stamp() - t0) / 2;
+    }
+
+    return 0;
+}
+
+template<typename T>
+void pair(int (* a)(), unsigned int cpu_a, int (* b)(), unsigned int cpu_b)
+{
+    T * ta = spawn<T>(a, cpu_a);
+    T * tb = spawn<T>(b, cpu_b);
+    ta->join();
+    tb->join();
+    delete ta;
+    delete tb;
+}
+
+template<typename IC>
+struct IRQ
+{
+    static void handler(typename IC::Interrupt_Id i) { irq_stamp = stamp(); }
+
+    static void measure() {
+        typename IC::Interrupt_Handler rescheduler = IC::int_vector(IC::INT_RESCHEDULER);
+        IC::int_vector(IC::INT_RESCHEDULER, &handler);
+
+        for(unsigned int i = 0; i < SAMPLES; i++) {
+            irq_stamp = 0;
+            Stamp t0 = stamp();
+            IC::ipi(EPOS::S::CPU::id(), IC::INT_RESCHEDULER);
+            while(!irq_stamp);
+            samples[i] = irq_stamp - t0;
+        }
+
+        IC::int_vector(IC::INT_RESCHEDULER, rescheduler);
+    }
+};
+
+template<typename T>
+void task_switch()
+{
+    T * task = new T(T::self(), &ponger);
+    pinger();
+    task->main()->join();
+    delete task;
+}
+
+int main()
+{
+    cout << "Latency Benchmark" << endl;
+
+    if(!user_tsc) {
+        cout << "The TSC cannot be read in user mode on this architecture!" << endl;
+        return -1;
+    }
+
+    frequency = calibrate<Alarm>();
+    cout << "TSC frequency: " << frequency << " Hz, CPUS = " << CPUS << ", samples = " << SAMPLES << endl;
+    cout << "latency\t\tmin\tavg\tp99\tmax (ns)" << endl;
+
+    done = false;
+    pair<Thread>(&switcher, 0, &yielder, 0);
+    report("thread switch");
+
+    pair<Thread>(&pinger, 0, &ponger, 0);
+    report("semaphore");
+
+    if(CPUS > 1) {
+        pair<Thread>(&pinger, 0, &ponger, 1);
+        report("IPI\t");
+
+        if constexpr(!kernel) {
+            IRQ<EPOS::S::IC>::measure();
+            report("IRQ\t");
+        }
+    }
+
+    if constexpr(kernel) {
+        task_switch<Task>();
+        report("task switch");
+    }
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+// EPOS Lazy FPU Context Switching Test Program
+//
+// More FPU-bound threads than CPUs accumulate exact floating-point sums in registers while they are preempted by each
+// other, by threads that never touch the FPU and by an alarm handler that uses the FPU in interrupt context (i.e., in a
+// kernel FPU section). Any FPU state lost or mixed up on the way shows up as a sum that differs from its closed form.
+
+#include <time.h>
+#include <process.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Machine>::CPUS;
+const unsigned int FPU_THREADS = 3; // per CPU
+const unsigned int INT_THREADS = 1; // per CPU
+const unsigned int ITERATIONS = 1 << 16;
+const unsigned int ROUNDS = 64;
+
+OStream cout;
+
+volatile double kernel_sum;
+volatile unsigned int kernel_calls;
+volatile unsigned int integer_sum;
+
+int fpu_worker(unsigned int seed);
+int int_worker(unsigned int n);
+void kernel_fpu_user();
+
+int main()
+{
+    cout << "Lazy FPU test" << endl;
+    cout << "CPUS=" << CPUS << ", lazy=" << Traits<FPU>::lazy << ", threads=" << CPUS * (FPU_THREADS + INT_THREADS) << endl;
+
+    Function_Handler handler(&kernel_fpu_user);
+    Alarm alarm(1000, &handler, INFINITE);
+
+    Thread * fpu_threads[CPUS * FPU_THREADS];
+    Thread * int_threads[CPUS * INT_THREADS];
+
+    for(unsigned int i = 0; i < CPUS * FPU_THREADS; i++)
+        fpu_threads[i] = new Thread(&fpu_worker, i + 1);
+
+    // Threads configured without an FPU context are terminated if they touch the FPU
+    for(unsigned int i = 0; i < CPUS * INT_THREADS; i++)
+        int_threads[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL), WHITE, 0, Traits<Application>::STACK_SIZE, false), &int_worker, i);
+
+    // The main thread uses the FPU as well
+    double x = 0.5;
+    for(unsigned int i = 0; i < ITERATIONS; i++)
+        x += 0.25;
+
+    unsigned int failures = 0;
+    for(unsigned int i = 0; i < CPUS * FPU_THREADS; i++)
+        failures += fpu_threads[i]->join();
+    for(unsigned int i = 0; i < CPUS * INT_THREADS; i++)
+        int_threads[i]->join();
+
+    if(x != 0.5 + 0.25 * ITERATIONS) {
+        cout << "main: x=" << static_cast<long>(x) << " (expected " << static_cast<long>(0.5 + 0.25 * ITERATIONS) << ")" << endl;
+        failures++;
+    }
+
+    cout << "kernel FPU sections=" << kernel_calls << ", integer sum=" << integer_sum << endl;
+
+    for(unsigned int i = 0; i < CPUS * FPU_THREADS; i++)
+        delete fpu_threads[i];
+    for(unsigned int i = 0; i < CPUS * INT_THREADS; i++)
+        delete int_threads[i];
+
+    if(failures)
+        cout << "FAILED: " << failures << " corrupted FPU contexts!" << endl;
+    else
+        cout << "The end!" << endl;
+
+    return 0;
+}
+
+// All partial sums are integers below 2^53, so they are exact and independent of rounding
+int fpu_worker(unsigned int seed)
+{
+    int failures = 0;
+
+    for(unsigned int r = 0; r < ROUNDS; r++) {
+        double a = 0, b = 0, c = seed;
+        for(unsigned int i = 0; i < ITERATIONS; i++) {
+            a += c;
+            b += a;
+            c += 1;
+        }
+
+        // a = sum(seed + i) and b = sum(a_i), for i in [0, ITERATIONS)
+        double n = ITERATIONS;
+        double ea = n * seed + n * (n - 1) / 2;
+        double eb = seed * n * (n + 1) / 2 + (n - 1) * n * (n + 1) / 6;
+        if((a != ea) || (b != eb)) {
+            cout << "fpu_worker(" << seed << "): round " << r << " failed" << endl;
+            failures++;
+        }
+
+        Thread::yield();
+    }
+
+    return failures;
+}
+
+int int_worker(unsigned int n)
+{
+    for(unsigned int r = 0; r < ROUNDS; r++) {
+        for(unsigned int i = 0; i < ITERATIONS; i++)
+            integer_sum += i ^ n;
+        Thread::yield();
+    }
+
+    return 0;
+}
+
+// Runs in interrupt context and overwrites the FPU registers of whatever thread is interrupted
+void kernel_fpu_user()
+{
+    double x = kernel_sum;
+    for(unsigned int i = 0; i < 16; i++)
+        x = x * 0.5 + 1.0;
+    kernel_sum = x;
+    kernel_calls++;
+}
@@ -1,13 +1,20 @@
 // EPOS Memory Allocation Utility Test Program
 
 #include <utility/string.h>
+#include <process.h>
 
 using namespace EPOS;
 
+const unsigned int THREADS = 2 * Traits<Machine>::CPUS + 2;
+const unsigned int iterations = 10000;
+const unsigned int depth = 16; // blocks held by each thread at a time
+
+OStream cout;
+
+int worker(unsigned int n);
+
 int main()
 {
-    OStream cout;
-
     cout << "Memory allocation test" << endl;
     char * cp = new char('A');
     cout << "new char('A')\t\t=> {p=" << (void *)cp << ",v=" << *cp << "}" << endl;
@@ -36,6 +43,52 @@ int main()
     strcpy(sp, "string");
     cout << "new char[1024]\t\t=> {p=" << (void *)sp << ",v=" << sp << "}" << endl;
 
+    cout << "Throughput (slab=" << Traits<Heaps>::slab << ", iterations=" << iterations << " per thread):" << endl;
+    Slab_Heap::reset_statistics();
+    for(unsigned int n = 1; n <= THREADS; n++) {
+        Thread * threads[THREADS];
+
+        TSC::Time_Stamp begin = TSC::time_stamp();
+        for(unsigned int i = 0; i < n; i++)
+            threads[i] = new Thread(&worker, i);
+        for(unsigned int i = 0; i < n; i++)
+            threads[i]->join();
+        TSC::Time_Stamp elapsed = TSC::time_stamp() - begin;
+
+        for(unsigned int i = 0; i < n; i++)
+            delete threads[i];
+
+        unsigned long long ops = 2ULL * n * iterations; // new + delete
+        cout << n << " thread(s): " << ops * TSC::frequency() / (elapsed ? elapsed : 1) << " ops/s" << endl;
+    }
+
+    if(Traits<Heaps>::slab) {
+        cout << "class\thits\tmisses\tflushes" << endl;
+        for(unsigned int c = 0; c < Slab_Heap::CLASSES; c++) {
+            Slab_Heap::Statistics s = Slab_Heap::statistics(c);
+            cout << Slab_Heap::class_size(c) << "\t" << s.hits << "\t" << s.misses << "\t" << s.flushes << endl;
+        }
+    }
+
+    cout << "The end!" << endl;
 
     return 0;
 }
+
+int worker(unsigned int n)
+{
+    char * blocks[depth];
+    for(unsigned int i = 0; i < depth; i++)
+        blocks[i] = 0;
+
+    for(unsigned int i = 0; i < iterations; i++) {
+        unsigned int slot = (i + n) % depth;
+        delete [] blocks[slot];
+        blocks[slot] = new char[8 << ((i + n) % 7)]; // 8 .. 512 bytes
+    }
+
+    for(unsigned int i = 0; i < depth; i++)
+        delete [] blocks[i];
+
+    return n;
+}
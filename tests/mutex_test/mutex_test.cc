@@ -8,6 +8,7 @@
 using namespace EPOS;
 
 const int iterations = 10;
+const unsigned int pairs = 100000;
 
 Mutex mutex_display;
 
@@ -92,6 +93,16 @@ int main()
     for(int i = 0; i < 5; i++)
         delete phil[i];
 
+    // Uncontended fast path cost
+    Mutex mutex;
+    TSC::Time_Stamp begin = TSC::time_stamp();
+    for(unsigned int i = 0; i < pairs; i++) {
+        mutex.lock();
+        mutex.unlock();
+    }
+    TSC::Time_Stamp elapsed = TSC::time_stamp() - begin;
+    cout << "Uncontended lock/unlock: " << elapsed * 1000000000ULL / TSC::frequency() / pairs << " ns per pair (" << pairs << " pairs)" << endl;
+
     cout << "The end!" << endl;
 
     return 0;
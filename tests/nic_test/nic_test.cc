@@ -8,6 +8,8 @@ using namespace EPOS;
 
 OStream cout;
 
+const unsigned int FRAMES = 4096; // sent for each batch size
+
 template<typename Family>
 class NIC_Receiver: public NIC<Family>::Observer
 {
@@ -46,6 +48,20 @@ void ethernet_test() {
             data[nic->mtu() - 1] = '\n';
             nic->send(nic->broadcast(), 0x8888, data, nic->mtu());
         }
+
+        cout << "Batched send (" << FRAMES << " frames of " << nic->mtu() << " bytes):" << endl;
+        for(unsigned int batch = 1; batch <= 64; batch *= 2) {
+            NIC<Ethernet>::Buffer::List list;
+
+            TSC::Time_Stamp begin = TSC::time_stamp();
+            for(unsigned int sent = 0; sent < FRAMES; sent += batch) {
+                nic->alloc_batch(&list, nic->broadcast(), 0x8889, batch, nic->mtu()); // no one listens to 0x8889
+                nic->send(&list);
+            }
+            TSC::Time_Stamp elapsed = TSC::time_stamp() - begin;
+
+            cout << "  batch=" << batch << ": " << static_cast<unsigned long long>(FRAMES) * TSC::frequency() / elapsed << " frames/s" << endl;
+        }
     } else { // receiver
         Delay (10000000);
     }
@@ -0,0 +1,103 @@
+// EPOS Scheduler Lock Contention Benchmark
+//
+// Each CPU runs a set of threads pinned to it that either yield (local scheduling queue only)
+// or play ping-pong on semaphores with a partner on the next CPU (cross-queue wakeups).
+// At the end, the per-CPU wait and hold times of the scheduler locks are reported.
+// Compare runs with Traits<Thread>::queue_locking enabled and disabled.
+
+#include <time.h>
+#include <synchronizer.h>
+#include <process.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Machine>::CPUS;
+const unsigned int YIELDERS = 2; // per CPU
+const unsigned int iterations = 10000;
+
+OStream cout;
+
+Semaphore * ping[CPUS];
+Semaphore * pong[CPUS];
+
+int yielder(unsigned int n);
+int pinger(unsigned int cpu);
+int ponger(unsigned int cpu);
+
+int main()
+{
+    cout << "Scheduler Lock Contention Benchmark" << endl;
+    cout << "CPUS=" << CPUS << ", queue_locking=" << Traits<Thread>::queue_locking << ", iterations=" << iterations << endl;
+
+    Thread * threads[CPUS * (YIELDERS + 2)];
+    unsigned int t = 0;
+
+    for(unsigned int i = 0; i < CPUS; i++) {
+        ping[i] = new Semaphore(0);
+        pong[i] = new Semaphore(0);
+    }
+
+    Thread::reset_lock_statistics();
+    TSC::Time_Stamp begin = TSC::time_stamp();
+
+    for(unsigned int i = 0; i < CPUS; i++) {
+        for(unsigned int j = 0; j < YIELDERS; j++)
+            threads[t++] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, i)), &yielder, j);
+        threads[t++] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, i)), &pinger, i);
+        threads[t++] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, (i + 1) % CPUS)), &ponger, i);
+    }
+
+    for(unsigned int i = 0; i < t; i++)
+        threads[i]->join();
+
+    TSC::Time_Stamp elapsed = TSC::time_stamp() - begin;
+
+    cout << "Elapsed: " << TSC::time(elapsed) << " us" << endl;
+    cout << "CPU\tacquisitions\twait(us)\thold(us)\twait/acq(ticks)" << endl;
+    for(unsigned int i = 0; i < CPUS; i++) {
+        const Thread::Lock_Statistics & s = Thread::lock_statistics(i);
+        cout << i << "\t" << s.acquisitions
+             << "\t" << TSC::time(s.wait_time)
+             << "\t" << TSC::time(s.hold_time)
+             << "\t" << (s.acquisitions ? s.wait_time / s.acquisitions : 0) << endl;
+    }
+
+    for(unsigned int i = 0; i < t; i++)
+        delete threads[i];
+    for(unsigned int i = 0; i < CPUS; i++) {
+        delete ping[i];
+        delete pong[i];
+    }
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
+
+int yielder(unsigned int n)
+{
+    for(unsigned int i = 0; i < iterations; i++)
+        Thread::yield();
+
+    return n;
+}
+
+int pinger(unsigned int cpu)
+{
+    for(unsigned int i = 0; i < iterations; i++) {
+        ping[cpu]->v();
+        pong[cpu]->p();
+    }
+
+    return cpu;
+}
+
+int ponger(unsigned int cpu)
+{
+    for(unsigned int i = 0; i < iterations; i++) {
+        ping[cpu]->p();
+        pong[cpu]->v();
+    }
+
+    return cpu;
+}
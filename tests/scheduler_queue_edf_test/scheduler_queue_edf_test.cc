@@ -0,0 +1,94 @@
+// EPOS Scheduling Queue Benchmark (EDF)
+//
+// Same as scheduler_queue_test, but under a dynamic criterion (EDF), whose ready threads are kept in a Pairing_Heap
+// when Traits<Scheduler<Thread>>::indexed_queues is enabled.
+// First checks that ready threads with scattered ranks (several of them per rank) run in rank order, FIFO among
+// equal ranks. Then measures the cost of resuming and suspending a thread while a growing number of threads is ready.
+
+#include <time.h>
+#include <process.h>
+
+using namespace EPOS;
+
+const unsigned int sizes[] = { 10, 50, 100, 200, 400 };
+const unsigned int THREADS = 400;
+const unsigned int CHECKED = 100;
+const unsigned int iterations = 10000;
+
+OStream cout;
+
+volatile unsigned int ran;
+unsigned int order[CHECKED + 1];
+
+int nop() { return 0; }
+
+int record(unsigned int i) { order[ran++] = i; return 0; }
+
+// Four threads per rank, below main's; the last thread has the lowest rank of all
+int rank(unsigned int i) { return Thread::HIGH + 1 + ((i < CHECKED) ? (i * 37) % (CHECKED / 4) : CHECKED); }
+
+bool check()
+{
+    Thread * threads[CHECKED + 1];
+
+    ran = 0;
+    for(unsigned int i = 0; i <= CHECKED; i++)
+        threads[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(rank(i))), &record, i);
+
+    // Joining the last thread lets all the others run first, in the order they leave the ready queue
+    threads[CHECKED]->join();
+
+    bool ok = (ran == CHECKED + 1);
+    for(unsigned int i = 1; ok && (i <= CHECKED); i++)
+        ok = (rank(order[i - 1]) < rank(order[i])) || ((rank(order[i - 1]) == rank(order[i])) && (order[i - 1] < order[i]));
+
+    for(unsigned int i = 0; i <= CHECKED; i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    return ok;
+}
+
+int main()
+{
+    cout << "Scheduling Queue Benchmark (EDF)" << endl;
+    cout << "indexed_queues=" << Traits<Scheduler<Thread>>::indexed_queues << ", iterations=" << iterations << endl;
+
+    cout << "Dispatch order: " << (check() ? "OK" : "WRONG!") << endl;
+
+    cout << "threads\tresume+suspend(ns)" << endl;
+
+    Thread * threads[THREADS];
+
+    for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        unsigned int n = sizes[s];
+
+        // Ready threads with scattered ranks, all lower than main's, so they only run at join()
+        for(unsigned int i = 0; i < n; i++)
+            threads[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::HIGH + 1 + (i * 37) % n)), &nop);
+
+        Thread * probe = new Thread(Thread::Configuration(Thread::SUSPENDED, Thread::Criterion(Thread::HIGH + 1 + n / 2)), &nop);
+
+        TSC::Time_Stamp begin = TSC::time_stamp();
+        for(unsigned int i = 0; i < iterations; i++) {
+            probe->resume();
+            probe->suspend();
+        }
+        TSC::Time_Stamp end = TSC::time_stamp();
+
+        cout << n << "\t" << (end - begin) * 1000000000ULL / TSC::frequency() / iterations << endl;
+
+        probe->resume();
+        probe->join();
+        delete probe;
+        for(unsigned int i = 0; i < n; i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+    }
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+// EPOS Scheduling Queue Benchmark
+//
+// Checks that both indexed run-queues (Priority_Bitmap_List, for static criteria, and Pairing_Heap, for dynamic
+// ones) dequeue elements in rank order, FIFO among equal ranks, also after elements are removed and reinserted with
+// new ranks (as dynamic criteria do from job to job).
+// Then measures the cost of resuming and suspending a thread (i.e. inserting it into and removing it from
+// the ready queue, plus choosing the next thread) while a growing number of threads with distinct
+// priorities are ready.
+// Compare runs with Traits<Scheduler<Thread>>::indexed_queues enabled and disabled (and scheduler_queue_edf_test).
+
+#include <time.h>
+#include <process.h>
+#include <utility/list.h>
+
+using namespace EPOS;
+
+const unsigned int sizes[] = { 10, 50, 100, 200, 400 };
+const unsigned int THREADS = 400;
+const unsigned int iterations = 10000;
+const unsigned int JOBS = 300;
+
+OStream cout;
+
+int nop() { return 0; }
+
+struct Job {};
+typedef List_Elements::Doubly_Linked_Scheduling<Job, List_Element_Rank> Element;
+
+Job jobs[JOBS];
+Element * elements[JOBS];
+unsigned int sequence[JOBS];    // insertion order, for FIFO among equal ranks
+bool queued[JOBS];
+
+// Scattered ranks, with ties, negatives and large values spread over several buckets of Priority_Bitmap_List
+int rank(unsigned int i, unsigned int round) { return ((int((i + round) * 37 % 61) - 10) * (((i + round) % 3) ? 1 : 1000)); }
+
+template<typename Queue>
+bool check(const char * name)
+{
+    Queue queue;
+    unsigned int inserted = 0;
+    unsigned int expected = 0;
+
+    for(unsigned int i = 0; i < JOBS; i++) {
+        elements[i] = new Element(&jobs[i], rank(i, 0));
+        sequence[i] = inserted++;
+        queued[i] = true;
+        queue.insert(elements[i]);
+        expected++;
+    }
+
+    // Remove some elements and reinsert others with new ranks
+    for(unsigned int i = 0; i < JOBS; i += 5) {
+        queue.remove(elements[i]);
+        queued[i] = false;
+        expected--;
+    }
+    for(unsigned int i = 1; i < JOBS; i += 7) {
+        if(!queued[i])
+            continue;
+        queue.remove(elements[i]);
+        elements[i]->rank(rank(i, 1));
+        sequence[i] = inserted++;
+        queue.insert(elements[i]);
+    }
+
+    bool ok = true;
+    unsigned int dequeued = 0;
+    int last_rank = 0;
+    unsigned int last_sequence = 0;
+    for(Element * e; (e = queue.remove_head()); dequeued++) {
+        unsigned int i = e->object() - jobs;
+        int r = e->rank();
+        if(!queued[i] || (dequeued && ((r < last_rank) || ((r == last_rank) && (sequence[i] < last_sequence)))))
+            ok = false;
+        queued[i] = false;
+        last_rank = r;
+        last_sequence = sequence[i];
+    }
+    ok = ok && (dequeued == expected) && queue.empty();
+
+    for(unsigned int i = 0; i < JOBS; i++)
+        delete elements[i];
+
+    cout << name << " dequeue order: " << (ok ? "OK" : "WRONG!") << endl;
+
+    return ok;
+}
+
+int main()
+{
+    cout << "Scheduling Queue Benchmark" << endl;
+
+    check<Priority_Bitmap_List<Job, List_Element_Rank, Element>>("Priority_Bitmap_List");
+    check<Pairing_Heap<Job, List_Element_Rank, Element>>("Pairing_Heap");
+    cout << "indexed_queues=" << Traits<Scheduler<Thread>>::indexed_queues << ", iterations=" << iterations << endl;
+    cout << "threads\tresume+suspend(ns)" << endl;
+
+    Thread * threads[THREADS];
+
+    for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        unsigned int n = sizes[s];
+
+        // Ready threads with scattered priorities, all lower than main's, so they only run at join()
+        for(unsigned int i = 0; i < n; i++)
+            threads[i] = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::HIGH + 1 + (i * 37) % n)), &nop);
+
+        Thread * probe = new Thread(Thread::Configuration(Thread::SUSPENDED, Thread::Criterion(Thread::HIGH + 1 + n / 2)), &nop);
+
+        TSC::Time_Stamp begin = TSC::time_stamp();
+        for(unsigned int i = 0; i < iterations; i++) {
+            probe->resume();
+            probe->suspend();
+        }
+        TSC::Time_Stamp end = TSC::time_stamp();
+
+        cout << n << "\t" << (end - begin) * 1000000000ULL / TSC::frequency() / iterations << endl;
+
+        probe->resume();
+        probe->join();
+        delete probe;
+        for(unsigned int i = 0; i < n; i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+    }
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -2,16 +2,20 @@
 
 #include <memory.h>
 #include <process.h>
+#include <time.h>
 
 using namespace EPOS;
 
 #ifdef __cortex_m__
 const unsigned ES1_SIZE = 100;
 const unsigned ES2_SIZE = 200;
+const unsigned long sizes[] = {64, 256};
 #else
 const unsigned ES1_SIZE = 10000;
 const unsigned ES2_SIZE = 100000;
+const unsigned long sizes[] = {4096, 65536, 262144};
 #endif
+const unsigned int iterations = 1000;
 
 int main()
 {
@@ -73,6 +77,24 @@ int main()
     delete es2;
     cout << "  done!" << endl;
 
+    cout << "Segment create/destroy rates (buddy=" << Traits<MMU>::buddy << "):" << endl;
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        Chronometer chrono;
+        chrono.start();
+        for(unsigned int j = 0; j < iterations; j++) {
+#ifdef __kernel__
+            Segment * s = new Segment(sizes[i]);
+#else
+            Segment * s = new (SYSTEM) Segment(sizes[i], MMU::Flags::SYSD);
+#endif
+            delete s;
+        }
+        chrono.stop();
+        Microsecond::Type elapsed = chrono.read();
+
+        cout << "  " << sizes[i] << " bytes => " << iterations * 1000000ULL / (elapsed ? elapsed : 1) << " segments/s" << endl;
+    }
+
     cout << "I'm done, bye!" << endl;
 
     return 0;
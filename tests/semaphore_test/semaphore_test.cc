@@ -8,6 +8,7 @@
 using namespace EPOS;
 
 const int iterations = 10;
+const unsigned int pairs = 100000;
 
 Mutex table;
 
@@ -64,6 +65,16 @@ int main()
     for(int i = 0; i < 5; i++)
         delete phil[i];
 
+    // Uncontended fast path cost
+    Semaphore semaphore;
+    TSC::Time_Stamp begin = TSC::time_stamp();
+    for(unsigned int i = 0; i < pairs; i++) {
+        semaphore.p();
+        semaphore.v();
+    }
+    TSC::Time_Stamp elapsed = TSC::time_stamp() - begin;
+    cout << "Uncontended p/v: " << elapsed * 1000000000ULL / TSC::frequency() / pairs << " ns per pair (" << pairs << " pairs)" << endl;
+
     cout << "The end!" << endl;
 
     return 0;
@@ -0,0 +1,72 @@
+// EPOS System Call Ring Benchmark
+//
+// Measures the rate of a non-blocking system call (Semaphore::v() on a semaphore nobody waits on) issued
+// with one trap per call and queued in the task's system call ring with one submission per batch.
+// Each variant runs until a thread sleeping for one second with Alarm::delay() stops it (at most a QUANTUM later), so
+// nothing but the measured calls traps while it runs (time can't be read in user mode without a system call).
+// This test requires Traits<Build>::SMOD == KERNEL.
+// Compare runs with Traits<Framework>::syscall_ring enabled and disabled.
+// It is configured for rv64 (SiFive_U) here and for ia32 (Legacy_PC) in syscall_ring_ia32_test.
+
+#include <time.h>
+#include <process.h>
+#include <synchronizer.h>
+
+using namespace EPOS;
+
+const unsigned int batches[] = { 1, 2, 4, 8, 16 };
+
+OStream cout;
+
+volatile bool done;
+
+int stopper()
+{
+    Alarm::delay(1000000);
+    done = true;
+    return 0;
+}
+
+template<typename F>
+unsigned long rate(F f)
+{
+    done = false;
+    Thread * thread = new Thread(&stopper);
+
+    unsigned long n = 0;
+    while(!done) {
+        f();
+        n++;
+    }
+
+    thread->join();
+    delete thread;
+
+    return n;
+}
+
+int main()
+{
+    cout << "System Call Ring Benchmark" << endl;
+
+    Semaphore semaphore(0);
+
+    unsigned long n = rate([&]() { semaphore.v(); });
+    cout << "trap per call: " << n << " calls/s, " << 1000000000ULL / n << " ns/call" << endl;
+
+    cout << "batch\tcalls/s\tns/call" << endl;
+    for(unsigned int b = 0; b < sizeof(batches) / sizeof(batches[0]); b++) {
+        unsigned int batch = batches[b];
+        n = batch * rate([&]() {
+            for(unsigned int i = 0; i < batch; i++)
+                semaphore.post_v();
+            Semaphore::submit();
+        });
+
+        cout << batch << "\t" << n << "\t" << 1000000000ULL / n << endl;
+    }
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+// EPOS Per-Thread PMU Test
+//
+// Two threads sharing CPU 0 run different workloads, each counting its own retired instructions and CPU cycles
+// through a Clerk<PMU> bound to it, while the main thread counts the whole run with a per-CPU Clerk<PMU>.
+// The compute thread should retire many more instructions per cycle than the memory walker, and the per-thread
+// cycle counts should add up to (a bit less than) the per-CPU one, however the scheduler interleaves the threads.
+// Reading the PMU while in QEMU is only available with KVM enabled.
+// This test requires Traits<Build>::SMOD == LIBRARY.
+
+#include <time.h>
+#include <process.h>
+#include <clerk.h>
+
+using namespace EPOS;
+
+const unsigned int ITERATIONS = 5;
+const unsigned int WORK = 2000000;
+const unsigned int ARRAY_SIZE = 256 * 1024;
+
+OStream cout;
+
+volatile unsigned int sink;
+unsigned int array[ARRAY_SIZE];
+
+PMU::Count instructions[2];
+PMU::Count cycles[2];
+
+void compute()
+{
+    unsigned int x = 1;
+    for(unsigned int i = 0; i < WORK; i++)
+        x = x * 1103515245 + 12345;
+    sink = x;
+}
+
+void walk()
+{
+    unsigned int j = 0;
+    for(unsigned int i = 0; i < WORK / 4; i++) {
+        j = (j + 4099) % ARRAY_SIZE;    // a stride that defeats the caches
+        array[j]++;
+    }
+}
+
+int run(int id)
+{
+    Clerk<PMU> retired(PMU_Event::INSTRUCTIONS_RETIRED, Thread::self());
+    Clerk<PMU> elapsed(PMU_Event::CPU_CYCLES, Thread::self());
+
+    for(unsigned int i = 0; i < ITERATIONS; i++) {
+        if(id == 0)
+            compute();
+        else
+            walk();
+        Thread::yield();
+    }
+
+    instructions[id] = retired.read();
+    cycles[id] = elapsed.read();
+
+    return 0;
+}
+
+int main()
+{
+    cout << "Per-Thread PMU Test" << endl;
+
+    Clerk<PMU> total(PMU_Event::CPU_CYCLES);
+    total.start();
+
+    Thread * a = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, 0)), &run, 0);
+    Thread * b = new Thread(Thread::Configuration(Thread::READY, Thread::Criterion(Thread::NORMAL, 0)), &run, 1);
+    a->join();
+    b->join();
+
+    total.stop();
+    PMU::Count all = total.read();
+
+    delete a;
+    delete b;
+
+    cout << "thread\tinstructions\tcycles" << endl;
+    cout << "compute\t" << instructions[0] << "\t" << cycles[0] << endl;
+    cout << "walk\t" << instructions[1] << "\t" << cycles[1] << endl;
+    cout << "CPU cycles during the test: " << all << endl;
+
+    if(cycles[0] + cycles[1] > all)
+        cout << "Per-thread counts exceed the per-CPU count!" << endl;
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
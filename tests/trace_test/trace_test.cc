@@ -0,0 +1,50 @@
+// EPOS Monitor Trace Test
+//
+// Threads alternate between computing and sleeping while the Monitor samples the system events configured in
+// Traits<Monitor> and the scheduler records each dispatch. The trace is streamed through the console UART while
+// the test runs and can be decoded from the captured output with:
+//   tools/epostrace/epostrace.py img/trace_test.out > trace.csv
+//   tools/epostrace/epostrace.py --chrome img/trace_test.out > trace.json
+
+#include <time.h>
+#include <process.h>
+#include <clerk.h>
+
+using namespace EPOS;
+
+const unsigned int THREADS = 4;
+const unsigned int iterations = 50;
+
+OStream cout;
+
+int worker(unsigned int n)
+{
+    for(unsigned int i = 0; i < iterations; i++) {
+        volatile unsigned int sum = 0;
+        for(unsigned int j = 0; j < 100000 * (n + 1); j++)
+            sum += j;
+        Alarm::delay(5000 * (n + 1));
+    }
+
+    return n;
+}
+
+int main()
+{
+    cout << "Monitor Trace Test" << endl;
+
+    Monitor::enable_captures();
+
+    Thread * threads[THREADS];
+    for(unsigned int i = 0; i < THREADS; i++)
+        threads[i] = new Thread(&worker, i);
+
+    for(unsigned int i = 0; i < THREADS; i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
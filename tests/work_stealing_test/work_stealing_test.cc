@@ -0,0 +1,68 @@
+// EPOS Work Stealing Benchmark
+//
+// Best-effort threads are spread over the CPUs by Fixed_CPU, but those that land on CPU 0 get
+// much more work than the others, so the remaining CPUs soon run out of threads.
+// At the end, the elapsed time and the per-CPU steal and migration counters are reported.
+// Compare runs with Traits<Thread>::work_stealing enabled and disabled.
+
+#include <time.h>
+#include <process.h>
+
+using namespace EPOS;
+
+const unsigned int CPUS = Traits<Machine>::CPUS;
+const unsigned int THREADS = 4; // per CPU
+const unsigned int iterations = 1000000;
+const unsigned int imbalance = 8;
+
+OStream cout;
+
+volatile unsigned int work[CPUS * THREADS];
+
+int worker(unsigned int n);
+
+int main()
+{
+    cout << "Work Stealing Benchmark" << endl;
+    cout << "CPUS=" << CPUS << ", work_stealing=" << Traits<Thread>::work_stealing << ", threads=" << CPUS * THREADS << endl;
+
+    Thread * threads[CPUS * THREADS];
+
+    // Created suspended, so the work of each thread can be set according to the queue it was placed in
+    for(unsigned int i = 0; i < CPUS * THREADS; i++) {
+        threads[i] = new Thread(Thread::Configuration(Thread::SUSPENDED, Thread::Criterion(Thread::NORMAL)), &worker, i);
+        work[i] = (threads[i]->priority().queue() == 0) ? iterations * imbalance : iterations;
+    }
+
+    TSC::Time_Stamp begin = TSC::time_stamp();
+
+    for(unsigned int i = 0; i < CPUS * THREADS; i++)
+        threads[i]->resume();
+    for(unsigned int i = 0; i < CPUS * THREADS; i++)
+        threads[i]->join();
+
+    TSC::Time_Stamp elapsed = TSC::time_stamp() - begin;
+
+    cout << "Elapsed: " << TSC::time(elapsed) << " us" << endl;
+    cout << "CPU\tsteals\tmigrations" << endl;
+    for(unsigned int i = 0; i < CPUS; i++) {
+        const Thread::Steal_Statistics & s = Thread::steal_statistics(i);
+        cout << i << "\t" << s.steals << "\t" << s.migrations << endl;
+    }
+
+    for(unsigned int i = 0; i < CPUS * THREADS; i++)
+        delete threads[i];
+
+    cout << "The end!" << endl;
+
+    return 0;
+}
+
+int worker(unsigned int n)
+{
+    volatile unsigned int sum = 0;
+    for(unsigned int i = 0; i < work[n]; i++)
+        sum += i;
+
+    return n;
+}
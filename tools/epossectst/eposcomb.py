@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+
+# EPOS Diffie-Hellman comb generator
+# This script prints the comb of secp128r1's base point used by include/utility/diffie_hellman.h
+# (_default_base_point_comb): entry j - 1 is the sum of 2^(32 * t) * G for each bit t set in j, in affine coordinates
+
+p = 2**128 - 2**97 - 1
+a = p - 3
+b = 0xE87579C11079F43DD824993C2CEE5ED3
+G = (0x161FF7528B899B2D0C28607CA52C5B86, 0xCF5AC8395BAFEB13C02DA292DDED7A83)
+
+WINDOW = 4
+SPACING = 128 // WINDOW
+
+# Affine point addition (None is the point at infinity)
+def add(P, Q):
+    if P is None:
+        return Q
+    if Q is None:
+        return P
+    if P[0] == Q[0] and (P[1] + Q[1]) % p == 0:
+        return None
+    if P == Q:
+        l = (3 * P[0] * P[0] + a) * pow(2 * P[1], -1, p) % p
+    else:
+        l = (Q[1] - P[1]) * pow(Q[0] - P[0], -1, p) % p
+    x = (l * l - P[0] - Q[0]) % p
+    return (x, (l * (P[0] - x) - P[1]) % p)
+
+def mult(k, P):
+    R = None
+    while k:
+        if k & 1:
+            R = add(R, P)
+        P = add(P, P)
+        k >>= 1
+    return R
+
+# Little-endian bytes, in EPOS' format
+def coordinate(v, last):
+    q = ["'\\x%02X'" % c for c in v.to_bytes(16, 'little')]
+    return "  {" + ", ".join(q[:8]) + ",\n   " + ", ".join(q[8:]) + "}" + last
+
+assert (G[1]**2 - G[0]**3 - a * G[0] - b) % p == 0
+
+for j in range(1, 2**WINDOW):
+    teeth = [t for t in range(WINDOW) if (j >> t) & 1]
+    terms = ["2^%d" % (SPACING * t) for t in teeth]
+    print(" { // %s * G" % (("(" + " + ".join(terms) + ")") if len(terms) > 1 else terms[0]))
+    P = mult(sum(1 << (SPACING * t) for t in teeth), G)
+    print(coordinate(P[0], ","))
+    print(coordinate(P[1], "}," if j < 2**WINDOW - 1 else "}"))
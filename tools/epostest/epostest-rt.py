@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+
+# EPOS Real-Time Benchmark Comparator
+# This script compares the results of app/tc2026 (the lines starting with "tc2026," in its output, collected by
+# "epostest rt" into one CSV file per target and task set) against a baseline with files of the same names.
+# A task fails if any iteration failed, if it ran fewer jobs or missed more deadlines than in the baseline, or if
+# the p99 of its response time, release jitter or execution time grew beyond the tolerance.
+# With --update, the results become the new baseline.
+
+import argparse
+import csv
+import os
+import shutil
+import sys
+
+PREFIX = 'tc2026'
+METRICS = ['response_p99', 'jitter_p99', 'execution_p99']
+SLACK = 100  # us, so a tick of difference in short tasks is not reported as a regression
+
+RED = '\033[0;31m'
+GREEN = '\033[0;32m'
+NORMAL = '\033[0m'
+
+
+def read(path):
+    rows = {}
+    with open(path) as f:
+        for row in csv.DictReader(line[len(PREFIX) + 1:] for line in f if line.startswith(PREFIX + ',')):
+            rows[(row['task'], row['benchmark'])] = {k: (int(v) if v.isdigit() else v) for k, v in row.items()}
+    return rows
+
+
+def compare(current, baseline, tolerance):
+    failures = []
+    for key, row in sorted(current.items()):
+        name = 'task %s (%s)' % key
+        if row['errors']:
+            failures.append('%s: %d failed iterations' % (name, row['errors']))
+        if key not in baseline:
+            continue
+        base = baseline[key]
+        if row['jobs'] < base['jobs']:
+            failures.append('%s: %d jobs (baseline %d)' % (name, row['jobs'], base['jobs']))
+        if row['misses'] > base['misses']:
+            failures.append('%s: %d deadline misses (baseline %d)' % (name, row['misses'], base['misses']))
+        for metric in METRICS:
+            limit = max(base[metric] * (100 + tolerance) // 100, base[metric] + SLACK)
+            if row[metric] > limit:
+                failures.append('%s: %s = %d us (baseline %d us)' % (name, metric, row[metric], base[metric]))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare tc2026 results against a baseline.')
+    parser.add_argument('baseline', help='directory with the baseline CSV files')
+    parser.add_argument('results', nargs='+', help='CSV files produced by "epostest rt"')
+    parser.add_argument('--tolerance', type=int, default=20, help='allowed growth of p99 metrics in percent (default: 20)')
+    parser.add_argument('--update', action='store_true', help='store the results as the new baseline')
+    args = parser.parse_args()
+
+    failed = 0
+    for result in args.results:
+        name = os.path.basename(result)
+        reference = os.path.join(args.baseline, name)
+        current = read(result)
+
+        if args.update:
+            os.makedirs(args.baseline, exist_ok=True)
+            shutil.copyfile(result, reference)
+            print('%s: stored as baseline' % name)
+            continue
+
+        if not current:
+            print('%s%s: no results (did the benchmark finish?)%s' % (RED, name, NORMAL))
+            failed += 1
+            continue
+
+        failures = compare(current, read(reference) if os.path.exists(reference) else {}, args.tolerance)
+        if failures:
+            failed += 1
+            print('%s%s: FAILED%s' % (RED, name, NORMAL))
+            for failure in failures:
+                print('    ' + failure)
+        elif not os.path.exists(reference):
+            print('%s: no baseline (run "epostest rt update" to store one)' % name)
+        else:
+            print('%s%s: passed%s' % (GREEN, name, NORMAL))
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+
+# EPOS Monitor Trace Decoder
+# This script extracts the binary trace frames streamed by Monitor (see Trace in include/clerk.h) from the output
+# captured from the console UART (e.g. img/<application>.out) and converts them into CSV or Chrome trace JSON
+# (chrome://tracing or https://ui.perfetto.dev).
+# Frames that fail the checksum (e.g. because some text got in the middle of them) are dropped.
+
+import argparse
+import json
+import sys
+
+SYNC = b'\xeb\x7e'
+HEADER_SIZE = 12
+MAX_FRAME = 256
+
+INFO = 0
+DATA = 1
+
+SYSTEM_EVENT = 0
+PMU_EVENT = 1
+TRANSDUCER_EVENT = 2
+SCHEDULER_EVENT = 3
+
+# Must match System_Event in include/system/traits.h
+SYSTEM_EVENTS = ['NONE', 'ELAPSED_TIME', 'DEADLINE_MISSES', 'CPU_EXECUTION_TIME', 'THREAD_EXECUTION_TIME',
+                 'RUNNING_THREAD', 'JOB_UTILIZATION', 'JOB_UTILIZATION_PER_PERIOD', 'CORE',
+                 'PREDICTED_JOB_UTILIZATION', 'THREAD_STEALS', 'THREAD_MIGRATIONS', 'CPU_CLOCK', 'CPU_VOLTAGE']
+
+# Must match Trace::Scheduler_Event in include/clerk.h
+SCHEDULER_EVENTS = ['DISPATCH', 'LOST']
+
+
+def event_name(event):
+    kind = event >> 12
+    number = event & 0xfff
+    if kind == SYSTEM_EVENT:
+        return 'System::' + (SYSTEM_EVENTS[number] if number < len(SYSTEM_EVENTS) else str(number))
+    if kind == PMU_EVENT:
+        return 'PMU::' + str(number)
+    if kind == TRANSDUCER_EVENT:
+        return 'Transducer::' + str(number)
+    if kind == SCHEDULER_EVENT:
+        return 'Scheduler::' + (SCHEDULER_EVENTS[number] if number < len(SCHEDULER_EVENTS) else str(number))
+    return 'Unknown::' + str(event)
+
+
+def varint(data, i):
+    value = 0
+    shift = 0
+    while True:
+        if i >= len(data):
+            raise ValueError('truncated record')
+        c = data[i]
+        value |= (c & 0x7f) << shift
+        shift += 7
+        i += 1
+        if not c & 0x80:
+            return value, i
+
+
+# Yields (cpu, time stamp, event, value) for each record and sets info['frequency'] and info['cpus']
+def records(stream, info):
+    i = 0
+    dropped = 0
+    while True:
+        i = stream.find(SYNC, i)
+        if i < 0 or i + 2 + HEADER_SIZE > len(stream):
+            break
+
+        header = stream[i + 2:i + 2 + HEADER_SIZE]
+        kind = header[0]
+        cpu = header[1]
+        size = header[2] | (header[3] << 8)
+        base = int.from_bytes(header[4:12], 'little')
+        end = i + 2 + HEADER_SIZE + size
+        if kind not in (INFO, DATA) or size > MAX_FRAME or end >= len(stream) or (sum(stream[i + 2:end]) & 0xff) != stream[end]:
+            dropped += 1
+            i += 1
+            continue
+
+        if kind == INFO:
+            info['frequency'] = base
+            info['cpus'] = cpu
+        else:
+            payload = stream[i + 2 + HEADER_SIZE:end]
+            ts = base
+            j = 0
+            while j < len(payload):
+                delta, j = varint(payload, j)
+                event, j = varint(payload, j)
+                value, j = varint(payload, j)
+                ts += delta
+                yield cpu, ts, event, value
+
+        i = end + 1
+
+    if dropped:
+        print('epostrace: skipped', dropped, 'sync patterns that were not valid frames', file=sys.stderr)
+
+
+def to_us(ts, t0, info):
+    frequency = info.get('frequency', 0)
+    if not frequency:
+        return ts - t0
+    return (ts - t0) * 1000000.0 / frequency
+
+
+def csv(stream, output):
+    info = {}
+    t0 = None
+    output.write('time_us,cpu,event,value\n')
+    for cpu, ts, event, value in records(stream, info):
+        if t0 is None:
+            t0 = ts
+        output.write('%.3f,%d,%s,%d\n' % (to_us(ts, t0, info), cpu, event_name(event), value))
+
+
+def chrome(stream, output):
+    info = {}
+    t0 = None
+    events = []
+    running = {}  # cpu -> (thread, start)
+    for cpu, ts, event, value in records(stream, info):
+        if t0 is None:
+            t0 = ts
+        us = to_us(ts, t0, info)
+        name = event_name(event)
+        if event == (SCHEDULER_EVENT << 12):  # DISPATCH: close the slice of the previous thread of this CPU
+            if cpu in running:
+                thread, start = running[cpu]
+                events.append({'name': 'Thread %#x' % thread, 'ph': 'X', 'pid': 0, 'tid': cpu, 'ts': start, 'dur': us - start})
+            running[cpu] = (value, us)
+        elif event == (SCHEDULER_EVENT << 12) + 1:  # LOST
+            events.append({'name': name, 'ph': 'i', 's': 't', 'pid': 0, 'tid': cpu, 'ts': us, 'args': {'records': value}})
+        else:
+            events.append({'name': '%s (CPU%d)' % (name, cpu), 'ph': 'C', 'pid': 0, 'tid': cpu, 'ts': us, 'args': {'value': value}})
+
+    for cpu in range(info.get('cpus', 0)):
+        events.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': cpu, 'args': {'name': 'CPU%d' % cpu}})
+
+    json.dump({'traceEvents': events, 'displayTimeUnit': 'ns'}, output)
+    output.write('\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the binary trace streamed by the EPOS Monitor.')
+    parser.add_argument('input', nargs='?', help='captured console output (default: standard input)')
+    parser.add_argument('--chrome', action='store_true', help='produce Chrome trace JSON instead of CSV')
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, 'rb') as f:
+            stream = f.read()
+    else:
+        stream = sys.stdin.buffer.read()
+
+    if args.chrome:
+        chrome(stream, sys.stdout)
+    else:
+        csv(stream, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()